@@ -0,0 +1,53 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#define DEFAULT_LOG_CHANNEL "CthulhuAlignerMetaConvert"
+#include <cthulhu/AlignerMeta.h>
+#include <logging/Log.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Converts aligner meta logged with serialize() to the binary log format read by
+// AlignerMetaReader.
+//
+// Usage: CthulhuAlignerMetaConvert [--samples-only] input output
+//
+// The input is expected to hold the AlignerConfigsMeta followed by every AlignerSamplesMeta, or
+// only AlignerSamplesMeta with --samples-only.
+
+int main(int argc, char** argv) {
+  bool hasConfigs = true;
+  std::vector<std::string> paths;
+  for (int argIdx = 1; argIdx < argc; argIdx++) {
+    if ("--samples-only" == std::string_view(argv[argIdx])) {
+      hasConfigs = false;
+    } else {
+      paths.emplace_back(argv[argIdx]);
+    }
+  }
+  if (paths.size() != 2) {
+    XR_LOGE("Usage: CthulhuAlignerMetaConvert [--samples-only] input output");
+    return 1;
+  }
+
+  std::ifstream input(paths[0], std::ios::binary);
+  if (!input) {
+    XR_LOGE("Couldn't open {}", paths[0]);
+    return 1;
+  }
+  std::ofstream output(paths[1], std::ios::binary | std::ios::trunc);
+  if (!output) {
+    XR_LOGE("Couldn't open {} for writing", paths[1]);
+    return 1;
+  }
+  try {
+    const size_t converted = cthulhu::convertAlignerMeta(input, output, hasConfigs);
+    XR_LOGI("Converted {} samples meta to {}", converted, paths[1]);
+  } catch (const std::runtime_error&) {
+    return 1;
+  }
+  return output ? 0 : 1;
+}
@@ -4,10 +4,13 @@
 
 #include <cmath>
 #include <future>
-#include <queue>
+#include <deque>
+
+#include <boost/circular_buffer.hpp>
 
 #include <cthulhu/AlignerMeta.h>
 #include <cthulhu/StreamInterface.h>
+#include <cthulhu/Watchdog.h>
 
 namespace cthulhu {
 
@@ -16,6 +19,10 @@ using AlignerConfigCallback = std::function<bool(const std::vector<StreamConfig>
 using AlignerSamplesMetaCallback = std::function<void(const AlignerSamplesMeta&)>;
 using AlignerConfigsMetaCallback = std::function<void(const AlignerConfigsMeta&)>;
 
+// The samples queued on one stream of an Aligner. The queues are bounded, so they are ring buffers
+// sized once rather than deques that allocate and free blocks as samples pass through.
+using AlignerSampleQueue = boost::circular_buffer<StreamSample>;
+
 // Thread policies are:
 //  - THREAD_NEUTRAL: Aligner/Dispatcher do not spawn any new threads. For example, the thread that
 //                    calls sampleCallback will also call alignedCallback
@@ -37,10 +44,14 @@ class AlignerBase {
   void setSamplesMetaCallback(const AlignerSamplesMetaCallback& callback);
   void setConfigsMetaCallback(const AlignerConfigsMetaCallback& callback);
 
+  // Has the Watchdog check the aligner against budget, reporting it under the given name. maxAge
+  // bounds how long samples may wait for the next aligned set.
+  void setWatchdogBudget(const std::string& name, const WatchdogBudget& budget);
+
   // This should be called once all consumers are registered
   // align() should only be called once we are finalized, and
   // we cannot be un-finalized (the transition is uni-directional)
-  void finalize();
+  virtual void finalize();
 
   // Clear the aligner's internal sample state, if any.
   //
@@ -76,6 +87,8 @@ class AlignerBase {
   bool inhibitSampleCallback_ = false;
 
   std::atomic<bool> finalized_;
+
+  Heartbeat heartbeat_;
 }; // class AlignerBase
 
 enum class AlignerMode : uint32_t { TIMESTAMP = 0, SEQUENCE = 1 };
@@ -103,7 +116,7 @@ class Aligner : public AlignerBase {
   void execute(const std::vector<StreamSample>& samples);
 
   struct StreamQueue {
-    std::queue<StreamSample> samples;
+    AlignerSampleQueue samples;
     std::deque<std::pair<uint32_t, StreamConfig>> configs;
     uint32_t latestSequence = 0;
     std::unique_ptr<StreamConsumer> consumer;
@@ -115,6 +128,9 @@ class Aligner : public AlignerBase {
   // This enables multi-threaded access to the queues_ via sampleCallback. The public functions
   // are not thread-safe.
   std::mutex queueMutex_;
+  // Bumped whenever a sample is queued, so aligners polling from their own thread can tell
+  // whether anything changed since they last looked. Guarded by queueMutex_.
+  uint64_t queueVersion_ = 0;
   double threshold_;
   std::function<bool(const StreamSample& sample1, const StreamSample& sample2)> comparison_;
   bool configured_ = false;
@@ -4,7 +4,11 @@
 
 #include <cthulhu/StreamInterface.h>
 
+#include <istream>
+#include <optional>
+#include <ostream>
 #include <sstream>
+#include <vector>
 
 namespace cthulhu {
 
@@ -38,4 +42,100 @@ void deserialize(std::istringstream& input, AlignerConfigsMeta& output);
 
 void deserialize(std::istringstream& input, AlignerSamplesMeta& output);
 
+// Fixed-layout binary encoding of aligner meta, written with memcpy rather than iostreams, for
+// logging the meta of every aligned output. Unlike serialize(), it keeps the duration of each
+// aligned output and the timestamp of each reference.
+//
+// AlignerSamplesMeta: uint32 count, uint32 reserved, then per aligned output
+//   - float64 timestamp, float64 duration, uint32 reference count, uint32 reserved
+//   - per reference: float64 timestamp, uint32 sequence number, uint32 subsample offset,
+//     uint32 subsample count, uint32 reserved
+// AlignerConfigsMeta: uint32 count, then per stream uint16 stream ID length, stream ID, uint32
+//   subsample size
+// All fields are in host byte order, and reserved fields are zero.
+
+size_t encodedSize(const AlignerConfigsMeta& input);
+size_t encodedSize(const AlignerSamplesMeta& input);
+
+// Encodes into a buffer of the caller. Returns the bytes written, or 0 if capacity is less than
+// encodedSize(input).
+size_t encode(const AlignerConfigsMeta& input, uint8_t* output, size_t capacity);
+size_t encode(const AlignerSamplesMeta& input, uint8_t* output, size_t capacity);
+
+// Appends the encoding to output
+void encode(const AlignerConfigsMeta& input, std::vector<uint8_t>& output);
+void encode(const AlignerSamplesMeta& input, std::vector<uint8_t>& output);
+
+// Encodes into a buffer of the memory pool of the stream, of encodedSize(input) bytes
+CpuBuffer encode(const AlignerSamplesMeta& input, StreamHandle poolHandle);
+
+// Decodes an encoding at the start of data. Returns the bytes it took, or 0 if it is truncated or
+// malformed.
+size_t decode(const uint8_t* data, size_t length, AlignerConfigsMeta& output);
+size_t decode(const uint8_t* data, size_t length, AlignerSamplesMeta& output);
+
+namespace alignermeta {
+
+// Aligner meta logs are a FileHeader followed by records, each a RecordHeader and the encoding of
+// an AlignerConfigsMeta or AlignerSamplesMeta
+constexpr uint32_t kFileMagic = 0x424d4c41;
+constexpr uint16_t kVersion = 1;
+
+enum class RecordKind : uint32_t { CONFIGS = 0, SAMPLES = 1 };
+
+struct FileHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t reserved;
+};
+
+struct RecordHeader {
+  RecordKind kind;
+  uint32_t bytes;
+};
+
+static_assert(sizeof(FileHeader) == 8, "FileHeader must not be padded");
+static_assert(sizeof(RecordHeader) == 8, "RecordHeader must not be padded");
+
+} // namespace alignermeta
+
+// Appends aligner meta to a log, one record at a time, e.g. from the aligner's meta callbacks
+class AlignerMetaWriter {
+ public:
+  // Writes the file header
+  explicit AlignerMetaWriter(std::ostream& output);
+
+  void write(const AlignerConfigsMeta& meta);
+  void write(const AlignerSamplesMeta& meta);
+
+ private:
+  void writeRecord(alignermeta::RecordKind kind);
+
+  std::ostream& output_;
+  // Reused between records
+  std::vector<uint8_t> buffer_;
+};
+
+class AlignerMetaReader {
+ public:
+  // Throws if the log doesn't start with a file header of a known version
+  explicit AlignerMetaReader(std::istream& input);
+
+  // Decodes the next record into configs or samples, depending on its kind. Returns std::nullopt
+  // at the end of the log, and throws if a record is truncated or malformed.
+  std::optional<alignermeta::RecordKind> next(
+      AlignerConfigsMeta& configs,
+      AlignerSamplesMeta& samples);
+
+ private:
+  std::istream& input_;
+  std::vector<uint8_t> buffer_;
+};
+
+// Converts a log written with serialize(), an AlignerConfigsMeta followed by AlignerSamplesMeta
+// until the end, or only AlignerSamplesMeta if hasConfigs is false. The fields the old format
+// lacks, durations and reference timestamps, are written as 0. Returns the number of
+// AlignerSamplesMeta converted, and throws if the input is truncated.
+size_t convertAlignerMeta(std::istream& input, std::ostream& output, bool hasConfigs = true);
+
 } // namespace cthulhu
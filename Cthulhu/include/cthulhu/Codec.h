@@ -0,0 +1,132 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cthulhu/StreamInterface.h>
+#include <cthulhu/TypeRegistryInterface.h>
+
+namespace cthulhu {
+
+// Codecs compress the content blocks of serialized samples, for recording and bridging
+enum class CodecType : uint8_t { NONE = 0, LZ4 = 1, DELTA_BITPACK = 2 };
+
+class Codec {
+ public:
+  virtual ~Codec() = default;
+
+  virtual CodecType type() const = 0;
+
+  // Appends the encoding of size bytes to out
+  virtual void encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out) const = 0;
+
+  // Decodes exactly decodedSize bytes into out. Returns false if the encoding is malformed, or
+  // doesn't decode to decodedSize bytes.
+  virtual bool decode(const uint8_t* data, size_t size, uint8_t* out, size_t decodedSize)
+      const = 0;
+
+  // Upper bound of the bytes that size encoded bytes can decode to, to reject implausible sizes
+  // before allocating for them
+  virtual size_t maxDecodedSize(size_t size) const = 0;
+};
+
+// General-purpose compression in the LZ4 block format
+class Lz4Codec : public Codec {
+ public:
+  CodecType type() const override {
+    return CodecType::LZ4;
+  }
+  void encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out) const override;
+  bool decode(const uint8_t* data, size_t size, uint8_t* out, size_t decodedSize) const override;
+  size_t maxDecodedSize(size_t size) const override;
+};
+
+// For integer signals, such as multichannel recordings: each element is replaced by its difference
+// from the element stride elements before it (the same channel, one subsample earlier), zig-zag
+// encoded so that small negative differences stay small, and bit-packed in blocks of 128 at the
+// width of the largest. The element size, stride and decoded size are written with the encoding,
+// so any instance decodes it.
+class DeltaBitPackCodec : public Codec {
+ public:
+  // elementBytes is 1, 2, 4 or 8
+  explicit DeltaBitPackCodec(size_t elementBytes = 2, size_t stride = 1);
+
+  CodecType type() const override {
+    return CodecType::DELTA_BITPACK;
+  }
+  void encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out) const override;
+  bool decode(const uint8_t* data, size_t size, uint8_t* out, size_t decodedSize) const override;
+  size_t maxDecodedSize(size_t size) const override;
+
+ private:
+  uint8_t elementBytes_;
+  uint32_t stride_;
+};
+
+// Picks the codec for the content blocks of a stream: delta bit-packing if its samples in the
+// content block are made of integer fields of a single width, and LZ4 otherwise. Returns nullptr
+// if the type has no content block.
+std::shared_ptr<const Codec> selectCodec(
+    const TypeInfoInterface& typeInfo,
+    const StreamConfig& config);
+
+// A codec able to decode content blocks of the given type, or nullptr for NONE
+const Codec* decoderFor(CodecType type);
+
+/**
+ *  Serialize a Stream Sample as serializeSample does, except that the content block is replaced by
+ * its size once encoded, as a uint32, followed by its encoding. Returns an empty vector on failure.
+ */
+std::vector<uint8_t> encodeSample(
+    const std::string& typeName,
+    const StreamSample& sample,
+    const StreamConfig* const config,
+    const Codec& codec);
+
+/**
+ *  Deserialize a Stream Sample written by encodeSample, checking that it fits in length bytes.
+ * The parameters and payload are taken from the memory pool of the given stream. Returns false if
+ * the bytes are malformed.
+ */
+bool decodeSample(
+    const std::string& typeName,
+    const uint8_t* data,
+    size_t length,
+    const StreamConfig* const config,
+    const Codec& codec,
+    StreamSample& sample,
+    StreamHandle poolHandle = StreamHandles::anonymous());
+
+// Worker threads for encoding off the producer's thread. Jobs submitted with the same key run in
+// the order they were submitted, on the same worker.
+class CodecPool {
+ public:
+  explicit CodecPool(size_t numThreads);
+  ~CodecPool();
+
+  void submit(size_t key, std::function<void()> job);
+
+ private:
+  struct Worker {
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable pending;
+    bool stop = false;
+    std::thread thread;
+  };
+
+  void run(Worker& worker);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+} // namespace cthulhu
@@ -7,6 +7,7 @@
 #include <cthulhu/Aligner.h>
 #include <cthulhu/Dispatcher.h>
 #include <cthulhu/Framework.h>
+#include <cthulhu/SampleView.h>
 
 namespace cthulhu {
 
@@ -19,7 +20,8 @@ std::unique_ptr<T> ptrWrap(T&& obj) {
 
 template <typename T>
 TypeInfoInterfacePtr sampleType() {
-  auto type = Framework::instance().typeRegistry()->findSampleType(typeid(T));
+  auto type =
+      Framework::instance().typeRegistry()->findSampleType(typeid(details::viewed_type_t<T>));
   if (!type) {
     auto str = "Failed to lookup type in registry: " + std::string(typeid(T).name());
     XR_LOGCE("Cthulhu", "{}", str);
@@ -242,7 +244,51 @@ class MultiPublisher : public NodeBase {
 };
 using MultiPublisherPtr = std::unique_ptr<MultiPublisher>;
 
-enum class ConsumerType : uint8_t { SYNC = 0, ASYNC = 1 };
+// Forward Declarations
+template <typename T>
+class TransformerChain;
+namespace details {
+class FusedStage;
+} // namespace details
+
+// This is a handle for a chain of sync transformers that have been fused into a single node. It
+// can only be constructed by a TransformerChain
+class FusedTransformer : public NodeBase {
+ public:
+  FusedTransformer& operator=(FusedTransformer&& other) = delete;
+  FusedTransformer(FusedTransformer&& other) = default;
+
+  FusedTransformer& operator=(const FusedTransformer& other) = delete;
+  FusedTransformer(const FusedTransformer& other) = delete;
+
+  virtual ~FusedTransformer() {
+    // Must delete the consumer before the producers to prevent the consumer thread from
+    // accessing the producers after they're deleted
+    consumer_.reset();
+    producers_.clear();
+  };
+
+ private:
+  explicit FusedTransformer(
+      const std::vector<StreamIDView>& ids,
+      std::unique_ptr<StreamConsumer> consumer,
+      std::vector<std::unique_ptr<StreamProducer>> producers)
+      : NodeBase(true),
+        consumer_(std::move(consumer)),
+        producers_(std::move(producers)),
+        ids_(ids){};
+  FusedTransformer(const std::vector<StreamIDView>& ids) : ids_(ids){};
+  std::unique_ptr<StreamConsumer> consumer_;
+  std::vector<std::unique_ptr<StreamProducer>> producers_;
+  const std::vector<StreamIDView> ids_;
+  template <typename T>
+  friend class TransformerChain;
+};
+using FusedTransformerPtr = std::unique_ptr<FusedTransformer>;
+
+// SCHEDULED consumers are run by a shared executor, in order of their priority and deadline (see
+// ConsumerScheduling)
+enum class ConsumerType : uint8_t { SYNC = 0, ASYNC = 1, SCHEDULED = 2 };
 
 enum class ProducerType : uint8_t { SYNC = 0, ASYNC = 1 };
 
@@ -252,6 +298,7 @@ enum class DispatcherType : uint8_t { SYNC = 0, ASYNC = 1, CUSTOM = 2 };
 
 struct SubscriberOptions {
   ConsumerType consumerType = ConsumerType::SYNC;
+  ConsumerScheduling scheduling;
 };
 
 struct PublisherOptions {
@@ -261,8 +308,23 @@ struct PublisherOptions {
 struct TransformerOptions {
   ConsumerType consumerType = ConsumerType::SYNC;
   ProducerType producerType = ProducerType::SYNC;
+  ConsumerScheduling scheduling;
 };
 
+namespace details {
+// Creates the consumer of a single-stream node
+inline std::unique_ptr<StreamConsumer> makeConsumer(
+    StreamInterface* si,
+    SampleCallback sampleCallback,
+    ConfigCallback configCallback,
+    ConsumerType consumerType,
+    ConsumerScheduling scheduling = ConsumerScheduling()) {
+  scheduling.scheduled = consumerType == ConsumerType::SCHEDULED;
+  return std::make_unique<StreamConsumer>(
+      si, sampleCallback, configCallback, consumerType == ConsumerType::ASYNC, scheduling);
+}
+} // namespace details
+
 struct MultiSubscriberOptions {
   AlignerType alignerType = AlignerType::SYNC;
   std::unique_ptr<AlignerBase> alignerPtr;
@@ -367,7 +429,7 @@ class Context {
         streamID.substr(0, name_.size()) == name_;
   }
 
-  // Template for constructing a subscriber
+  // Template for constructing a subscriber. T may be a SampleView to receive borrowed samples.
   template <typename T, typename U = DefaultStreamConfig>
   Subscriber subscribe(
       const StreamID& streamID,
@@ -398,7 +460,8 @@ class Context {
       const std::function<bool(const StreamConfig&)>& configCallback = nullptr,
       SubscriberOptions options = SubscriberOptions()) const;
 
-  // Template for constructing a transformer
+  // Template for constructing a transformer. The input type T may be a SampleView to receive
+  // borrowed samples.
   template <typename T, typename U, typename X>
   Transformer transform(
       const StreamID& inputID,
@@ -425,6 +488,11 @@ class Context {
       const std::function<bool(const W&, X&)>& configCallback = nullptr,
       TransformerOptions options = TransformerOptions()) const;
 
+  // Starts a chain of sync transformers reading samples of type T from inputID. The chain is
+  // fused into a single node when built, see TransformerChain.
+  template <typename T>
+  TransformerChain<T> chain(const StreamID& inputID) const;
+
   // Template for constructing a publisher
   template <typename T>
   Publisher advertise(const StreamID& streamID, PublisherOptions options = PublisherOptions())
@@ -501,6 +569,70 @@ class Context {
   ContextInfoInterface* ctx_;
   std::string name_;
   bool private_ns_;
+
+  template <typename T>
+  friend class TransformerChain;
+};
+
+// Builds a linear chain of sync transformers and fuses it into a single node. Rather than hopping
+// through a producer, stream and consumer per stage, the stages are composed into one callback on
+// the input stream's consumer:
+//
+//   auto node = context.chain<ImageData>("raw")
+//                   .then<ImageData, ImageConfig, ImageConfig>("gray", toGray, grayConfig)
+//                   .then<ImageData, ImageConfig, ImageConfig>("blurred", blur, blurConfig)
+//                   .build();
+//
+// Each intermediate stream is still registered and configured, but samples are only published on
+// it while it has consumers. While unobserved, its sample buffers are reused in place between
+// invocations instead of being reallocated from the pool, so a stage callback must write every
+// field of its output rather than relying on a freshly allocated sample. The last stream is always
+// published. Only AutoStreamSample types are supported.
+template <typename T>
+class TransformerChain {
+ public:
+  // Appends a stage producing samples of type U on outputID, and returns the extended chain. The
+  // callbacks follow the same rules as Context::transform. Like transform, a stage without a config
+  // callback never configures its output, so it and every later stage will drop samples. The chain
+  // is moved into the returned one, so this can only be called on an rvalue.
+  template <typename U, typename W = DefaultStreamConfig, typename X = DefaultStreamConfig>
+  TransformerChain<U> then(
+      const StreamID& outputID,
+      const std::function<void(const T&, U&)>& sampleCallback,
+      const std::function<bool(const W&, X&)>& configCallback = nullptr) &&;
+
+  // Hooks the fused chain onto the input stream. Only the consumer type is configurable, since
+  // all stages after the first run synchronously in the consumer's callback. Like then, this
+  // consumes the chain.
+  FusedTransformer build(ConsumerType consumerType = ConsumerType::SYNC) &&;
+
+ private:
+  using SampleStage = std::function<const T*(const StreamSample&)>;
+  using ConfigStage = std::function<const StreamConfig*(const StreamConfig&)>;
+
+  TransformerChain(const Context* context, const StreamID& inputID);
+  TransformerChain(
+      const Context* context,
+      StreamInterface* input,
+      std::vector<StreamIDView> ids,
+      std::vector<std::unique_ptr<StreamProducer>> producers,
+      std::shared_ptr<details::FusedStage> lastStage,
+      SampleStage sampleStage,
+      ConfigStage configStage,
+      bool valid);
+
+  const Context* context_;
+  StreamInterface* input_ = nullptr;
+  std::vector<StreamIDView> ids_;
+  std::vector<std::unique_ptr<StreamProducer>> producers_;
+  std::shared_ptr<details::FusedStage> lastStage_;
+  SampleStage sampleStage_;
+  ConfigStage configStage_;
+  bool valid_ = true;
+
+  template <typename V>
+  friend class TransformerChain;
+  friend class Context;
 };
 
 inline static const std::shared_ptr<ClockInterface> clock() {
@@ -53,14 +53,24 @@ T Publisher::allocateSample(uint32_t numSubSamples) const {
     XR_LOGCW("Cthulhu", "{}", str);
     throw std::runtime_error(str);
   }
-  return details::allocateSampleHelper<T>(producer_->config(), id_, numSubSamples);
+  return details::allocateSampleHelper<T>(producer_->config(), producer_->handle(), numSubSamples);
 };
 
 template <typename... T>
 bool MultiPublisher::publish(const T&... args) {
-  std::vector<StreamSample> samplesUnflat(ids_.size());
-  bool success = details::SampleUncaster<T...>::uncast(samplesUnflat, 0, args...);
-  dispatcher_->dispatchSamples(samplesUnflat);
+  // The flattened samples are kept per thread, so that publishing from several threads doesn't
+  // race and publishing doesn't allocate. The scratch is taken for the duration of the call, so a
+  // publish nested in a consumer callback of this one gets its own vector.
+  thread_local std::vector<StreamSample> scratch;
+  std::vector<StreamSample> samples = std::move(scratch);
+  samples.resize(ids_.size(), StreamSample(StreamSample::Unallocated()));
+  bool success = details::SampleUncaster<T...>::uncast(samples, 0, args...);
+  // The scratch samples have no metadata until they are filled in, so only dispatch a full set
+  if (success) {
+    dispatcher_->dispatchSamples(samples);
+  }
+  details::releaseSamples(samples);
+  scratch = std::move(samples);
   return success;
 };
 
@@ -87,7 +97,7 @@ T MultiPublisher::allocateSample(uint32_t streamNum, uint32_t numSubSamples) con
     throw std::runtime_error(str);
   }
   return details::allocateSampleHelper<T>(
-      dispatcher_->streamConfig(streamNum), ids_[streamNum], numSubSamples);
+      dispatcher_->streamConfig(streamNum), dispatcher_->streamHandle(streamNum), numSubSamples);
 };
 
 template <typename T, typename U>
@@ -105,7 +115,8 @@ Subscriber Context::subscribe(
       "Context::subscribe requires that configuration type U is constructed with const StreamConfig&");
   // Make sure the stream is valid
   if (!std::is_same<U, DefaultStreamConfig>::value &&
-      !Framework::instance().typeRegistry()->isValidStreamType(typeid(T), typeid(U))) {
+      !Framework::instance().typeRegistry()->isValidStreamType(
+          typeid(details::viewed_type_t<T>), typeid(U))) {
     auto str = "Stream/Config Mismatch";
     XR_LOGCW("Cthulhu", "{}", str);
     throw std::runtime_error(str);
@@ -145,8 +156,8 @@ Subscriber Context::subscribe(
   }
 
   // Create Consumer
-  std::unique_ptr<StreamConsumer> consumer(
-      new StreamConsumer(si, scallback, ccallback, options.consumerType == ConsumerType::ASYNC));
+  auto consumer = details::makeConsumer(
+      si, scallback, ccallback, options.consumerType, options.scheduling);
 
   // Return Node
   if (ctx_ == nullptr) {
@@ -219,7 +230,8 @@ Transformer Context::transform(
 
   // Make sure the streams are valid
   if ((!std::is_same<W, DefaultStreamConfig>::value &&
-       !Framework::instance().typeRegistry()->isValidStreamType(typeid(T), typeid(W))) ||
+       !Framework::instance().typeRegistry()->isValidStreamType(
+           typeid(details::viewed_type_t<T>), typeid(W))) ||
       (!std::is_same<X, DefaultStreamConfig>::value &&
        !Framework::instance().typeRegistry()->isValidStreamType(typeid(U), typeid(X)))) {
     auto str = "Stream/Config Mismatch";
@@ -243,9 +255,9 @@ Transformer Context::transform(
     XR_LOGCW(
         "Cthulhu",
         "Type mismatch detected [{}, {}] [{}, {}]",
-        typeIn,
+        typeIn->typeID(),
         siIn->description().type(),
-        typeOut,
+        typeOut->typeID(),
         siOut->description().type());
     return Transformer(siIn->description().id(), siOut->description().id());
   }
@@ -258,13 +270,13 @@ Transformer Context::transform(
   auto scallback = [sampleCallback,
                     producer = producer.get(),
                     &inID = siIn->description().id(),
-                    &outID = siOut->description().id()](const StreamSample& in) -> void {
+                    outHandle = siOut->handle()](const StreamSample& in) -> void {
     const T inData(in);
     if (!producer->config()) {
       XR_LOGCW("Cthulhu", "Transformer callback not executing, output stream not configured.");
       return;
     }
-    U outData = details::allocateSampleHelper<U>(producer->config(), outID);
+    U outData = details::allocateSampleHelper<U>(producer->config(), outHandle);
     // TBD: What to do if callback needs to determine numSubSamples?
     sampleCallback(inData, outData);
 
@@ -289,8 +301,8 @@ Transformer Context::transform(
   }
 
   // Create Consumer
-  std::unique_ptr<StreamConsumer> consumer(
-      new StreamConsumer(siIn, scallback, ccallback, options.consumerType == ConsumerType::ASYNC));
+  auto consumer = details::makeConsumer(
+      siIn, scallback, ccallback, options.consumerType, options.scheduling);
 
   // Return Node
   if (ctx_ == nullptr) {
@@ -304,6 +316,186 @@ Transformer Context::transform(
   return Transformer(inId, outId, std::move(consumer), std::move(producer));
 };
 
+template <typename T>
+TransformerChain<T> Context::chain(const StreamID& inputID) const {
+  return TransformerChain<T>(this, inputID);
+};
+
+template <typename T>
+TransformerChain<T>::TransformerChain(const Context* context, const StreamID& inputIDRaw)
+    : context_(context) {
+  StreamID inputID = context_->applyNamespace(inputIDRaw);
+  auto typeIn = sampleType<T>();
+  StreamDescription descIn{inputID, typeIn->typeID()};
+  input_ = Framework::instance().streamRegistry()->registerStream(descIn);
+  ids_.push_back(input_->description().id());
+  if (typeIn->typeID() != input_->description().type()) {
+    // Type mismatch detected
+    XR_LOGCW(
+        "Cthulhu",
+        "Type mismatch detected [{}, {}]",
+        typeIn->typeID(),
+        input_->description().type());
+    valid_ = false;
+    return;
+  }
+
+  // The first stage just views the input sample
+  auto view = std::make_shared<SampleView<T>>();
+  sampleStage_ = [view](const StreamSample& in) -> const T* {
+    view->setSample(in);
+    return &view->get();
+  };
+  configStage_ = [](const StreamConfig& in) -> const StreamConfig* { return &in; };
+};
+
+template <typename T>
+TransformerChain<T>::TransformerChain(
+    const Context* context,
+    StreamInterface* input,
+    std::vector<StreamIDView> ids,
+    std::vector<std::unique_ptr<StreamProducer>> producers,
+    std::shared_ptr<details::FusedStage> lastStage,
+    SampleStage sampleStage,
+    ConfigStage configStage,
+    bool valid)
+    : context_(context),
+      input_(input),
+      ids_(std::move(ids)),
+      producers_(std::move(producers)),
+      lastStage_(std::move(lastStage)),
+      sampleStage_(std::move(sampleStage)),
+      configStage_(std::move(configStage)),
+      valid_(valid){};
+
+template <typename T>
+template <typename U, typename W, typename X>
+TransformerChain<U> TransformerChain<T>::then(
+    const StreamID& outputIDRaw,
+    const std::function<void(const T&, U&)>& sampleCallback,
+    const std::function<bool(const W&, X&)>& configCallback) && {
+  StreamID outputID = context_->applyNamespace(outputIDRaw);
+  static_assert(
+      std::is_constructible<W, const StreamConfig&>::value,
+      "TransformerChain::then requires that configuration type W is constructed with const StreamConfig&");
+
+  // Make sure the streams are valid
+  if ((!std::is_same<W, DefaultStreamConfig>::value &&
+       !Framework::instance().typeRegistry()->isValidStreamType(typeid(T), typeid(W))) ||
+      (!std::is_same<X, DefaultStreamConfig>::value &&
+       !Framework::instance().typeRegistry()->isValidStreamType(typeid(U), typeid(X)))) {
+    auto str = "Stream/Config Mismatch";
+    XR_LOGCW("Cthulhu", "{}", str);
+    throw std::runtime_error(str);
+  }
+
+  auto typeOut = sampleType<U>();
+  StreamDescription descOut{outputID, typeOut->typeID()};
+  auto siOut = Framework::instance().streamRegistry()->registerStream(descOut);
+  ids_.push_back(siOut->description().id());
+  if (typeOut->typeID() != siOut->description().type()) {
+    // Type mismatch detected
+    XR_LOGCW(
+        "Cthulhu",
+        "Type mismatch detected [{}, {}]",
+        typeOut->typeID(),
+        siOut->description().type());
+    valid_ = false;
+  }
+  if (!valid_) {
+    return TransformerChain<U>(
+        context_, input_, std::move(ids_), std::move(producers_), nullptr, nullptr, nullptr, false);
+  }
+
+  // Create Producer. Stages are chained synchronously, so it never needs its own thread.
+  std::unique_ptr<StreamProducer> producer(new StreamProducer(siOut, false));
+  auto stage = std::make_shared<details::FusedStageImpl<U>>(
+      producer.get(), siOut, siOut->description().id());
+  if (lastStage_) {
+    lastStage_->setTerminal(false);
+  }
+
+  // Compose Callbacks
+  typename TransformerChain<U>::SampleStage sampleStage =
+      [previous = std::move(sampleStage_),
+       previousStage = lastStage_,
+       sampleCallback,
+       stage,
+       inID = ids_[ids_.size() - 2]](const StreamSample& in) -> const U* {
+    const T* inData = previous(in);
+    if (!inData) {
+      return nullptr;
+    }
+    U* outData = stage->prepare();
+    if (!outData) {
+      return nullptr;
+    }
+    sampleCallback(*inData, *outData);
+    stage->finish(inID, inData->getSample(), previousStage && !previousStage->published());
+    return outData;
+  };
+  ConfigStage configStage = [previous = std::move(configStage_),
+                             configCallback,
+                             stage,
+                             producer = producer.get()](
+                                const StreamConfig& in) -> const StreamConfig* {
+    const StreamConfig* config = previous(in);
+    if (!config || configCallback == nullptr) {
+      return nullptr;
+    }
+    const W inData(*config);
+    X outData;
+    bool success = configCallback(inData, outData);
+    if (!success) {
+      return nullptr;
+    }
+    stage->reset();
+    producer->configureStream(outData.getConfig());
+    return producer->config();
+  };
+
+  producers_.push_back(std::move(producer));
+  return TransformerChain<U>(
+      context_,
+      input_,
+      std::move(ids_),
+      std::move(producers_),
+      std::move(stage),
+      std::move(sampleStage),
+      std::move(configStage),
+      true);
+};
+
+template <typename T>
+FusedTransformer TransformerChain<T>::build(ConsumerType consumerType) && {
+  if (!valid_ || producers_.empty()) {
+    XR_LOGCW_IF(valid_, "Cthulhu", "Attempted to build a transformer chain with no stages");
+    return FusedTransformer(ids_);
+  }
+
+  // Create Callbacks
+  auto scallback = [sampleStage = std::move(sampleStage_)](const StreamSample& in) -> void {
+    sampleStage(in);
+  };
+  ConfigCallback ccallback = [configStage =
+                                  std::move(configStage_)](const StreamConfig& in) -> bool {
+    return configStage(in) != nullptr;
+  };
+
+  // Create Consumer
+  auto consumer = details::makeConsumer(input_, scallback, ccallback, consumerType);
+
+  // Return Node
+  if (context_->ctx_ == nullptr) {
+    const auto err = "Attempted to register fused transformer against null context";
+    XR_LOGCE("Cthulhu", "{}", err);
+    throw std::runtime_error(err);
+  }
+  std::vector<StreamID> outputIDs(ids_.begin() + 1, ids_.end());
+  context_->ctx_->registerTransformer(std::vector<StreamID>{StreamID(ids_.front())}, outputIDs);
+  return FusedTransformer(ids_, std::move(consumer), std::move(producers_));
+};
+
 template <typename T>
 Publisher Context::advertise(const StreamID& streamIDRaw, PublisherOptions options) const {
   return advertise(streamIDRaw, sampleType<T>()->typeID(), options);
@@ -2,17 +2,19 @@
 
 #pragma once
 
+#include <optional>
 #include <type_traits>
 
 namespace cthulhu {
 
 namespace details {
 
-// This is a utility for allocating a sample from the Framework.
+// This is a utility for allocating a sample of a stream from the Framework. The stream is given by
+// its handle, since this runs for every sample.
 template <typename T>
 T allocateSampleHelper(
     const StreamConfig* const config,
-    const StreamIDView& id,
+    StreamHandle handle,
     uint32_t numSubSamples = 1) {
   static_assert(
       std::is_base_of_v<AutoStreamSample, T>,
@@ -30,7 +32,8 @@ T allocateSampleHelper(
 
   size_t payloadSize = config->sampleSizeInBytes * numSubSamples;
   StreamSample uncastedSample;
-  uncastedSample.payload = Framework::instance().memoryPool()->getBufferFromPool(id, payloadSize);
+  uncastedSample.payload =
+      Framework::instance().memoryPool()->getBufferFromPool(handle, payloadSize);
   uncastedSample.numberOfSubSamples = numSubSamples;
 
   return T{uncastedSample, hasSamplesInContentBlock};
@@ -67,37 +70,64 @@ struct ResizeHelper {
 };
 
 // Similar to ResizeHelper, but this can be used on a Sample Type to both resize the
-// vector and allocate a sample, given its StreamID.
+// vector and allocate a sample for each of the streams of the dispatcher starting at idx.
 template <class>
 struct ResizeAllocHelper;
 template <class T>
 struct ResizeAllocHelper<std::vector<T>> {
-  static void resize(
-      std::vector<T>& arg,
-      size_t size,
-      Dispatcher* dispatcher,
-      unsigned long idx,
-      const std::vector<StreamID>& ids) {
+  static void resize(std::vector<T>& arg, size_t size, Dispatcher* dispatcher, unsigned long idx) {
     arg.resize(size);
-    for (const auto& id : ids) {
-      arg[idx] = details::allocateSampleHelper<T>(dispatcher->streamConfig(idx), id);
-      idx++;
+    for (size_t i = 0; i < size; ++i, ++idx) {
+      arg[i] = details::allocateSampleHelper<T>(
+          dispatcher->streamConfig(idx), dispatcher->streamHandle(idx));
     }
   };
 };
 template <class T>
 struct ResizeAllocHelper {
-  static void resize(
-      T& arg,
-      size_t size,
-      Dispatcher* dispatcher,
-      unsigned long idx,
-      const std::vector<StreamID>& ids) {
+  static void resize(T& arg, size_t size, Dispatcher* dispatcher, unsigned long idx) {
     assert(size == 1);
-    arg = details::allocateSampleHelper<T>(dispatcher->streamConfig(idx), ids[0]);
+    arg = details::allocateSampleHelper<T>(
+        dispatcher->streamConfig(idx), dispatcher->streamHandle(idx));
   };
 };
 
+// Typed samples that are reused across aligner callbacks are released once the callback returns,
+// so that they don't hold the buffers of the previous samples out of the pool until the next one.
+inline const StreamSample& releasedSample() {
+  static const StreamSample released{StreamSample::Unallocated()};
+  return released;
+}
+template <class>
+struct ReleaseHelper;
+template <class T>
+struct ReleaseHelper<std::vector<T>> {
+  static void release(std::vector<T>& arg) {
+    for (auto& sample : arg) {
+      sample.setSample(releasedSample());
+    }
+  };
+};
+template <class T, size_t N>
+struct ReleaseHelper<std::array<T, N>> {
+  static void release(std::array<T, N>& arg) {
+    for (auto& sample : arg) {
+      sample.setSample(releasedSample());
+    }
+  };
+};
+template <class T>
+struct ReleaseHelper {
+  static void release(T& arg) {
+    arg.setSample(releasedSample());
+  };
+};
+inline void releaseSamples(std::vector<StreamSample>& samples) {
+  for (auto& sample : samples) {
+    sample = releasedSample();
+  }
+}
+
 // These cast generic samples to typed samples statically (for sizes known at compile time)
 template <unsigned long offset, unsigned long groupSize, typename T>
 void sampleCaster(
@@ -370,7 +400,8 @@ struct SampleTypesDynamicHelper {
       throw std::exception();
     }
     for (unsigned long i = 0; i < groups[groupNumber]; i++) {
-      types[offset + i] = Framework::instance().typeRegistry()->findSampleType(typeid(T))->typeID();
+      types[offset + i] =
+          Framework::instance().typeRegistry()->findSampleType(typeid(viewed_type_t<T>))->typeID();
     }
     return;
   }
@@ -387,7 +418,7 @@ struct SampleTypesDynamicHelper<std::vector<T>> {
     }
     for (unsigned long in = 0; in < groups[groupNumber]; in++) {
       types[offset + in] =
-          Framework::instance().typeRegistry()->findSampleType(typeid(T))->typeID();
+          Framework::instance().typeRegistry()->findSampleType(typeid(viewed_type_t<T>))->typeID();
     }
     return;
   }
@@ -404,7 +435,7 @@ struct SampleTypesDynamicHelper<const std::vector<T>> {
     }
     for (unsigned long in = 0; in < groups[groupNumber]; in++) {
       types[offset + in] =
-          Framework::instance().typeRegistry()->findSampleType(typeid(T))->typeID();
+          Framework::instance().typeRegistry()->findSampleType(typeid(viewed_type_t<T>))->typeID();
     }
     return;
   }
@@ -521,7 +552,8 @@ struct SampleTypesStatic<std::array<T, N>> {
   static void getTypes(std::array<uint32_t, M>& types) {
     static_assert((offset + N) <= M, "SampleTypesStatic::getTypes out of bounds");
     for (unsigned long i = 0; i < N; i++) {
-      types[offset + i] = Framework::instance().typeRegistry()->findSampleType(typeid(T))->typeID();
+      types[offset + i] =
+          Framework::instance().typeRegistry()->findSampleType(typeid(viewed_type_t<T>))->typeID();
     }
   }
 };
@@ -530,7 +562,8 @@ struct SampleTypesStatic<T> {
   template <unsigned long offset, unsigned long M>
   static void getTypes(std::array<uint32_t, M>& types) {
     static_assert(offset <= M, "SampleTypesStatic::getTypes out of bounds");
-    types[offset] = Framework::instance().typeRegistry()->findSampleType(typeid(T))->typeID();
+    types[offset] =
+        Framework::instance().typeRegistry()->findSampleType(typeid(viewed_type_t<T>))->typeID();
   }
 };
 template <typename T, unsigned long N, typename... other>
@@ -539,9 +572,10 @@ struct SampleTypesStatic<std::array<T, N>, other...> {
   static void getTypes(std::array<uint32_t, M>& types) {
     static_assert((offset + N) <= M, "SampleTypesStatic::getTypes out of bounds");
     for (unsigned long i = 0; i < N; i++) {
-      types[offset + i] = Framework::instance().typeRegistry()->findSampleType(typeid(T))->typeID();
+      types[offset + i] =
+          Framework::instance().typeRegistry()->findSampleType(typeid(viewed_type_t<T>))->typeID();
     }
-    return SampleTypesStatic<other...>::getTypes<offset + N>(types);
+    return SampleTypesStatic<other...>::template getTypes<offset + N>(types);
   }
 };
 template <typename T, typename... other>
@@ -549,8 +583,9 @@ struct SampleTypesStatic<T, other...> {
   template <unsigned long offset, unsigned long M>
   static void getTypes(std::array<uint32_t, M>& types) {
     static_assert(offset <= M, "SampleTypesStatic::getTypes out of bounds");
-    types[offset] = Framework::instance().typeRegistry()->findSampleType(typeid(T))->typeID();
-    return SampleTypesStatic<other...>::getTypes<offset + 1>(types);
+    types[offset] =
+        Framework::instance().typeRegistry()->findSampleType(typeid(viewed_type_t<T>))->typeID();
+    return SampleTypesStatic<other...>::template getTypes<offset + 1>(types);
   }
 };
 
@@ -583,7 +618,7 @@ struct ConfigTypesStatic<std::array<T, N>, other...> {
     for (unsigned long i = 0; i < N; i++) {
       types[offset + i] = Framework::instance().typeRegistry()->findConfigType(typeid(T))->typeID();
     }
-    return ConfigTypesStatic<other...>::getTypes<offset + N>(types);
+    return ConfigTypesStatic<other...>::template getTypes<offset + N>(types);
   }
 };
 template <typename T, typename... other>
@@ -592,7 +627,7 @@ struct ConfigTypesStatic<T, other...> {
   static void getTypes(std::array<uint32_t, M>& types) {
     static_assert(offset <= M, "ConfigTypesStatic::getTypes out of bounds");
     types[offset] = Framework::instance().typeRegistry()->findConfigType(typeid(T))->typeID();
-    return ConfigTypesStatic<other...>::getTypes<offset + 1>(types);
+    return ConfigTypesStatic<other...>::template getTypes<offset + 1>(types);
   }
 };
 
@@ -601,10 +636,10 @@ template <unsigned long offset, typename T>
 AlignerSampleCallback generateAlignerCallback(
     const std::function<void(const std::vector<StreamSample>&, const T&)>& callback) {
   AlignerSampleCallback alignerCallback =
-      [callback](const std::vector<StreamSample>& samples) -> void {
-    T castedSamples;
+      [callback, castedSamples = T()](const std::vector<StreamSample>& samples) mutable -> void {
     sampleCaster<offset>(samples, castedSamples);
     callback(samples, castedSamples);
+    ReleaseHelper<T>::release(castedSamples);
   };
   return alignerCallback;
 };
@@ -613,10 +648,11 @@ AlignerSampleCallback generateAlignerCallback(
     const std::function<void(const std::vector<StreamSample>&, const T&, const other&...)>&
         callback) {
   std::function<void(const std::vector<StreamSample>&, const other&...)> callbackReduced =
-      [callback](const std::vector<StreamSample>& samples, const other&... args) -> void {
-    T castedSamples;
+      [callback, castedSamples = T()](
+          const std::vector<StreamSample>& samples, const other&... args) mutable -> void {
     sampleCaster<offset>(samples, castedSamples);
     callback(samples, castedSamples, args...);
+    ReleaseHelper<T>::release(castedSamples);
   };
   return generateAlignerCallback<offset + ArraySize<T>::size>(callbackReduced);
 };
@@ -630,11 +666,14 @@ AlignerSampleCallback generateAlignerCallback(
   if (groupNumber >= groupSizes.size()) {
     throw std::exception();
   }
-  AlignerSampleCallback alignerCallback = [callback, offset, groupSize = groupSizes[groupNumber]](
-                                              const std::vector<StreamSample>& samples) -> void {
-    T castedSamples;
+  T castedSamples;
+  ResizeHelper<T>::resize(castedSamples, groupSizes[groupNumber]);
+  AlignerSampleCallback alignerCallback =
+      [callback, offset, groupSize = groupSizes[groupNumber], castedSamples](
+          const std::vector<StreamSample>& samples) mutable -> void {
     sampleCaster(offset, groupSize, samples, castedSamples);
     callback(samples, castedSamples);
+    ReleaseHelper<T>::release(castedSamples);
   };
   if (groupSizes.size() != groupNumber + 1) {
     throw std::exception();
@@ -650,12 +689,14 @@ AlignerSampleCallback generateAlignerCallback(
   if (groupNumber >= groupSizes.size()) {
     throw std::exception();
   }
+  T castedSamples;
+  ResizeHelper<T>::resize(castedSamples, groupSizes[groupNumber]);
   std::function<void(const std::vector<StreamSample>&, const other&...)> callbackReduced =
-      [callback, offset, groupSize = groupSizes[groupNumber]](
-          const std::vector<StreamSample>& samples, const other&... args) -> void {
-    T castedSamples;
+      [callback, offset, groupSize = groupSizes[groupNumber], castedSamples](
+          const std::vector<StreamSample>& samples, const other&... args) mutable -> void {
     sampleCaster(offset, groupSize, samples, castedSamples);
     callback(samples, castedSamples, args...);
+    ReleaseHelper<T>::release(castedSamples);
   };
   return generateAlignerCallback<groupNumber + 1>(
       offset + groupSizes[groupNumber], groupSizes, callbackReduced);
@@ -678,16 +719,20 @@ AlignerSampleCallback generateAlignerCallback(
   if (groupNumber >= groupSizes.size()) {
     throw std::exception();
   }
+  // The output samples are allocated from the pool on every callback, but the containers holding
+  // them are only allocated once
   AlignerSampleCallback callbackReduced =
       [dispatcher,
        inputIDs,
        outputIDs,
        callback,
        outputOffset,
-       groupSize = groupSizes[groupNumber]](const std::vector<StreamSample>& samplesIn) -> void {
-    T castedSamples;
-    ResizeAllocHelper<T>::resize(castedSamples, groupSize, dispatcher, outputOffset, outputIDs);
-    std::vector<StreamSample> samplesOut(outputIDs.size());
+       groupSize = groupSizes[groupNumber],
+       castedSamples = T(),
+       samplesOut = std::vector<StreamSample>(
+           outputIDs.size(), StreamSample(StreamSample::Unallocated()))](
+          const std::vector<StreamSample>& samplesIn) mutable -> void {
+    ResizeAllocHelper<T>::resize(castedSamples, groupSize, dispatcher, outputOffset);
     callback(outputIDs, samplesIn, samplesOut, castedSamples);
     SampleUncaster<T>::uncast(samplesOut, outputOffset, castedSamples);
     for (auto& sampleOut : samplesOut) {
@@ -696,6 +741,8 @@ AlignerSampleCallback generateAlignerCallback(
       }
     }
     dispatcher->dispatchSamples(samplesOut);
+    ReleaseHelper<T>::release(castedSamples);
+    releaseSamples(samplesOut);
   };
   return callbackReduced;
 };
@@ -716,19 +763,24 @@ AlignerSampleCallback generateAlignerCallback(
   if (groupNumber >= groupSizes.size()) {
     throw std::exception();
   }
+  T castedSamples;
+  ResizeHelper<T>::resize(castedSamples, groupSizes[groupNumber]);
   std::function<void(
       const std::vector<StreamID>&,
       const std::vector<StreamSample>&,
       std::vector<StreamSample>&,
       other&...)>
-      callbackReduced = [callback, inputOffset, groupSize = groupSizes[groupNumber]](
+      callbackReduced = [callback,
+                         inputOffset,
+                         groupSize = groupSizes[groupNumber],
+                         castedSamples](
                             const std::vector<StreamID>& _outputIDs,
                             const std::vector<StreamSample>& samplesIn,
                             std::vector<StreamSample>& samplesOut,
-                            other&... args) -> void {
-    T castedSamples;
+                            other&... args) mutable -> void {
     sampleCaster(inputOffset, groupSize, samplesIn, castedSamples);
     callback(_outputIDs, samplesIn, samplesOut, castedSamples, args...);
+    ReleaseHelper<T>::release(castedSamples);
   };
   return generateAlignerCallback<groupNumber + 1>(
       dispatcher,
@@ -739,8 +791,10 @@ AlignerSampleCallback generateAlignerCallback(
       groupSizes,
       callbackReduced);
 };
+// Output groups are taken by non-const reference, so const input groups only match the overload
+// above
 template <unsigned long groupNumber, typename T, typename... other>
-AlignerSampleCallback generateAlignerCallback(
+std::enable_if_t<!std::is_const<T>::value, AlignerSampleCallback> generateAlignerCallback(
     Dispatcher* dispatcher,
     unsigned long inputOffset,
     unsigned long outputOffset,
@@ -761,15 +815,19 @@ AlignerSampleCallback generateAlignerCallback(
       const std::vector<StreamSample>&,
       std::vector<StreamSample>&,
       other&...)>
-      callbackReduced = [dispatcher, callback, outputOffset, groupSize = groupSizes[groupNumber]](
+      callbackReduced = [dispatcher,
+                         callback,
+                         outputOffset,
+                         groupSize = groupSizes[groupNumber],
+                         castedSamples = T()](
                             const std::vector<StreamID>& _outputIDs,
                             const std::vector<StreamSample>& samplesIn,
                             std::vector<StreamSample>& samplesOut,
-                            other&... args) -> void {
-    T castedSamples;
-    ResizeAllocHelper<T>::resize(castedSamples, groupSize, dispatcher, outputOffset, _outputIDs);
+                            other&... args) mutable -> void {
+    ResizeAllocHelper<T>::resize(castedSamples, groupSize, dispatcher, outputOffset);
     callback(_outputIDs, samplesIn, samplesOut, castedSamples, args...);
     SampleUncaster<T>::uncast(samplesOut, outputOffset, castedSamples);
+    ReleaseHelper<T>::release(castedSamples);
   };
   return generateAlignerCallback<groupNumber + 1>(
       dispatcher,
@@ -1112,6 +1170,97 @@ inline std::unique_ptr<AlignerBase> alignerFromOptions(
   throw std::runtime_error(str);
 }
 
+// The untyped part of a stage in a TransformerChain. The last stage of a chain is terminal, and
+// always publishes its output; earlier stages only publish while their stream is observed.
+class FusedStage {
+ public:
+  virtual ~FusedStage() = default;
+
+  void setTerminal(bool terminal) {
+    terminal_ = terminal;
+  }
+
+  // Whether the last output of the stage was published
+  bool published() const {
+    return published_;
+  }
+
+ protected:
+  bool terminal_ = true;
+  bool published_ = false;
+};
+
+// A typed stage in a TransformerChain. It owns the output sample of the stage, which is handed to
+// the next stage directly rather than through the stream.
+template <typename U>
+class FusedStageImpl : public FusedStage {
+ public:
+  FusedStageImpl(StreamProducer* producer, StreamInterface* stream, const StreamIDView& outID)
+      : producer_(producer), stream_(stream), outID_(outID) {}
+
+  // Returns the sample to run the stage callback on, or nullptr if the output is not configured.
+  // While nobody outside the chain can see the previous output, and nothing the callback did
+  // retained any of its buffers, it is reused in place rather than allocated from the pool again.
+  U* prepare() {
+    const StreamConfig* config = producer_->config();
+    if (!config) {
+      XR_LOGCW("Cthulhu", "Fused transformer not executing, output stream not configured.");
+      return nullptr;
+    }
+    if (observed() || !output_ || !isExclusive(output_->getSample())) {
+      output_.emplace(allocateSampleHelper<U>(config, stream_->handle()));
+    } else {
+      auto& metadata = *output_->getSample().metadata;
+      metadata.header = SampleHeader();
+      metadata.processingStamps.clear();
+      metadata.history.clear();
+    }
+    return &*output_;
+  }
+
+  // Records the input in the history of the output, and publishes it if anything is listening. An
+  // input that is the unpublished output of the previous stage is recorded through its own history
+  // instead, since holding its metadata would keep that stage from reusing it.
+  void finish(const StreamIDView& inID, const StreamSample& in, bool inUnpublished) {
+    const auto& out = output_->getSample();
+    if (inUnpublished) {
+      out.metadata->history.insert(in.metadata->history.begin(), in.metadata->history.end());
+    } else {
+      out.metadata->history.emplace(inID, in.metadata);
+    }
+    published_ = observed();
+    if (published_) {
+      producer_->produceSample(out);
+    }
+  }
+
+  // Drops the output sample, which must be reallocated against the new config
+  void reset() {
+    output_.reset();
+  }
+
+  const StreamIDView& id() const {
+    return outID_;
+  }
+
+ private:
+  bool observed() const {
+    return terminal_ || stream_->hasConsumers();
+  }
+
+  static bool isExclusive(const StreamSample& sample) {
+    const bool payloadExclusive =
+        std::visit([](const auto& buffer) { return buffer.use_count() <= 1; }, sample.payload.data);
+    return payloadExclusive && sample.metadata.use_count() == 1 &&
+        sample.parameters.use_count() <= 1 && sample.dynamicParameters.use_count() <= 1;
+  }
+
+  StreamProducer* producer_;
+  StreamInterface* stream_;
+  const StreamIDView outID_;
+  std::optional<U> output_;
+};
+
 } // namespace details
 
 } // namespace cthulhu
@@ -4,10 +4,36 @@
 
 #include <cthulhu/ForceCleanable.h>
 #include <cthulhu/LogDisabling.h>
+#include <cthulhu/StreamHandle.h>
 #include <cthulhu/StreamInterface.h>
 
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 namespace cthulhu {
 
+enum class RegistrationKind : uint8_t {
+  SUBSCRIPTION,
+  PUBLICATION,
+  TRANSFORMATION_INPUT,
+  TRANSFORMATION_OUTPUT,
+};
+
+// Visits the registrations of a context in place, see ContextInfoInterface::visitRegistrations()
+class RegistrationVisitor {
+ public:
+  virtual ~RegistrationVisitor() = default;
+
+  // Called at the start of each registration group. The outputs of a transformation follow its
+  // inputs as a group of their own.
+  virtual void beginGroup(RegistrationKind kind) = 0;
+
+  // Called with each stream of the current group. The view is only valid during the call.
+  virtual void stream(StreamIDView id) = 0;
+};
+
 // ContextInfoInterface provides a handle into data about a specific context
 //
 // The handle should be used by contexts to update information about their publications and
@@ -37,6 +63,11 @@ class ContextInfoInterface {
   virtual std::vector<RegistrationGroup> publications() const = 0;
   virtual std::vector<std::pair<RegistrationGroup, RegistrationGroup>> transformations() const = 0;
 
+  // Visits the subscriptions, publications and transformations of the context, in that order,
+  // without copying them. The context is locked during the visit, so the visitor must not call
+  // back into the registry.
+  virtual void visitRegistrations(RegistrationVisitor& visitor) const = 0;
+
   virtual void registerSubscriber(const std::vector<StreamID>& streams) = 0;
   virtual void registerPublisher(const std::vector<StreamID>& streams) = 0;
   virtual void registerTransformer(
@@ -52,6 +83,110 @@ class ContextInfoInterface {
 };
 using ContextInfoInterfaceConstPtr = std::shared_ptr<const ContextInfoInterface>;
 
+// An immutable copy of the contexts of a registry, as of a version of the registry. The streams of
+// the registrations are stored as interned StreamHandles, so taking a snapshot copies no stream
+// names and iterating it neither allocates nor locks the registry.
+class ContextRegistrySnapshot {
+ public:
+  struct Context {
+    std::string name;
+    bool privateNamespace;
+    int pid;
+    bool valid;
+  };
+
+  // The streams of a registration group
+  class Group {
+   public:
+    Group(const StreamHandle* begin, const StreamHandle* end) : begin_(begin), end_(end) {}
+
+    const StreamHandle* begin() const {
+      return begin_;
+    }
+
+    const StreamHandle* end() const {
+      return end_;
+    }
+
+    size_t size() const {
+      return end_ - begin_;
+    }
+
+    bool empty() const {
+      return begin_ == end_;
+    }
+
+   private:
+    const StreamHandle* begin_;
+    const StreamHandle* end_;
+  };
+
+  // Takes a snapshot of the given contexts, tagged with the version of the registry they were
+  // listed at
+  static std::shared_ptr<const ContextRegistrySnapshot> take(
+      const std::vector<ContextInfoInterfaceConstPtr>& contexts,
+      uint64_t version);
+
+  uint64_t version() const {
+    return version_;
+  }
+
+  const std::vector<Context>& contexts() const {
+    return contexts_;
+  }
+
+  // Calls visitor(const Context&, Group) for each subscription, in registration order
+  template <typename Visitor>
+  void forEachSubscription(Visitor&& visitor) const {
+    forEach(RegistrationKind::SUBSCRIPTION, visitor);
+  }
+
+  // Calls visitor(const Context&, Group) for each publication, in registration order
+  template <typename Visitor>
+  void forEachPublication(Visitor&& visitor) const {
+    forEach(RegistrationKind::PUBLICATION, visitor);
+  }
+
+  // Calls visitor(const Context&, Group inputs, Group outputs) for each transformation, in
+  // registration order
+  template <typename Visitor>
+  void forEachTransformation(Visitor&& visitor) const {
+    for (size_t i = 0; i + 1 < groups_.size(); ++i) {
+      if (groups_[i].kind == RegistrationKind::TRANSFORMATION_INPUT) {
+        visitor(contexts_[groups_[i].context], group(groups_[i]), group(groups_[i + 1]));
+      }
+    }
+  }
+
+ private:
+  struct GroupRange {
+    uint32_t context;
+    RegistrationKind kind;
+    uint32_t begin;
+    uint32_t end;
+  };
+
+  explicit ContextRegistrySnapshot(uint64_t version) : version_(version) {}
+
+  Group group(const GroupRange& range) const {
+    return Group(handles_.data() + range.begin, handles_.data() + range.end);
+  }
+
+  template <typename Visitor>
+  void forEach(RegistrationKind kind, Visitor& visitor) const {
+    for (const auto& range : groups_) {
+      if (range.kind == kind) {
+        visitor(contexts_[range.context], group(range));
+      }
+    }
+  }
+
+  uint64_t version_;
+  std::vector<Context> contexts_;
+  std::vector<StreamHandle> handles_;
+  std::vector<GroupRange> groups_;
+};
+
 class ContextRegistryInterface : public ForceCleanable, public LogDisabling {
  public:
   virtual ~ContextRegistryInterface() = default;
@@ -80,5 +215,19 @@ class ContextRegistryInterface : public ForceCleanable, public LogDisabling {
   // all contexts it currently knows about. The return value in both cases may be the same, or the
   // contexts returned by setting all=true may be a superset of all=false.
   virtual std::vector<ContextInfoInterfaceConstPtr> contexts(bool all = false) const = 0;
+
+  // Returns a counter that changes whenever a context is registered or removed, or registers
+  // streams. Callers can compare it with the version of a snapshot they took to skip work when
+  // nothing changed.
+  virtual uint64_t version() const = 0;
+
+  // Returns a snapshot of the contexts returned by contexts(all). The snapshot is cached, and only
+  // taken again once the version of the registry changed, so calling this repeatedly is cheap.
+  std::shared_ptr<const ContextRegistrySnapshot> snapshot(bool all = false) const;
+
+ private:
+  mutable std::mutex snapshotMutex_;
+  // Indexed by the all argument of snapshot()
+  mutable std::array<std::shared_ptr<const ContextRegistrySnapshot>, 2> snapshots_;
 };
 } // namespace cthulhu
@@ -29,9 +29,11 @@ class Dispatcher {
 
   const StreamConfig* streamConfig(uint32_t streamNumber);
 
+  StreamHandle streamHandle(uint32_t streamNumber) const;
+
  protected:
-  using IdentifiedProducer = std::pair<StreamIDView, std::unique_ptr<StreamProducer>>;
-  std::vector<IdentifiedProducer> producers_;
+  // Producers are indexed by stream number; their stream IDs are available from the streams
+  std::vector<std::unique_ptr<StreamProducer>> producers_;
 
 }; // class Dispatcher
 
@@ -0,0 +1,137 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cthulhu/Clock.h>
+#include <cthulhu/StreamInterface.h>
+
+namespace cthulhu {
+
+// Publishes a precomputed schedule of samples, each at its deadline against the Cthulhu Clock.
+// Deadlines are absolute, computed from the start time of the schedule rather than from the
+// previous event, so that lateness never accumulates. The scheduler thread sleeps until shortly
+// before each deadline, then spins on the clock for the rest of the way, which takes the wakeup
+// latency of the OS scheduler out of the timing of the events.
+//
+// With a real clock, or no clock authority, the deadlines are waited for on the steady clock. With
+// a simulated clock, whose rate can change, the clock is read again at least every
+// maxSimulatedSleep.
+
+// A sample to publish on a stream, at a time relative to the start of the schedule
+struct ScheduledEvent {
+  // Seconds after the start of the schedule
+  double offset = 0.0;
+  StreamID streamID;
+  StreamSample sample;
+};
+
+struct EventSchedulerOptions {
+  // How long before each deadline the scheduler stops sleeping and spins on the clock
+  std::chrono::duration<double> spinThreshold{0.0005};
+  // Longest sleep between reads of a simulated clock
+  std::chrono::duration<double> maxSimulatedSleep{0.001};
+  // Whether to stamp the header of each sample with the clock time it is published at
+  bool stampTimestamp = true;
+};
+
+// How late events were published after their deadlines, in buckets of BUCKET_WIDTH seconds. The
+// last bucket counts all events at least NUM_BUCKETS * BUCKET_WIDTH late.
+struct LatenessHistogram {
+  static constexpr size_t NUM_BUCKETS = 100;
+  static constexpr double BUCKET_WIDTH = 10e-6;
+
+  std::array<uint64_t, NUM_BUCKETS + 1> counts{};
+  uint64_t events = 0;
+  double totalLateness = 0.0;
+  double maxLateness = 0.0;
+
+  void add(double lateness);
+
+  double meanLateness() const {
+    return events > 0 ? totalLateness / events : 0.0;
+  }
+
+  // Upper bound of the bucket holding the given quantile of the lateness, between 0 and 1
+  double quantile(double q) const;
+};
+
+class EventScheduler {
+ public:
+  // Events are published in the order of their offsets, or in the order given for equal offsets.
+  // Throws if a stream of the schedule isn't registered, or already has a producer.
+  explicit EventScheduler(
+      std::vector<ScheduledEvent> events,
+      const EventSchedulerOptions& options = EventSchedulerOptions());
+  ~EventScheduler();
+
+  // Starts publishing, with offset 0 at startTime on the clock, or at the current time if
+  // startTime is negative. Events whose deadline has already passed are published right away.
+  void start(double startTime = -1.0);
+
+  // Stops publishing, and waits for the scheduler thread to finish
+  void stop();
+
+  // Whether all events were published, or the scheduler was stopped
+  bool finished() const {
+    return finished_.load(std::memory_order_acquire);
+  }
+
+  size_t published() const {
+    return published_.load(std::memory_order_relaxed);
+  }
+
+  LatenessHistogram lateness() const;
+  // Lateness of the events of a stream, empty for a stream that isn't part of the schedule
+  LatenessHistogram lateness(const StreamID& id) const;
+
+ private:
+  struct Event {
+    double offset;
+    size_t producer;
+    StreamSample sample;
+  };
+
+  void run(double startTime);
+  // Waits until deadline on the clock, or until stopped. Returns the lateness in seconds.
+  double waitUntil(double deadline, double startTime);
+  // The time on the clock, or the wall time if there is no clock authority to provide one
+  double clockTime() const;
+  // Sleeps until the time point, or until stopped
+  void sleepUntil(std::chrono::steady_clock::time_point until);
+  bool stopping() const {
+    return stop_.load(std::memory_order_relaxed);
+  }
+
+  EventSchedulerOptions options_;
+  std::vector<Event> events_;
+  std::vector<StreamID> streamIDs_;
+  std::vector<std::unique_ptr<StreamProducer>> producers_;
+  // Unset if there is no clock authority
+  std::shared_ptr<ClockInterface> clock_;
+  // The steady clock time at which the real clock read the start time of the schedule
+  std::chrono::steady_clock::time_point steadyStart_;
+
+  mutable std::mutex mutex_;
+  // Wakes the scheduler thread up to stop. stop_ is set under mutex_.
+  std::condition_variable stopped_;
+  std::atomic<bool> stop_{false};
+  // Indexed like producers_. Guarded by mutex_.
+  std::vector<LatenessHistogram> lateness_;
+
+  std::atomic<size_t> published_{0};
+  std::atomic<bool> finished_{false};
+  std::thread thread_;
+};
+
+} // namespace cthulhu
@@ -0,0 +1,135 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cthulhu/StreamInterface.h>
+
+namespace cthulhu {
+
+// Publishes data read from a UDP socket or a device file on a stream. Reads go straight into
+// buffers of the MemoryPool, several at a time, and a framer turns each completed read into
+// samples that reference the buffer instead of copying it.
+//
+// On Linux, the reads are queued with io_uring, which completes them without a system call per
+// read. Up to queueDepth datagrams are received at once, while devices are read one read at a
+// time, since concurrent reads of a device complete in no particular order. Where io_uring is
+// unavailable (old kernels, or blocked by seccomp as in many containers), or disabled in the
+// IngestOptions, the source falls back to poll, with recvmmsg to receive a batch of datagrams at
+// once.
+
+struct IngestOptions {
+  // Bytes per read, and the size of the buffers read into. Longer datagrams are truncated.
+  size_t readBytes = 64 * 1024;
+  // Reads kept in flight at once
+  unsigned queueDepth = 32;
+  bool disableIoUring = false;
+};
+
+struct IngestStats {
+  uint64_t reads = 0;
+  uint64_t bytes = 0;
+  uint64_t samples = 0;
+  // Datagrams longer than readBytes
+  uint64_t truncated = 0;
+  // CPU time of the ingest thread, and wall time since start()
+  double cpuSeconds = 0.0;
+  double elapsedSeconds = 0.0;
+  bool ioUring = false;
+
+  double readsPerSecond() const {
+    return elapsedSeconds > 0 ? reads / elapsedSeconds : 0.0;
+  }
+  double cpuSecondsPerGigabyte() const {
+    return bytes > 0 ? cpuSeconds * 1e9 / bytes : 0.0;
+  }
+};
+
+// Turns the bytes of a completed read into samples, appended to samples. The samples may share
+// data with std::shared_ptr's aliasing constructor. The source then stamps each sample with the
+// time its read completed and the next sequence number.
+using IngestFramer =
+    std::function<void(const CpuBuffer& data, size_t length, std::vector<StreamSample>& samples)>;
+
+class IngestSource {
+ public:
+  // Receives the datagrams sent to address:port. Port 0 picks a free port, see port().
+  static std::unique_ptr<IngestSource> udp(
+      const StreamID& id,
+      const std::string& address,
+      uint16_t port,
+      const IngestFramer& framer,
+      const IngestOptions& options = IngestOptions());
+
+  // Reads a character device, FIFO or file until it ends
+  static std::unique_ptr<IngestSource> device(
+      const StreamID& id,
+      const std::string& path,
+      const IngestFramer& framer,
+      const IngestOptions& options = IngestOptions());
+
+  // Publishes each read as the content block of one sample, of length / subSampleBytes
+  // subsamples
+  static IngestFramer contentBlockFramer(size_t subSampleBytes);
+
+  ~IngestSource();
+
+  // Reading starts with start(), so that the stream can be configured first
+  void configureStream(const StreamConfig& config);
+  void start();
+
+  uint16_t port() const {
+    return port_;
+  }
+
+  IngestStats stats() const;
+
+ private:
+  IngestSource(
+      const StreamID& id,
+      int fd,
+      bool datagrams,
+      const IngestFramer& framer,
+      const IngestOptions& options);
+
+  void run();
+  // Returns false if io_uring can't be set up
+  bool runIoUring();
+  void runPolling();
+  // Frames and publishes a completed read
+  void publish(const CpuBuffer& buffer, size_t length);
+  CpuBuffer nextBuffer();
+
+  StreamID id_;
+  int fd_;
+  // Wakes the ingest thread up to stop
+  int stopFd_ = -1;
+  bool datagrams_;
+  uint16_t port_ = 0;
+  IngestFramer framer_;
+  IngestOptions options_;
+  std::unique_ptr<StreamProducer> producer_;
+  std::vector<StreamSample> framed_;
+  uint32_t sequenceNumber_ = 0;
+
+  std::atomic<uint64_t> reads_{0};
+  std::atomic<uint64_t> bytes_{0};
+  std::atomic<uint64_t> samples_{0};
+  std::atomic<uint64_t> truncated_{0};
+  std::atomic<int64_t> cpuNs_{0};
+  std::atomic<bool> ioUring_{false};
+  std::atomic<bool> finished_{false};
+  std::chrono::steady_clock::time_point started_;
+
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+
+} // namespace cthulhu
@@ -0,0 +1,79 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace cthulhu {
+
+// How much lineage to keep for the samples a node produces:
+//  - OFF: none
+//  - SAMPLED: the inputs of one out of every sampleInterval output samples
+//  - FULL: the inputs of every output sample
+enum class LineagePolicy : uint8_t { OFF = 0, SAMPLED = 1, FULL = 2 };
+
+struct LineageSettings {
+  LineagePolicy policy = LineagePolicy::OFF;
+  uint32_t sampleInterval = 1;
+
+  // Returns true if the output sample with the given sequence number should have its lineage kept
+  bool shouldRecord(uint32_t sequenceNumber) const {
+    switch (policy) {
+      case LineagePolicy::FULL:
+        return true;
+      case LineagePolicy::SAMPLED:
+        return sampleInterval <= 1 || sequenceNumber % sampleInterval == 0;
+      default:
+        return false;
+    }
+  }
+};
+
+// Identifies an input sample by the index of the stream it arrived on and its sequence number
+struct LineageRecord {
+  uint32_t streamIndex;
+  uint32_t sequenceNumber;
+};
+
+// A bounded side table mapping output samples to the input samples they were produced from. Unlike
+// SampleMetadata::history, it holds no references to the input metadata, so the memory it uses
+// doesn't grow with the depth of the graph. Once full, the oldest entries are evicted.
+class LineageTable {
+ public:
+  explicit LineageTable(size_t capacity = 4096);
+
+  void record(uint32_t streamIndex, uint32_t sequenceNumber, std::vector<LineageRecord> inputs);
+
+  // Returns the inputs of the given output sample, if they were recorded and not yet evicted
+  std::optional<std::vector<LineageRecord>> lookup(uint32_t streamIndex, uint32_t sequenceNumber)
+      const;
+
+  // Evicts the oldest entries if there are more than the new capacity
+  void setCapacity(size_t capacity);
+
+  size_t size() const;
+  void clear();
+
+ private:
+  static uint64_t key(uint32_t streamIndex, uint32_t sequenceNumber) {
+    return (static_cast<uint64_t>(streamIndex) << 32) | sequenceNumber;
+  }
+
+  // Called with mutex_ held
+  void evict();
+
+  // Atomic so that record() can skip the lock while lineage is off
+  std::atomic<size_t> capacity_;
+  std::unordered_map<uint64_t, std::vector<LineageRecord>> entries_;
+  // Keys in insertion order, for eviction
+  std::deque<uint64_t> order_;
+  mutable std::mutex mutex_;
+};
+
+} // namespace cthulhu
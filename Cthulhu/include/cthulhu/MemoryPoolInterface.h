@@ -11,14 +11,89 @@
 
 namespace cthulhu {
 
+struct MemoryPoolStats {
+  // Bytes allocated ahead of use by warmPool
+  size_t warmedBytes = 0;
+  // Bytes allocated while serving a request, because no pooled buffer of that size was free
+  size_t demandBytes = 0;
+  // Bytes locked into RAM by lockMemory
+  size_t lockedBytes = 0;
+  // Buffers, and their bytes, that were allocated in local memory and copied into shared memory
+  // because they were sent to another process
+  size_t promotedBuffers = 0;
+  size_t promotedBytes = 0;
+};
+
+// Where the buffers of a stream are allocated, for streams that may be sent to other processes
+enum class SharedMemoryPolicy : uint8_t {
+  // Local memory while the stream has no subscribers in other processes, and shared memory while
+  // it has. Samples that were allocated locally anyway are promoted when they are sent.
+  ADAPTIVE = 0,
+  // Always shared memory, so that samples never need to be promoted
+  ALWAYS_SHARED = 1,
+  // Always local memory, and samples are promoted whenever they are sent to another process. Suits
+  // streams that only occasionally have a subscriber outside of their process.
+  ALWAYS_LOCAL = 2,
+};
+
 class MemoryPoolInterface : public ForceCleanable, public LogDisabling {
  public:
   virtual ~MemoryPoolInterface() = default;
 
   // Provides thread-safe access to the Sample Pool
-  // A StreamID is provided, and the Framework transparently allocated a memory buffer from the
-  // appropriate pool (local or shared) based on stream linkages with other processes
-  virtual CpuBuffer getBufferFromPool(const StreamIDView& id, size_t nrBytes) = 0;
+  // A StreamHandle is provided, and the Framework transparently allocated a memory buffer from the
+  // appropriate pool (local or shared) based on stream linkages with other processes. Callers
+  // resolve the handle of their stream once, when they are created or configured, and
+  // StreamHandles::anonymous() for buffers that don't belong to a stream.
+  virtual CpuBuffer getBufferFromPool(StreamHandle handle, size_t nrBytes) = 0;
+
+  // Allocates the buffers of a stream on the given NUMA node, instead of the node of the thread
+  // requesting them. A negative node removes the placement.
+  virtual void setStreamNumaNode(StreamHandle handle, int node) = 0;
+
+  void setStreamNumaNode(const StreamIDView& id, int node) {
+    setStreamNumaNode(StreamHandles::intern(id), node);
+  }
+
+  // Sets where the buffers of a stream are allocated. Only matters for pools with shared memory.
+  virtual void setSharedMemoryPolicy(StreamHandle handle, SharedMemoryPolicy policy) = 0;
+
+  void setSharedMemoryPolicy(const StreamIDView& id, SharedMemoryPolicy policy) {
+    setSharedMemoryPolicy(StreamHandles::intern(id), policy);
+  }
+
+  // Makes sure at least count free buffers of nrBytes are pooled for the stream, allocating and
+  // pre-faulting any that are missing, so that the first samples don't pay for it. Returns the
+  // number of bytes allocated.
+  virtual size_t warmPool(StreamHandle handle, size_t nrBytes, size_t count) = 0;
+
+  size_t warmPool(const StreamIDView& id, size_t nrBytes, size_t count) {
+    return warmPool(StreamHandles::intern(id), nrBytes, count);
+  }
+
+  // Warms the pool with count samples of the stream, as declared by its config
+  size_t warmPool(
+      StreamHandle handle,
+      const StreamConfig& config,
+      size_t count,
+      uint32_t numSubSamples = 1) {
+    return warmPool(handle, static_cast<size_t>(config.sampleSizeInBytes) * numSubSamples, count);
+  }
+
+  size_t warmPool(
+      const StreamIDView& id,
+      const StreamConfig& config,
+      size_t count,
+      uint32_t numSubSamples = 1) {
+    return warmPool(StreamHandles::intern(id), config, count, numSubSamples);
+  }
+
+  // Locks the pooled buffers, and the shared memory segment if there is one, into RAM, as well as
+  // any buffers allocated afterwards. Returns false if anything could not be locked, e.g. because
+  // of RLIMIT_MEMLOCK.
+  virtual bool lockMemory() = 0;
+
+  virtual MemoryPoolStats stats() const = 0;
 
   // Equivalent to getBufferFromPool, but will request a GPU-backed buffer.
   virtual GpuBuffer getGpuBufferFromPool(size_t nrBytes, bool device_local) = 0;
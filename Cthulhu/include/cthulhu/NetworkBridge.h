@@ -0,0 +1,250 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cthulhu/Codec.h>
+#include <cthulhu/Serialization.h>
+#include <cthulhu/StreamInterface.h>
+
+namespace cthulhu {
+
+// Mirrors streams to another Cthulhu instance over the network. A BridgeSender consumes local
+// streams and writes their configs and samples, in the layout of Serialization.h, to a
+// BridgeReceiver, which produces them on streams of the same name and type in its own process.
+// Each stream is announced with the checksum of its type, and the receiver refuses streams whose
+// type doesn't match its own definition. Samples are batched into frames of up to maxFrameBytes,
+// and written with scatter-gather I/O straight from their buffers.
+//
+// Over TCP, the sender reconnects if the connection drops, and samples produced while it is down
+// are dropped. Over UDP, each frame is a datagram, samples that don't fit one are dropped, and
+// streams are announced again every second so that a receiver can join late.
+//
+// Both ends can run in the same process over loopback: remapping the streams on the receiver keeps
+// it from producing on the streams the sender consumes.
+
+enum class BridgeTransport : uint8_t { TCP = 0, UDP = 1 };
+
+struct BridgeOptions {
+  BridgeTransport transport = BridgeTransport::TCP;
+  // Frames are sent once they reach this size, or once their first record has waited
+  // maxBatchDelay. Records larger than a frame are sent in a frame of their own, except over UDP.
+  size_t maxFrameBytes = 64 * 1024;
+  std::chrono::duration<double> maxBatchDelay{0.001};
+  // Samples are dropped while this many bytes are waiting to be sent
+  size_t maxQueuedBytes = 16 * 1024 * 1024;
+  // Compresses content blocks with the codec selectCodec picks for each stream, on encoderThreads
+  // threads rather than those of the producers
+  bool compress = false;
+  size_t encoderThreads = 2;
+};
+
+namespace bridge {
+
+constexpr uint32_t kFrameMagic = 0x43544252;
+constexpr uint16_t kVersion = 2;
+
+enum class RecordKind : uint8_t { ANNOUNCE = 0, CONFIG = 1, SAMPLE = 2 };
+
+// Frames are a FrameHeader followed by records, each a RecordHeader followed by its body:
+//  - ANNOUNCE: int32 type checksum, uint16 stream ID length, stream ID, uint16 type name length,
+//              type name
+//  - CONFIG: the config, as written by serializeConfig
+//  - SAMPLE: the sample, as written by serializeSample, or by encodeSample if the record has a
+//            codec
+// All fields are in host byte order, like the rest of the serialized layout.
+struct FrameHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t numRecords;
+  uint32_t payloadBytes;
+};
+
+struct RecordHeader {
+  uint32_t bodyBytes;
+  uint16_t channel;
+  RecordKind kind;
+  CodecType codec;
+};
+
+static_assert(sizeof(FrameHeader) == 12, "FrameHeader must not be padded");
+static_assert(sizeof(RecordHeader) == 8, "RecordHeader must not be padded");
+
+} // namespace bridge
+
+class BridgeSender {
+ public:
+  // Connects to a BridgeReceiver at host:port, in the background
+  BridgeSender(
+      const std::string& host,
+      uint16_t port,
+      const BridgeOptions& options = BridgeOptions());
+
+  ~BridgeSender();
+
+  // Starts mirroring a registered stream. Returns false if it doesn't exist, or is already
+  // mirrored.
+  bool mirror(const StreamID& id);
+
+  bool connected() const {
+    return socket_ >= 0;
+  }
+
+  uint64_t samplesSent() const {
+    return samplesSent_;
+  }
+  uint64_t samplesDropped() const {
+    return samplesDropped_;
+  }
+  // Bytes of the bodies of the samples sent, after encoding
+  uint64_t sampleBytesSent() const {
+    return sampleBytesSent_;
+  }
+
+ private:
+  struct Channel {
+    StreamID id;
+    std::string typeName;
+    int checksum;
+    std::optional<StreamConfig> config;
+    // Set when compressing, once the stream is configured
+    std::shared_ptr<const Codec> codec;
+    std::unique_ptr<StreamConsumer> consumer{};
+  };
+
+  struct Record {
+    bridge::RecordHeader header;
+    // Keeps the buffers referenced by ranges alive
+    StreamSample sample{};
+    std::vector<uint8_t> body{};
+    std::vector<SerializedRange> ranges{};
+    std::chrono::steady_clock::time_point queued{};
+
+    size_t size() const {
+      return sizeof(header) + header.bodyBytes;
+    }
+  };
+
+  void enqueueConfig(uint16_t channel, const StreamConfig& config);
+  void enqueueSample(uint16_t channel, const StreamSample& sample);
+  // Encodes a sample on an encoder thread, and queues it. The channel is looked up with mutex_
+  // held, since mirror() may grow channels_ meanwhile.
+  void submitEncoding(
+      uint16_t channel,
+      const Channel& state,
+      const StreamSample& sample,
+      const StreamConfig& config,
+      std::shared_ptr<const Codec> codec,
+      size_t size);
+  // Queues a record whose body is complete. Called with mutex_ held.
+  void push(Record&& record);
+
+  void run();
+  bool connect();
+  // Closes the connection and drops the queued records. Called with mutex_ held.
+  void disconnect();
+  // Queues the announcements, and latest configs, of the given channels at the front of the queue.
+  // Called with mutex_ held.
+  void announce(size_t firstChannel);
+  // Takes the records of the next frame from the queue and writes them. Returns false if the
+  // connection failed.
+  bool sendFrame(std::unique_lock<std::mutex>& lock);
+
+  std::string host_;
+  uint16_t port_;
+  BridgeOptions options_;
+
+  std::vector<std::unique_ptr<Channel>> channels_;
+  std::deque<Record> queue_;
+  size_t queuedBytes_ = 0;
+  // Bytes of the samples being encoded
+  size_t encodingBytes_ = 0;
+  // Channels announced on the current connection
+  size_t announced_ = 0;
+  std::chrono::steady_clock::time_point lastAnnounced_;
+  std::atomic<int> socket_{-1};
+  std::atomic<uint64_t> samplesSent_{0};
+  std::atomic<uint64_t> samplesDropped_{0};
+  std::atomic<uint64_t> sampleBytesSent_{0};
+
+  bool stop_ = false;
+  std::mutex mutex_;
+  std::condition_variable pending_;
+  std::thread thread_;
+  // Encodes the samples of each stream in order, on the same thread
+  std::unique_ptr<CodecPool> encoders_;
+};
+
+class BridgeReceiver {
+ public:
+  // Listens on address:port. Port 0 picks a free port, see port().
+  BridgeReceiver(
+      uint16_t port,
+      const std::string& address = "0.0.0.0",
+      const BridgeOptions& options = BridgeOptions());
+
+  ~BridgeReceiver();
+
+  uint16_t port() const {
+    return port_;
+  }
+
+  // Produces the samples of a remote stream on a local stream with a different ID. Only applies to
+  // streams announced after the call.
+  void remap(const StreamID& remote, const StreamID& local);
+
+  uint64_t samplesReceived() const {
+    return samplesReceived_;
+  }
+
+ private:
+  struct Inbound {
+    StreamID id;
+    std::string typeName;
+    std::unique_ptr<StreamProducer> producer{};
+    bool configured = false;
+  };
+
+  // A TCP connection, or a UDP peer
+  struct Peer {
+    int socket = -1;
+    std::vector<uint8_t> buffer;
+    std::map<uint16_t, Inbound> channels;
+  };
+
+  void run();
+  // Returns false once the connection is closed, or sent malformed data
+  bool receiveStream(Peer& peer);
+  void receiveDatagram();
+  // Consumes the complete frames at the start of the peer's buffer. Returns false if the data is
+  // malformed.
+  bool processFrames(Peer& peer);
+  bool processRecord(Peer& peer, const bridge::RecordHeader& header, const uint8_t* body);
+  void announced(Peer& peer, uint16_t channel, const uint8_t* body, size_t length);
+
+  BridgeOptions options_;
+  uint16_t port_ = 0;
+  int socket_ = -1;
+  std::vector<std::unique_ptr<Peer>> connections_;
+  std::map<std::string, Peer> datagramPeers_;
+  std::vector<uint8_t> datagram_;
+  std::map<StreamID, StreamID> remapped_;
+  std::mutex remapMutex_;
+  std::atomic<uint64_t> samplesReceived_{0};
+
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+
+} // namespace cthulhu
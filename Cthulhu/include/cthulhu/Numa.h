@@ -0,0 +1,73 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <cthulhu/StreamInterface.h>
+
+namespace cthulhu {
+
+// The threads Cthulhu starts on its own, which can be pinned with Numa::setThreadPlacement
+enum class ThreadRole : uint8_t {
+  ASYNC_PRODUCER = 0,
+  ASYNC_CONSUMER = 1,
+  ALIGNER = 2,
+  IPC_LISTENER = 3,
+  CLOCK = 4,
+  AUDITOR = 5,
+  WATCHDOG = 6,
+  INGEST = 7,
+};
+
+// NUMA topology, memory binding and thread pinning. On platforms without NUMA support, there is a
+// single node 0, and binding and pinning fail without side effects.
+class Numa {
+ public:
+  // Number of memory nodes in the system, at least 1
+  static int numNodes();
+
+  // Node of the CPU the calling thread is running on
+  static int currentNode();
+
+  // CPUs belonging to the given node
+  static std::vector<int> cpusOfNode(int node);
+
+  // Binds the whole pages within [address, address + length) to the given node, moving any pages
+  // that were already touched by this process. Returns false if nothing could be bound.
+  static bool bindMemory(void* address, size_t length, int node);
+
+  // Restricts the calling thread to the given CPUs
+  static bool pinCurrentThread(const std::vector<int>& cpus);
+
+  // Sets the CPUs that threads of the given role are restricted to. Only applies to threads
+  // started after the call. An empty set removes the restriction for new threads.
+  static void setThreadPlacement(ThreadRole role, const std::vector<int>& cpus);
+
+  // Pins the calling thread according to the placement of its role, if any. Called by Cthulhu
+  // when it starts a thread.
+  static void applyThreadPlacement(ThreadRole role);
+};
+
+// Chooses the NUMA node buffers of a stream are allocated from: the node the stream was placed on,
+// or else the node of the allocating thread, which is usually the producer
+class NumaPlacement {
+ public:
+  void setStreamNode(StreamHandle handle, int node);
+
+  // Always a valid node, in [0, Numa::numNodes()). Lock-free, it is looked up on every allocation.
+  int nodeFor(StreamHandle handle) const;
+
+ private:
+  struct StreamNode {
+    // Negative if the stream wasn't placed
+    std::atomic<int> node{-1};
+  };
+  StreamHandleTable<StreamNode> streamNodes_;
+};
+
+} // namespace cthulhu
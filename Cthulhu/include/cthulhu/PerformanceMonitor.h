@@ -16,6 +16,7 @@ struct PerformanceSummary {
   std::chrono::duration<double> totalRuntime;
   uint64_t numCalls = 0;
   uint64_t numSamplesDropped = 0;
+  uint64_t numDeadlineMisses = 0;
 };
 
 // PerformanceMonitor provides a way to measure the timing of callbacks and update
@@ -26,6 +27,7 @@ struct PerformanceMonitor {
   void startMeasurement();
   void endMeasurement();
   void sampleDropped();
+  void deadlineMissed();
   PerformanceSummary getSummary();
 
  private:
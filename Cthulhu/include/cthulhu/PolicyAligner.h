@@ -0,0 +1,56 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <cthulhu/Aligner.h>
+
+namespace cthulhu {
+
+// Built-in alignment policies. The stream registered at index 0 is the reference stream, and each
+// of its samples produces at most one aligned set:
+//  - NEAREST_TIMESTAMP: pairs the reference sample with the sample of every other stream nearest
+//                       to it in time, once a sample at or after its timestamp has arrived there
+//  - INTERPOLATE: like NEAREST_TIMESTAMP, but passes the two samples bracketing the reference
+//                 timestamp to an interpolator to produce the aligned sample
+//  - HOLD_LAST: pairs the reference sample with the latest sample of every other stream, as soon
+//               as every stream has produced one
+enum class AlignPolicy : uint8_t { NEAREST_TIMESTAMP = 0, INTERPOLATE = 1, HOLD_LAST = 2 };
+
+// Produces a sample for stream idx at a weight in [0, 1] between the samples before and after it
+using AlignerInterpolator = std::function<StreamSample(
+    size_t idx,
+    const StreamSample& before,
+    const StreamSample& after,
+    double weight)>;
+
+class PolicyAligner : public Aligner {
+ public:
+  // queueSize bounds how long a stream waits for a later sample before settling for its newest
+  PolicyAligner(
+      AlignPolicy policy,
+      size_t queueSize = 10,
+      ThreadPolicy threadPolicy = ThreadPolicy::THREAD_NEUTRAL);
+
+  virtual ~PolicyAligner();
+
+  // Required by INTERPOLATE, and set before finalize()
+  void setInterpolator(const AlignerInterpolator& interpolator);
+
+  // Throws if INTERPOLATE was selected without an interpolator
+  virtual void finalize() override;
+
+ protected:
+  virtual void align() override;
+
+ private:
+  // Fills samples with the next aligned set, if there is one. Called with queueMutex_ held.
+  bool alignNext(std::vector<StreamSample>& samples);
+  bool selectNearest(size_t idx, double timestamp, StreamSample& sample);
+  bool selectLatest(size_t idx, StreamSample& sample);
+
+  AlignPolicy alignPolicy_;
+  AlignerInterpolator interpolator_;
+  uint64_t alignedVersion_ = 0;
+}; // class PolicyAligner
+
+} // namespace cthulhu
@@ -0,0 +1,81 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace cthulhu {
+
+struct ProcessTableData;
+
+// A table in shared memory holding the phase, heartbeat and exception of each process of a group,
+// such as the processes of a LabGraph graph. The process that creates the table owns it and
+// removes it when destroyed; the others open it by name.
+//
+// Phases are integers that only move forward. Setting a phase or an exception wakes up the
+// processes blocked in waitForChange(), so that startup barriers and failure detection don't
+// have to poll. Heartbeats are only stored, since they are meant to be written often.
+class ProcessTable {
+ public:
+  static constexpr size_t kMaxNameLength = 63;
+  // Longer exception descriptions are truncated
+  static constexpr size_t kMaxExceptionLength = 16 * 1024 - 1;
+
+  // Creates a table named name, replacing any left over, with every phase set to initialPhase.
+  // Throws if it can't be created or a process name is longer than kMaxNameLength.
+  static std::unique_ptr<ProcessTable> create(
+      const std::string& name,
+      const std::vector<std::string>& processes,
+      uint32_t initialPhase = 0);
+
+  // Opens a table created by another process. Throws if it doesn't exist.
+  static std::unique_ptr<ProcessTable> open(const std::string& name);
+
+  ~ProcessTable();
+
+  const std::string& name() const {
+    return name_;
+  }
+  std::vector<std::string> processes() const;
+
+  // Functions taking a process name throw std::out_of_range if it isn't in the table
+  uint32_t phase(const std::string& process) const;
+  std::map<std::string, uint32_t> phases() const;
+  // Returns false, leaving the phase unchanged, unless phase is after the current one
+  bool setPhase(const std::string& process, uint32_t phase);
+
+  // Records that the process is alive at the time of the call
+  void heartbeat(const std::string& process);
+  // Seconds since the last heartbeat of the process, or since the table was created
+  double secondsSinceHeartbeat(const std::string& process) const;
+
+  std::optional<std::string> exception(const std::string& process) const;
+  std::map<std::string, std::optional<std::string>> exceptions() const;
+  // Returns false, leaving the exception unchanged, if the process already has one
+  bool setException(const std::string& process, const std::string& description);
+  bool hasException() const;
+
+  // Counts the changes of phases and exceptions
+  uint64_t version() const;
+  // Blocks until version() differs from the given version, or timeout seconds have passed, and
+  // returns version()
+  uint64_t waitForChange(uint64_t version, double timeout) const;
+
+ private:
+  ProcessTable(const std::string& name, bool owner);
+
+  size_t slotOf(const std::string& process) const;
+
+  std::string name_;
+  bool owner_;
+  struct Mapping;
+  std::unique_ptr<Mapping> mapping_;
+  ProcessTableData* data_ = nullptr;
+};
+
+} // namespace cthulhu
@@ -27,6 +27,7 @@ class QueueingAligner : public AlignerBase {
     uint32_t latestSequence = 0;
     std::unique_ptr<StreamConsumer> consumer;
     StreamID id;
+    StreamHandle handle = INVALID_STREAM_HANDLE;
   };
   std::vector<StreamQueue> queues_;
   std::mutex queueMutex_;
@@ -0,0 +1,86 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <type_traits>
+
+#include <cthulhu/StreamType.h>
+
+namespace cthulhu {
+
+// A SampleView is a read-only, non-owning view of a typed sample. It exposes the same field
+// accessors as T, but instead of copying the underlying StreamSample (and bumping the reference
+// counts of its metadata, payload and parameters) it borrows the sample handed to the callback.
+//
+// Views are only valid for the duration of the callback they were passed to. To keep a sample
+// around longer, call retain(), which returns an owning T.
+//
+// Use it by naming SampleView<T> as the sample type of a subscriber or transformer input, e.g.
+//
+//   ctx.subscribe<SampleView<MySample>>(
+//       "stream", [](const SampleView<MySample>& view) { use(view->field); });
+template <typename T>
+class SampleView {
+  static_assert(
+      std::is_base_of_v<AutoStreamSample, T>,
+      "cthulhu::SampleView only supports types that subclass cthulhu::AutoStreamSample");
+
+ public:
+  using SampleType = T;
+
+  SampleView() : view_(details::borrowed_sample(), nullptr) {}
+  explicit SampleView(const StreamSample& sample) : view_(details::borrowed_sample(), &sample) {}
+
+  SampleView(const SampleView& other) : view_(details::borrowed_sample(), other.view_.borrowed_) {}
+  SampleView& operator=(const SampleView& other) {
+    view_.borrowed_ = other.view_.borrowed_;
+    return *this;
+  }
+
+  const T& get() const {
+    return view_;
+  }
+
+  const T& operator*() const {
+    return view_;
+  }
+
+  const T* operator->() const {
+    return &view_;
+  }
+
+  const StreamSample& getSample() const {
+    return view_.getSample();
+  }
+
+  // Rebinds the view to another sample. This lets the aligner callbacks reuse views the same way
+  // they reuse owning samples.
+  void setSample(const StreamSample& sample) {
+    view_.borrowed_ = &sample;
+  }
+
+  // Returns an owning copy of the viewed sample, which may outlive the callback.
+  T retain() const {
+    return T(getSample());
+  }
+
+ private:
+  T view_;
+};
+
+namespace details {
+// Maps a SampleView<T> to T so that type registry lookups see the underlying sample type
+template <typename T>
+struct viewed_type {
+  using type = T;
+};
+template <typename T>
+struct viewed_type<SampleView<T>> {
+  using type = T;
+};
+
+template <typename T>
+using viewed_type_t = typename viewed_type<T>::type;
+} // namespace details
+
+} // namespace cthulhu
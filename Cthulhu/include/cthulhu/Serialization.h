@@ -28,27 +28,16 @@ void deserializeDynamicFields(
 } // namespace details
 
 /**
- *  Compute a checksum for a type definition, based on its sample type.
+ *  Compute a checksum for a registered type definition.
  *  The checksum can be used to validate across processes/machines that the
  *  layout for a given type matches.
- *  Returns -1 on failure, otherwise returns the checksum.
  */
-template <class SampleType>
-int typeChecksum() {
-  auto sampleTypeInfo = Framework::instance().typeRegistry()->findSampleType(typeid(SampleType));
-  if (!sampleTypeInfo) {
-    XR_LOGCE(
-        "Cthulhu",
-        "Couldn't compute checksum for type info, failed to find sample type in registry: ",
-        typeid(SampleType).name());
-    return -1;
-  }
-
+inline int typeChecksum(const TypeInfoInterface& typeInfo) {
   std::stringstream ss;
-  ss << sampleTypeInfo->typeName();
-  ss << sampleTypeInfo->isBasic();
-  ss << sampleTypeInfo->hasContentBlock();
-  ss << sampleTypeInfo->hasSamplesInContentBlock();
+  ss << typeInfo.typeName();
+  ss << typeInfo.isBasic();
+  ss << typeInfo.hasContentBlock();
+  ss << typeInfo.hasSamplesInContentBlock();
 
   auto addFields = [&ss](const FieldData& fields) -> void {
     for (const auto& field : fields) {
@@ -61,8 +50,8 @@ int typeChecksum() {
     }
   };
 
-  addFields(sampleTypeInfo->configFields());
-  addFields(sampleTypeInfo->sampleFields());
+  addFields(typeInfo.configFields());
+  addFields(typeInfo.sampleFields());
 
   boost::crc_32_type result;
   result.process_bytes(ss.str().data(), ss.str().length());
@@ -70,6 +59,23 @@ int typeChecksum() {
   return result.checksum();
 }
 
+/**
+ *  Compute a checksum for a type definition, based on its sample type.
+ *  Returns -1 on failure, otherwise returns the checksum.
+ */
+template <class SampleType>
+int typeChecksum() {
+  auto sampleTypeInfo = Framework::instance().typeRegistry()->findSampleType(typeid(SampleType));
+  if (!sampleTypeInfo) {
+    XR_LOGCE(
+        "Cthulhu",
+        "Couldn't compute checksum for type info, failed to find sample type in registry: ",
+        typeid(SampleType).name());
+    return -1;
+  }
+  return typeChecksum(*sampleTypeInfo);
+}
+
 /**
  *  Serialize a Stream Config into a flat array of bytes
  */
@@ -92,6 +98,12 @@ std::vector<uint8_t> serializeConfig(const ConfigType& config) {
   return serializeConfig(typeInfo->typeName(), config.getConfig());
 }
 
+/**
+ *  Size of the Stream Config serialized at the start of the given bytes, or 0 if they are too short
+ * to hold it. Check this before deserializing bytes from an untrusted source.
+ */
+size_t serializedConfigSize(const std::string& typeName, const uint8_t* config, size_t length);
+
 /**
  *  Deserialize a Stream Config from a flat array of bytes
  */
@@ -172,14 +184,46 @@ std::vector<uint8_t> serializeSample(
   return serializeSample(typeInfo->typeName(), sample.getSample(), streamConfigPtr);
 }
 
+/**
+ *  A range of bytes of a serialized Stream Sample
+ */
+struct SerializedRange {
+  const uint8_t* data;
+  size_t size;
+};
+
+/**
+ *  Describe the serialized form of a Stream Sample, byte for byte that of serializeSample, as a
+ * list of ranges that can be written with scatter-gather I/O. The parameters, dynamic fields and
+ * payload are referenced in place, and the small fixed-size fields are written to header, which the
+ * ranges also point into. Returns the total size, or 0 on failure.
+ */
+size_t gatherSample(
+    const std::string& typeName,
+    const StreamSample& sample,
+    const StreamConfig* const config,
+    std::vector<SerializedRange>& ranges,
+    std::vector<uint8_t>& header);
+
+/**
+ *  Size of the Stream Sample serialized at the start of the given bytes, or 0 if they are too short
+ * to hold it. Check this before deserializing bytes from an untrusted source.
+ */
+size_t serializedSampleSize(
+    const std::string& typeName,
+    const uint8_t* sample,
+    size_t length,
+    const StreamConfig* const config = nullptr);
+
 /**
  *  Deserialize a Stream Sample from a flat array of bytes, using the current Config for non-basic
- * streams.
+ * streams. The parameters and payload are taken from the memory pool of the given stream.
  */
 StreamSample deserializeSample(
     const std::string& typeName,
     const uint8_t* sample,
-    const StreamConfig* const config = nullptr);
+    const StreamConfig* const config = nullptr,
+    StreamHandle poolHandle = StreamHandles::anonymous());
 
 inline StreamSample deserializeSample(
     const std::string& typeName,
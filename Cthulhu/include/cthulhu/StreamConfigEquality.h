@@ -7,8 +7,14 @@
 
 namespace cthulhu {
 
+// Returns a hash of the content of a StreamConfig given the type information of the stream
+// associated with the config type that the StreamConfig backs. Never returns 0, which marks a
+// StreamConfig whose contentHash wasn't computed.
+uint64_t streamConfigHash(const StreamConfig& config, const TypeInfoInterface& stream_type_info);
+
 // Returns whether two StreamConfigs are equal given the type information of the stream associated
-// with the config type that these StreamConfigs back.
+// with the config type that these StreamConfigs back. When both configs carry a contentHash, the
+// hashes are compared instead of the content.
 bool streamConfigsEqual(
     const StreamConfig& lhs,
     const StreamConfig& rhs,
@@ -0,0 +1,99 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace cthulhu {
+
+// A StreamHandle is a dense index interned for a StreamID the first time the stream is registered
+// in the process. Per-sample paths carry the handle and index per-stream state with it, so the
+// StreamID string is only needed when registering and looking up streams. Handles are only
+// meaningful within the process that interned them.
+using StreamHandle = uint32_t;
+
+constexpr StreamHandle INVALID_STREAM_HANDLE = std::numeric_limits<StreamHandle>::max();
+
+// How many StreamIDs a process can intern, which is the capacity of a StreamHandleTable
+constexpr StreamHandle MAX_STREAM_HANDLES = 256 * 4096;
+
+// The process-wide table of interned StreamIDs
+class StreamHandles {
+ public:
+  // Returns the handle of the StreamID, interning it if it hasn't been seen before. Throws once
+  // MAX_STREAM_HANDLES StreamIDs were interned.
+  static StreamHandle intern(std::string_view id);
+
+  // The handle of the empty StreamID, used for buffers that don't belong to a stream. Cached, so it
+  // costs no lookup.
+  static StreamHandle anonymous();
+
+  // Returns the handle of the StreamID, or INVALID_STREAM_HANDLE if it was never interned
+  static StreamHandle find(std::string_view id);
+
+  // Returns the StreamID of an interned handle, or an empty string for an unknown handle
+  static std::string id(StreamHandle handle);
+};
+
+// Per-stream state indexed by StreamHandle. Slots are allocated in blocks that never move once
+// allocated, so looking up a slot is lock-free and stays valid while other streams are added.
+// Slots are default constructed.
+template <typename T>
+class StreamHandleTable {
+ public:
+  StreamHandleTable() = default;
+
+  ~StreamHandleTable() {
+    for (auto& block : blocks_) {
+      delete[] block.load(std::memory_order_relaxed);
+    }
+  }
+
+  StreamHandleTable(const StreamHandleTable&) = delete;
+  StreamHandleTable& operator=(const StreamHandleTable&) = delete;
+
+  // Returns the slot of the handle, or nullptr if no slot was allocated for it yet
+  T* find(StreamHandle handle) const {
+    const size_t block = handle / BLOCK_SIZE;
+    if (block >= MAX_BLOCKS) {
+      return nullptr;
+    }
+    T* slots = blocks_[block].load(std::memory_order_acquire);
+    return slots ? &slots[handle % BLOCK_SIZE] : nullptr;
+  }
+
+  // Returns the slot of the handle, allocating it if needed. Returns nullptr for handles past the
+  // capacity of the table.
+  T* at(StreamHandle handle) {
+    const size_t block = handle / BLOCK_SIZE;
+    if (block >= MAX_BLOCKS) {
+      return nullptr;
+    }
+    T* slots = blocks_[block].load(std::memory_order_acquire);
+    if (!slots) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      slots = blocks_[block].load(std::memory_order_relaxed);
+      if (!slots) {
+        slots = new T[BLOCK_SIZE]();
+        blocks_[block].store(slots, std::memory_order_release);
+      }
+    }
+    return &slots[handle % BLOCK_SIZE];
+  }
+
+ private:
+  static constexpr size_t BLOCK_SIZE = 256;
+  static constexpr size_t MAX_BLOCKS = MAX_STREAM_HANDLES / BLOCK_SIZE;
+
+  std::array<std::atomic<T*>, MAX_BLOCKS> blocks_{};
+  std::mutex mutex_;
+};
+
+} // namespace cthulhu
@@ -3,6 +3,8 @@
 #pragma once
 
 #include <assert.h>
+#include <atomic>
+#include <chrono>
 #include <cstring>
 #include <functional>
 #include <future>
@@ -19,6 +21,8 @@
 #include <cthulhu/BufferTypes.h>
 #include <cthulhu/PerformanceMonitor.h>
 #include <cthulhu/RawDynamic.h>
+#include <cthulhu/StreamHandle.h>
+#include <cthulhu/Watchdog.h>
 
 namespace cthulhu {
 
@@ -91,6 +95,11 @@ struct SampleMetadata {
 struct StreamSample {
   StreamSample();
 
+  // Type tag for constructing a sample without allocating its metadata. This is only meant for
+  // storage that is never read before it is overwritten, such as the unused slot of a SampleView.
+  struct Unallocated {};
+  explicit StreamSample(Unallocated) {}
+
   // The full historical metadata of the sample
   std::shared_ptr<SampleMetadata> metadata;
 
@@ -127,6 +136,10 @@ struct StreamConfig {
 
   // This carries any dynamically-sized parameters
   SharedRawDynamicArray dynamicParameters;
+
+  // Hash of the fields above, set by StreamProducer::configureStream once the config is filled in,
+  // or 0 if it wasn't computed. Must be reset to 0 if the config is modified afterwards.
+  uint64_t contentHash = 0;
 };
 
 using SampleCallback = std::function<void(const StreamSample&)>;
@@ -136,6 +149,28 @@ struct DataVariant {
   enum class Type { SAMPLE, CONFIG, INVALID } type = Type::INVALID;
   StreamSample sample;
   StreamConfig config;
+  // When the item reached the consumer, for deadline accounting. Unset without a deadline.
+  std::chrono::steady_clock::time_point arrival;
+};
+
+// How urgent the samples of a consumer are, relative to the other consumers of the process
+enum class PriorityClass : uint8_t { BACKGROUND = 0, NORMAL = 1, REALTIME = 2 };
+
+// Scheduling hints for delivering samples to a consumer
+struct ConsumerScheduling {
+  PriorityClass priority = PriorityClass::NORMAL;
+  // How long a sample may take from reaching the consumer until its callback returns. Slower
+  // samples are counted as deadline misses. Zero means no deadline.
+  std::chrono::duration<double> deadline{0.0};
+  // Runs the consumer thread with SCHED_FIFO. Only honored for REALTIME consumers, and needs
+  // CAP_SYS_NICE (or an RLIMIT_RTPRIO) to take effect.
+  bool realtimeThread = false;
+  // Delivers samples through the shared executor, which runs the consumers of the process in
+  // priority order, and earliest deadline first within a priority class, instead of on a thread of
+  // the consumer's own. Set for ConsumerType::SCHEDULED.
+  bool scheduled = false;
+  // Latency budget checked by the Watchdog. Where empty, the budget of the stream applies.
+  WatchdogBudget watchdog;
 };
 
 // Forward Declaration
@@ -167,6 +202,9 @@ class StreamProducer {
   // This gets the current configuration for the stream
   const StreamConfig* config() const;
 
+  // The handle of the produced stream, for allocating its samples from the pool
+  StreamHandle handle() const;
+
   // This will return false if the Producer was constructed on a Stream with an existing Producer
   inline bool isActive() const {
     return producedStream_ != nullptr;
@@ -197,7 +235,8 @@ class StreamConsumer {
       StreamInterface* si,
       SampleCallback callback,
       ConfigCallback configCallback = nullptr,
-      bool async = false);
+      bool async = false,
+      const ConsumerScheduling& scheduling = ConsumerScheduling());
 
   // Unhooks from the StreamInterface
   virtual ~StreamConsumer();
@@ -217,7 +256,34 @@ class StreamConsumer {
   uint64_t getQueueCapacity() const;
   void setQueueCapacity(uint64_t capacity);
 
+  const ConsumerScheduling& scheduling() const {
+    return scheduling_;
+  }
+
  protected:
+  // Runs the callback for a queued sample or config
+  void deliver(DataVariant& item) const;
+
+  // The arrival time of an item, for deadline accounting. Only reads the clock when the consumer has
+  // a deadline.
+  std::chrono::steady_clock::time_point arrivalTime() const;
+
+  // Calls the sample callback and accounts for the deadline
+  void deliverSample(
+      const StreamSample& sample,
+      std::chrono::steady_clock::time_point arrival) const;
+
+  // Queues an item for a scheduled consumer, and submits the consumer to the executor if it isn't
+  // already waiting there. Called with queueMutex_ held.
+  void enqueueScheduled(DataVariant&& item) const;
+
+  // Delivers the oldest queued item of a scheduled consumer. Runs on the executor.
+  void deliverScheduled() const;
+
+  // Submits the consumer to the executor, with the deadline of its oldest queued item. Called with
+  // queueMutex_ held.
+  void submitScheduled() const;
+
   StreamInterface* consumedStream_ = nullptr;
   SampleCallback callback_;
   ConfigCallback configCallback_;
@@ -233,6 +299,12 @@ class StreamConsumer {
   mutable std::queue<DataVariant> queue_;
   uint64_t queueCapacity_;
   static constexpr uint64_t DEFAULT_QUEUE_CAPACITY = 10;
+
+  ConsumerScheduling scheduling_;
+  // Whether a scheduled consumer is waiting in, or running on, the executor. Locked by queueMutex_.
+  mutable bool submitted_ = false;
+
+  mutable Heartbeat heartbeat_;
 };
 
 // This is the interface used to represent a stream. A single instance for each stream lives in the
@@ -242,8 +314,9 @@ class StreamConsumer {
 // be hooked-in concurrently with signaling.
 class StreamInterface {
  public:
-  // Constructs given a description, which cannot be changed
-  explicit StreamInterface(const StreamDescription& desc) : description_(desc){};
+  // Constructs given a description, which cannot be changed. Interns the handle of the stream.
+  explicit StreamInterface(const StreamDescription& desc)
+      : description_(desc), handle_(StreamHandles::intern(desc.id())){};
   // This won't have ownership of any of the hooked producers or consumers. But it
   // only exists in the Singleton Registry, so it will live longer than any of them
   virtual ~StreamInterface() = default;
@@ -253,6 +326,11 @@ class StreamInterface {
     return description_;
   };
 
+  // Gets the handle interned for the StreamID of the description
+  inline StreamHandle handle() const {
+    return handle_;
+  };
+
   // Sets the paused flag to on/off
   inline void setPaused(bool paused) {
     paused_ = paused;
@@ -264,7 +342,11 @@ class StreamInterface {
 
   // Move-constructable, only for insertion into the Registry
   StreamInterface(StreamInterface&& other)
-      : description_(other.description_), config_(other.config_), paused_(other.paused_) {
+      : description_(other.description_),
+        handle_(other.handle_),
+        config_(other.config_),
+        paused_(other.paused_),
+        deadlineMisses_(other.deadlineMisses_.load()) {
     std::lock_guard<std::timed_mutex> lock(other.timed_mutex_);
     producer_ = std::move(other.producer_);
     consumers_ = std::move(other.consumers_);
@@ -279,6 +361,20 @@ class StreamInterface {
     return consumers_;
   };
 
+  // Returns whether anything is listening on this stream. Cheaper than consumers(), since it
+  // doesn't copy the consumer list.
+  virtual bool hasConsumers() const {
+    std::lock_guard<std::timed_mutex> lock(timed_mutex_);
+    return !consumers_.empty();
+  };
+
+  // Returns the number of consumers of this stream, including those in other processes as seen from
+  // the process that produces it.
+  virtual size_t numConsumers() const {
+    std::lock_guard<std::timed_mutex> lock(timed_mutex_);
+    return consumers_.size();
+  };
+
   const StreamConfig& config() const {
     return config_;
   };
@@ -287,6 +383,11 @@ class StreamInterface {
     return configured_;
   };
 
+  // Number of samples that missed the deadline of the consumer they were delivered to
+  uint64_t deadlineMisses() const {
+    return deadlineMisses_;
+  }
+
  protected:
   // Signal interfaces, should only be called by the producer
   // These lock the mutex to ensure that consumers are not hooked/unhooked while sending signals.
@@ -303,6 +404,8 @@ class StreamInterface {
 
   const StreamDescription description_;
 
+  const StreamHandle handle_;
+
   // The latest config sits on the interface, so it can be pushed to any new Consumers
   StreamConfig config_;
 
@@ -321,6 +424,8 @@ class StreamInterface {
 
   bool configured_ = false;
 
+  std::atomic<uint64_t> deadlineMisses_{0};
+
   // Friend these classes to restrict hook/unhook and signaling APIs
   friend class StreamProducer;
   friend class StreamConsumer;
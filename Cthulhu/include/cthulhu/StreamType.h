@@ -18,6 +18,15 @@ namespace cthulhu {
 class AutoStreamConfig;
 class AutoStreamSample;
 
+template <typename T>
+class SampleView;
+
+namespace details {
+// Type tag for constructing an AutoStreamSample that borrows a StreamSample rather than holding
+// its own copy. Only SampleView should need this.
+struct borrowed_sample {};
+} // namespace details
+
 // These base classes allow data accessors to perform non-const access
 // to the underlying data for set functions.
 class ConfigAccessor {
@@ -95,9 +104,15 @@ class AutoStreamSample {
   // Do not use; construct a AutoStreamSample subclass instead.
   explicit AutoStreamSample(size_t size, size_t numberDynamicFields);
   AutoStreamSample(const StreamSample& sample, size_t size, size_t numberDynamicFields);
+  // Wraps a sample owned by someone else. No reference counts are touched, so the sample must
+  // outlive this wrapper. Any non-const access copies the sample into sample_ first.
+  AutoStreamSample(details::borrowed_sample, const StreamSample* sample);
 
   StreamSample sample_;
+  const StreamSample* borrowed_ = nullptr;
   friend class SampleAccessor;
+  template <typename T>
+  friend class SampleView;
 };
 
 namespace details {
@@ -476,6 +491,8 @@ class ProcessingTimestamp : public SampleAccessor {
  public:
   ProcessingTimestamp(const std::string& stampName, AutoStreamSample* wrapper);
 
+  // Reads NaN if the sample doesn't carry the stamp, e.g. when a SampleView is rebound to a sample
+  // whose producer never set it
   const double& get() const;
 
   operator const double&() const;
@@ -674,9 +691,11 @@ struct FieldOffsets {
   Type(const cthulhu::StreamSample& sample, bool skipParameters = false)                      \
       : cthulhu::AutoStreamSample(                                                            \
             sample, skipParameters ? 0U : getSize(), getDynamicFieldCount()) {}               \
-  Type(const Type& other) : cthulhu::AutoStreamSample(other.sample_, 0U, 0U) {}               \
+  Type(cthulhu::details::borrowed_sample tag, const cthulhu::StreamSample* sample)            \
+      : cthulhu::AutoStreamSample(tag, sample) {}                                             \
+  Type(const Type& other) : cthulhu::AutoStreamSample(other.getSample(), 0U, 0U) {}           \
   Type& operator=(const Type& other) {                                                        \
-    sample_ = other.sample_;                                                                  \
+    setSample(other.getSample());                                                             \
     return *this;                                                                             \
   }                                                                                           \
   virtual ~Type() = default;                                                                  \
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <cthulhu/Aligner.h>
+#include <cthulhu/Lineage.h>
 
 #include <set>
 #include <unordered_map>
@@ -23,6 +24,8 @@ class SubAligner : public AlignerBase {
     double timeOffset = 0.0;
     // Flag for whether to install a metronome for the stream, default true
     bool useMetronome = true;
+    // Lineage to keep for the stream, overriding the aligner default if set
+    std::optional<LineageSettings> lineage;
   };
 
   SubAligner(
@@ -34,6 +37,14 @@ class SubAligner : public AlignerBase {
   // Use this to change that default
   void setDefaultMetronome(bool value);
 
+  // Lineage to keep for streams without their own lineage setting, off by default. Lineage is kept
+  // in a side table holding the most recent lineageCapacity entries across all streams.
+  void setDefaultLineage(const LineageSettings& settings, size_t lineageCapacity = 4096);
+
+  // Returns the input sequence numbers that went into output sample sequenceNumber of stream idx,
+  // if its lineage was kept and hasn't been evicted yet
+  std::optional<std::vector<LineageRecord>> lineage(size_t idx, uint32_t sequenceNumber) const;
+
   // This will apply a specific stream setting based on the StreamID, if used. This
   // will override any settings that are based on the pin ordering
   void setStreamSettingHint(const StreamID& id, const StreamSettings& settings);
@@ -158,12 +169,16 @@ class SubAligner : public AlignerBase {
   struct GlobalStreamData {
     // The unique ID for the stream
     StreamID streamID;
+    // The handle of the stream, for allocating output samples
+    StreamHandle handle = INVALID_STREAM_HANDLE;
     // The consumer on which samples and configuration should be sent
     std::unique_ptr<StreamConsumer> consumer;
     // The context actively being used by this stream
     int activeContext = -1;
     // The next sequence number to apply to output samples
     uint32_t sequenceOut = 0;
+    // The lineage to keep for output samples, resolved when the stream is enrolled
+    LineageSettings lineage;
   };
 
   // This is data for each input stream that is useful regardless of the impl context that is active
@@ -175,6 +190,9 @@ class SubAligner : public AlignerBase {
       AlignerContext& context,
       const std::lock_guard<std::mutex>& globalMutexLock);
 
+  // Resolves the lineage settings of stream idx from the defaults, settings and hints
+  LineageSettings lineageSettings(size_t idx) const;
+
   void processManifests(
       const std::vector<subaligner::Manifest>& manifests,
       const std::lock_guard<std::mutex>& globalMutexLock,
@@ -197,6 +215,11 @@ class SubAligner : public AlignerBase {
 
   bool defaultUseMetronome_ = false;
 
+  LineageSettings defaultLineage_;
+
+  // Lineage of the output samples of all streams
+  LineageTable lineageTable_;
+
 }; // class AlignerBase
 
 // Implements various primary alignment stream selection approaches
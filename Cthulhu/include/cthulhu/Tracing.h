@@ -0,0 +1,117 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <cthulhu/StreamInterface.h>
+
+namespace cthulhu {
+
+// Sample lifecycle tracing
+//
+// When the CTHULHU_TRACE environment variable is set, producers, consumers, aligners and IPC hops
+// record a fixed-size event for every sample they handle. Events are written to a ring buffer in
+// shared memory, one per thread, so recording never takes a lock and the rings outlive the
+// process. CthulhuTraceCollect merges the rings into a Chrome/Perfetto JSON trace.
+//
+// The ring of a thread that exits is handed back to the index, and the next thread to start
+// tracing restarts it rather than creating a new one. A process that creates many short-lived
+// threads only keeps the events of its live threads and of the ones that exited last.
+
+enum class TracePhase : uint8_t {
+  PRODUCE = 0,
+  CONSUME_BEGIN = 1,
+  CONSUME_END = 2,
+  ALIGN = 3,
+  IPC_SEND = 4,
+  IPC_RECEIVE = 5,
+};
+
+struct TraceEvent {
+  // Ticks of the TraceRingHeader clock
+  uint64_t ticks;
+  uint32_t sequenceNumber;
+  TracePhase phase;
+  uint8_t reserved[3];
+  // Truncated and null-terminated if it doesn't fit
+  char streamID[48];
+};
+static_assert(sizeof(TraceEvent) == 64, "TraceEvent should fill exactly one cache line");
+
+struct TraceRingHeader {
+  uint32_t magic;
+  uint32_t capacity;
+  uint32_t pid;
+  uint32_t tid;
+  // Converts ticks to wall time: wallNs = wallBaseNs + (ticks - ticksBase) / ticksPerSecond * 1e9
+  uint64_t ticksBase;
+  uint64_t wallBaseNs;
+  double ticksPerSecond;
+  // Total number of events written. The ring holds the last min(head, capacity) of them.
+  std::atomic<uint64_t> head;
+};
+
+// The most rings an index can hold, which bounds the number of threads tracing at the same time
+constexpr uint32_t kMaxTraceRings = 4096;
+
+struct TraceIndex {
+  // Rings are numbered in creation order across all processes sharing the index
+  std::atomic<uint32_t> numRings;
+  // Set once the thread writing to a ring has exited, so that another thread can take it over
+  std::atomic<uint8_t> released[kMaxTraceRings];
+};
+
+// An event read back from a ring, with its ticks converted to wall time
+struct CollectedTraceEvent {
+  double timestampUs;
+  uint32_t slot;
+  uint32_t pid;
+  uint32_t tid;
+  uint32_t sequenceNumber;
+  TracePhase phase;
+  std::string streamID;
+};
+
+class Tracer {
+ public:
+  static constexpr uint32_t kMagic = 0x43545243;
+
+  static bool enabled() {
+    static const bool enabled = std::getenv("CTHULHU_TRACE") != nullptr;
+    return enabled;
+  }
+
+  // Records an event on the calling thread's ring, if tracing is enabled
+  static void record(const StreamIDView& id, uint32_t sequenceNumber, TracePhase phase) {
+    if (enabled()) {
+      recordEvent(id, sequenceNumber, phase);
+    }
+  }
+  static void record(const StreamIDView& id, const StreamSample& sample, TracePhase phase) {
+    if (enabled()) {
+      recordEvent(id, sample.metadata ? sample.metadata->header.sequenceNumber : 0, phase);
+    }
+  }
+
+  // Shared memory holding the number of rings created so far
+  static std::string indexName();
+  // Shared memory holding the ring with the given slot number
+  static std::string ringName(uint32_t slot);
+
+  // Number of rings in the index, or 0 if there is none
+  static uint32_t numRings();
+  // Appends the events held by the ring in the given slot. Returns false if there is no such ring.
+  static bool readRing(uint32_t slot, std::vector<CollectedTraceEvent>& events);
+  // Removes the index and all of its rings. Returns the number of rings removed.
+  static uint32_t removeRings();
+
+ private:
+  static void recordEvent(const StreamIDView& id, uint32_t sequenceNumber, TracePhase phase);
+};
+
+} // namespace cthulhu
@@ -0,0 +1,216 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cthulhu {
+
+// Latency budgets checked by the Watchdog. Zero means unchecked.
+struct WatchdogBudget {
+  // How long a sample may wait for its consumer (or an aligner for its next aligned set)
+  std::chrono::duration<double> maxAge{0.0};
+  // How long a single callback may run, or an IPC producer may wait for its consumers
+  std::chrono::duration<double> maxCallbackTime{0.0};
+
+  bool empty() const {
+    return maxAge.count() <= 0 && maxCallbackTime.count() <= 0;
+  }
+};
+
+// Progress counters of a consumer, aligner or IPC producer. A heartbeat is disabled until the
+// Watchdog has a budget to check it against, and then only costs a relaxed load per call. Enabled,
+// it takes a few relaxed atomic updates and one clock read per call.
+class Heartbeat {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Called by the Watchdog. Samples that arrived while the heartbeat was disabled are treated as
+  // completed.
+  void enable(bool enabled) {
+    if (enabled && !enabled_.load(std::memory_order_relaxed)) {
+      completed_.store(arrived_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      busySinceNs_.store(0, std::memory_order_relaxed);
+    }
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  // A sample was queued for the subject
+  void arrive() {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    if (arrived_.fetch_add(1, std::memory_order_relaxed) ==
+        completed_.load(std::memory_order_relaxed)) {
+      pendingSinceNs_.store(nowNs(), std::memory_order_relaxed);
+    }
+  }
+
+  // A callback, or a blocking wait, has started
+  void begin() {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    busySinceNs_.store(nowNs(), std::memory_order_relaxed);
+  }
+
+  // The callback has returned. Completes one arrived sample, or all of them if caughtUp is set,
+  // as for aligners, whose aligned sets consume a varying number of samples.
+  void end(bool caughtUp = false) {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    busySinceNs_.store(0, std::memory_order_relaxed);
+    const uint64_t arrived = arrived_.load(std::memory_order_relaxed);
+    if (caughtUp) {
+      completed_.store(arrived, std::memory_order_relaxed);
+    } else {
+      complete(arrived);
+    }
+  }
+
+  // An arrived sample was dropped without running the callback
+  void drop() {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    complete(arrived_.load(std::memory_order_relaxed));
+  }
+
+  // Seconds the oldest waiting sample has waited for, or 0 if nothing is waiting
+  double age(int64_t now) const {
+    if (arrived_.load(std::memory_order_relaxed) <= completed_.load(std::memory_order_relaxed)) {
+      return 0.0;
+    }
+    return secondsSince(pendingSinceNs_.load(std::memory_order_relaxed), now);
+  }
+
+  // Seconds the running callback has run for, or 0 if none is running
+  double busy(int64_t now) const {
+    const int64_t since = busySinceNs_.load(std::memory_order_relaxed);
+    return since == 0 ? 0.0 : secondsSince(since, now);
+  }
+
+  static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+        .count();
+  }
+
+ private:
+  void complete(uint64_t arrived) {
+    // A sample that arrived before the heartbeat was enabled was already counted as completed
+    uint64_t completed = completed_.load(std::memory_order_relaxed);
+    do {
+      if (completed >= arrived) {
+        return;
+      }
+    } while (!completed_.compare_exchange_weak(
+        completed, completed + 1, std::memory_order_relaxed, std::memory_order_relaxed));
+    ++completed;
+    // The next sample has been waiting at least since this one completed
+    if (completed < arrived) {
+      pendingSinceNs_.store(nowNs(), std::memory_order_relaxed);
+    }
+  }
+
+  static double secondsSince(int64_t since, int64_t now) {
+    return now > since ? (now - since) * 1e-9 : 0.0;
+  }
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> arrived_{0};
+  std::atomic<uint64_t> completed_{0};
+  std::atomic<int64_t> pendingSinceNs_{0};
+  std::atomic<int64_t> busySinceNs_{0};
+};
+
+enum class WatchdogSubject : uint8_t { CONSUMER = 0, ALIGNER = 1, IPC_PRODUCER = 2 };
+
+//  - STALL: a callback, or an IPC producer's wait for consumers, ran longer than maxCallbackTime
+//  - LAG: a sample waited longer than maxAge
+//  - RECOVERED: a subject that stalled or lagged is back within its budget
+enum class WatchdogEvent : uint8_t { STALL = 0, LAG = 1, RECOVERED = 2 };
+
+struct WatchdogAlert {
+  WatchdogSubject subject;
+  WatchdogEvent event;
+  // The stream ID of consumers and IPC producers, or the name given to an aligner
+  std::string name;
+  // Seconds observed, and the budget they exceeded. Zero for RECOVERED.
+  double observed = 0.0;
+  double budget = 0.0;
+};
+
+using WatchdogCallback = std::function<void(const WatchdogAlert&)>;
+
+// Checks the heartbeats of consumers, aligners and IPC producers against their budgets on a
+// monitor thread, logging and calling the registered callbacks when one stalls or lags, once per
+// episode. Budgets are declared per stream with setBudget, or per consumer through its
+// ConsumerScheduling, which takes precedence. The monitor thread only runs once a budget has been
+// declared, and checks every CTHULHU_WATCHDOG_PERIOD_MS milliseconds (10 by default). Heartbeats
+// without a budget are disabled.
+//
+// The instance is never destroyed, since consumers may outlive it during static destruction.
+class Watchdog {
+ public:
+  static Watchdog& instance();
+
+  // Declares the budget of every consumer and IPC producer of the stream. An empty budget removes
+  // it.
+  void setBudget(const std::string& streamID, const WatchdogBudget& budget);
+
+  // Returns an ID for removeCallback. Callbacks run on the monitor thread.
+  size_t addCallback(const WatchdogCallback& callback);
+  // Waits for running callbacks to return, so it must not be called from one
+  void removeCallback(size_t callbackID);
+
+  // Starts checking a heartbeat, which must stay valid until unwatch(owner) returns. An empty
+  // budget falls back to the budget of the stream called name.
+  void watch(
+      const void* owner,
+      WatchdogSubject subject,
+      const std::string& name,
+      Heartbeat* heartbeat,
+      const WatchdogBudget& budget = WatchdogBudget());
+  void unwatch(const void* owner);
+
+ private:
+  Watchdog() = default;
+
+  struct Entry {
+    WatchdogSubject subject;
+    std::string name;
+    Heartbeat* heartbeat;
+    WatchdogBudget budget;
+    bool stalled = false;
+    bool lagging = false;
+  };
+
+  // Enables the heartbeat of an entry while it has a budget of its own or of its stream. Called
+  // with mutex_ held.
+  void updateHeartbeat(const Entry& entry) const;
+
+  // Called with mutex_ held
+  void startMonitor();
+  void run();
+  void check(Entry& entry, int64_t now, std::vector<WatchdogAlert>& alerts) const;
+
+  std::map<const void*, Entry> entries_;
+  std::map<std::string, WatchdogBudget> budgets_;
+  std::map<size_t, WatchdogCallback> callbacks_;
+  size_t nextCallbackID_ = 0;
+  std::mutex mutex_;
+  // Serializes the callbacks, so that removeCallback can wait for them
+  std::mutex callbackMutex_;
+  bool monitorStarted_ = false;
+};
+
+} // namespace cthulhu
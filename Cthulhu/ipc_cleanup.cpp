@@ -2,12 +2,27 @@
 
 #define DEFAULT_LOG_CHANNEL "CthulhuIPCClean"
 #include <cthulhu/Framework.h>
+#include <cthulhu/Tracing.h>
 #include <logging/Log.h>
 
+namespace {
+
+// Trace rings aren't part of the Framework's shared memory, and outlive the processes that wrote
+// them until they are collected
+void removeTraceRings() {
+  const auto removed = cthulhu::Tracer::removeRings();
+  if (removed > 0) {
+    XR_LOGI("Removed {} trace rings.", removed);
+  }
+}
+
+} // namespace
+
 int main(int argc, char** argv) {
   for (int argIdx = 0; argIdx < argc; argIdx++) {
     if ("--hard" == std::string_view(argv[argIdx])) {
       XR_LOGW("Nuking Cthulhu shared memory. This will reset Cthulhu for all users.");
+      removeTraceRings();
       if (!cthulhu::Framework::nuke()) {
         XR_LOGW("Failed to nuke Cthulhu shared memory.");
         return 1;
@@ -19,6 +34,7 @@ int main(int argc, char** argv) {
   }
   XR_LOGW("Cleaning up Cthulhu shared memory.");
   cthulhu::Framework::instance().cleanup(true);
+  removeTraceRings();
   XR_LOGI("Cleaned up Cthulhu shared memory.");
   return 0;
 }
@@ -32,8 +32,32 @@ void bindings(py::module_& m) {
         return output.str();
       });
 
+  py::class_<cthulhu::PyContextRegistrySnapshot> snapshot(m, "ContextRegistrySnapshot");
+  py::class_<cthulhu::ContextRegistrySnapshot::Context>(snapshot, "Context")
+      .def_readonly("name", &cthulhu::ContextRegistrySnapshot::Context::name)
+      .def_readonly("private_ns", &cthulhu::ContextRegistrySnapshot::Context::privateNamespace)
+      .def_readonly("pid", &cthulhu::ContextRegistrySnapshot::Context::pid)
+      .def_readonly("valid", &cthulhu::ContextRegistrySnapshot::Context::valid);
+  snapshot.def_property_readonly("version", &cthulhu::PyContextRegistrySnapshot::version)
+      .def_property_readonly("contexts", &cthulhu::PyContextRegistrySnapshot::contexts)
+      .def("subscriptions", &cthulhu::PyContextRegistrySnapshot::subscriptions)
+      .def("publications", &cthulhu::PyContextRegistrySnapshot::publications)
+      .def("transformations", &cthulhu::PyContextRegistrySnapshot::transformations);
+
   py::class_<cthulhu::PyContextRegistry>(m, "ContextRegistry")
-      .def("contexts", &cthulhu::PyContextRegistry::contexts, py::arg("all") = false);
+      .def("contexts", &cthulhu::PyContextRegistry::contexts, py::arg("all") = false)
+      .def_property_readonly("version", &cthulhu::PyContextRegistry::version)
+      .def("snapshot", &cthulhu::PyContextRegistry::snapshot, py::arg("all") = false)
+      .def(
+          "subscribers",
+          &cthulhu::PyContextRegistry::subscribers,
+          py::arg("stream_id"),
+          py::arg("all") = false)
+      .def(
+          "publishers",
+          &cthulhu::PyContextRegistry::publishers,
+          py::arg("stream_id"),
+          py::arg("all") = false);
 
   m.def("contextRegistry", []() -> std::optional<cthulhu::PyContextRegistry> {
     if (cthulhu::Framework::instance().contextRegistry()) {
@@ -42,6 +66,33 @@ void bindings(py::module_& m) {
     return {};
   });
 
+  py::class_<cthulhu::ProcessTable>(m, "ProcessTable")
+      .def_static(
+          "create",
+          &cthulhu::ProcessTable::create,
+          py::arg("name"),
+          py::arg("processes"),
+          py::arg("initial_phase") = 0)
+      .def_static("open", &cthulhu::ProcessTable::open, py::arg("name"))
+      .def_property_readonly("name", &cthulhu::ProcessTable::name)
+      .def_property_readonly("processes", &cthulhu::ProcessTable::processes)
+      .def("phase", &cthulhu::ProcessTable::phase)
+      .def("phases", &cthulhu::ProcessTable::phases)
+      .def("set_phase", &cthulhu::ProcessTable::setPhase)
+      .def("heartbeat", &cthulhu::ProcessTable::heartbeat)
+      .def("seconds_since_heartbeat", &cthulhu::ProcessTable::secondsSinceHeartbeat)
+      .def("exception", &cthulhu::ProcessTable::exception)
+      .def("exceptions", &cthulhu::ProcessTable::exceptions)
+      .def("set_exception", &cthulhu::ProcessTable::setException)
+      .def_property_readonly("has_exception", &cthulhu::ProcessTable::hasException)
+      .def_property_readonly("version", &cthulhu::ProcessTable::version)
+      .def(
+          "wait_for_change",
+          &cthulhu::ProcessTable::waitForChange,
+          py::arg("version"),
+          py::arg("timeout"),
+          py::call_guard<py::gil_scoped_release>());
+
   py::class_<cthulhu::Field>(m, "Field")
       .def(py::init<uint32_t, uint32_t, const std::string, uint32_t>())
       .def(py::init<uint32_t, uint32_t, const std::string, uint32_t, bool>())
@@ -139,7 +190,34 @@ void bindings(py::module_& m) {
 
   py::class_<cthulhu::PyMemoryPool>(m, "MemoryPool")
       .def("getBufferFromPool", &cthulhu::PyMemoryPool::getBufferFromPool)
-      .def("getGpuBufferFromPool", &cthulhu::PyMemoryPool::getGpuBufferFromPool);
+      .def("getGpuBufferFromPool", &cthulhu::PyMemoryPool::getGpuBufferFromPool)
+      .def("warmPool", &cthulhu::PyMemoryPool::warmPool)
+      .def("setSharedMemoryPolicy", &cthulhu::PyMemoryPool::setSharedMemoryPolicy)
+      .def("setStreamNumaNode", &cthulhu::PyMemoryPool::setStreamNumaNode)
+      .def("lockMemory", &cthulhu::PyMemoryPool::lockMemory)
+      .def("stats", &cthulhu::PyMemoryPool::stats);
+
+  py::class_<cthulhu::Numa>(m, "Numa")
+      .def_static("numNodes", &cthulhu::Numa::numNodes)
+      .def_static("currentNode", &cthulhu::Numa::currentNode)
+      .def_static("cpusOfNode", &cthulhu::Numa::cpusOfNode);
+
+  py::class_<cthulhu::MemoryPoolStats>(m, "MemoryPoolStats")
+      .def_readonly("warmed_bytes", &cthulhu::MemoryPoolStats::warmedBytes)
+      .def_readonly("demand_bytes", &cthulhu::MemoryPoolStats::demandBytes)
+      .def_readonly("locked_bytes", &cthulhu::MemoryPoolStats::lockedBytes)
+      .def_readonly("promoted_buffers", &cthulhu::MemoryPoolStats::promotedBuffers)
+      .def_readonly("promoted_bytes", &cthulhu::MemoryPoolStats::promotedBytes);
+
+  py::enum_<cthulhu::SharedMemoryPolicy>(m, "SharedMemoryPolicy")
+      .value("ADAPTIVE", cthulhu::SharedMemoryPolicy::ADAPTIVE)
+      .value("ALWAYS_SHARED", cthulhu::SharedMemoryPolicy::ALWAYS_SHARED)
+      .value("ALWAYS_LOCAL", cthulhu::SharedMemoryPolicy::ALWAYS_LOCAL)
+      .export_values();
+
+  // Interns the StreamID, so that per-sample allocations pass the handle instead
+  m.def("streamHandle", [](const std::string& id) { return cthulhu::StreamHandles::intern(id); });
+  m.def("anonymousStreamHandle", &cthulhu::StreamHandles::anonymous);
 
   m.def("memoryPool", []() -> std::optional<cthulhu::PyMemoryPool> {
     if (cthulhu::Framework::instance().memoryPool()) {
@@ -154,7 +232,9 @@ void bindings(py::module_& m) {
       .def_property_readonly("type", &cthulhu::StreamDescription::type);
 
   py::class_<cthulhu::PyStreamInterface>(m, "StreamInterface")
-      .def_property_readonly("description", &cthulhu::PyStreamInterface::description);
+      .def_property_readonly("description", &cthulhu::PyStreamInterface::description)
+      .def_property_readonly("num_consumers", &cthulhu::PyStreamInterface::numConsumers)
+      .def_property_readonly("deadline_misses", &cthulhu::PyStreamInterface::deadlineMisses);
 
   py::class_<cthulhu::PyStreamConfig>(m, "StreamConfig")
       .def(py::init<cthulhu::PyCpuBuffer>())
@@ -169,7 +249,8 @@ void bindings(py::module_& m) {
       .def_property(
           "parameters",
           &cthulhu::PyStreamConfig::getParameters,
-          &cthulhu::PyStreamConfig::setParameters);
+          &cthulhu::PyStreamConfig::setParameters)
+      .def_property_readonly("contentHash", &cthulhu::PyStreamConfig::getContentHash);
 
   py::class_<cthulhu::SampleHeader>(m, "SampleHeader")
       .def_readwrite("timestamp", &cthulhu::SampleHeader::timestamp)
@@ -210,17 +291,69 @@ void bindings(py::module_& m) {
           &cthulhu::PyStreamSample::getDynamicParameters,
           &cthulhu::PyStreamSample::setDynamicParameters);
 
+  py::enum_<cthulhu::PriorityClass>(m, "PriorityClass")
+      .value("BACKGROUND", cthulhu::PriorityClass::BACKGROUND)
+      .value("NORMAL", cthulhu::PriorityClass::NORMAL)
+      .value("REALTIME", cthulhu::PriorityClass::REALTIME)
+      .export_values();
+
+  py::class_<cthulhu::WatchdogBudget>(m, "WatchdogBudget")
+      .def(py::init())
+      .def_readwrite("max_age", &cthulhu::WatchdogBudget::maxAge)
+      .def_readwrite("max_callback_time", &cthulhu::WatchdogBudget::maxCallbackTime);
+
+  py::class_<cthulhu::ConsumerScheduling>(m, "ConsumerScheduling")
+      .def(py::init())
+      .def_readwrite("priority", &cthulhu::ConsumerScheduling::priority)
+      .def_readwrite("deadline", &cthulhu::ConsumerScheduling::deadline)
+      .def_readwrite("realtime_thread", &cthulhu::ConsumerScheduling::realtimeThread)
+      .def_readwrite("scheduled", &cthulhu::ConsumerScheduling::scheduled)
+      .def_readwrite("watchdog", &cthulhu::ConsumerScheduling::watchdog);
+
+  py::enum_<cthulhu::WatchdogSubject>(m, "WatchdogSubject")
+      .value("CONSUMER", cthulhu::WatchdogSubject::CONSUMER)
+      .value("ALIGNER", cthulhu::WatchdogSubject::ALIGNER)
+      .value("IPC_PRODUCER", cthulhu::WatchdogSubject::IPC_PRODUCER)
+      .export_values();
+
+  py::enum_<cthulhu::WatchdogEvent>(m, "WatchdogEvent")
+      .value("STALL", cthulhu::WatchdogEvent::STALL)
+      .value("LAG", cthulhu::WatchdogEvent::LAG)
+      .value("RECOVERED", cthulhu::WatchdogEvent::RECOVERED)
+      .export_values();
+
+  py::class_<cthulhu::WatchdogAlert>(m, "WatchdogAlert")
+      .def_readonly("subject", &cthulhu::WatchdogAlert::subject)
+      .def_readonly("event", &cthulhu::WatchdogAlert::event)
+      .def_readonly("name", &cthulhu::WatchdogAlert::name)
+      .def_readonly("observed", &cthulhu::WatchdogAlert::observed)
+      .def_readonly("budget", &cthulhu::WatchdogAlert::budget);
+
+  // The Watchdog is never destroyed. Callbacks run on its monitor thread, which takes the GIL to
+  // call them, so removing one releases the GIL while it waits for running callbacks.
+  py::class_<cthulhu::Watchdog, std::unique_ptr<cthulhu::Watchdog, py::nodelete>>(m, "Watchdog")
+      .def("setBudget", &cthulhu::Watchdog::setBudget, py::arg("streamID"), py::arg("budget"))
+      .def("addCallback", &cthulhu::Watchdog::addCallback, py::arg("callback"))
+      .def(
+          "removeCallback",
+          &cthulhu::Watchdog::removeCallback,
+          py::arg("callbackID"),
+          py::call_guard<py::gil_scoped_release>());
+  m.def("watchdog", &cthulhu::Watchdog::instance, py::return_value_policy::reference);
+
   py::class_<cthulhu::PyStreamConsumer>(m, "StreamConsumer")
       .def(
           py::init<
               cthulhu::PyStreamInterface,
               cthulhu::PySampleCallback,
               cthulhu::PyConfigCallback,
-              bool>(),
+              bool,
+              cthulhu::ConsumerScheduling>(),
           py::arg("si"),
           py::arg("sampleCb"),
           py::arg("configCb") = nullptr,
-          py::arg("async") = false)
+          py::arg("async") = false,
+          py::arg("scheduling") = cthulhu::ConsumerScheduling())
       .def("close", &cthulhu::PyStreamConsumer::close)
       .def_property_readonly("closed", &cthulhu::PyStreamConsumer::isClosed)
       .def("get_performance_summary", &cthulhu::PyStreamConsumer::getPerformanceSummary)
@@ -243,6 +376,129 @@ void bindings(py::module_& m) {
         return !prod.isClosed();
       });
 
+#ifndef _WIN32
+  py::enum_<cthulhu::BridgeTransport>(m, "BridgeTransport")
+      .value("TCP", cthulhu::BridgeTransport::TCP)
+      .value("UDP", cthulhu::BridgeTransport::UDP)
+      .export_values();
+
+  py::class_<cthulhu::BridgeOptions>(m, "BridgeOptions")
+      .def(py::init())
+      .def_readwrite("transport", &cthulhu::BridgeOptions::transport)
+      .def_readwrite("max_frame_bytes", &cthulhu::BridgeOptions::maxFrameBytes)
+      .def_readwrite("max_batch_delay", &cthulhu::BridgeOptions::maxBatchDelay)
+      .def_readwrite("max_queued_bytes", &cthulhu::BridgeOptions::maxQueuedBytes)
+      .def_readwrite("compress", &cthulhu::BridgeOptions::compress)
+      .def_readwrite("encoder_threads", &cthulhu::BridgeOptions::encoderThreads);
+
+  py::class_<cthulhu::PyBridgeSender>(m, "BridgeSender")
+      .def(
+          py::init<std::string, uint16_t, cthulhu::BridgeOptions>(),
+          py::arg("host"),
+          py::arg("port"),
+          py::arg("options") = cthulhu::BridgeOptions())
+      .def("mirror", &cthulhu::PyBridgeSender::mirror)
+      .def("close", &cthulhu::PyBridgeSender::close)
+      .def_property_readonly("closed", &cthulhu::PyBridgeSender::isClosed)
+      .def_property_readonly("connected", &cthulhu::PyBridgeSender::connected)
+      .def_property_readonly("samples_sent", &cthulhu::PyBridgeSender::samplesSent)
+      .def_property_readonly("samples_dropped", &cthulhu::PyBridgeSender::samplesDropped)
+      .def_property_readonly("sample_bytes_sent", &cthulhu::PyBridgeSender::sampleBytesSent);
+
+  py::class_<cthulhu::PyBridgeReceiver>(m, "BridgeReceiver")
+      .def(
+          py::init<uint16_t, std::string, cthulhu::BridgeOptions>(),
+          py::arg("port") = 0,
+          py::arg("address") = "0.0.0.0",
+          py::arg("options") = cthulhu::BridgeOptions())
+      .def("remap", &cthulhu::PyBridgeReceiver::remap)
+      .def("close", &cthulhu::PyBridgeReceiver::close)
+      .def_property_readonly("closed", &cthulhu::PyBridgeReceiver::isClosed)
+      .def_property_readonly("port", &cthulhu::PyBridgeReceiver::port)
+      .def_property_readonly("samples_received", &cthulhu::PyBridgeReceiver::samplesReceived);
+#endif
+
+#ifdef __linux__
+  py::class_<cthulhu::IngestOptions>(m, "IngestOptions")
+      .def(py::init())
+      .def_readwrite("read_bytes", &cthulhu::IngestOptions::readBytes)
+      .def_readwrite("queue_depth", &cthulhu::IngestOptions::queueDepth)
+      .def_readwrite("disable_io_uring", &cthulhu::IngestOptions::disableIoUring);
+
+  py::class_<cthulhu::IngestStats>(m, "IngestStats")
+      .def_readonly("reads", &cthulhu::IngestStats::reads)
+      .def_readonly("bytes", &cthulhu::IngestStats::bytes)
+      .def_readonly("samples", &cthulhu::IngestStats::samples)
+      .def_readonly("truncated", &cthulhu::IngestStats::truncated)
+      .def_readonly("cpu_seconds", &cthulhu::IngestStats::cpuSeconds)
+      .def_readonly("elapsed_seconds", &cthulhu::IngestStats::elapsedSeconds)
+      .def_readonly("io_uring", &cthulhu::IngestStats::ioUring)
+      .def_property_readonly("reads_per_second", &cthulhu::IngestStats::readsPerSecond)
+      .def_property_readonly(
+          "cpu_seconds_per_gigabyte", &cthulhu::IngestStats::cpuSecondsPerGigabyte);
+
+  py::class_<cthulhu::PyIngestSource>(m, "IngestSource")
+      .def(
+          py::init<std::string, std::string, uint16_t, size_t, cthulhu::IngestOptions>(),
+          py::arg("stream_id"),
+          py::arg("address"),
+          py::arg("port") = 0,
+          py::arg("sub_sample_bytes") = 1,
+          py::arg("options") = cthulhu::IngestOptions())
+      .def("configureStream", &cthulhu::PyIngestSource::configureStream)
+      .def("start", &cthulhu::PyIngestSource::start)
+      .def("close", &cthulhu::PyIngestSource::close)
+      .def_property_readonly("closed", &cthulhu::PyIngestSource::isClosed)
+      .def_property_readonly("port", &cthulhu::PyIngestSource::port)
+      .def("stats", &cthulhu::PyIngestSource::stats);
+#endif
+
+  py::class_<cthulhu::EventSchedulerOptions>(m, "EventSchedulerOptions")
+      .def(py::init())
+      .def_readwrite("spin_threshold", &cthulhu::EventSchedulerOptions::spinThreshold)
+      .def_readwrite("max_simulated_sleep", &cthulhu::EventSchedulerOptions::maxSimulatedSleep)
+      .def_readwrite("stamp_timestamp", &cthulhu::EventSchedulerOptions::stampTimestamp);
+
+  py::class_<cthulhu::LatenessHistogram>(m, "LatenessHistogram")
+      .def_readonly_static("bucket_width", &cthulhu::LatenessHistogram::BUCKET_WIDTH)
+      .def_readonly("counts", &cthulhu::LatenessHistogram::counts)
+      .def_readonly("events", &cthulhu::LatenessHistogram::events)
+      .def_readonly("max_lateness", &cthulhu::LatenessHistogram::maxLateness)
+      .def_property_readonly("mean_lateness", &cthulhu::LatenessHistogram::meanLateness)
+      .def("quantile", &cthulhu::LatenessHistogram::quantile);
+
+  py::class_<cthulhu::PyEventScheduler>(m, "EventScheduler")
+      .def(
+          py::init<std::vector<cthulhu::PyScheduledEvent>, cthulhu::EventSchedulerOptions>(),
+          py::arg("events"),
+          py::arg("options") = cthulhu::EventSchedulerOptions())
+      .def("start", &cthulhu::PyEventScheduler::start, py::arg("start_time") = -1.0)
+      .def("close", &cthulhu::PyEventScheduler::close)
+      .def_property_readonly("closed", &cthulhu::PyEventScheduler::isClosed)
+      .def_property_readonly("finished", &cthulhu::PyEventScheduler::finished)
+      .def_property_readonly("published", &cthulhu::PyEventScheduler::published)
+      .def(
+          "lateness",
+          &cthulhu::PyEventScheduler::lateness,
+          py::arg("stream_id") = std::optional<std::string>());
+
+  py::enum_<cthulhu::CodecType>(m, "CodecType")
+      .value("NONE", cthulhu::CodecType::NONE)
+      .value("LZ4", cthulhu::CodecType::LZ4)
+      .value("DELTA_BITPACK", cthulhu::CodecType::DELTA_BITPACK)
+      .export_values();
+
+  py::class_<cthulhu::PyCodec>(m, "Codec")
+      .def_static("lz4", &cthulhu::PyCodec::lz4)
+      .def_static(
+          "delta_bitpack",
+          &cthulhu::PyCodec::deltaBitPack,
+          py::arg("element_bytes") = 2,
+          py::arg("stride") = 1)
+      .def_property_readonly("type", &cthulhu::PyCodec::type)
+      .def("encode", &cthulhu::PyCodec::encode, py::arg("data"))
+      .def("decode", &cthulhu::PyCodec::decode, py::arg("data"), py::arg("decoded_size"));
+
   py::class_<cthulhu::PyStreamRegistry>(m, "StreamRegistry")
       .def("registerStream", &cthulhu::PyStreamRegistry::registerStream)
       .def("getStream", &cthulhu::PyStreamRegistry::getStream)
@@ -300,6 +556,106 @@ void bindings(py::module_& m) {
       .value("SEQUENCE", cthulhu::AlignerMode::SEQUENCE)
       .export_values();
 
+  py::class_<cthulhu::AlignerReferenceMeta>(m, "AlignerReferenceMeta")
+      .def(py::init())
+      .def_readwrite("timestamp", &cthulhu::AlignerReferenceMeta::timestamp)
+      .def_readwrite("sequenceNumber", &cthulhu::AlignerReferenceMeta::sequenceNumber)
+      .def_readwrite("subSampleOffset", &cthulhu::AlignerReferenceMeta::subSampleOffset)
+      .def_readwrite("numSubSamples", &cthulhu::AlignerReferenceMeta::numSubSamples);
+
+  py::class_<cthulhu::AlignerSampleMeta>(m, "AlignerSampleMeta")
+      .def(py::init())
+      .def_readwrite("timestamp", &cthulhu::AlignerSampleMeta::timestamp)
+      .def_readwrite("duration", &cthulhu::AlignerSampleMeta::duration)
+      .def_readwrite("references", &cthulhu::AlignerSampleMeta::references);
+
+  py::class_<cthulhu::AlignerStreamMeta>(m, "AlignerStreamMeta")
+      .def(py::init())
+      .def_readwrite("streamID", &cthulhu::AlignerStreamMeta::streamID)
+      .def_readwrite("subSampleSize", &cthulhu::AlignerStreamMeta::subSampleSize);
+
+  // Aligner meta is passed as bytes: the fixed-layout encoding, the log of AlignerMetaWriter, or
+  // the older format of serialize()
+  m.def(
+      "encodeAlignerSamplesMeta", [](const cthulhu::AlignerSamplesMeta& meta) -> py::bytes {
+        std::vector<uint8_t> output;
+        cthulhu::encode(meta, output);
+        return py::bytes(reinterpret_cast<const char*>(output.data()), output.size());
+      });
+  m.def(
+      "encodeAlignerConfigsMeta", [](const cthulhu::AlignerConfigsMeta& meta) -> py::bytes {
+        std::vector<uint8_t> output;
+        cthulhu::encode(meta, output);
+        return py::bytes(reinterpret_cast<const char*>(output.data()), output.size());
+      });
+  m.def(
+      "decodeAlignerSamplesMeta",
+      [](const std::string& data) -> std::optional<cthulhu::AlignerSamplesMeta> {
+        cthulhu::AlignerSamplesMeta meta;
+        if (cthulhu::decode(reinterpret_cast<const uint8_t*>(data.data()), data.size(), meta) ==
+            0) {
+          return std::nullopt;
+        }
+        return meta;
+      });
+  m.def(
+      "decodeAlignerConfigsMeta",
+      [](const std::string& data) -> std::optional<cthulhu::AlignerConfigsMeta> {
+        cthulhu::AlignerConfigsMeta meta;
+        if (cthulhu::decode(reinterpret_cast<const uint8_t*>(data.data()), data.size(), meta) ==
+            0) {
+          return std::nullopt;
+        }
+        return meta;
+      });
+  m.def(
+      "serializeAlignerMeta",
+      [](const std::optional<cthulhu::AlignerConfigsMeta>& configs,
+         const std::vector<cthulhu::AlignerSamplesMeta>& samples) -> py::bytes {
+        std::ostringstream output;
+        if (configs) {
+          cthulhu::serialize(*configs, output);
+        }
+        for (const auto& meta : samples) {
+          cthulhu::serialize(meta, output);
+        }
+        return py::bytes(output.str());
+      },
+      py::arg("configs"),
+      py::arg("samples"));
+  m.def(
+      "convertAlignerMeta",
+      [](const std::string& legacy, bool hasConfigs) -> std::pair<size_t, py::bytes> {
+        std::istringstream input(legacy);
+        std::ostringstream output;
+        const size_t converted = cthulhu::convertAlignerMeta(input, output, hasConfigs);
+        return {converted, py::bytes(output.str())};
+      },
+      py::arg("legacy"),
+      py::arg("has_configs") = true);
+  m.def(
+      "readAlignerMetaLog",
+      [](const std::string& log) -> std::pair<
+                                     std::vector<cthulhu::AlignerConfigsMeta>,
+                                     std::vector<cthulhu::AlignerSamplesMeta>> {
+        std::istringstream input(log);
+        cthulhu::AlignerMetaReader reader(input);
+        std::pair<
+            std::vector<cthulhu::AlignerConfigsMeta>,
+            std::vector<cthulhu::AlignerSamplesMeta>>
+            records;
+        cthulhu::AlignerConfigsMeta configs;
+        cthulhu::AlignerSamplesMeta samples;
+        while (const auto kind = reader.next(configs, samples)) {
+          if (*kind == cthulhu::alignermeta::RecordKind::CONFIGS) {
+            records.first.push_back(configs);
+          } else {
+            records.second.push_back(samples);
+          }
+        }
+        return records;
+      });
+
   py::class_<cthulhu::PyAligner>(m, "Aligner")
       .def(py::init())
       .def(py::init<size_t, cthulhu::ThreadPolicy, cthulhu::AlignerMode>())
@@ -309,7 +665,44 @@ void bindings(py::module_& m) {
       .def("setSamplesMetaCallback", &cthulhu::PyAligner::setSamplesMetaCallback)
       .def("setConfigsMetaCallback", &cthulhu::PyAligner::setConfigsMetaCallback)
       .def("finalize", &cthulhu::PyAligner::finalize)
-      .def("setAlignCallback", &cthulhu::PyAligner::setAlignCallback);
+      .def("setAlignCallback", &cthulhu::PyAligner::setAlignCallback)
+      .def(
+          "setWatchdogBudget",
+          &cthulhu::PyAligner::setWatchdogBudget,
+          py::arg("name"),
+          py::arg("budget"));
+
+  py::class_<cthulhu::PyAlignerQueue>(m, "AlignerQueue")
+      .def_property_readonly("id", &cthulhu::PyAlignerQueue::id)
+      .def("__len__", &cthulhu::PyAlignerQueue::size)
+      .def("__getitem__", &cthulhu::PyAlignerQueue::sample)
+      .def("timestamp", &cthulhu::PyAlignerQueue::timestamp)
+      .def("sequenceNumber", &cthulhu::PyAlignerQueue::sequenceNumber);
+
+  py::enum_<cthulhu::AlignPolicy>(m, "AlignPolicy")
+      .value("NEAREST_TIMESTAMP", cthulhu::AlignPolicy::NEAREST_TIMESTAMP)
+      .value("INTERPOLATE", cthulhu::AlignPolicy::INTERPOLATE)
+      .value("HOLD_LAST", cthulhu::AlignPolicy::HOLD_LAST)
+      .export_values();
+
+  py::class_<cthulhu::PyPolicyAligner>(m, "PolicyAligner")
+      .def(
+          py::init<cthulhu::AlignPolicy, size_t, cthulhu::ThreadPolicy>(),
+          py::arg("policy"),
+          py::arg("queueSize") = 10,
+          py::arg("threadPolicy") = cthulhu::ThreadPolicy::THREAD_NEUTRAL)
+      .def("registerConsumer", &cthulhu::PyPolicyAligner::pyRegisterConsumer)
+      .def("setCallback", &cthulhu::PyPolicyAligner::setCallback)
+      .def("setConfigCallback", &cthulhu::PyPolicyAligner::setConfigCallback)
+      .def("setSamplesMetaCallback", &cthulhu::PyPolicyAligner::setSamplesMetaCallback)
+      .def("setConfigsMetaCallback", &cthulhu::PyPolicyAligner::setConfigsMetaCallback)
+      .def("setInterpolator", &cthulhu::PyPolicyAligner::setInterpolator)
+      .def("finalize", &cthulhu::PyPolicyAligner::finalize)
+      .def(
+          "setWatchdogBudget",
+          &cthulhu::PyPolicyAligner::setWatchdogBudget,
+          py::arg("name"),
+          py::arg("budget"));
 
   py::class_<cthulhu::PyImageBuffer>(m, "ImageBuffer", py::buffer_protocol())
       .def_buffer([](cthulhu::PyImageBuffer& b) -> py::buffer_info {
@@ -333,7 +726,8 @@ void bindings(py::module_& m) {
       .def_readonly("max_runtime", &cthulhu::PerformanceSummary::maxRuntime)
       .def_readonly("total_runtime", &cthulhu::PerformanceSummary::totalRuntime)
       .def_readonly("num_calls", &cthulhu::PerformanceSummary::numCalls)
-      .def_readonly("num_samples_dropped", &cthulhu::PerformanceSummary::numSamplesDropped);
+      .def_readonly("num_samples_dropped", &cthulhu::PerformanceSummary::numSamplesDropped)
+      .def_readonly("num_deadline_misses", &cthulhu::PerformanceSummary::numDeadlineMisses);
 
   py::enum_<cthulhu::BufferType>(m, "BufferType", py::arithmetic())
       .value("NULL_BUFFER", cthulhu::BufferType::NULL_BUFFER)
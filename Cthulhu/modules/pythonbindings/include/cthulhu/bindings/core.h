@@ -4,8 +4,17 @@
 
 #include <cthulhu/Aligner.h>
 #include <cthulhu/BufferTypes.h>
+#include <cthulhu/Codec.h>
+#include <cthulhu/EventScheduler.h>
 #include <cthulhu/Framework.h>
+#ifdef __linux__
+#include <cthulhu/Ingest.h>
+#endif
+#include <cthulhu/NetworkBridge.h>
+#include <cthulhu/Numa.h>
 #include <cthulhu/PerformanceMonitor.h>
+#include <cthulhu/PolicyAligner.h>
+#include <cthulhu/ProcessTable.h>
 #include <cthulhu/bindings/cuda_util.h>
 #include <pybind11/functional.h>
 #include <pybind11/pybind11.h>
@@ -13,6 +22,65 @@
 
 namespace cthulhu {
 
+// The registrations of a snapshot, with the streams as StreamIDs and each registration tagged with
+// the name of its context
+class PyContextRegistrySnapshot {
+ public:
+  using Registration = std::pair<std::string, std::vector<StreamID>>;
+  using Transformation = std::tuple<std::string, std::vector<StreamID>, std::vector<StreamID>>;
+
+  explicit PyContextRegistrySnapshot(std::shared_ptr<const ContextRegistrySnapshot> snapshot)
+      : snapshot_(std::move(snapshot)) {}
+
+  uint64_t version() const {
+    return snapshot_->version();
+  }
+
+  const std::vector<ContextRegistrySnapshot::Context>& contexts() const {
+    return snapshot_->contexts();
+  }
+
+  std::vector<Registration> subscriptions() const {
+    std::vector<Registration> registrations;
+    snapshot_->forEachSubscription(
+        [&](const ContextRegistrySnapshot::Context& context, ContextRegistrySnapshot::Group group) {
+          registrations.emplace_back(context.name, ids(group));
+        });
+    return registrations;
+  }
+
+  std::vector<Registration> publications() const {
+    std::vector<Registration> registrations;
+    snapshot_->forEachPublication(
+        [&](const ContextRegistrySnapshot::Context& context, ContextRegistrySnapshot::Group group) {
+          registrations.emplace_back(context.name, ids(group));
+        });
+    return registrations;
+  }
+
+  std::vector<Transformation> transformations() const {
+    std::vector<Transformation> transformations;
+    snapshot_->forEachTransformation([&](const ContextRegistrySnapshot::Context& context,
+                                         ContextRegistrySnapshot::Group inputs,
+                                         ContextRegistrySnapshot::Group outputs) {
+      transformations.emplace_back(context.name, ids(inputs), ids(outputs));
+    });
+    return transformations;
+  }
+
+ private:
+  static std::vector<StreamID> ids(ContextRegistrySnapshot::Group group) {
+    std::vector<StreamID> ids;
+    ids.reserve(group.size());
+    for (const StreamHandle handle : group) {
+      ids.push_back(StreamHandles::id(handle));
+    }
+    return ids;
+  }
+
+  std::shared_ptr<const ContextRegistrySnapshot> snapshot_;
+};
+
 class PyContextRegistry {
  public:
   PyContextRegistry(cthulhu::ContextRegistryInterface* impl) : impl_(impl) {}
@@ -21,7 +89,55 @@ class PyContextRegistry {
     return impl_->contexts(all);
   }
 
+  uint64_t version() const {
+    return impl_->version();
+  }
+
+  PyContextRegistrySnapshot snapshot(bool all) const {
+    return PyContextRegistrySnapshot(impl_->snapshot(all));
+  }
+
+  // The names of the contexts subscribing to a stream, directly or as the input of a transformer,
+  // once per registration
+  std::vector<std::string> subscribers(const StreamID& id, bool all) const {
+    return registrants(id, all, false);
+  }
+
+  // The names of the contexts publishing on a stream, directly or as the output of a transformer,
+  // once per registration
+  std::vector<std::string> publishers(const StreamID& id, bool all) const {
+    return registrants(id, all, true);
+  }
+
  private:
+  // Looks the stream up by handle in the cached snapshot of the registry
+  std::vector<std::string> registrants(const StreamID& id, bool all, bool publishing) const {
+    std::vector<std::string> names;
+    // Taking the snapshot interns the handles of the registered streams
+    const auto snapshot = impl_->snapshot(all);
+    const StreamHandle handle = StreamHandles::find(id);
+    if (handle == INVALID_STREAM_HANDLE) {
+      return names;
+    }
+    auto collect = [&](const ContextRegistrySnapshot::Context& context,
+                       ContextRegistrySnapshot::Group group) {
+      if (std::find(group.begin(), group.end(), handle) != group.end()) {
+        names.push_back(context.name);
+      }
+    };
+    if (publishing) {
+      snapshot->forEachPublication(collect);
+    } else {
+      snapshot->forEachSubscription(collect);
+    }
+    snapshot->forEachTransformation([&](const ContextRegistrySnapshot::Context& context,
+                                        ContextRegistrySnapshot::Group inputs,
+                                        ContextRegistrySnapshot::Group outputs) {
+      collect(context, publishing ? outputs : inputs);
+    });
+    return names;
+  }
+
   const ContextRegistryInterface* impl_;
 };
 
@@ -203,14 +319,34 @@ class PyMemoryPool {
   PyMemoryPool(MemoryPoolInterface* impl) : impl_(impl) {}
   ~PyMemoryPool() = default;
 
-  PyCpuBuffer getBufferFromPool(const std::string& id, size_t nrBytes) {
-    return PyCpuBuffer(impl_->getBufferFromPool(id, nrBytes), nrBytes);
+  PyCpuBuffer getBufferFromPool(StreamHandle handle, size_t nrBytes) {
+    return PyCpuBuffer(impl_->getBufferFromPool(handle, nrBytes), nrBytes);
   }
 
   PyGpuBuffer getGpuBufferFromPool(size_t nrBytes, bool deviceLocal) {
     return PyGpuBuffer(impl_->getGpuBufferFromPool(nrBytes, deviceLocal), nrBytes);
   }
 
+  size_t warmPool(const std::string& id, size_t nrBytes, size_t count) {
+    return impl_->warmPool(id, nrBytes, count);
+  }
+
+  void setSharedMemoryPolicy(const std::string& id, SharedMemoryPolicy policy) {
+    impl_->setSharedMemoryPolicy(id, policy);
+  }
+
+  void setStreamNumaNode(const std::string& id, int node) {
+    impl_->setStreamNumaNode(id, node);
+  }
+
+  bool lockMemory() {
+    return impl_->lockMemory();
+  }
+
+  MemoryPoolStats stats() const {
+    return impl_->stats();
+  }
+
  private:
   MemoryPoolInterface* impl_;
 };
@@ -218,6 +354,7 @@ class PyMemoryPool {
 class PyStreamConsumer;
 class PyStreamProducer;
 class PyAligner;
+class PyPolicyAligner;
 
 class PyStreamInterface {
  public:
@@ -228,12 +365,22 @@ class PyStreamInterface {
     return impl_->description();
   }
 
+  size_t numConsumers() const {
+    return impl_->numConsumers();
+  }
+
+  uint64_t deadlineMisses() const {
+    return impl_->deadlineMisses();
+  }
+
  private:
   StreamInterface* impl_;
 
   friend class PyStreamConsumer;
+  friend class PyEventScheduler;
   friend class PyStreamProducer;
   friend class PyAligner;
+  friend class PyPolicyAligner;
 };
 
 class PyStreamConfig {
@@ -252,6 +399,7 @@ class PyStreamConfig {
   }
   void setNominalSampleRate(const double& value) {
     config_.nominalSampleRate = value;
+    config_.contentHash = 0;
   }
 
   const uint32_t& getSampleSizeInBytes() {
@@ -259,6 +407,7 @@ class PyStreamConfig {
   }
   void setSampleSizeInBytes(const uint32_t& value) {
     config_.sampleSizeInBytes = value;
+    config_.contentHash = 0;
   }
 
   PyCpuBuffer getParameters() {
@@ -267,6 +416,11 @@ class PyStreamConfig {
   void setParameters(const PyCpuBuffer& value) {
     size_ = value.size();
     config_.parameters = value.dataRef();
+    config_.contentHash = 0;
+  }
+
+  const uint64_t& getContentHash() {
+    return config_.contentHash;
   }
 
   const StreamConfig& getConfig() const {
@@ -408,7 +562,9 @@ class PyStreamSample {
   size_t payloadSize_ = 0;
   size_t parameterSize_ = 0;
 
+  friend class PyEventScheduler;
   friend class PyStreamProducer;
+  friend class PyPolicyAligner;
 };
 
 using PySampleCallback = std::function<void(const PyStreamSample&)>;
@@ -420,7 +576,8 @@ class PyStreamConsumer {
       const PyStreamInterface& si,
       const PySampleCallback& sampleCb,
       const PyConfigCallback& configCb,
-      bool async) {
+      bool async,
+      const ConsumerScheduling& scheduling = ConsumerScheduling()) {
     pybind11::gil_scoped_release unlock;
 
     auto typeInfo =
@@ -460,7 +617,8 @@ class PyStreamConsumer {
                          return configCb(pyconfig);
                        })
                  : nullptr,
-        async);
+        async,
+        scheduling);
   }
 
   void close() {
@@ -540,6 +698,279 @@ class PyStreamProducer {
   PyStreamConfig config_;
 };
 
+#ifndef _WIN32
+class PyBridgeSender {
+ public:
+  PyBridgeSender(const std::string& host, uint16_t port, const BridgeOptions& options) {
+    pybind11::gil_scoped_release unlock;
+    sender_ = std::make_unique<BridgeSender>(host, port, options);
+  }
+
+  bool mirror(const std::string& id) {
+    if (isClosed())
+      throw std::runtime_error("BridgeSender is closed");
+
+    pybind11::gil_scoped_release unlock;
+    return sender_->mirror(id);
+  }
+
+  bool connected() const {
+    return !isClosed() && sender_->connected();
+  }
+
+  uint64_t samplesSent() const {
+    return isClosed() ? 0 : sender_->samplesSent();
+  }
+
+  uint64_t samplesDropped() const {
+    return isClosed() ? 0 : sender_->samplesDropped();
+  }
+
+  uint64_t sampleBytesSent() const {
+    return isClosed() ? 0 : sender_->sampleBytesSent();
+  }
+
+  void close() {
+    pybind11::gil_scoped_release release;
+    sender_.reset();
+  }
+
+  bool isClosed() const {
+    return nullptr == sender_;
+  }
+
+  ~PyBridgeSender() {
+    close();
+  }
+
+ private:
+  std::unique_ptr<BridgeSender> sender_;
+};
+
+class PyBridgeReceiver {
+ public:
+  PyBridgeReceiver(uint16_t port, const std::string& address, const BridgeOptions& options) {
+    pybind11::gil_scoped_release unlock;
+    receiver_ = std::make_unique<BridgeReceiver>(port, address, options);
+  }
+
+  uint16_t port() const {
+    return isClosed() ? 0 : receiver_->port();
+  }
+
+  void remap(const std::string& remote, const std::string& local) {
+    if (isClosed())
+      throw std::runtime_error("BridgeReceiver is closed");
+
+    receiver_->remap(remote, local);
+  }
+
+  uint64_t samplesReceived() const {
+    return isClosed() ? 0 : receiver_->samplesReceived();
+  }
+
+  // The receiver thread may be delivering to Python consumers, which need the GIL
+  void close() {
+    pybind11::gil_scoped_release release;
+    receiver_.reset();
+  }
+
+  bool isClosed() const {
+    return nullptr == receiver_;
+  }
+
+  ~PyBridgeReceiver() {
+    close();
+  }
+
+ private:
+  std::unique_ptr<BridgeReceiver> receiver_;
+};
+#endif
+
+#ifdef __linux__
+// Framers run on the ingest thread, so Python sources publish each datagram as one content block
+// rather than calling back into Python
+class PyIngestSource {
+ public:
+  PyIngestSource(
+      const std::string& id,
+      const std::string& address,
+      uint16_t port,
+      size_t subSampleBytes,
+      const IngestOptions& options) {
+    pybind11::gil_scoped_release unlock;
+    source_ = IngestSource::udp(
+        id, address, port, IngestSource::contentBlockFramer(subSampleBytes), options);
+  }
+
+  void configureStream(const PyStreamConfig& config) {
+    if (isClosed())
+      throw std::runtime_error("IngestSource is closed");
+
+    pybind11::gil_scoped_release unlock;
+    source_->configureStream(config.getConfig());
+  }
+
+  void start() {
+    if (isClosed())
+      throw std::runtime_error("IngestSource is closed");
+
+    source_->start();
+  }
+
+  uint16_t port() const {
+    return isClosed() ? 0 : source_->port();
+  }
+
+  IngestStats stats() const {
+    return isClosed() ? IngestStats() : source_->stats();
+  }
+
+  // The ingest thread may be delivering to Python consumers, which need the GIL
+  void close() {
+    pybind11::gil_scoped_release release;
+    source_.reset();
+  }
+
+  bool isClosed() const {
+    return nullptr == source_;
+  }
+
+  ~PyIngestSource() {
+    close();
+  }
+
+ private:
+  std::unique_ptr<IngestSource> source_;
+};
+#endif
+
+// A schedule entry: seconds after the start of the schedule, the stream and the sample
+using PyScheduledEvent = std::tuple<double, PyStreamInterface, PyStreamSample>;
+
+class PyEventScheduler {
+ public:
+  PyEventScheduler(
+      const std::vector<PyScheduledEvent>& events,
+      const EventSchedulerOptions& options) {
+    std::vector<ScheduledEvent> scheduled;
+    scheduled.reserve(events.size());
+    for (const auto& [offset, si, sample] : events) {
+      ScheduledEvent event;
+      event.offset = offset;
+      event.streamID = si.impl_->description().id();
+      event.sample = sample.sample_;
+      // Determine the number of subsamples from the payload size, like PyStreamProducer
+      event.sample.numberOfSubSamples =
+          sample.payloadSize_ / si.impl_->config().sampleSizeInBytes;
+      scheduled.push_back(std::move(event));
+    }
+    pybind11::gil_scoped_release unlock;
+    scheduler_ = std::make_unique<EventScheduler>(std::move(scheduled), options);
+  }
+
+  void start(double startTime) {
+    if (isClosed())
+      throw std::runtime_error("EventScheduler is closed");
+
+    scheduler_->start(startTime);
+  }
+
+  bool finished() const {
+    return isClosed() || scheduler_->finished();
+  }
+
+  size_t published() const {
+    return isClosed() ? 0 : scheduler_->published();
+  }
+
+  LatenessHistogram lateness(const std::optional<std::string>& id) const {
+    if (isClosed()) {
+      return LatenessHistogram();
+    }
+    return id ? scheduler_->lateness(*id) : scheduler_->lateness();
+  }
+
+  void close() {
+    pybind11::gil_scoped_release release;
+    scheduler_.reset();
+  }
+
+  bool isClosed() const {
+    return nullptr == scheduler_;
+  }
+
+  ~PyEventScheduler() {
+    close();
+  }
+
+ private:
+  std::unique_ptr<EventScheduler> scheduler_;
+};
+
+// Encodes and decodes bytes-like objects with a content block codec, without the GIL
+class PyCodec {
+ public:
+  static PyCodec lz4() {
+    return PyCodec(std::make_shared<Lz4Codec>());
+  }
+
+  static PyCodec deltaBitPack(size_t elementBytes, size_t stride) {
+    return PyCodec(std::make_shared<DeltaBitPackCodec>(elementBytes, stride));
+  }
+
+  CodecType type() const {
+    return codec_->type();
+  }
+
+  pybind11::bytes encode(const pybind11::buffer& data) const {
+    const pybind11::buffer_info info = contiguous(data);
+    std::vector<uint8_t> out;
+    {
+      pybind11::gil_scoped_release unlock;
+      codec_->encode(static_cast<const uint8_t*>(info.ptr), info.size * info.itemsize, out);
+    }
+    return pybind11::bytes(reinterpret_cast<const char*>(out.data()), out.size());
+  }
+
+  // Returns None if the encoding is malformed or doesn't decode to decodedSize bytes
+  std::optional<pybind11::bytes> decode(const pybind11::buffer& data, size_t decodedSize) const {
+    const pybind11::buffer_info info = contiguous(data);
+    const size_t size = info.size * info.itemsize;
+    if (decodedSize > codec_->maxDecodedSize(size)) {
+      return std::nullopt;
+    }
+    std::vector<uint8_t> out(decodedSize);
+    bool decoded;
+    {
+      pybind11::gil_scoped_release unlock;
+      decoded = codec_->decode(static_cast<const uint8_t*>(info.ptr), size, out.data(), decodedSize);
+    }
+    if (!decoded) {
+      return std::nullopt;
+    }
+    return pybind11::bytes(reinterpret_cast<const char*>(out.data()), out.size());
+  }
+
+ private:
+  explicit PyCodec(std::shared_ptr<const Codec> codec) : codec_(std::move(codec)) {}
+
+  static pybind11::buffer_info contiguous(const pybind11::buffer& data) {
+    pybind11::buffer_info info = data.request();
+    ssize_t stride = info.itemsize;
+    for (ssize_t dim = info.ndim - 1; dim >= 0; --dim) {
+      if (info.shape[dim] > 1 && info.strides[dim] != stride) {
+        throw pybind11::value_error("Codecs take contiguous buffers");
+      }
+      stride *= info.shape[dim];
+    }
+    return info;
+  }
+
+  std::shared_ptr<const Codec> codec_;
+};
+
 class PyStreamRegistry {
  public:
   PyStreamRegistry(StreamRegistryInterface* impl) : impl_(impl) {}
@@ -583,6 +1014,60 @@ class PyClockManager {
   ClockManagerInterface* impl_;
 };
 
+// A read-only view over one of the sample queues of a PyAligner. Samples are only wrapped when
+// they are accessed, sharing their buffers with the queue. A view is only valid during the align
+// callback it was passed to.
+class PyAlignerQueue {
+ public:
+  PyAlignerQueue(
+      const std::string& id,
+      const AlignerSampleQueue* samples,
+      const std::deque<std::pair<uint32_t, StreamConfig>>* configs,
+      size_t parameterSize)
+      : id_(id), samples_(samples), configs_(configs), parameterSize_(parameterSize) {}
+
+  const std::string& id() const {
+    return id_;
+  }
+
+  size_t size() const {
+    return samples_->size();
+  }
+
+  double timestamp(size_t index) const {
+    return at(index).metadata->header.timestamp;
+  }
+
+  uint32_t sequenceNumber(size_t index) const {
+    return at(index).metadata->header.sequenceNumber;
+  }
+
+  PyStreamSample sample(size_t index) const {
+    const StreamSample& sample = at(index);
+    const size_t sampleSizeInBytes =
+        configs_->empty() ? 0 : configs_->front().second.sampleSizeInBytes;
+    return PyStreamSample(sample, sample.numberOfSubSamples * sampleSizeInBytes, parameterSize_);
+  }
+
+ private:
+  const StreamSample& at(size_t index) const {
+    if (index >= samples_->size()) {
+      throw pybind11::index_error("Aligner queue index out of range");
+    }
+    return (*samples_)[index];
+  }
+
+  std::string id_;
+  const AlignerSampleQueue* samples_;
+  const std::deque<std::pair<uint32_t, StreamConfig>>* configs_;
+  size_t parameterSize_;
+};
+
+// Returns the index of the sample to align from each queue, or nothing if there is no aligned set.
+// The aligned samples are removed from their queues along with the samples queued before them.
+using PyAlignCallback =
+    std::function<std::optional<std::vector<size_t>>(const std::vector<PyAlignerQueue>& queues)>;
+
 class PyAligner : public Aligner {
  public:
   PyAligner(
@@ -593,12 +1078,25 @@ class PyAligner : public Aligner {
   virtual ~PyAligner() = default;
 
   void pyRegisterConsumer(const PyStreamInterface& si, int index) {
+    if (index < 0) {
+      throw pybind11::index_error("Aligner consumer index must not be negative");
+    }
     registerConsumer(si.impl_, index);
+    const size_t slot = static_cast<size_t>(index);
+    if (parameterSizes_.size() <= slot) {
+      parameterSizes_.resize(slot + 1);
+    }
+    parameterSizes_[slot] = Framework::instance()
+                                .typeRegistry()
+                                ->findTypeID(si.impl_->description().type())
+                                ->sampleParameterSize();
   }
 
-  void setAlignCallback(const std::function<bool(
-                            const std::map<std::string, std::queue<StreamSample>>& queues,
-                            std::vector<StreamSample>& samples)>& alignCallback) {
+  // The callback is only invoked when a sample has been queued since its last invocation.
+  // Callbacks written for the previous signature, which received a map of copied queues and
+  // appended the aligned samples to a list, must return the index to align from each queue
+  // instead. Python callables can't be overloaded on their signature, so there is no shim.
+  void setAlignCallback(const PyAlignCallback& alignCallback) {
     alignCallback_ = alignCallback;
   }
 
@@ -606,6 +1104,7 @@ class PyAligner : public Aligner {
     // Just execute the standard behavior if we haven't been given a callback
     if (!alignCallback_) {
       Aligner::align();
+      return;
     }
 
     if (!finalized_) {
@@ -615,15 +1114,49 @@ class PyAligner : public Aligner {
     samples.reserve(queues_.size());
     {
       std::lock_guard<std::mutex> lock(queueMutex_);
-
-      std::map<std::string, std::queue<StreamSample>> queues;
-      for (const auto& queue : queues_) {
-        queues[queue.id] = queue.samples;
+      if (queueVersion_ == alignedVersion_) {
+        return;
+      }
+      alignedVersion_ = queueVersion_;
+
+      // The queues can't be resized once we're finalized, so the views only need to be made once
+      if (views_.size() != queues_.size()) {
+        views_.clear();
+        views_.reserve(queues_.size());
+        for (size_t i = 0; i < queues_.size(); i++) {
+          views_.emplace_back(
+              queues_[i].id,
+              &queues_[i].samples,
+              &queues_[i].configs,
+              i < parameterSizes_.size() ? parameterSizes_[i] : 0);
+        }
       }
 
-      if (!alignCallback_(queues, samples)) {
+      const auto indices = alignCallback_(views_);
+      if (!indices) {
         return;
       }
+      if (indices->size() != queues_.size()) {
+        XR_LOGCW(
+            "Cthulhu",
+            "Align callback returned {} indices for {} queues",
+            indices->size(),
+            queues_.size());
+        return;
+      }
+      for (size_t i = 0; i < queues_.size(); i++) {
+        if ((*indices)[i] >= queues_[i].samples.size()) {
+          XR_LOGCW("Cthulhu", "Align callback returned an out of range index for queue {}", i);
+          return;
+        }
+        samples.push_back(queues_[i].samples[(*indices)[i]]);
+      }
+      // The aligned samples and the ones queued before them are consumed, so they aren't aligned
+      // again on the next tick
+      for (size_t i = 0; i < queues_.size(); i++) {
+        auto& queue = queues_[i].samples;
+        queue.erase(queue.begin(), queue.begin() + (*indices)[i] + 1);
+      }
 
       // Check to see if this set of samples should have a new config
       checkConfig(samples);
@@ -633,10 +1166,68 @@ class PyAligner : public Aligner {
   }
 
  private:
-  std::function<bool(
-      const std::map<std::string, std::queue<StreamSample>>& queues,
-      std::vector<StreamSample>& samples)>
-      alignCallback_;
+  PyAlignCallback alignCallback_;
+  std::vector<PyAlignerQueue> views_;
+  std::vector<size_t> parameterSizes_;
+  uint64_t alignedVersion_ = 0;
+};
+
+// Returns the sample of stream idx at a weight in [0, 1] between the samples before and after it
+using PyAlignerInterpolator = std::function<PyStreamSample(
+    size_t idx,
+    const PyStreamSample& before,
+    const PyStreamSample& after,
+    double weight)>;
+
+// A native PolicyAligner that can be registered on streams from Python, for the common cases that
+// would otherwise need a custom align callback
+class PyPolicyAligner : public PolicyAligner {
+ public:
+  PyPolicyAligner(
+      AlignPolicy policy,
+      size_t queueSize = 10,
+      ThreadPolicy threadPolicy = ThreadPolicy::THREAD_NEUTRAL)
+      : PolicyAligner(policy, queueSize, threadPolicy){};
+  virtual ~PyPolicyAligner() = default;
+
+  void pyRegisterConsumer(const PyStreamInterface& si, int index) {
+    if (index < 0) {
+      throw pybind11::index_error("Aligner consumer index must not be negative");
+    }
+    registerConsumer(si.impl_, index);
+    const size_t slot = static_cast<size_t>(index);
+    if (parameterSizes_.size() <= slot) {
+      parameterSizes_.resize(slot + 1);
+    }
+    parameterSizes_[slot] = Framework::instance()
+                                .typeRegistry()
+                                ->findTypeID(si.impl_->description().type())
+                                ->sampleParameterSize();
+  }
+
+  // The interpolator is called with the aligner's queues locked, so it must not block on them
+  void setInterpolator(const PyAlignerInterpolator& interpolator) {
+    PolicyAligner::setInterpolator(
+        [this, interpolator](
+            size_t idx,
+            const StreamSample& before,
+            const StreamSample& after,
+            double weight) -> StreamSample {
+          return interpolator(idx, pySample(idx, before), pySample(idx, after), weight).sample_;
+        });
+  }
+
+ private:
+  PyStreamSample pySample(size_t idx, const StreamSample& sample) const {
+    const auto& configs = queues_[idx].configs;
+    const size_t sampleSizeInBytes = configs.empty() ? 0 : configs.front().second.sampleSizeInBytes;
+    return PyStreamSample(
+        sample,
+        sample.numberOfSubSamples * sampleSizeInBytes,
+        idx < parameterSizes_.size() ? parameterSizes_[idx] : 0);
+  }
+
+  std::vector<size_t> parameterSizes_;
 };
 
 class PyImageBuffer {
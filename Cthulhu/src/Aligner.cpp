@@ -2,6 +2,9 @@
 
 #include <cthulhu/Aligner.h>
 
+#include <cthulhu/Numa.h>
+#include <cthulhu/Tracing.h>
+
 #define DEFAULT_LOG_CHANNEL "Cthulhu"
 #include <logging/Log.h>
 
@@ -13,6 +16,7 @@ void AlignerBase::initThread() {
   if (policy_ == ThreadPolicy::SINGLE_THREADED && !thread_is_alive_) {
     thread_ = std::thread(
         [this](std::future<void> signal) -> void {
+          Numa::applyThreadPlacement(ThreadRole::ALIGNER);
           while (signal.wait_for(std::chrono::milliseconds(1)) == std::future_status::timeout) {
             this->align();
           }
@@ -34,6 +38,7 @@ void AlignerBase::killThread() {
 }
 
 AlignerBase::~AlignerBase() {
+  Watchdog::instance().unwatch(this);
   killThread();
 }
 
@@ -53,10 +58,16 @@ void AlignerBase::setConfigsMetaCallback(const AlignerConfigsMetaCallback& cmcal
   cmcallback_ = cmcallback;
 }
 
+void AlignerBase::setWatchdogBudget(const std::string& name, const WatchdogBudget& budget) {
+  Watchdog::instance().watch(this, WatchdogSubject::ALIGNER, name, &heartbeat_, budget);
+}
+
 void AlignerBase::alignedCallback(const std::vector<StreamSample>& samples) {
+  heartbeat_.begin();
   if (callback_) {
     callback_(samples);
   }
+  heartbeat_.end(true);
 }
 
 bool AlignerBase::alignedConfigCallback(const std::vector<StreamConfig>& configs) {
@@ -133,6 +144,7 @@ void Aligner::registerConsumer(StreamInterface* si, int index) {
   ConfigCallback ccallback = [this, index](const StreamConfig& config) -> bool {
     return configCallback(index, config);
   };
+  queues_[index].samples.set_capacity(queueSize_);
   queues_[index].id = si->description().id();
   queues_[index].consumer = std::make_unique<StreamConsumer>(si, callback, ccallback);
 }
@@ -171,30 +183,37 @@ void Aligner::checkConfig(const std::vector<StreamSample>& samples) {
 
 void Aligner::execute(const std::vector<StreamSample>& samples) {
   if (!inhibitSampleCallback_) {
-    // Produce aligned metadata
-    AlignerSamplesMeta meta(samples.size());
-    for (size_t i = 0; i < samples.size(); i++) {
-      meta[i].timestamp = samples[i].metadata->header.timestamp;
-      meta[i].references.resize(1);
-      meta[i].references[0].sequenceNumber = samples[i].metadata->header.sequenceNumber;
-      meta[i].references[0].subSampleOffset = 0;
-      meta[i].references[0].numSubSamples = samples[i].numberOfSubSamples;
+    if (Tracer::enabled()) {
+      for (size_t i = 0; i < samples.size() && i < queues_.size(); i++) {
+        Tracer::record(queues_[i].id, samples[i], TracePhase::ALIGN);
+      }
+    }
+
+    // Produce aligned metadata, which nothing needs unless it is listened for
+    if (smcallback_) {
+      AlignerSamplesMeta meta(samples.size());
+      for (size_t i = 0; i < samples.size(); i++) {
+        meta[i].timestamp = samples[i].metadata->header.timestamp;
+        meta[i].references.resize(1);
+        meta[i].references[0].sequenceNumber = samples[i].metadata->header.sequenceNumber;
+        meta[i].references[0].subSampleOffset = 0;
+        meta[i].references[0].numSubSamples = samples[i].numberOfSubSamples;
+      }
+      alignedSamplesMetaCallback(meta);
     }
-    alignedSamplesMetaCallback(meta);
 
     alignedCallback(samples);
   }
 }
 
 void Aligner::sampleCallback(size_t idx, const StreamSample& sample) {
+  heartbeat_.arrive();
   {
     std::lock_guard<std::mutex> lock(queueMutex_);
     queues_[idx].latestSequence = sample.metadata->header.sequenceNumber;
-    queues_[idx].samples.push(sample);
-
-    if (queues_[idx].samples.size() > queueSize_) {
-      queues_[idx].samples.pop();
-    }
+    // A full queue drops its oldest sample
+    queues_[idx].samples.push_back(sample);
+    ++queueVersion_;
   }
   if (policy_ == ThreadPolicy::THREAD_NEUTRAL) {
     align();
@@ -205,8 +224,10 @@ void Aligner::align() {
   if (!finalized_) {
     return;
   }
+  // The aligned samples are kept per thread, so that aligning on several publishing threads doesn't
+  // race and aligning doesn't allocate. The scratch is only taken once a set is aligned.
+  thread_local std::vector<StreamSample> scratch;
   std::vector<StreamSample> samples;
-  samples.reserve(queues_.size());
   {
     std::lock_guard<std::mutex> lock(queueMutex_);
     const StreamSample* refSample = nullptr;
@@ -230,9 +251,10 @@ void Aligner::align() {
       return;
     }
 
+    samples = std::move(scratch);
     for (auto& queue : queues_) {
       samples.push_back(queue.samples.front());
-      queue.samples.pop();
+      queue.samples.pop_front();
     }
 
     // Check to see if this set of samples should have a new config
@@ -240,6 +262,8 @@ void Aligner::align() {
   }
 
   execute(samples);
+  samples.clear();
+  scratch = std::move(samples);
 }
 
 bool Aligner::configCallback(size_t idx, const StreamConfig& config) {
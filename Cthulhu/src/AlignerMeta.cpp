@@ -1,9 +1,91 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
 
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
 #include <cthulhu/AlignerMeta.h>
+#include <cthulhu/Framework.h>
+
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
 
 namespace cthulhu {
 
+namespace {
+
+// Fixed parts of the binary encoding
+constexpr size_t SAMPLES_HEADER_BYTES = 2 * sizeof(uint32_t);
+constexpr size_t SAMPLE_BYTES = 2 * sizeof(double) + 2 * sizeof(uint32_t);
+constexpr size_t REFERENCE_BYTES = sizeof(double) + 4 * sizeof(uint32_t);
+
+template <typename T>
+void put(uint8_t*& output, const T& value) {
+  std::memcpy(output, &value, sizeof(T));
+  output += sizeof(T);
+}
+
+template <typename T>
+bool get(const uint8_t* data, size_t length, size_t& offset, T& value) {
+  if (length - offset < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, data + offset, sizeof(T));
+  offset += sizeof(T);
+  return true;
+}
+
+// Checked readers of the format of serialize(), for converting logs
+bool decodeLegacy(const uint8_t* data, size_t length, size_t& offset, AlignerConfigsMeta& output) {
+  uint32_t size;
+  if (!get(data, length, offset, size)) {
+    return false;
+  }
+  output.clear();
+  for (uint32_t in = 0; in < size; ++in) {
+    uint8_t idLength;
+    if (!get(data, length, offset, idLength) || length - offset < idLength) {
+      return false;
+    }
+    AlignerStreamMeta meta;
+    meta.streamID.assign(reinterpret_cast<const char*>(data + offset), idLength);
+    offset += idLength;
+    if (!get(data, length, offset, meta.subSampleSize)) {
+      return false;
+    }
+    output.push_back(std::move(meta));
+  }
+  return true;
+}
+
+bool decodeLegacy(const uint8_t* data, size_t length, size_t& offset, AlignerSamplesMeta& output) {
+  uint32_t size;
+  if (!get(data, length, offset, size)) {
+    return false;
+  }
+  output.clear();
+  for (uint32_t in = 0; in < size; ++in) {
+    AlignerSampleMeta meta{0.0, 0.0, {}};
+    uint32_t refs;
+    if (!get(data, length, offset, meta.timestamp) || !get(data, length, offset, refs) ||
+        refs > (length - offset) / (3 * sizeof(uint32_t))) {
+      return false;
+    }
+    meta.references.resize(refs);
+    for (auto& ref : meta.references) {
+      ref.timestamp = 0.0;
+      get(data, length, offset, ref.sequenceNumber);
+      get(data, length, offset, ref.subSampleOffset);
+      get(data, length, offset, ref.numSubSamples);
+    }
+    output.push_back(std::move(meta));
+  }
+  return true;
+}
+
+} // namespace
+
 void serialize(const AlignerConfigsMeta& input, std::ostringstream& output) {
   uint32_t size = input.size();
   output.write((char*)&size, sizeof(uint32_t));
@@ -60,4 +142,223 @@ void deserialize(std::istringstream& input, AlignerSamplesMeta& output) {
   }
 }
 
+size_t encodedSize(const AlignerConfigsMeta& input) {
+  size_t size = sizeof(uint32_t);
+  for (const auto& in : input) {
+    size += sizeof(uint16_t) + in.streamID.length() + sizeof(uint32_t);
+  }
+  return size;
+}
+
+size_t encodedSize(const AlignerSamplesMeta& input) {
+  size_t size = SAMPLES_HEADER_BYTES;
+  for (const auto& in : input) {
+    size += SAMPLE_BYTES + in.references.size() * REFERENCE_BYTES;
+  }
+  return size;
+}
+
+size_t encode(const AlignerConfigsMeta& input, uint8_t* output, size_t capacity) {
+  const size_t size = encodedSize(input);
+  if (capacity < size) {
+    return 0;
+  }
+  put<uint32_t>(output, input.size());
+  for (const auto& in : input) {
+    put<uint16_t>(output, in.streamID.length());
+    std::memcpy(output, in.streamID.data(), in.streamID.length());
+    output += in.streamID.length();
+    put(output, in.subSampleSize);
+  }
+  return size;
+}
+
+size_t encode(const AlignerSamplesMeta& input, uint8_t* output, size_t capacity) {
+  const size_t size = encodedSize(input);
+  if (capacity < size) {
+    return 0;
+  }
+  put<uint32_t>(output, input.size());
+  put<uint32_t>(output, 0);
+  for (const auto& in : input) {
+    put(output, in.timestamp);
+    put(output, in.duration);
+    put<uint32_t>(output, in.references.size());
+    put<uint32_t>(output, 0);
+    for (const auto& ref : in.references) {
+      put(output, ref.timestamp);
+      put(output, ref.sequenceNumber);
+      put(output, ref.subSampleOffset);
+      put(output, ref.numSubSamples);
+      put<uint32_t>(output, 0);
+    }
+  }
+  return size;
+}
+
+void encode(const AlignerConfigsMeta& input, std::vector<uint8_t>& output) {
+  const size_t offset = output.size();
+  const size_t size = encodedSize(input);
+  output.resize(offset + size);
+  encode(input, output.data() + offset, size);
+}
+
+void encode(const AlignerSamplesMeta& input, std::vector<uint8_t>& output) {
+  const size_t offset = output.size();
+  const size_t size = encodedSize(input);
+  output.resize(offset + size);
+  encode(input, output.data() + offset, size);
+}
+
+CpuBuffer encode(const AlignerSamplesMeta& input, StreamHandle poolHandle) {
+  const size_t size = encodedSize(input);
+  CpuBuffer buffer = Framework::instance().memoryPool()->getBufferFromPool(poolHandle, size);
+  encode(input, buffer.get(), size);
+  return buffer;
+}
+
+size_t decode(const uint8_t* data, size_t length, AlignerConfigsMeta& output) {
+  size_t offset = 0;
+  uint32_t size;
+  if (!get(data, length, offset, size)) {
+    return 0;
+  }
+  output.clear();
+  for (uint32_t in = 0; in < size; ++in) {
+    uint16_t idLength;
+    if (!get(data, length, offset, idLength) || length - offset < idLength) {
+      return 0;
+    }
+    AlignerStreamMeta meta;
+    meta.streamID.assign(reinterpret_cast<const char*>(data + offset), idLength);
+    offset += idLength;
+    if (!get(data, length, offset, meta.subSampleSize)) {
+      return 0;
+    }
+    output.push_back(std::move(meta));
+  }
+  return offset;
+}
+
+size_t decode(const uint8_t* data, size_t length, AlignerSamplesMeta& output) {
+  size_t offset = 0;
+  uint32_t size;
+  uint32_t reserved;
+  if (!get(data, length, offset, size) || !get(data, length, offset, reserved) ||
+      size > (length - offset) / SAMPLE_BYTES) {
+    return 0;
+  }
+  output.resize(size);
+  for (auto& out : output) {
+    uint32_t refs;
+    if (!get(data, length, offset, out.timestamp) || !get(data, length, offset, out.duration) ||
+        !get(data, length, offset, refs) || !get(data, length, offset, reserved) ||
+        refs > (length - offset) / REFERENCE_BYTES) {
+      return 0;
+    }
+    // The references were checked to fit
+    out.references.resize(refs);
+    for (auto& ref : out.references) {
+      get(data, length, offset, ref.timestamp);
+      get(data, length, offset, ref.sequenceNumber);
+      get(data, length, offset, ref.subSampleOffset);
+      get(data, length, offset, ref.numSubSamples);
+      get(data, length, offset, reserved);
+    }
+  }
+  return offset;
+}
+
+AlignerMetaWriter::AlignerMetaWriter(std::ostream& output) : output_(output) {
+  const alignermeta::FileHeader header{alignermeta::kFileMagic, alignermeta::kVersion, 0};
+  output_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void AlignerMetaWriter::write(const AlignerConfigsMeta& meta) {
+  buffer_.resize(sizeof(alignermeta::RecordHeader));
+  encode(meta, buffer_);
+  writeRecord(alignermeta::RecordKind::CONFIGS);
+}
+
+void AlignerMetaWriter::write(const AlignerSamplesMeta& meta) {
+  buffer_.resize(sizeof(alignermeta::RecordHeader));
+  encode(meta, buffer_);
+  writeRecord(alignermeta::RecordKind::SAMPLES);
+}
+
+void AlignerMetaWriter::writeRecord(alignermeta::RecordKind kind) {
+  const alignermeta::RecordHeader header{
+      kind, static_cast<uint32_t>(buffer_.size() - sizeof(alignermeta::RecordHeader))};
+  std::memcpy(buffer_.data(), &header, sizeof(header));
+  output_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+}
+
+AlignerMetaReader::AlignerMetaReader(std::istream& input) : input_(input) {
+  alignermeta::FileHeader header;
+  if (!input_.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      header.magic != alignermeta::kFileMagic) {
+    XR_LOGE("Input is not an aligner meta log");
+    throw std::runtime_error("Input is not an aligner meta log");
+  }
+  if (header.version != alignermeta::kVersion) {
+    XR_LOGE("Unsupported aligner meta log version {}", header.version);
+    throw std::runtime_error("Unsupported aligner meta log version");
+  }
+}
+
+std::optional<alignermeta::RecordKind> AlignerMetaReader::next(
+    AlignerConfigsMeta& configs,
+    AlignerSamplesMeta& samples) {
+  alignermeta::RecordHeader header;
+  input_.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (input_.gcount() == 0 && input_.eof()) {
+    return std::nullopt;
+  }
+  buffer_.resize(input_ ? header.bytes : 0);
+  if (!input_ || !input_.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size())) {
+    XR_LOGE("Aligner meta log is truncated");
+    throw std::runtime_error("Aligner meta log is truncated");
+  }
+  size_t decoded = 0;
+  switch (header.kind) {
+    case alignermeta::RecordKind::CONFIGS:
+      decoded = decode(buffer_.data(), buffer_.size(), configs);
+      break;
+    case alignermeta::RecordKind::SAMPLES:
+      decoded = decode(buffer_.data(), buffer_.size(), samples);
+      break;
+  }
+  if (decoded == 0 || decoded != buffer_.size()) {
+    XR_LOGE("Aligner meta log has a malformed record");
+    throw std::runtime_error("Aligner meta log has a malformed record");
+  }
+  return header.kind;
+}
+
+size_t convertAlignerMeta(std::istream& input, std::ostream& output, bool hasConfigs) {
+  const std::string legacy{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+  const auto* data = reinterpret_cast<const uint8_t*>(legacy.data());
+  size_t offset = 0;
+  AlignerMetaWriter writer(output);
+  if (hasConfigs) {
+    AlignerConfigsMeta configs;
+    if (!decodeLegacy(data, legacy.size(), offset, configs)) {
+      XR_LOGE("Aligner meta is truncated in its configs meta");
+      throw std::runtime_error("Aligner meta is truncated");
+    }
+    writer.write(configs);
+  }
+  size_t converted = 0;
+  AlignerSamplesMeta samples;
+  while (offset < legacy.size()) {
+    if (!decodeLegacy(data, legacy.size(), offset, samples)) {
+      XR_LOGE("Aligner meta is truncated after {} samples meta", converted);
+      throw std::runtime_error("Aligner meta is truncated");
+    }
+    writer.write(samples);
+    converted++;
+  }
+  return converted;
+}
+
 } // namespace cthulhu
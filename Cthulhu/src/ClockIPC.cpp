@@ -5,6 +5,8 @@
 #define DEFAULT_LOG_CHANNEL "Cthulhu"
 #include <logging/Log.h>
 
+#include <cthulhu/Numa.h>
+
 #include <boost/thread/thread_time.hpp>
 
 namespace cthulhu {
@@ -47,6 +49,7 @@ ControllableClockIPC::ControllableClockIPC(ClockIPCData* data)
     : ClockIPC(data, true), localControl_(false) {
   thread_ = std::thread(
       [this](std::future<void> signal) -> void {
+        Numa::applyThreadPlacement(ThreadRole::CLOCK);
         uint32_t latestEvent = 0;
         while (signal.wait_for(std::chrono::microseconds(0)) == std::future_status::timeout) {
           if (latestEvent < this->data_->signal_count) {
@@ -0,0 +1,704 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/Codec.h>
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+#include <cthulhu/Framework.h>
+#include <cthulhu/Serialization.h>
+#include <cthulhu/TypeHelpers.h>
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace cthulhu {
+
+namespace {
+
+// LZ4 block format, as specified in lz4_Block_format.md of the reference implementation
+const size_t LZ4_MIN_MATCH = 4;
+const size_t LZ4_LAST_LITERALS = 5;
+// Matches must start at least this far from the end of the block
+const size_t LZ4_MATCH_FIND_LIMIT = 12;
+const size_t LZ4_MAX_OFFSET = 65535;
+const int LZ4_HASH_BITS = 12;
+
+uint32_t read32(const uint8_t* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t lz4Hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+uint8_t* writeLength(uint8_t* op, size_t length) {
+  for (; length >= 255; length -= 255) {
+    *op++ = 255;
+  }
+  *op++ = static_cast<uint8_t>(length);
+  return op;
+}
+
+uint8_t* writeSequence(
+    uint8_t* op,
+    const uint8_t* literals,
+    size_t numLiterals,
+    size_t offset,
+    size_t matchLength) {
+  uint8_t* token = op++;
+  *token = static_cast<uint8_t>((std::min<size_t>(numLiterals, 15) << 4));
+  if (numLiterals >= 15) {
+    op = writeLength(op, numLiterals - 15);
+  }
+  std::memcpy(op, literals, numLiterals);
+  op += numLiterals;
+  if (matchLength == 0) {
+    // The last sequence has no match
+    return op;
+  }
+  const size_t matchCode = matchLength - LZ4_MIN_MATCH;
+  *token |= static_cast<uint8_t>(std::min<size_t>(matchCode, 15));
+  *op++ = static_cast<uint8_t>(offset & 0xff);
+  *op++ = static_cast<uint8_t>(offset >> 8);
+  if (matchCode >= 15) {
+    op = writeLength(op, matchCode - 15);
+  }
+  return op;
+}
+
+// Reads the extra bytes of a length whose 4 bits in the token were all set
+bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+  uint8_t byte;
+  do {
+    if (ip >= end) {
+      return false;
+    }
+    byte = *ip++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+// Delta bit-packing
+
+const size_t BITPACK_BLOCK = 128;
+
+template <typename U>
+U zigZag(U delta) {
+  using S = std::make_signed_t<U>;
+  const S value = static_cast<S>(delta);
+  return static_cast<U>(static_cast<U>(delta << 1) ^ static_cast<U>(value >> (8 * sizeof(U) - 1)));
+}
+
+template <typename U>
+U unZigZag(U value) {
+  return static_cast<U>((value >> 1) ^ static_cast<U>(-static_cast<U>(value & 1)));
+}
+
+template <typename U>
+U load(const uint8_t* data, size_t index) {
+  U value;
+  std::memcpy(&value, data + index * sizeof(U), sizeof(U));
+  return value;
+}
+
+// Writes the zig-zag encoded differences of count elements from the elements stride before them
+template <typename U>
+void deltaEncode(const uint8_t* data, size_t count, size_t stride, U* out) {
+  const size_t first = std::min(count, stride);
+  for (size_t i = 0; i < first; ++i) {
+    out[i] = zigZag(load<U>(data, i));
+  }
+  size_t i = first;
+#ifdef __SSE2__
+  if constexpr (sizeof(U) == 2 || sizeof(U) == 4) {
+    constexpr size_t lanes = 16 / sizeof(U);
+    for (; i + lanes <= count; i += lanes) {
+      const __m128i current =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * sizeof(U)));
+      const __m128i previous =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + (i - stride) * sizeof(U)));
+      __m128i encoded;
+      if constexpr (sizeof(U) == 2) {
+        const __m128i delta = _mm_sub_epi16(current, previous);
+        encoded = _mm_xor_si128(_mm_slli_epi16(delta, 1), _mm_srai_epi16(delta, 15));
+      } else {
+        const __m128i delta = _mm_sub_epi32(current, previous);
+        encoded = _mm_xor_si128(_mm_slli_epi32(delta, 1), _mm_srai_epi32(delta, 31));
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), encoded);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = zigZag(static_cast<U>(load<U>(data, i) - load<U>(data, i - stride)));
+  }
+}
+
+// Inverse of deltaEncode, in place of values
+template <typename U>
+void deltaDecode(U* values, size_t count, size_t stride, uint8_t* out) {
+  const size_t first = std::min(count, stride);
+  for (size_t i = 0; i < first; ++i) {
+    const U value = unZigZag(values[i]);
+    std::memcpy(out + i * sizeof(U), &value, sizeof(U));
+  }
+  size_t i = first;
+#ifdef __SSE2__
+  if constexpr (sizeof(U) == 2 || sizeof(U) == 4) {
+    constexpr size_t lanes = 16 / sizeof(U);
+    // The lanes of a vector must not depend on each other
+    if (stride >= lanes) {
+      for (; i + lanes <= count; i += lanes) {
+        const __m128i encoded = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        const __m128i previous =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + (i - stride) * sizeof(U)));
+        __m128i decoded;
+        if constexpr (sizeof(U) == 2) {
+          const __m128i sign =
+              _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(encoded, _mm_set1_epi16(1)));
+          decoded = _mm_add_epi16(_mm_xor_si128(_mm_srli_epi16(encoded, 1), sign), previous);
+        } else {
+          const __m128i sign =
+              _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(encoded, _mm_set1_epi32(1)));
+          decoded = _mm_add_epi32(_mm_xor_si128(_mm_srli_epi32(encoded, 1), sign), previous);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * sizeof(U)), decoded);
+      }
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    const U value = static_cast<U>(unZigZag(values[i]) + load<U>(out, i - stride));
+    std::memcpy(out + i * sizeof(U), &value, sizeof(U));
+  }
+}
+
+size_t packedBytes(size_t count, unsigned width) {
+  return (count * width + 7) / 8;
+}
+
+// Packs values at width bits each, least significant bits first
+template <typename U>
+uint8_t* pack(const U* values, size_t count, unsigned width, uint8_t* out) {
+  uint64_t bits = 0;
+  unsigned numBits = 0;
+  auto put = [&](uint64_t value, unsigned valueBits) {
+    bits |= value << numBits;
+    numBits += valueBits;
+    while (numBits >= 8) {
+      *out++ = static_cast<uint8_t>(bits);
+      bits >>= 8;
+      numBits -= 8;
+    }
+  };
+  for (size_t i = 0; i < count; ++i) {
+    const uint64_t value = values[i];
+    // Keeps the accumulator from overflowing
+    if (width > 32) {
+      put(value & 0xffffffffu, 32);
+      put(value >> 32, width - 32);
+    } else {
+      put(value, width);
+    }
+  }
+  if (numBits > 0) {
+    *out++ = static_cast<uint8_t>(bits);
+  }
+  return out;
+}
+
+template <typename U>
+void unpack(const uint8_t* in, size_t count, unsigned width, U* values) {
+  uint64_t bits = 0;
+  unsigned numBits = 0;
+  auto get = [&](unsigned valueBits) -> uint64_t {
+    while (numBits < valueBits) {
+      bits |= static_cast<uint64_t>(*in++) << numBits;
+      numBits += 8;
+    }
+    const uint64_t value = valueBits == 64 ? bits : bits & ((uint64_t(1) << valueBits) - 1);
+    bits = valueBits == 64 ? 0 : bits >> valueBits;
+    numBits -= valueBits;
+    return value;
+  };
+  for (size_t i = 0; i < count; ++i) {
+    if (width > 32) {
+      const uint64_t low = get(32);
+      values[i] = static_cast<U>(low | (get(width - 32) << 32));
+    } else {
+      values[i] = static_cast<U>(get(width));
+    }
+  }
+}
+
+template <typename U>
+void encodeBlocks(
+    const uint8_t* data,
+    size_t count,
+    size_t stride,
+    std::vector<uint8_t>& out) {
+  std::vector<U> deltas(count);
+  deltaEncode<U>(data, count, stride, deltas.data());
+  for (size_t first = 0; first < count; first += BITPACK_BLOCK) {
+    const size_t blockSize = std::min(BITPACK_BLOCK, count - first);
+    U combined = 0;
+    for (size_t i = first; i < first + blockSize; ++i) {
+      combined |= deltas[i];
+    }
+    unsigned width = 0;
+    for (uint64_t remaining = combined; remaining != 0; remaining >>= 1) {
+      ++width;
+    }
+    const size_t offset = out.size();
+    out.resize(offset + 1 + packedBytes(blockSize, width));
+    out[offset] = static_cast<uint8_t>(width);
+    pack(deltas.data() + first, blockSize, width, out.data() + offset + 1);
+  }
+}
+
+template <typename U>
+bool decodeBlocks(const uint8_t* in, size_t size, size_t count, size_t stride, uint8_t* out) {
+  std::vector<U> deltas(count);
+  size_t offset = 0;
+  for (size_t first = 0; first < count; first += BITPACK_BLOCK) {
+    const size_t blockSize = std::min(BITPACK_BLOCK, count - first);
+    if (offset >= size) {
+      return false;
+    }
+    const unsigned width = in[offset++];
+    if (width > 8 * sizeof(U) || offset + packedBytes(blockSize, width) > size) {
+      return false;
+    }
+    unpack(in + offset, blockSize, width, deltas.data() + first);
+    offset += packedBytes(blockSize, width);
+  }
+  if (offset != size) {
+    return false;
+  }
+  deltaDecode<U>(deltas.data(), count, stride, out);
+  return true;
+}
+
+bool isIntegerType(const std::string& typeName) {
+  static const std::vector<std::string> integerTypes = {
+      typeString<int8_t>(),
+      typeString<uint8_t>(),
+      typeString<int16_t>(),
+      typeString<uint16_t>(),
+      typeString<int32_t>(),
+      typeString<uint32_t>(),
+      typeString<int64_t>(),
+      typeString<uint64_t>(),
+  };
+  return std::find(integerTypes.begin(), integerTypes.end(), typeName) != integerTypes.end();
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& out, const T& value) {
+  const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool read(const uint8_t* data, size_t length, size_t& offset, T& value) {
+  if (offset + sizeof(T) > length) {
+    return false;
+  }
+  std::memcpy(&value, data + offset, sizeof(T));
+  offset += sizeof(T);
+  return true;
+}
+
+} // namespace
+
+void Lz4Codec::encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out) const {
+  const size_t start = out.size();
+  out.resize(start + size + size / 255 + 16);
+  uint8_t* op = out.data() + start;
+  size_t anchor = 0;
+
+  if (size > LZ4_MATCH_FIND_LIMIT) {
+    // Positions of recent sequences plus one, so that 0 means none
+    std::vector<uint32_t> table(size_t(1) << LZ4_HASH_BITS, 0);
+    const size_t matchLimit = size - LZ4_LAST_LITERALS;
+    const size_t searchLimit = size - LZ4_MATCH_FIND_LIMIT;
+    size_t position = 0;
+    unsigned misses = 0;
+    while (position < searchLimit) {
+      const uint32_t sequence = read32(data + position);
+      uint32_t& entry = table[lz4Hash(sequence)];
+      const size_t candidate = entry;
+      entry = static_cast<uint32_t>(position + 1);
+      if (candidate == 0 || position + 1 - candidate > LZ4_MAX_OFFSET ||
+          read32(data + candidate - 1) != sequence) {
+        // Skips ahead faster through data that doesn't compress
+        position += 1 + (misses++ >> 6);
+        continue;
+      }
+      misses = 0;
+      const size_t match = candidate - 1;
+      size_t length = LZ4_MIN_MATCH;
+      while (position + length < matchLimit && data[match + length] == data[position + length]) {
+        ++length;
+      }
+      op = writeSequence(op, data + anchor, position - anchor, position - match, length);
+      position += length;
+      anchor = position;
+    }
+  }
+
+  op = writeSequence(op, data + anchor, size - anchor, 0, 0);
+  out.resize(op - out.data());
+}
+
+bool Lz4Codec::decode(const uint8_t* data, size_t size, uint8_t* out, size_t decodedSize) const {
+  const uint8_t* ip = data;
+  const uint8_t* const end = data + size;
+  uint8_t* op = out;
+  uint8_t* const outEnd = out + decodedSize;
+  while (ip < end) {
+    const uint8_t token = *ip++;
+    size_t numLiterals = token >> 4;
+    if (numLiterals == 15 && !readLength(ip, end, numLiterals)) {
+      return false;
+    }
+    if (numLiterals > static_cast<size_t>(end - ip) ||
+        numLiterals > static_cast<size_t>(outEnd - op)) {
+      return false;
+    }
+    if (numLiterals > 0) {
+      std::memcpy(op, ip, numLiterals);
+      ip += numLiterals;
+      op += numLiterals;
+    }
+    if (ip == end) {
+      break;
+    }
+
+    if (end - ip < 2) {
+      return false;
+    }
+    const size_t offset = ip[0] | (size_t(ip[1]) << 8);
+    ip += 2;
+    size_t matchLength = token & 15;
+    if (matchLength == 15 && !readLength(ip, end, matchLength)) {
+      return false;
+    }
+    matchLength += LZ4_MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(op - out) ||
+        matchLength > static_cast<size_t>(outEnd - op)) {
+      return false;
+    }
+    const uint8_t* match = op - offset;
+    if (offset >= matchLength) {
+      std::memcpy(op, match, matchLength);
+      op += matchLength;
+    } else {
+      // Overlapping matches repeat the last offset bytes
+      for (size_t i = 0; i < matchLength; ++i) {
+        *op++ = match[i];
+      }
+    }
+  }
+  return op == outEnd;
+}
+
+size_t Lz4Codec::maxDecodedSize(size_t size) const {
+  // A byte of match length extends a match by at most 255 bytes
+  return size * 255 + 16;
+}
+
+DeltaBitPackCodec::DeltaBitPackCodec(size_t elementBytes, size_t stride)
+    : elementBytes_(static_cast<uint8_t>(elementBytes)), stride_(static_cast<uint32_t>(stride)) {
+  if ((elementBytes != 1 && elementBytes != 2 && elementBytes != 4 && elementBytes != 8) ||
+      stride == 0) {
+    XR_LOGE("Invalid delta bit-packing of {} byte elements with stride {}", elementBytes, stride);
+    throw std::runtime_error("Invalid delta bit-packing parameters");
+  }
+}
+
+void DeltaBitPackCodec::encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+    const {
+  append(out, elementBytes_);
+  append(out, stride_);
+  // Bit-packed blocks of different element counts can take the same bytes, so the size is checked
+  // when decoding
+  append(out, static_cast<uint64_t>(size));
+  const size_t count = size / elementBytes_;
+  switch (elementBytes_) {
+    case 1:
+      encodeBlocks<uint8_t>(data, count, stride_, out);
+      break;
+    case 2:
+      encodeBlocks<uint16_t>(data, count, stride_, out);
+      break;
+    case 4:
+      encodeBlocks<uint32_t>(data, count, stride_, out);
+      break;
+    default:
+      encodeBlocks<uint64_t>(data, count, stride_, out);
+      break;
+  }
+  // Bytes that don't make up a whole element are kept as they are
+  out.insert(out.end(), data + count * elementBytes_, data + size);
+}
+
+bool DeltaBitPackCodec::decode(const uint8_t* data, size_t size, uint8_t* out, size_t decodedSize)
+    const {
+  uint8_t elementBytes;
+  uint32_t stride;
+  uint64_t encodedSize;
+  size_t offset = 0;
+  if (!read(data, size, offset, elementBytes) || !read(data, size, offset, stride) ||
+      !read(data, size, offset, encodedSize) || stride == 0 || encodedSize != decodedSize) {
+    return false;
+  }
+  if (elementBytes != 1 && elementBytes != 2 && elementBytes != 4 && elementBytes != 8) {
+    return false;
+  }
+  const size_t count = decodedSize / elementBytes;
+  const size_t tail = decodedSize - count * elementBytes;
+  if (size - offset < tail) {
+    return false;
+  }
+  const uint8_t* blocks = data + offset;
+  const size_t blockBytes = size - offset - tail;
+  bool success = false;
+  switch (elementBytes) {
+    case 1:
+      success = decodeBlocks<uint8_t>(blocks, blockBytes, count, stride, out);
+      break;
+    case 2:
+      success = decodeBlocks<uint16_t>(blocks, blockBytes, count, stride, out);
+      break;
+    case 4:
+      success = decodeBlocks<uint32_t>(blocks, blockBytes, count, stride, out);
+      break;
+    default:
+      success = decodeBlocks<uint64_t>(blocks, blockBytes, count, stride, out);
+      break;
+  }
+  if (success) {
+    std::memcpy(out + count * elementBytes, blocks + blockBytes, tail);
+  }
+  return success;
+}
+
+size_t DeltaBitPackCodec::maxDecodedSize(size_t size) const {
+  // A block of zero-width elements takes one byte
+  return size * BITPACK_BLOCK * sizeof(uint64_t) + sizeof(uint64_t);
+}
+
+std::shared_ptr<const Codec> selectCodec(
+    const TypeInfoInterface& typeInfo,
+    const StreamConfig& config) {
+  // Samples of basic types are serialized without their content block
+  if (typeInfo.isBasic() || !typeInfo.hasContentBlock()) {
+    return nullptr;
+  }
+  if (typeInfo.hasSamplesInContentBlock() && !typeInfo.sampleFields().empty()) {
+    size_t elementBytes = 0;
+    bool integers = true;
+    for (const auto& field : typeInfo.sampleFields()) {
+      if (field.second.isDynamic || field.second.numElements == 0 ||
+          !isIntegerType(field.second.typeName)) {
+        integers = false;
+        break;
+      }
+      const size_t fieldElementBytes = field.second.size / field.second.numElements;
+      if (elementBytes != 0 && fieldElementBytes != elementBytes) {
+        integers = false;
+        break;
+      }
+      elementBytes = fieldElementBytes;
+    }
+    if (integers && config.sampleSizeInBytes % elementBytes == 0) {
+      return std::make_shared<DeltaBitPackCodec>(
+          elementBytes, config.sampleSizeInBytes / elementBytes);
+    }
+  }
+  return std::make_shared<Lz4Codec>();
+}
+
+const Codec* decoderFor(CodecType type) {
+  static const Lz4Codec lz4;
+  static const DeltaBitPackCodec deltaBitPack;
+  switch (type) {
+    case CodecType::LZ4:
+      return &lz4;
+    case CodecType::DELTA_BITPACK:
+      return &deltaBitPack;
+    default:
+      return nullptr;
+  }
+}
+
+std::vector<uint8_t> encodeSample(
+    const std::string& typeName,
+    const StreamSample& sample,
+    const StreamConfig* const config,
+    const Codec& codec) {
+  std::vector<uint8_t> result;
+  auto typeInfo = Framework::instance().typeRegistry()->findTypeName(typeName);
+  if (!typeInfo) {
+    XR_LOGE("Couldn't encode sample, failed to find type in registry: {}", typeName);
+    return result;
+  }
+  if (!typeInfo->isBasic() && !config) {
+    XR_LOGE("Couldn't encode sample for non-basic type {} without a config", typeName);
+    return result;
+  }
+  const size_t paramSize = typeInfo->sampleParameterSize();
+  const size_t numDynFields = typeInfo->sampleNumberDynamicFields();
+  const size_t payloadSize =
+      !typeInfo->isBasic() ? size_t(config->sampleSizeInBytes) * sample.numberOfSubSamples : 0;
+
+  if (sample.parameters) {
+    result.insert(result.end(), sample.parameters.get(), sample.parameters.get() + paramSize);
+  } else {
+    result.resize(paramSize, 0);
+  }
+  for (size_t fieldIdx = 0; fieldIdx < numDynFields; ++fieldIdx) {
+    const auto& field = sample.dynamicParameters.get()[fieldIdx];
+    const uint32_t fieldSize = field.size();
+    append(result, fieldSize);
+    result.insert(result.end(), field.raw.get(), field.raw.get() + fieldSize);
+  }
+  append(result, sample.numberOfSubSamples);
+
+  const size_t sizeOffset = result.size();
+  append(result, uint32_t(0));
+  if (payloadSize > 0) {
+    if (sample.payload) {
+      codec.encode(((CpuBuffer)sample.payload).get(), payloadSize, result);
+    } else {
+      const std::vector<uint8_t> zeros(payloadSize, 0);
+      codec.encode(zeros.data(), payloadSize, result);
+    }
+  }
+  const uint32_t encodedSize = result.size() - sizeOffset - sizeof(uint32_t);
+  std::memcpy(result.data() + sizeOffset, &encodedSize, sizeof(uint32_t));
+
+  append(result, sample.metadata->header.timestamp);
+  append(result, sample.metadata->header.sequenceNumber);
+  return result;
+}
+
+bool decodeSample(
+    const std::string& typeName,
+    const uint8_t* data,
+    size_t length,
+    const StreamConfig* const config,
+    const Codec& codec,
+    StreamSample& sample,
+    StreamHandle poolHandle) {
+  auto typeInfo = Framework::instance().typeRegistry()->findTypeName(typeName);
+  if (!typeInfo || (!typeInfo->isBasic() && !config)) {
+    return false;
+  }
+  auto* memoryPool = Framework::instance().memoryPool();
+  const size_t paramSize = typeInfo->sampleParameterSize();
+  const size_t numDynFields = typeInfo->sampleNumberDynamicFields();
+
+  size_t offset = paramSize;
+  for (size_t fieldIdx = 0; fieldIdx < numDynFields; ++fieldIdx) {
+    uint32_t fieldSize;
+    if (!read(data, length, offset, fieldSize) || fieldSize > length - offset) {
+      return false;
+    }
+    offset += fieldSize;
+  }
+  uint32_t numberOfSubSamples;
+  uint32_t encodedSize;
+  if (offset > length || !read(data, length, offset, numberOfSubSamples) ||
+      !read(data, length, offset, encodedSize) || encodedSize > length - offset ||
+      length - offset - encodedSize < sizeof(double) + sizeof(uint32_t)) {
+    return false;
+  }
+  const size_t payloadSize =
+      !typeInfo->isBasic() ? size_t(config->sampleSizeInBytes) * numberOfSubSamples : 0;
+  if ((payloadSize == 0) != (encodedSize == 0) || payloadSize > codec.maxDecodedSize(encodedSize)) {
+    return false;
+  }
+  const uint8_t* encoded = data + offset;
+
+  sample = StreamSample();
+  if (paramSize > 0) {
+    sample.parameters = memoryPool->getBufferFromPool(poolHandle, paramSize);
+    std::memcpy(sample.parameters.get(), data, paramSize);
+  }
+  int dynamicOffset = paramSize;
+  if (numDynFields > 0) {
+    sample.dynamicParameters = makeSharedRawDynamicArray(numDynFields);
+    details::deserializeDynamicFields(sample.dynamicParameters, numDynFields, dynamicOffset, data);
+  }
+  sample.numberOfSubSamples = numberOfSubSamples;
+  if (payloadSize > 0) {
+    CpuBuffer payload = memoryPool->getBufferFromPool(poolHandle, payloadSize);
+    if (!codec.decode(encoded, encodedSize, payload.get(), payloadSize)) {
+      return false;
+    }
+    sample.payload = payload;
+  }
+  offset += encodedSize;
+  read(data, length, offset, sample.metadata->header.timestamp);
+  read(data, length, offset, sample.metadata->header.sequenceNumber);
+  return true;
+}
+
+CodecPool::CodecPool(size_t numThreads) {
+  for (size_t i = 0; i < std::max<size_t>(numThreads, 1); ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+    auto& worker = *workers_.back();
+    worker.thread = std::thread([this, &worker]() { run(worker); });
+  }
+}
+
+CodecPool::~CodecPool() {
+  for (auto& worker : workers_) {
+    {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+      worker->stop = true;
+    }
+    worker->pending.notify_one();
+  }
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void CodecPool::submit(size_t key, std::function<void()> job) {
+  auto& worker = *workers_[key % workers_.size()];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.jobs.push_back(std::move(job));
+  }
+  worker.pending.notify_one();
+}
+
+void CodecPool::run(Worker& worker) {
+  std::unique_lock<std::mutex> lock(worker.mutex);
+  while (true) {
+    worker.pending.wait(lock, [&worker]() { return worker.stop || !worker.jobs.empty(); });
+    // Jobs still queued when stopping are run first
+    if (worker.jobs.empty()) {
+      return;
+    }
+    auto job = std::move(worker.jobs.front());
+    worker.jobs.pop_front();
+    lock.unlock();
+    job();
+    lock.lock();
+  }
+}
+
+} // namespace cthulhu
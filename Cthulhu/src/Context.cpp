@@ -41,8 +41,8 @@ Subscriber Context::subscribeGeneric(
 
   // Now that the callbacks match the stream, add a StreamConsumer for it. We can directly pass the
   // callbacks that we received from the caller since no type conversions need to happen.
-  std::unique_ptr<StreamConsumer> consumer(new StreamConsumer(
-      stream, sampleCallback, configCallback, options.consumerType == ConsumerType::ASYNC));
+  auto consumer = details::makeConsumer(
+      stream, sampleCallback, configCallback, options.consumerType, options.scheduling);
 
   // Finally, register against the context registry and return a new subscriber.
   if (ctx_ == nullptr) {
@@ -95,8 +95,8 @@ Subscriber Context::subscribeGeneric(
 
   // Now that the callbacks match the stream, add a StreamConsumer for it. We can directly pass the
   // callbacks that we received from the caller since no type conversions need to happen.
-  std::unique_ptr<StreamConsumer> consumer(new StreamConsumer(
-      si, sampleCallback, configCallback, options.consumerType == ConsumerType::ASYNC));
+  auto consumer = details::makeConsumer(
+      si, sampleCallback, configCallback, options.consumerType, options.scheduling);
 
   // Finally, register against the context registry and return a new subscriber.
   if (ctx_ == nullptr) {
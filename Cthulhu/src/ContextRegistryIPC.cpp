@@ -82,12 +82,34 @@ ContextInfoIPCHandle::transformations() const {
   return out_tfs;
 }
 
+void ContextInfoIPCHandle::visitRegistrations(RegistrationVisitor& visitor) const {
+  const auto visitGroup = [&visitor](RegistrationKind kind, const VectorStreamIDIPC& group) {
+    visitor.beginGroup(kind);
+    for (const auto& stream : group) {
+      visitor.stream(StreamIDView(stream.data(), stream.size()));
+    }
+  };
+
+  ScopedLockIPC lock(data_->mutex);
+  for (const auto& group : data_->subscriptions_) {
+    visitGroup(RegistrationKind::SUBSCRIPTION, group);
+  }
+  for (const auto& group : data_->publications_) {
+    visitGroup(RegistrationKind::PUBLICATION, group);
+  }
+  for (const auto& [inputs, outputs] : data_->transformations_) {
+    visitGroup(RegistrationKind::TRANSFORMATION_INPUT, inputs);
+    visitGroup(RegistrationKind::TRANSFORMATION_OUTPUT, outputs);
+  }
+}
+
 void ContextInfoIPCHandle::registerSubscriber(const std::vector<StreamID>& streams) {
   ScopedLockIPC lock(data_->mutex);
   auto& back = data_->subscriptions_.emplace_back(alloc_);
   for (const auto& stream : streams) {
     back.emplace_back(stream.c_str(), alloc_);
   }
+  registryVersion_->fetch_add(1, std::memory_order_release);
 }
 
 void ContextInfoIPCHandle::registerPublisher(const std::vector<StreamID>& streams) {
@@ -96,6 +118,7 @@ void ContextInfoIPCHandle::registerPublisher(const std::vector<StreamID>& stream
   for (const auto& stream : streams) {
     back.emplace_back(stream.c_str(), alloc_);
   }
+  registryVersion_->fetch_add(1, std::memory_order_release);
 }
 
 void ContextInfoIPCHandle::registerTransformer(
@@ -110,6 +133,7 @@ void ContextInfoIPCHandle::registerTransformer(
   for (const auto& output : outputs) {
     second.emplace_back(output.c_str(), alloc_);
   }
+  registryVersion_->fetch_add(1, std::memory_order_release);
 }
 
 void ContextInfoIPCHandle::registerSubscriber(const std::vector<StreamIDView>& views) {
@@ -118,6 +142,7 @@ void ContextInfoIPCHandle::registerSubscriber(const std::vector<StreamIDView>& v
   for (const auto& view : views) {
     back.emplace_back(view.data(), alloc_);
   }
+  registryVersion_->fetch_add(1, std::memory_order_release);
 }
 
 void ContextInfoIPCHandle::registerPublisher(const std::vector<StreamIDView>& views) {
@@ -126,6 +151,7 @@ void ContextInfoIPCHandle::registerPublisher(const std::vector<StreamIDView>& vi
   for (const auto& view : views) {
     back.emplace_back(view.data(), alloc_);
   }
+  registryVersion_->fetch_add(1, std::memory_order_release);
 }
 
 void ContextInfoIPCHandle::registerTransformer(
@@ -140,6 +166,7 @@ void ContextInfoIPCHandle::registerTransformer(
   for (const auto& output : output_views) {
     second.emplace_back(output.data(), alloc_);
   }
+  registryVersion_->fetch_add(1, std::memory_order_release);
 }
 
 ContextRegistryIPC::ContextRegistryIPC(ManagedSHM* shm) : shm_(shm) {
@@ -187,6 +214,7 @@ ContextInfoInterface* ContextRegistryIPC::registerContext(std::string_view name,
 
   auto& back = registryData_->contexts.emplace_back(name, private_ns, shm_->get_segment_manager());
   ++registryData_->valid_contexts; // Need to track valid size separately to avoid looping.
+  registryData_->version.fetch_add(1, std::memory_order_release);
   XR_LOGD(
       "adding context {}, {}, up to {} valid contexts out of {}",
       std::string(name),
@@ -194,7 +222,8 @@ ContextInfoInterface* ContextRegistryIPC::registerContext(std::string_view name,
       registryData_->valid_contexts,
       registryData_->contexts.size());
 
-  auto& handle = handles_.emplace_back(&back, shm_->get_segment_manager());
+  auto& handle =
+      handles_.emplace_back(&back, shm_->get_segment_manager(), &registryData_->version);
   return &handle;
 }
 
@@ -207,6 +236,7 @@ void ContextRegistryIPC::removeContext(ContextInfoInterface* handle) {
     if (&ctx == ipc_handle->data_) {
       ipc_handle->setValid(false); // Use the convenient handle we've been given
       --registryData_->valid_contexts;
+      registryData_->version.fetch_add(1, std::memory_order_release);
       matched = true;
     }
   }
@@ -240,11 +270,16 @@ std::vector<ContextInfoInterfaceConstPtr> ContextRegistryIPC::contexts(bool all)
   out.reserve(registryData_->contexts.size());
   for (auto& ctx : registryData_->contexts) {
     if (all || ctx.valid_) {
-      out.emplace_back(new ContextInfoIPCHandle(&ctx, shm_->get_segment_manager()));
+      out.emplace_back(
+          new ContextInfoIPCHandle(&ctx, shm_->get_segment_manager(), &registryData_->version));
     }
   }
 
   return out;
 }
 
+uint64_t ContextRegistryIPC::version() const {
+  return registryData_->version.load(std::memory_order_acquire);
+}
+
 } // namespace cthulhu
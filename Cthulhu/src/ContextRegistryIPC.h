@@ -65,8 +65,12 @@ struct ContextInfoIPCData {
 
 class ContextInfoIPCHandle : public ContextInfoInterface {
  public:
-  ContextInfoIPCHandle(ContextInfoIPCData* data, const VoidAllocatorIPC& alloc)
-      : data_(data), alloc_(alloc) {}
+  // The registry's version, in shared memory, is bumped whenever the context registers streams
+  ContextInfoIPCHandle(
+      ContextInfoIPCData* data,
+      const VoidAllocatorIPC& alloc,
+      std::atomic<uint64_t>* registryVersion)
+      : data_(data), alloc_(alloc), registryVersion_(registryVersion) {}
   virtual ~ContextInfoIPCHandle() = default;
 
   std::string name() const override;
@@ -79,6 +83,8 @@ class ContextInfoIPCHandle : public ContextInfoInterface {
   std::vector<RegistrationGroup> publications() const override;
   std::vector<std::pair<RegistrationGroup, RegistrationGroup>> transformations() const override;
 
+  void visitRegistrations(RegistrationVisitor& visitor) const override;
+
   void registerSubscriber(const std::vector<StreamID>& streams) override;
   void registerPublisher(const std::vector<StreamID>& streams) override;
   void registerTransformer(
@@ -94,6 +100,7 @@ class ContextInfoIPCHandle : public ContextInfoInterface {
  private:
   ContextInfoIPCData* data_;
   VoidAllocatorIPC alloc_;
+  std::atomic<uint64_t>* registryVersion_;
 
   friend class ContextRegistryIPC;
 };
@@ -107,6 +114,10 @@ struct ContextRegistryIPCData {
   ContextInfoList contexts;
   size_t valid_contexts = 0;
 
+  // Bumped whenever a context is registered or removed, or registers streams
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "uint64_t must be lock free!");
+  std::atomic<uint64_t> version{0};
+
   // Must only be updated with mutex held
   uint32_t referenceCount = 0;
 
@@ -121,6 +132,7 @@ class ContextRegistryIPC : public ContextRegistryInterface {
   ContextInfoInterface* registerContext(std::string_view name, bool private_ns = false) override;
   void removeContext(ContextInfoInterface* handle) override;
   std::vector<ContextInfoInterfaceConstPtr> contexts(bool all = false) const override;
+  uint64_t version() const override;
 
   // Destroy the framework without any concern for other Cthulhu users
   //
@@ -0,0 +1,54 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/ContextRegistryInterface.h>
+
+namespace cthulhu {
+
+std::shared_ptr<const ContextRegistrySnapshot> ContextRegistrySnapshot::take(
+    const std::vector<ContextInfoInterfaceConstPtr>& contexts,
+    uint64_t version) {
+  // Appends the registrations of a context to the snapshot, interning its streams
+  class Builder : public RegistrationVisitor {
+   public:
+    Builder(ContextRegistrySnapshot& snapshot, uint32_t context)
+        : snapshot_(snapshot), context_(context) {}
+
+    void beginGroup(RegistrationKind kind) override {
+      const auto begin = static_cast<uint32_t>(snapshot_.handles_.size());
+      snapshot_.groups_.push_back({context_, kind, begin, begin});
+    }
+
+    void stream(StreamIDView id) override {
+      snapshot_.handles_.push_back(StreamHandles::intern(id));
+      snapshot_.groups_.back().end = static_cast<uint32_t>(snapshot_.handles_.size());
+    }
+
+   private:
+    ContextRegistrySnapshot& snapshot_;
+    uint32_t context_;
+  };
+
+  std::shared_ptr<ContextRegistrySnapshot> snapshot(new ContextRegistrySnapshot(version));
+  snapshot->contexts_.reserve(contexts.size());
+  for (const auto& context : contexts) {
+    Builder builder(*snapshot, static_cast<uint32_t>(snapshot->contexts_.size()));
+    snapshot->contexts_.push_back(
+        {context->name(), context->isPrivateNamespace(), context->getPid(), context->getValid()});
+    context->visitRegistrations(builder);
+  }
+  return snapshot;
+}
+
+std::shared_ptr<const ContextRegistrySnapshot> ContextRegistryInterface::snapshot(bool all) const {
+  // Read the version first: if the registry changes while the snapshot is taken, the snapshot is
+  // tagged with the older version and taken again on the next call
+  const auto currentVersion = version();
+  std::lock_guard<std::mutex> lock(snapshotMutex_);
+  auto& cached = snapshots_[all ? 1 : 0];
+  if (!cached || cached->version() != currentVersion) {
+    cached = ContextRegistrySnapshot::take(contexts(all), currentVersion);
+  }
+  return cached;
+}
+
+} // namespace cthulhu
@@ -14,7 +14,8 @@ ContextInfoInterface* ContextRegistryLocal::registerContext(
     bool private_ns) {
   // Return a raw pointer to the ContextInfoLocal. This is acceptable as the context info will be
   // in scope for the lifetime of the Context. Doesn't matter if there's duplicates.
-  return contexts_.emplace_back(new ContextInfoLocal(name, private_ns)).get();
+  ++version_;
+  return contexts_.emplace_back(new ContextInfoLocal(name, private_ns, &version_)).get();
 }
 
 void ContextRegistryLocal::removeContext(ContextInfoInterface* handle) {
@@ -26,6 +27,7 @@ void ContextRegistryLocal::removeContext(ContextInfoInterface* handle) {
     throw std::runtime_error("no elements removed");
   }
   contexts_.erase(it, contexts_.end());
+  ++version_;
 }
 
 std::vector<ContextInfoInterfaceConstPtr> ContextRegistryLocal::contexts(
@@ -39,4 +41,8 @@ std::vector<ContextInfoInterfaceConstPtr> ContextRegistryLocal::contexts(
   return ret;
 }
 
+uint64_t ContextRegistryLocal::version() const {
+  return version_.load();
+}
+
 } // namespace cthulhu
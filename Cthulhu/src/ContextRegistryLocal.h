@@ -4,13 +4,17 @@
 
 #include <cthulhu/ContextRegistryInterface.h>
 
+#include <atomic>
+
 namespace cthulhu {
 
 class ContextInfoLocal : public ContextInfoInterface {
  public:
   virtual ~ContextInfoLocal() = default;
 
-  ContextInfoLocal(std::string_view name, bool private_ns) : name_(name), private_ns_(private_ns) {}
+  // The registry's version is bumped whenever the context registers streams
+  ContextInfoLocal(std::string_view name, bool private_ns, std::atomic<uint64_t>* registryVersion)
+      : name_(name), private_ns_(private_ns), registryVersion_(registryVersion) {}
 
   inline std::string name() const override {
     return name_;
@@ -44,18 +48,40 @@ class ContextInfoLocal : public ContextInfoInterface {
     return transformations_;
   }
 
+  inline void visitRegistrations(RegistrationVisitor& visitor) const override {
+    const auto visitGroup = [&visitor](RegistrationKind kind, const RegistrationGroup& group) {
+      visitor.beginGroup(kind);
+      for (const auto& stream : group) {
+        visitor.stream(stream);
+      }
+    };
+    for (const auto& group : subscriptions_) {
+      visitGroup(RegistrationKind::SUBSCRIPTION, group);
+    }
+    for (const auto& group : publications_) {
+      visitGroup(RegistrationKind::PUBLICATION, group);
+    }
+    for (const auto& [inputs, outputs] : transformations_) {
+      visitGroup(RegistrationKind::TRANSFORMATION_INPUT, inputs);
+      visitGroup(RegistrationKind::TRANSFORMATION_OUTPUT, outputs);
+    }
+  }
+
   inline void registerSubscriber(const std::vector<StreamID>& streams) override {
     subscriptions_.emplace_back(streams);
+    ++*registryVersion_;
   }
 
   inline void registerPublisher(const std::vector<StreamID>& streams) override {
     publications_.emplace_back(streams);
+    ++*registryVersion_;
   }
 
   inline void registerTransformer(
       const std::vector<StreamID>& inputs,
       const std::vector<StreamID>& outputs) override {
     transformations_.emplace_back(inputs, outputs);
+    ++*registryVersion_;
   }
 
   inline void registerSubscriber(const std::vector<StreamIDView>& views) override {
@@ -65,6 +91,7 @@ class ContextInfoLocal : public ContextInfoInterface {
     for (const auto& view : views) {
       streams.emplace_back(view);
     }
+    ++*registryVersion_;
   }
 
   inline void registerPublisher(const std::vector<StreamIDView>& views) override {
@@ -74,6 +101,7 @@ class ContextInfoLocal : public ContextInfoInterface {
     for (const auto& view : views) {
       streams.emplace_back(view);
     }
+    ++*registryVersion_;
   }
 
   inline virtual void registerTransformer(
@@ -90,11 +118,13 @@ class ContextInfoLocal : public ContextInfoInterface {
     for (const auto& view : output_views) {
       outputs.emplace_back(view);
     }
+    ++*registryVersion_;
   }
 
  private:
   std::string name_;
   bool private_ns_;
+  std::atomic<uint64_t>* registryVersion_;
   std::vector<ContextInfoInterface::RegistrationGroup> subscriptions_;
   std::vector<ContextInfoInterface::RegistrationGroup> publications_;
   std::vector<
@@ -109,9 +139,11 @@ class ContextRegistryLocal : public ContextRegistryInterface {
   ContextInfoInterface* registerContext(std::string_view name, bool private_ns = false) override;
   void removeContext(ContextInfoInterface* handle) override;
   std::vector<ContextInfoInterfaceConstPtr> contexts(bool all = false) const override;
+  uint64_t version() const override;
 
  private:
   std::vector<std::shared_ptr<ContextInfoLocal>> contexts_;
+  std::atomic<uint64_t> version_{0};
 };
 
 } // namespace cthulhu
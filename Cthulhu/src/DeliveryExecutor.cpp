@@ -0,0 +1,148 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "DeliveryExecutor.h"
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace cthulhu {
+
+namespace {
+
+const size_t DEFAULT_NUM_THREADS = 2;
+
+size_t numThreads() {
+  const char* value = std::getenv("CTHULHU_EXECUTOR_THREADS");
+  if (value) {
+    const long count = std::strtol(value, nullptr, 10);
+    if (count > 0) {
+      return count;
+    }
+  }
+  return DEFAULT_NUM_THREADS;
+}
+
+} // namespace
+
+bool setCurrentThreadRealtime() {
+#ifndef _WIN32
+  sched_param param{};
+  param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+  return false;
+#endif
+}
+
+DeliveryExecutor& DeliveryExecutor::instance() {
+  static DeliveryExecutor executor;
+  return executor;
+}
+
+DeliveryExecutor::DeliveryExecutor() {
+  const size_t count = numThreads();
+  for (size_t idx = 0; idx < count; ++idx) {
+    workers_.emplace_back([this]() { run(false); });
+  }
+}
+
+DeliveryExecutor::~DeliveryExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  pending_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  if (realtimeWorker_.joinable()) {
+    realtimeWorker_.join();
+  }
+}
+
+bool DeliveryExecutor::runsLater(const Entry& a, const Entry& b) {
+  if (a.priority != b.priority) {
+    return a.priority < b.priority;
+  }
+  if (a.deadline != b.deadline) {
+    return a.deadline > b.deadline;
+  }
+  return a.order > b.order;
+}
+
+void DeliveryExecutor::submit(
+    const void* owner,
+    PriorityClass priority,
+    Clock::time_point deadline,
+    bool realtimeThread,
+    Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (realtimeThread && priority == PriorityClass::REALTIME && !realtimeWorker_.joinable()) {
+      realtimeWorker_ = std::thread([this]() {
+        if (!setCurrentThreadRealtime()) {
+          XR_LOGW("Failed to switch the realtime delivery thread to SCHED_FIFO");
+        }
+        run(true);
+      });
+    }
+    heap_.push_back(Entry{priority, deadline, order_++, owner, std::move(task)});
+    std::push_heap(heap_.begin(), heap_.end(), runsLater);
+  }
+  pending_.notify_all();
+}
+
+void DeliveryExecutor::cancel(const void* owner) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // A running delivery may queue the next one, so wait for it before dropping the queued ones. A
+  // delivery may also cancel its own owner, in which case there is nothing to wait for.
+  finished_.wait(lock, [this, owner]() {
+    auto range = running_.equal_range(owner);
+    return std::all_of(range.first, range.second, [](const auto& running) {
+      return running.second == std::this_thread::get_id();
+    });
+  });
+  auto removed = std::remove_if(
+      heap_.begin(), heap_.end(), [owner](const Entry& entry) { return entry.owner == owner; });
+  if (removed != heap_.end()) {
+    heap_.erase(removed, heap_.end());
+    std::make_heap(heap_.begin(), heap_.end(), runsLater);
+  }
+}
+
+void DeliveryExecutor::run(bool realtimeOnly) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    pending_.wait(lock, [this, realtimeOnly]() {
+      return stop_ ||
+          (!heap_.empty() &&
+           (!realtimeOnly || heap_.front().priority == PriorityClass::REALTIME));
+    });
+    if (stop_) {
+      return;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), runsLater);
+    Entry entry = std::move(heap_.back());
+    heap_.pop_back();
+    // A delivery may queue the next one for the same owner, which another thread can start before
+    // this one is marked finished, so each thread only clears its own marker
+    auto running = running_.emplace(entry.owner, std::this_thread::get_id());
+
+    lock.unlock();
+    entry.task();
+    lock.lock();
+
+    running_.erase(running);
+    finished_.notify_all();
+  }
+}
+
+} // namespace cthulhu
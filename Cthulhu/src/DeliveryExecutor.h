@@ -0,0 +1,72 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cthulhu/StreamInterface.h>
+
+namespace cthulhu {
+
+// Switches the calling thread to SCHED_FIFO. Returns false if that isn't permitted or supported.
+bool setCurrentThreadRealtime();
+
+// Runs the deliveries of scheduled consumers on a shared pool of threads. Pending deliveries run in
+// order of priority class, then earliest deadline first, then in submission order. The pool has
+// CTHULHU_EXECUTOR_THREADS threads (2 by default), plus a SCHED_FIFO thread serving only REALTIME
+// deliveries, started by the first delivery asking for it.
+class DeliveryExecutor {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Task = std::function<void()>;
+
+  static DeliveryExecutor& instance();
+
+  ~DeliveryExecutor();
+
+  // Queues a delivery for owner. Use Clock::time_point::max() for no deadline.
+  void submit(
+      const void* owner,
+      PriorityClass priority,
+      Clock::time_point deadline,
+      bool realtimeThread,
+      Task task);
+
+  // Drops the queued deliveries of owner, and waits for its running delivery to finish
+  void cancel(const void* owner);
+
+ private:
+  DeliveryExecutor();
+
+  struct Entry {
+    PriorityClass priority;
+    Clock::time_point deadline;
+    uint64_t order;
+    const void* owner;
+    Task task;
+  };
+
+  // Heap ordering, placing the entry to run next at the front
+  static bool runsLater(const Entry& a, const Entry& b);
+
+  void run(bool realtimeOnly);
+
+  std::vector<Entry> heap_;
+  uint64_t order_ = 0;
+  // Owners with a delivery in progress, and the threads running them
+  std::multimap<const void*, std::thread::id> running_;
+  bool stop_ = false;
+  std::mutex mutex_;
+  std::condition_variable pending_;
+  std::condition_variable finished_;
+
+  std::vector<std::thread> workers_;
+  std::thread realtimeWorker_;
+};
+
+} // namespace cthulhu
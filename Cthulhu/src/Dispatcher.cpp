@@ -9,20 +9,19 @@ namespace cthulhu {
 
 Dispatcher::Dispatcher(Dispatcher&& other) {
   for (auto& producer : other.producers_) {
-    producers_.push_back(IdentifiedProducer(producer.first, std::move(producer.second)));
+    producers_.push_back(std::move(producer));
   }
 }
 
 Dispatcher& Dispatcher::operator=(Dispatcher&& other) {
   for (auto& producer : other.producers_) {
-    producers_.push_back(IdentifiedProducer(producer.first, std::move(producer.second)));
+    producers_.push_back(std::move(producer));
   }
   return *this;
 }
 
 void Dispatcher::registerProducer(StreamInterface* si) {
-  producers_.push_back(
-      IdentifiedProducer(si->description().id(), std::make_unique<StreamProducer>(si)));
+  producers_.push_back(std::make_unique<StreamProducer>(si));
 };
 
 void Dispatcher::dispatchSamples(const std::vector<StreamSample>& samples) {
@@ -30,10 +29,10 @@ void Dispatcher::dispatchSamples(const std::vector<StreamSample>& samples) {
     throw std::exception();
   }
   for (size_t i = 0; i < producers_.size(); i++) {
-    if (!producers_[i].second->isActive()) {
+    if (!producers_[i]->isActive()) {
       continue;
     }
-    producers_[i].second->produceSample(samples[i]);
+    producers_[i]->produceSample(samples[i]);
   }
 };
 
@@ -42,10 +41,10 @@ void Dispatcher::dispatchConfigs(std::vector<StreamConfig>& configs) {
     throw std::exception();
   }
   for (size_t i = 0; i < producers_.size(); i++) {
-    if (!producers_[i].second->isActive()) {
+    if (!producers_[i]->isActive()) {
       continue;
     }
-    producers_[i].second->configureStream(configs[i]);
+    producers_[i]->configureStream(configs[i]);
   }
 };
 
@@ -54,7 +53,7 @@ void Dispatcher::configureStream(const StreamConfig& config, uint32_t streamNumb
     XR_LOGW("Dispatcher - Attempted to configure a stream with invalid streamNumber. Ignoring.");
     return;
   }
-  producers_[streamNumber].second->configureStream(std::move(config));
+  producers_[streamNumber]->configureStream(std::move(config));
 };
 
 const StreamConfig* Dispatcher::streamConfig(uint32_t streamNumber) {
@@ -62,7 +61,15 @@ const StreamConfig* Dispatcher::streamConfig(uint32_t streamNumber) {
     XR_LOGW("Dispatcher - Attempted to configure a stream with invalid streamNumber. Ignoring.");
     return nullptr;
   }
-  return producers_[streamNumber].second->config();
+  return producers_[streamNumber]->config();
+};
+
+StreamHandle Dispatcher::streamHandle(uint32_t streamNumber) const {
+  if (streamNumber >= producers_.size()) {
+    XR_LOGW("Dispatcher - Attempted to get the handle of an invalid streamNumber.");
+    return INVALID_STREAM_HANDLE;
+  }
+  return producers_[streamNumber]->handle();
 };
 
 } // namespace cthulhu
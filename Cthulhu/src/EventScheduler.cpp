@@ -0,0 +1,213 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/EventScheduler.h>
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+#include <cthulhu/Framework.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace cthulhu {
+
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+SteadyClock::duration toSteady(double seconds) {
+  return std::chrono::duration_cast<SteadyClock::duration>(std::chrono::duration<double>(seconds));
+}
+
+void mergeHistogram(LatenessHistogram& into, const LatenessHistogram& from) {
+  for (size_t i = 0; i < into.counts.size(); ++i) {
+    into.counts[i] += from.counts[i];
+  }
+  into.events += from.events;
+  into.totalLateness += from.totalLateness;
+  into.maxLateness = std::max(into.maxLateness, from.maxLateness);
+}
+
+} // namespace
+
+void LatenessHistogram::add(double lateness) {
+  lateness = std::max(lateness, 0.0);
+  const auto bucket = std::min(static_cast<size_t>(lateness / BUCKET_WIDTH), NUM_BUCKETS);
+  ++counts[bucket];
+  ++events;
+  totalLateness += lateness;
+  maxLateness = std::max(maxLateness, lateness);
+}
+
+double LatenessHistogram::quantile(double q) const {
+  if (events == 0) {
+    return 0.0;
+  }
+  const auto target =
+      std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * events)));
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    cumulative += counts[i];
+    if (cumulative >= target) {
+      return std::min((i + 1) * BUCKET_WIDTH, maxLateness);
+    }
+  }
+  return maxLateness;
+}
+
+EventScheduler::EventScheduler(
+    std::vector<ScheduledEvent> events,
+    const EventSchedulerOptions& options)
+    : options_(options) {
+  std::stable_sort(
+      events.begin(), events.end(), [](const ScheduledEvent& lhs, const ScheduledEvent& rhs) {
+        return lhs.offset < rhs.offset;
+      });
+
+  std::map<StreamID, size_t> producerIndices;
+  events_.reserve(events.size());
+  for (auto& event : events) {
+    auto it = producerIndices.find(event.streamID);
+    if (it == producerIndices.end()) {
+      auto* si = Framework::instance().streamRegistry()->getStream(event.streamID);
+      if (!si) {
+        XR_LOGE("Scheduled events on unregistered stream {}", event.streamID);
+        throw std::runtime_error("Scheduled events on unregistered stream " + event.streamID);
+      }
+      auto producer = std::make_unique<StreamProducer>(si);
+      if (!producer->isActive()) {
+        XR_LOGE("Failed to produce on scheduled stream {}", event.streamID);
+        throw std::runtime_error("Failed to produce on scheduled stream " + event.streamID);
+      }
+      it = producerIndices.emplace(event.streamID, producers_.size()).first;
+      producers_.push_back(std::move(producer));
+      streamIDs_.push_back(event.streamID);
+    }
+    events_.push_back(Event{event.offset, it->second, std::move(event.sample)});
+  }
+  lateness_.resize(producers_.size());
+
+  if (Framework::instance().clockManager()) {
+    clock_ = Framework::instance().clockManager()->clock();
+  }
+}
+
+EventScheduler::~EventScheduler() {
+  stop();
+}
+
+void EventScheduler::start(double startTime) {
+  if (thread_.joinable() || finished()) {
+    return;
+  }
+  const auto steadyNow = SteadyClock::now();
+  const double now = clockTime();
+  if (startTime < 0.0) {
+    startTime = now;
+  }
+  steadyStart_ = steadyNow + toSteady(startTime - now);
+  thread_ = std::thread([this, startTime]() { run(startTime); });
+}
+
+void EventScheduler::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  stopped_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  finished_.store(true, std::memory_order_release);
+}
+
+LatenessHistogram EventScheduler::lateness() const {
+  LatenessHistogram result;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& histogram : lateness_) {
+    mergeHistogram(result, histogram);
+  }
+  return result;
+}
+
+LatenessHistogram EventScheduler::lateness(const StreamID& id) const {
+  LatenessHistogram result;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < streamIDs_.size(); ++i) {
+    if (streamIDs_[i] == id) {
+      mergeHistogram(result, lateness_[i]);
+    }
+  }
+  return result;
+}
+
+void EventScheduler::run(double startTime) {
+  for (auto& event : events_) {
+    const double lateness = waitUntil(startTime + event.offset, startTime);
+    if (stopping()) {
+      break;
+    }
+    if (options_.stampTimestamp) {
+      if (!event.sample.metadata) {
+        event.sample.metadata = std::make_shared<SampleMetadata>();
+      }
+      event.sample.metadata->header.timestamp = startTime + event.offset + lateness;
+    }
+    producers_[event.producer]->produceSample(event.sample);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      lateness_[event.producer].add(lateness);
+    }
+    published_.fetch_add(1, std::memory_order_relaxed);
+    // The sample is owned by its consumers from here on
+    event.sample = StreamSample();
+  }
+  finished_.store(true, std::memory_order_release);
+}
+
+double EventScheduler::waitUntil(double deadline, double startTime) {
+  const double spin = options_.spinThreshold.count();
+  if (!clock_ || !clock_->isSimulated()) {
+    const auto steadyDeadline = steadyStart_ + toSteady(deadline - startTime);
+    sleepUntil(steadyDeadline - toSteady(spin));
+    auto now = SteadyClock::now();
+    while (now < steadyDeadline && !stopping()) {
+      now = SteadyClock::now();
+    }
+    return std::chrono::duration<double>(now - steadyDeadline).count();
+  }
+
+  for (;;) {
+    const double remaining = deadline - clock_->getTime();
+    if (remaining <= spin || stopping()) {
+      break;
+    }
+    const double sleep = std::min(remaining - spin, options_.maxSimulatedSleep.count());
+    sleepUntil(SteadyClock::now() + toSteady(sleep));
+  }
+  double now = clock_->getTime();
+  while (now < deadline && !stopping()) {
+    // A simulated clock can be paused, so don't hog the core while it is
+    std::this_thread::yield();
+    now = clock_->getTime();
+  }
+  return now - deadline;
+}
+
+double EventScheduler::clockTime() const {
+  if (clock_) {
+    return clock_->getTime();
+  }
+  // What the real clock reads
+  return std::chrono::duration<double>(std::chrono::high_resolution_clock::now().time_since_epoch())
+      .count();
+}
+
+void EventScheduler::sleepUntil(SteadyClock::time_point until) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  stopped_.wait_until(lock, until, [this]() { return stopping(); });
+}
+
+} // namespace cthulhu
@@ -34,6 +34,7 @@ const static char* SHM_NAME_ENV_VAR = "CTHULHU_SHM_NAME";
 
 const static char* DISABLE_SHARED_MEMORY_ENV_VAR = "CTHULHU_DISABLE_SHARED_MEMORY";
 const static char* ENABLE_AUDITOR_ENV_VAR = "CTHULHU_ENABLE_AUDITOR";
+const static char* LOCK_MEMORY_ENV_VAR = "CTHULHU_LOCK_MEMORY";
 
 static std::string shm_name() {
   return std::getenv(SHM_NAME_ENV_VAR) ? std::getenv(SHM_NAME_ENV_VAR) : DEFAULT_SHM_NAME;
@@ -91,6 +92,10 @@ Framework::Framework() : storage_(nullptr) {
     streamRegistry_ = std::make_unique<StreamRegistryLocal>();
     contextRegistry_ = std::make_unique<ContextRegistryLocal>();
   }
+
+  if (std::getenv(LOCK_MEMORY_ENV_VAR) && !memoryPool_->lockMemory()) {
+    XR_LOGW("Failed to lock all of the memory pool into RAM, check RLIMIT_MEMLOCK");
+  }
 }
 
 bool Framework::nuke() {
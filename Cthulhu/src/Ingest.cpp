@@ -0,0 +1,562 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/Ingest.h>
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+#include <cthulhu/Framework.h>
+#include <cthulhu/Numa.h>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <limits>
+
+// IORING_FEAT_FAST_POLL comes with the kernel headers (5.7) that also define the read and recv
+// operations used here
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_FAST_POLL)
+#define CTHULHU_HAS_IO_URING
+#endif
+#endif
+
+namespace cthulhu {
+
+namespace {
+
+const uint64_t STOP_TAG = ~0ull;
+
+int64_t threadCpuNs(clockid_t clock) {
+  timespec time{};
+  if (clock_gettime(clock, &time) != 0) {
+    return -1;
+  }
+  return int64_t(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+#ifdef CTHULHU_HAS_IO_URING
+
+// A minimal io_uring, set up with the raw system calls so that liburing isn't needed. Only the
+// ingest thread touches it.
+class IoUring {
+ public:
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, numEntries_ * sizeof(io_uring_sqe));
+    }
+    if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_) {
+      munmap(cqRing_, cqRingBytes_);
+    }
+    if (sqRing_ != MAP_FAILED) {
+      munmap(sqRing_, sqRingBytes_);
+    }
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  // Returns false if the kernel doesn't support io_uring, or the operations used here
+  bool setup(unsigned entries) {
+    io_uring_params params{};
+    fd_ = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd_ < 0) {
+      return false;
+    }
+    if (!(params.features & IORING_FEAT_FAST_POLL)) {
+      errno = ENOTSUP;
+      return false;
+    }
+    numEntries_ = params.sq_entries;
+    sqRingBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+      sqRingBytes_ = cqRingBytes_ = std::max(sqRingBytes_, cqRingBytes_);
+    }
+
+    const int protection = PROT_READ | PROT_WRITE;
+    const int flags = MAP_SHARED | MAP_POPULATE;
+    sqRing_ = mmap(nullptr, sqRingBytes_, protection, flags, fd_, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) {
+      return false;
+    }
+    cqRing_ = singleMmap ? sqRing_
+                         : mmap(nullptr, cqRingBytes_, protection, flags, fd_, IORING_OFF_CQ_RING);
+    if (cqRing_ == MAP_FAILED) {
+      return false;
+    }
+    void* sqes =
+        mmap(nullptr, numEntries_ * sizeof(io_uring_sqe), protection, flags, fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+      return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sq = static_cast<uint8_t*>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    auto* cq = static_cast<uint8_t*>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  // Queues an operation, submitted by the next enter(). Returns false if the queue is full.
+  bool queue(uint8_t opcode, int fd, void* address, uint32_t length, uint64_t tag, int flags = 0) {
+    const unsigned tail = *sqTail_;
+    if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= numEntries_) {
+      return false;
+    }
+    const unsigned index = tail & sqMask_;
+    io_uring_sqe& sqe = sqes_[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = opcode;
+    sqe.fd = fd;
+    // Reads at the current position of files, and is ignored by sockets and devices
+    sqe.off = opcode == IORING_OP_READ ? ~0ull : 0;
+    sqe.addr = reinterpret_cast<uintptr_t>(address);
+    sqe.len = length;
+    sqe.msg_flags = flags;
+    sqe.user_data = tag;
+    sqArray_[index] = index;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+    ++unsubmitted_;
+    return true;
+  }
+
+  bool cancel(uint64_t tag) {
+    return queue(IORING_OP_ASYNC_CANCEL, -1, reinterpret_cast<void*>(tag), 0, STOP_TAG - 1);
+  }
+
+  // Submits the queued operations and waits for a completion. Returns false on failure.
+  bool enter() {
+    const long submitted =
+        syscall(__NR_io_uring_enter, fd_, unsubmitted_, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    if (submitted < 0) {
+      return errno == EINTR;
+    }
+    unsubmitted_ -= submitted;
+    return true;
+  }
+
+  template <typename F>
+  void reap(F&& completed) {
+    unsigned head = *cqHead_;
+    const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      const io_uring_cqe& cqe = cqes_[head & cqMask_];
+      completed(cqe.user_data, cqe.res);
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+  }
+
+ private:
+  int fd_ = -1;
+  unsigned numEntries_ = 0;
+  unsigned unsubmitted_ = 0;
+  size_t sqRingBytes_ = 0;
+  size_t cqRingBytes_ = 0;
+  void* sqRing_ = MAP_FAILED;
+  void* cqRing_ = MAP_FAILED;
+  io_uring_sqe* sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+  unsigned* sqHead_ = nullptr;
+  unsigned* sqTail_ = nullptr;
+  unsigned sqMask_ = 0;
+  unsigned* sqArray_ = nullptr;
+  unsigned* cqHead_ = nullptr;
+  unsigned* cqTail_ = nullptr;
+  unsigned cqMask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+};
+
+#endif
+
+} // namespace
+
+std::unique_ptr<IngestSource> IngestSource::udp(
+    const StreamID& id,
+    const std::string& address,
+    uint16_t port,
+    const IngestFramer& framer,
+    const IngestOptions& options) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = AI_PASSIVE;
+  addrinfo* addresses = nullptr;
+  if (getaddrinfo(address.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0 ||
+      addresses == nullptr) {
+    XR_LOGE("Failed to resolve ingest address {}", address);
+    throw std::runtime_error("Failed to resolve ingest address " + address);
+  }
+  const int fd = socket(
+      addresses->ai_family, addresses->ai_socktype | SOCK_CLOEXEC, addresses->ai_protocol);
+  const bool bound = fd >= 0 && bind(fd, addresses->ai_addr, addresses->ai_addrlen) == 0;
+  freeaddrinfo(addresses);
+  if (!bound) {
+    const std::string error = std::strerror(errno);
+    if (fd >= 0) {
+      close(fd);
+    }
+    XR_LOGE("Failed to bind ingest socket to {}:{}: {}", address, port, error);
+    throw std::runtime_error("Failed to bind ingest socket to " + address);
+  }
+
+  // Absorbs bursts while the ingest thread is publishing
+  const size_t bufferBytes = options.readBytes * options.queueDepth * 4;
+  const int receiveBuffer =
+      static_cast<int>(std::min<size_t>(bufferBytes, std::numeric_limits<int>::max()));
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+  std::unique_ptr<IngestSource> source(new IngestSource(id, fd, true, framer, options));
+  sockaddr_storage boundAddress{};
+  socklen_t length = sizeof(boundAddress);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&boundAddress), &length);
+  if (boundAddress.ss_family == AF_INET6) {
+    source->port_ = ntohs(reinterpret_cast<sockaddr_in6*>(&boundAddress)->sin6_port);
+  } else {
+    source->port_ = ntohs(reinterpret_cast<sockaddr_in*>(&boundAddress)->sin_port);
+  }
+  return source;
+}
+
+std::unique_ptr<IngestSource> IngestSource::device(
+    const StreamID& id,
+    const std::string& path,
+    const IngestFramer& framer,
+    const IngestOptions& options) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    XR_LOGE("Failed to open ingest device {}: {}", path, std::strerror(errno));
+    throw std::runtime_error("Failed to open ingest device " + path);
+  }
+  return std::unique_ptr<IngestSource>(new IngestSource(id, fd, false, framer, options));
+}
+
+IngestFramer IngestSource::contentBlockFramer(size_t subSampleBytes) {
+  if (subSampleBytes == 0) {
+    XR_LOGE("Content block framer needs a subsample size");
+    throw std::runtime_error("Content block framer needs a subsample size");
+  }
+  return [subSampleBytes](
+             const CpuBuffer& data, size_t length, std::vector<StreamSample>& samples) {
+    if (length < subSampleBytes) {
+      return;
+    }
+    StreamSample sample;
+    sample.payload = data;
+    sample.numberOfSubSamples = length / subSampleBytes;
+    samples.push_back(sample);
+  };
+}
+
+IngestSource::IngestSource(
+    const StreamID& id,
+    int fd,
+    bool datagrams,
+    const IngestFramer& framer,
+    const IngestOptions& options)
+    : id_(id), fd_(fd), datagrams_(datagrams), framer_(framer), options_(options) {
+  if (options_.queueDepth == 0 || options_.readBytes == 0) {
+    close(fd_);
+    XR_LOGE("Ingest of {} needs a queue depth and read size", id_);
+    throw std::runtime_error("Invalid ingest options for " + id_);
+  }
+  // Reads of a device complete in the order they run, not the order they were queued
+  if (!datagrams_) {
+    options_.queueDepth = 1;
+  }
+
+  auto* si = Framework::instance().streamRegistry()->getStream(id_);
+  if (si) {
+    producer_ = std::make_unique<StreamProducer>(si);
+  }
+  if (!producer_ || !producer_->isActive()) {
+    close(fd_);
+    XR_LOGE("Failed to produce on ingest stream {}", id_);
+    throw std::runtime_error("Failed to produce on ingest stream " + id_);
+  }
+
+  stopFd_ = eventfd(0, EFD_CLOEXEC);
+  if (stopFd_ < 0) {
+    close(fd_);
+    XR_LOGE("Failed to create ingest event: {}", std::strerror(errno));
+    throw std::runtime_error("Failed to create ingest event");
+  }
+}
+
+IngestSource::~IngestSource() {
+  stop_ = true;
+  const uint64_t one = 1;
+  if (write(stopFd_, &one, sizeof(one)) < 0) {
+    XR_LOGW("Failed to wake up ingest of {}: {}", id_, std::strerror(errno));
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  close(stopFd_);
+  close(fd_);
+}
+
+void IngestSource::configureStream(const StreamConfig& config) {
+  producer_->configureStream(config);
+}
+
+void IngestSource::start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  started_ = std::chrono::steady_clock::now();
+  thread_ = std::thread([this]() { run(); });
+}
+
+IngestStats IngestSource::stats() const {
+  IngestStats stats;
+  stats.reads = reads_;
+  stats.bytes = bytes_;
+  stats.samples = samples_;
+  stats.truncated = truncated_;
+  stats.ioUring = ioUring_;
+  int64_t cpuNs = cpuNs_;
+  clockid_t clock;
+  if (!finished_ && thread_.joinable() &&
+      pthread_getcpuclockid(const_cast<std::thread&>(thread_).native_handle(), &clock) == 0) {
+    const int64_t running = threadCpuNs(clock);
+    if (running >= 0) {
+      cpuNs = running;
+    }
+  }
+  stats.cpuSeconds = cpuNs * 1e-9;
+  if (thread_.joinable()) {
+    stats.elapsedSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+  }
+  return stats;
+}
+
+void IngestSource::run() {
+  Numa::applyThreadPlacement(ThreadRole::INGEST);
+  if (options_.disableIoUring || !runIoUring()) {
+    runPolling();
+  }
+  cpuNs_ = threadCpuNs(CLOCK_THREAD_CPUTIME_ID);
+  finished_ = true;
+}
+
+bool IngestSource::runIoUring() {
+#ifdef CTHULHU_HAS_IO_URING
+  // Declared before the ring, so that the buffers outlive it
+  std::vector<CpuBuffer> buffers(options_.queueDepth);
+  auto stopValue = std::make_unique<uint64_t>(0);
+  IoUring ring;
+  // Room for the reads, the stop event and their cancellations
+  if (!ring.setup(2 * (options_.queueDepth + 1))) {
+    XR_LOGI_ONCE("io_uring unavailable ({}), ingesting with poll", std::strerror(errno));
+    return false;
+  }
+  ioUring_ = true;
+
+  const uint8_t opcode = datagrams_ ? IORING_OP_RECV : IORING_OP_READ;
+  // Makes recv return the full length of truncated datagrams
+  const int flags = datagrams_ ? MSG_TRUNC : 0;
+  auto queueRead = [&](uint64_t slot) {
+    buffers[slot] = nextBuffer();
+    ring.queue(opcode, fd_, buffers[slot].get(), options_.readBytes, slot, flags);
+  };
+
+  ring.queue(IORING_OP_READ, stopFd_, stopValue.get(), sizeof(uint64_t), STOP_TAG);
+  for (uint64_t slot = 0; slot < buffers.size(); ++slot) {
+    queueRead(slot);
+  }
+  size_t inFlight = buffers.size() + 1;
+  bool stopPending = true;
+
+  bool ended = false;
+  auto completed = [&](uint64_t tag, int result) {
+    if (tag == STOP_TAG) {
+      ended = true;
+      stopPending = false;
+      --inFlight;
+      return;
+    }
+    if (tag >= buffers.size()) {
+      // A cancellation
+      return;
+    }
+    --inFlight;
+    if (result > 0) {
+      size_t length = result;
+      if (length > options_.readBytes) {
+        ++truncated_;
+        length = options_.readBytes;
+      }
+      publish(buffers[tag], length);
+    } else if (result == 0 && !datagrams_) {
+      XR_LOGI("Ingest device of {} ended", id_);
+      ended = true;
+    } else if (result < 0 && result != -EAGAIN && result != -EINTR && result != -ECANCELED) {
+      XR_LOGE("Ingest read of {} failed: {}", id_, std::strerror(-result));
+      ended = true;
+    }
+    buffers[tag].reset();
+    if (!ended && !stop_) {
+      queueRead(tag);
+      ++inFlight;
+    }
+  };
+
+  // Submissions are refused while the kernel is short of memory or the completion queue is full,
+  // which reaping the completions resolves
+  auto enterAndReap = [&]() {
+    if (!ring.enter()) {
+      if (errno != EAGAIN && errno != EBUSY) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    ring.reap(completed);
+    return true;
+  };
+
+  while (!ended && !stop_) {
+    if (!enterAndReap()) {
+      XR_LOGE("io_uring_enter failed for ingest of {}: {}", id_, std::strerror(errno));
+      break;
+    }
+  }
+
+  // The kernel may still write into the buffers of pending reads, so wait for them to be cancelled
+  ended = true;
+  for (uint64_t slot = 0; slot < buffers.size(); ++slot) {
+    if (buffers[slot]) {
+      ring.cancel(slot);
+    }
+  }
+  if (stopPending) {
+    ring.cancel(STOP_TAG);
+  }
+  while (inFlight > 0) {
+    if (!enterAndReap()) {
+      // The reads can't be waited for, and closing the ring cancels them asynchronously, so the
+      // buffers they may still write into are leaked rather than returned to the pool
+      XR_LOGE(
+          "Failed to cancel {} reads of ingest of {}: {}", inFlight, id_, std::strerror(errno));
+      static_cast<void>(new std::vector<CpuBuffer>(std::move(buffers)));
+      static_cast<void>(stopValue.release());
+      break;
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void IngestSource::runPolling() {
+  pollfd descriptors[2] = {{fd_, POLLIN, 0}, {stopFd_, POLLIN, 0}};
+  std::vector<CpuBuffer> buffers(options_.queueDepth);
+  std::vector<iovec> iovecs(options_.queueDepth);
+  std::vector<mmsghdr> messages(options_.queueDepth);
+
+  while (!stop_) {
+    if (poll(descriptors, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      XR_LOGE("Ingest poll of {} failed: {}", id_, std::strerror(errno));
+      return;
+    }
+    if (descriptors[1].revents) {
+      return;
+    }
+
+    if (!datagrams_) {
+      CpuBuffer buffer = nextBuffer();
+      const ssize_t result = read(fd_, buffer.get(), options_.readBytes);
+      if (result > 0) {
+        publish(buffer, result);
+      } else if (result == 0) {
+        XR_LOGI("Ingest device of {} ended", id_);
+        return;
+      } else if (errno != EAGAIN && errno != EINTR) {
+        XR_LOGE("Ingest read of {} failed: {}", id_, std::strerror(errno));
+        return;
+      }
+      continue;
+    }
+
+    // Receives a batch of datagrams per system call
+    for (size_t i = 0; i < buffers.size(); ++i) {
+      if (!buffers[i]) {
+        buffers[i] = nextBuffer();
+      }
+      iovecs[i] = iovec{buffers[i].get(), options_.readBytes};
+      messages[i] = mmsghdr{};
+      messages[i].msg_hdr.msg_iov = &iovecs[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int received = recvmmsg(fd_, messages.data(), messages.size(), MSG_DONTWAIT, nullptr);
+    if (received < 0) {
+      if (errno != EAGAIN && errno != EINTR) {
+        XR_LOGE("Ingest receive of {} failed: {}", id_, std::strerror(errno));
+        return;
+      }
+      continue;
+    }
+    for (int i = 0; i < received; ++i) {
+      if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+        ++truncated_;
+      }
+      publish(buffers[i], messages[i].msg_len);
+      buffers[i].reset();
+    }
+  }
+}
+
+void IngestSource::publish(const CpuBuffer& buffer, size_t length) {
+  ++reads_;
+  bytes_ += length;
+  framer_(buffer, length, framed_);
+  if (framed_.empty()) {
+    return;
+  }
+  // Wall time, as the clock reads when no context has claimed it
+  const auto clock = Framework::instance().clockManager()->clock();
+  const double now = clock ? clock->getTime()
+                           : std::chrono::duration<double>(
+                                 std::chrono::high_resolution_clock::now().time_since_epoch())
+                                 .count();
+  for (auto& sample : framed_) {
+    sample.metadata->header.timestamp = now;
+    sample.metadata->header.sequenceNumber = sequenceNumber_++;
+    producer_->produceSample(sample);
+  }
+  samples_ += framed_.size();
+  // Releases the buffers for the pool
+  framed_.clear();
+}
+
+CpuBuffer IngestSource::nextBuffer() {
+  return Framework::instance().memoryPool()->getBufferFromPool(
+      producer_->handle(), options_.readBytes);
+}
+
+} // namespace cthulhu
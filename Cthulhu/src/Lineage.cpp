@@ -0,0 +1,62 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/Lineage.h>
+
+namespace cthulhu {
+
+LineageTable::LineageTable(size_t capacity) : capacity_(capacity) {}
+
+void LineageTable::record(
+    uint32_t streamIndex,
+    uint32_t sequenceNumber,
+    std::vector<LineageRecord> inputs) {
+  if (capacity_ == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto entryKey = key(streamIndex, sequenceNumber);
+  auto inserted = entries_.insert_or_assign(entryKey, std::move(inputs));
+  if (!inserted.second) {
+    // Sequence numbers restarted, so the entry is already in the eviction order
+    return;
+  }
+  order_.push_back(entryKey);
+  evict();
+}
+
+std::optional<std::vector<LineageRecord>> LineageTable::lookup(
+    uint32_t streamIndex,
+    uint32_t sequenceNumber) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key(streamIndex, sequenceNumber));
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void LineageTable::setCapacity(size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = capacity;
+  evict();
+}
+
+size_t LineageTable::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void LineageTable::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  order_.clear();
+}
+
+void LineageTable::evict() {
+  while (order_.size() > capacity_) {
+    entries_.erase(order_.front());
+    order_.pop_front();
+  }
+}
+
+} // namespace cthulhu
@@ -9,6 +9,8 @@
 
 #include <cthulhu/Framework.h>
 
+#include <cstring>
+
 #ifdef _WIN32
 #include <windows.h>
 #else
@@ -23,6 +25,13 @@ const char* const MEMORY_POOL_NAME = "MemoryPool";
 const char* const MEMORY_POOL_GPU_NAME = "MemoryPoolGPU";
 const char* const MEMORY_POOL_GPU_DEVICE_LOCAL_NAME = "MemoryPoolGPUDeviceLocal";
 const char* const AUDITOR_NAME = "Auditor";
+const char* const NUMA_MBIND_ENV_VAR = "CTHULHU_NUMA_MBIND";
+
+// Node 0 keeps the original name, so that single node systems are unaffected
+std::string poolName(int node) {
+  return node == 0 ? MEMORY_POOL_NAME
+                   : MEMORY_POOL_NAME + std::string("_numa") + std::to_string(node);
+}
 
 } // namespace
 
@@ -33,10 +42,14 @@ MemoryPoolIPCHybrid::MemoryPoolIPCHybrid(
     bool enableAuditor)
     : shmSize_(shmSize),
       shmGPUSize_(shmGPUSize),
-      memoryPool_(new MemoryPool()),
+      memoryPools_(createNodePools()),
       shm_(shm),
       stopSignal_{false} {
-  pool_ = shm_->find_or_construct<MemoryPoolIPC>(MEMORY_POOL_NAME)(shm_->get_segment_manager());
+  for (int node = 0; node < Numa::numNodes(); ++node) {
+    pools_.push_back(shm_->find_or_construct<MemoryPoolIPC>(poolName(node).c_str())(
+        shm_->get_segment_manager()));
+  }
+  bindShared_ = pools_.size() > 1 && std::getenv(NUMA_MBIND_ENV_VAR) != nullptr;
   poolGPU_ =
       shm_->find_or_construct<MemoryPoolIPC>(MEMORY_POOL_GPU_NAME)(shm_->get_segment_manager());
   poolGPUDeviceLocal_ = shm_->find_or_construct<MemoryPoolIPC>(MEMORY_POOL_GPU_DEVICE_LOCAL_NAME)(
@@ -51,6 +64,7 @@ MemoryPoolIPCHybrid::MemoryPoolIPCHybrid(
     auditor_->processes.emplace_back();
     if (enableAuditor) {
       auditorThread_ = std::thread([this]() {
+        Numa::applyThreadPlacement(ThreadRole::AUDITOR);
         while (!stopSignal_.load()) {
           std::this_thread::yield();
 
@@ -71,7 +85,9 @@ MemoryPoolIPCHybrid::MemoryPoolIPCHybrid(
 }
 
 bool MemoryPoolIPCHybrid::nuke(ManagedSHM* shm) {
-  shm->destroy<MemoryPoolIPC>(MEMORY_POOL_NAME);
+  for (int node = 0; node < Numa::numNodes(); ++node) {
+    shm->destroy<MemoryPoolIPC>(poolName(node).c_str());
+  }
   shm->destroy<MemoryPoolIPC>(MEMORY_POOL_GPU_NAME);
   shm->destroy<MemoryPoolIPC>(MEMORY_POOL_GPU_DEVICE_LOCAL_NAME);
   shm->destroy<AuditorIPC>(AUDITOR_NAME);
@@ -128,18 +144,20 @@ MemoryPoolIPCHybrid::~MemoryPoolIPCHybrid() {
     invalidate();
 
     // CPU Cleanup
-    ScopedLockIPC lock1(pool_->buffers_mutex);
-    ScopedLockIPC lock2(pool_->sizes_mutex);
-    for (auto& size : pool_->sizes) {
-      pool_->allocated -= size.second;
-    }
-    for (auto& buffers : pool_->buffers) {
-      for (auto& buffer : buffers.second) {
-        shm_->destroy_ptr(shm_->get_address_from_handle(buffer));
+    for (auto& pool : pools_) {
+      ScopedLockIPC lock1(pool->buffers_mutex);
+      ScopedLockIPC lock2(pool->sizes_mutex);
+      for (auto& size : pool->sizes) {
+        pool->allocated -= size.second;
+      }
+      for (auto& buffers : pool->buffers) {
+        for (auto& buffer : buffers.second) {
+          shm_->deallocate(shm_->get_address_from_handle(buffer));
+        }
       }
+      pool->buffers.clear();
+      pool->sizes.clear();
     }
-    pool_->buffers.clear();
-    pool_->sizes.clear();
   }
 
   // Release local GPU handle caches
@@ -161,20 +179,39 @@ MemoryPoolIPCHybrid::~MemoryPoolIPCHybrid() {
   }
 }
 
-CpuBuffer MemoryPoolIPCHybrid::getBufferFromPool(const StreamIDView& id, size_t nrBytes) {
-  if ((activatedStreams_.find(id) == activatedStreams_.end()) ||
-      (activatedStreams_.find(id) != activatedStreams_.end() && activatedStreams_[id])) {
-    auto shm = requestSHM(nrBytes);
+CpuBuffer MemoryPoolIPCHybrid::getBufferFromPool(StreamHandle handle, size_t nrBytes) {
+  const int node = placement_.nodeFor(handle);
+  if (usesSharedMemory(handle)) {
+    auto shm = requestSHM(nrBytes, node);
     if (!shm) {
       XR_LOGE_EVERY_N(
           100,
           "MemoryPoolIPCHybrid - Failed to get shared memory buffer for [{}] bytes. Allocated locally.",
           nrBytes);
-      return memoryPool_->request(nrBytes);
+      return memoryPools_[node]->request(nrBytes);
     }
     return shm;
   }
-  return memoryPool_->request(nrBytes);
+  return memoryPools_[node]->request(nrBytes);
+}
+
+void MemoryPoolIPCHybrid::setStreamNumaNode(StreamHandle handle, int node) {
+  placement_.setStreamNode(handle, node);
+}
+
+void MemoryPoolIPCHybrid::setSharedMemoryPolicy(StreamHandle handle, SharedMemoryPolicy policy) {
+  auto* activation = activations_.at(handle);
+  if (activation) {
+    activation->policy.store(policy, std::memory_order_relaxed);
+  }
+}
+
+size_t MemoryPoolIPCHybrid::sharedBytesAllocated() const {
+  size_t allocated = 0;
+  for (const auto& pool : pools_) {
+    allocated += pool->allocated;
+  }
+  return allocated;
 }
 
 bool MemoryPoolIPCHybrid::findBuffer(
@@ -289,16 +326,17 @@ GpuBuffer MemoryPoolIPCHybrid::getGpuBufferFromPool(size_t nrBytes, bool deviceL
       deviceLocal ? CpuBuffer() : gpuMappedBuffers_[ptr->first.handle]);
 }
 
-CpuBuffer MemoryPoolIPCHybrid::requestSHM(size_t nrBytes) {
+CpuBuffer MemoryPoolIPCHybrid::requestSHM(size_t nrBytes, int node) {
+  auto& pool = pools_[node];
   std::ptrdiff_t offset_ptr = 0;
   uint8_t* ptr = nullptr;
 
   // Check to see if we already have a buffer of this size
   {
-    ScopedLockIPC lock(pool_->buffers_mutex);
-    auto buffer_it = pool_->buffers.find(nrBytes);
-    if (buffer_it == pool_->buffers.cend()) {
-      buffer_it = pool_->buffers
+    ScopedLockIPC lock(pool->buffers_mutex);
+    auto buffer_it = pool->buffers.find(nrBytes);
+    if (buffer_it == pool->buffers.cend()) {
+      buffer_it = pool->buffers
                       .emplace(
                           nrBytes,
                           MemoryPoolIPC::PtrVectorType(
@@ -316,23 +354,18 @@ CpuBuffer MemoryPoolIPCHybrid::requestSHM(size_t nrBytes) {
 
   // Make a new buffer if needed
   if (!ptr) {
-    ScopedLockIPC lock(pool_->sizes_mutex);
-    XR_LOGT_EVERY_N(100, "MemoryPoolIPCHybrid - Num shared bytes allocated: {}", pool_->allocated);
-    if (pool_->allocated + nrBytes < shmSize_ * MAX_SHM_USAGE_FRAC) {
-      ptr = shm_->construct<uint8_t>(boost::interprocess::anonymous_instance)[nrBytes]();
-      offset_ptr = shm_->get_handle_from_address(ptr);
-      pool_->allocated += nrBytes;
-      pool_->sizes.emplace(offset_ptr, nrBytes);
-    } else {
+    ptr = allocateSHM(nrBytes, node, offset_ptr);
+    if (!ptr) {
       return std::shared_ptr<uint8_t>();
     }
+    demandShared_ += nrBytes;
   }
 
   std::lock_guard<std::mutex> lock(memoryMutex_);
 
   // Construct the shared shared pointer
   SharedPtrIPC& buffer = *shm_->construct<SharedPtrIPC>(boost::interprocess::anonymous_instance)(
-      ptr, PtrAllocatorIPC(shm_->get_segment_manager()), ReclaimerIPC(pool_, offset_ptr));
+      ptr, PtrAllocatorIPC(shm_->get_segment_manager()), ReclaimerIPC(pool, offset_ptr));
 
   // Store the mapping to it
   ptrs_.emplace(ptr, buffer);
@@ -343,8 +376,120 @@ CpuBuffer MemoryPoolIPCHybrid::requestSHM(size_t nrBytes) {
   return CpuBuffer(ptr, [this](uint8_t* ptr) { this->destroyLocal(ptr); });
 }
 
-void MemoryPoolIPCHybrid::activateStream(const StreamIDView& streamID, bool active) {
-  activatedStreams_[streamID] = active;
+uint8_t* MemoryPoolIPCHybrid::allocateSHM(size_t nrBytes, int node, std::ptrdiff_t& offset_ptr) {
+  auto& pool = pools_[node];
+  ScopedLockIPC lock(pool->sizes_mutex);
+  const size_t allocated = sharedBytesAllocated();
+  XR_LOGT_EVERY_N(100, "MemoryPoolIPCHybrid - Num shared bytes allocated: {}", allocated);
+  if (allocated + nrBytes >= shmSize_ * MAX_SHM_USAGE_FRAC) {
+    return nullptr;
+  }
+  // Bind the buffer before zeroing it, so its pages are faulted in on the node they are bound to
+  uint8_t* ptr = static_cast<uint8_t*>(shm_->allocate(nrBytes));
+  if (bindShared_) {
+    Numa::bindMemory(ptr, nrBytes, node);
+  }
+  std::memset(ptr, 0, nrBytes);
+  offset_ptr = shm_->get_handle_from_address(ptr);
+  pool->allocated += nrBytes;
+  pool->sizes.emplace(offset_ptr, nrBytes);
+  return ptr;
+}
+
+size_t MemoryPoolIPCHybrid::warmPool(StreamHandle handle, size_t nrBytes, size_t count) {
+  const int node = placement_.nodeFor(handle);
+  if (!usesSharedMemory(handle)) {
+    return memoryPools_[node]->warm(nrBytes, count);
+  }
+
+  auto& pool = pools_[node];
+  size_t available = 0;
+  {
+    ScopedLockIPC lock(pool->buffers_mutex);
+    auto buffer_it = pool->buffers.find(nrBytes);
+    if (buffer_it != pool->buffers.end()) {
+      available = buffer_it->second.size();
+    }
+  }
+
+  std::vector<std::ptrdiff_t> warmed;
+  for (size_t idx = available; idx < count; ++idx) {
+    std::ptrdiff_t offset_ptr = 0;
+    if (!allocateSHM(nrBytes, node, offset_ptr)) {
+      XR_LOGW(
+          "MemoryPoolIPCHybrid - Shared memory exhausted while warming [{}] buffers of [{}] bytes",
+          count,
+          nrBytes);
+      break;
+    }
+    warmed.push_back(offset_ptr);
+  }
+
+  {
+    ScopedLockIPC lock(pool->buffers_mutex);
+    auto buffer_it = pool->buffers.find(nrBytes);
+    if (buffer_it == pool->buffers.cend()) {
+      buffer_it = pool->buffers
+                      .emplace(
+                          nrBytes,
+                          MemoryPoolIPC::PtrVectorType(
+                              MemoryPoolIPC::PtrVectorAllocType(shm_->get_segment_manager())))
+                      .first;
+    }
+    buffer_it->second.insert(buffer_it->second.end(), warmed.begin(), warmed.end());
+  }
+  warmedShared_ += warmed.size() * nrBytes;
+  return warmed.size() * nrBytes;
+}
+
+bool MemoryPoolIPCHybrid::lockMemory() {
+  bool success = true;
+  for (auto& pool : memoryPools_) {
+    success = pool->lock() && success;
+  }
+  // Locking the whole segment covers shared buffers allocated later too
+  if (lockRange(shm_->get_address(), shm_->get_size())) {
+    lockedShared_ = shm_->get_size();
+  } else {
+    XR_LOGW("MemoryPoolIPCHybrid - Failed to lock the shared memory segment into RAM");
+    success = false;
+  }
+  return success;
+}
+
+MemoryPoolStats MemoryPoolIPCHybrid::stats() const {
+  MemoryPoolStats total;
+  total.warmedBytes = warmedShared_;
+  total.demandBytes = demandShared_;
+  total.lockedBytes = lockedShared_;
+  total.promotedBuffers = promotedBuffers_;
+  total.promotedBytes = promotedBytes_;
+  for (const auto& pool : memoryPools_) {
+    const auto stats = pool->stats();
+    total.warmedBytes += stats.warmedBytes;
+    total.demandBytes += stats.demandBytes;
+    total.lockedBytes += stats.lockedBytes;
+  }
+  return total;
+}
+
+bool MemoryPoolIPCHybrid::usesSharedMemory(StreamHandle handle) const {
+  const auto* activation = activations_.find(handle);
+  if (!activation) {
+    return true;
+  }
+  switch (activation->policy.load(std::memory_order_relaxed)) {
+    case SharedMemoryPolicy::ALWAYS_SHARED:
+      return true;
+    case SharedMemoryPolicy::ALWAYS_LOCAL:
+      return false;
+    default:
+      return activation->shared.load(std::memory_order_acquire);
+  }
+}
+
+StreamActivation* MemoryPoolIPCHybrid::activation(StreamHandle handle) {
+  return activations_.at(handle);
 }
 
 SharedPtrIPC MemoryPoolIPCHybrid::convert(const CpuBuffer& ptr) const {
@@ -441,7 +586,21 @@ void MemoryPoolIPCHybrid::destroyLocal(GpuBufferData* handlePtr) {
 }
 
 SharedPtrIPC MemoryPoolIPCHybrid::getBufferFromSharedPoolDirect(size_t nrBytes) {
-  return convert(requestSHM(nrBytes));
+  return convert(requestSHM(nrBytes, Numa::currentNode()));
+}
+
+SharedPtrIPC MemoryPoolIPCHybrid::promote(const CpuBuffer& ptr, size_t nrBytes) {
+  auto shared = convert(ptr);
+  if (shared || !ptr) {
+    return shared;
+  }
+  shared = getBufferFromSharedPoolDirect(nrBytes);
+  if (shared) {
+    std::memcpy(shared.get().get(), ptr.get(), nrBytes);
+    promotedBuffers_++;
+    promotedBytes_ += nrBytes;
+  }
+  return shared;
 }
 
 bool MemoryPoolIPCHybrid::isBufferFromPool(const AnyBuffer& buf) const {
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 
@@ -9,6 +10,7 @@
 #include "MemoryPoolIPC.h"
 
 #include <cthulhu/MemoryPoolInterface.h>
+#include <cthulhu/Numa.h>
 #include <cthulhu/VulkanUtil.h>
 
 namespace cthulhu {
@@ -16,12 +18,37 @@ namespace cthulhu {
 class MemoryPool;
 struct MemoryPoolIPC;
 
+// Whether the buffers of a stream are allocated from shared memory. It is owned by the stream,
+// which updates it as IPC subscribers come and go, and read by the pool on every allocation of the
+// stream, so it is a lock-free flag rather than state guarded by the pool.
+struct StreamActivation {
+  // Whether an ADAPTIVE stream allocates from shared memory. Slots of handles that aren't streams,
+  // like the empty StreamID used for scratch buffers, stay shared.
+  std::atomic<bool> shared{true};
+  std::atomic<SharedMemoryPolicy> policy{SharedMemoryPolicy::ADAPTIVE};
+};
+
 class MemoryPoolIPCHybrid : public MemoryPoolInterface {
  public:
   MemoryPoolIPCHybrid(ManagedSHM* shm, size_t shmSize, size_t shmGPUSize, bool enableAuditor);
   virtual ~MemoryPoolIPCHybrid();
 
-  virtual CpuBuffer getBufferFromPool(const StreamIDView& id, size_t nrBytes) override;
+  using MemoryPoolInterface::getBufferFromPool;
+  using MemoryPoolInterface::setSharedMemoryPolicy;
+  using MemoryPoolInterface::setStreamNumaNode;
+  using MemoryPoolInterface::warmPool;
+
+  virtual CpuBuffer getBufferFromPool(StreamHandle handle, size_t nrBytes) override;
+
+  virtual void setStreamNumaNode(StreamHandle handle, int node) override;
+
+  virtual void setSharedMemoryPolicy(StreamHandle handle, SharedMemoryPolicy policy) override;
+
+  virtual size_t warmPool(StreamHandle handle, size_t nrBytes, size_t count) override;
+
+  virtual bool lockMemory() override;
+
+  virtual MemoryPoolStats stats() const override;
 
   virtual GpuBuffer getGpuBufferFromPool(size_t nrBytes, bool deviceLocal) override;
 
@@ -32,12 +59,18 @@ class MemoryPoolIPCHybrid : public MemoryPoolInterface {
   SharedPtrIPC convert(const CpuBuffer& ptr) const;
   SharedPtrGPUIPC convert(const GpuBuffer& ptr) const;
 
+  // Gets the shared buffer to send a buffer of nrBytes to other processes: the buffer itself if it
+  // came from shared memory, or else a copy of it in shared memory, which is counted as a
+  // promotion. Returns null if shared memory is exhausted.
+  SharedPtrIPC promote(const CpuBuffer& ptr, size_t nrBytes);
+
   CpuBuffer createLocal(const SharedPtrIPC& buffer);
   GpuBuffer createLocal(const SharedPtrGPUIPC& buffer);
 
-  // Toggles whether a particular stream will actively allocate data from shared memory
-  // for IPC. If false, it will use local memory buffers.
-  void activateStream(const StreamIDView& streamID, bool active);
+  // The activation of a stream, which decides whether getBufferFromPool allocates its buffers from
+  // shared memory (unless it is exhausted) or local memory. Stays valid for the lifetime of the
+  // pool. Returns nullptr if the handle is past the capacity of the pool.
+  StreamActivation* activation(StreamHandle handle);
 
   SharedPtrIPC getBufferFromSharedPoolDirect(size_t nrBytes);
 
@@ -76,11 +109,24 @@ class MemoryPoolIPCHybrid : public MemoryPoolInterface {
       std::ptrdiff_t& offset_ptr_out,
       GpuBufferDataWithPID*& ptr_out);
 
-  CpuBuffer requestSHM(size_t nrBytes);
+  CpuBuffer requestSHM(size_t nrBytes, int node);
+
+  // Allocates a new buffer in the shared pool of the node, or returns null if the shared memory
+  // usage limit would be exceeded
+  uint8_t* allocateSHM(size_t nrBytes, int node, std::ptrdiff_t& offset_ptr);
+
+  // Whether buffers of the stream are allocated from shared memory, see activation
+  bool usesSharedMemory(StreamHandle handle) const;
+
+  // Shared bytes allocated across the pools of all nodes
+  size_t sharedBytesAllocated() const;
 
   boost::interprocess::offset_ptr<bool> killSignal_;
 
-  boost::interprocess::offset_ptr<MemoryPoolIPC> pool_;
+  // Shared memory pools, one per NUMA node
+  std::vector<boost::interprocess::offset_ptr<MemoryPoolIPC>> pools_;
+  // Whether new shared buffers are bound to the node of their pool (CTHULHU_NUMA_MBIND)
+  bool bindShared_;
   std::unordered_map<uint8_t*, SharedPtrIPC> ptrs_;
 
   boost::interprocess::offset_ptr<MemoryPoolIPC> poolGPU_;
@@ -92,12 +138,19 @@ class MemoryPoolIPCHybrid : public MemoryPoolInterface {
   size_t shmSize_;
   uint64_t shmGPUSize_;
 
-  std::unique_ptr<MemoryPool> memoryPool_;
+  std::vector<std::unique_ptr<MemoryPool>> memoryPools_;
+  NumaPlacement placement_;
   mutable std::mutex memoryMutex_;
 
   ManagedSHM* shm_;
 
-  std::map<StreamIDView, bool> activatedStreams_;
+  StreamHandleTable<StreamActivation> activations_;
+
+  std::atomic<size_t> warmedShared_{0};
+  std::atomic<size_t> demandShared_{0};
+  std::atomic<size_t> lockedShared_{0};
+  std::atomic<size_t> promotedBuffers_{0};
+  std::atomic<size_t> promotedBytes_{0};
 
   // The auditor shared object and associated local data.
   // This should be moved out of memory pool and into its own object
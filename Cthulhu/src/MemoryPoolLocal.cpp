@@ -10,7 +10,7 @@
 namespace cthulhu {
 
 MemoryPoolLocal::MemoryPoolLocal()
-    : memoryPool_(new MemoryPool()), allocatedGPU_(0), allocatedMaxGPU_(500 * 1024 * 1024) {
+    : memoryPools_(createNodePools()), allocatedGPU_(0), allocatedMaxGPU_(500 * 1024 * 1024) {
   vulkanUtil_.reset(new VulkanUtil());
 }
 
@@ -23,10 +23,37 @@ MemoryPoolLocal::~MemoryPoolLocal() {
   }
 }
 
-CpuBuffer MemoryPoolLocal::getBufferFromPool(const StreamIDView& id, size_t nrBytes) {
-  return memoryPool_->request(nrBytes);
+CpuBuffer MemoryPoolLocal::getBufferFromPool(StreamHandle handle, size_t nrBytes) {
+  return memoryPools_[placement_.nodeFor(handle)]->request(nrBytes);
 };
 
+void MemoryPoolLocal::setStreamNumaNode(StreamHandle handle, int node) {
+  placement_.setStreamNode(handle, node);
+}
+
+size_t MemoryPoolLocal::warmPool(StreamHandle handle, size_t nrBytes, size_t count) {
+  return memoryPools_[placement_.nodeFor(handle)]->warm(nrBytes, count);
+}
+
+bool MemoryPoolLocal::lockMemory() {
+  bool success = true;
+  for (auto& pool : memoryPools_) {
+    success = pool->lock() && success;
+  }
+  return success;
+}
+
+MemoryPoolStats MemoryPoolLocal::stats() const {
+  MemoryPoolStats total;
+  for (const auto& pool : memoryPools_) {
+    const auto stats = pool->stats();
+    total.warmedBytes += stats.warmedBytes;
+    total.demandBytes += stats.demandBytes;
+    total.lockedBytes += stats.lockedBytes;
+  }
+  return total;
+}
+
 GpuBuffer MemoryPoolLocal::getGpuBufferFromPool(size_t nrBytes, bool deviceLocal) {
   if (!vulkanUtil_->isActive()) {
     XR_LOGW("Failed to generate GPU Buffer. Vulkan is not active.");
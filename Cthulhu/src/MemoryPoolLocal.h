@@ -5,6 +5,7 @@
 #include <mutex>
 
 #include <cthulhu/MemoryPoolInterface.h>
+#include <cthulhu/Numa.h>
 #include <cthulhu/VulkanUtil.h>
 
 namespace cthulhu {
@@ -16,7 +17,18 @@ class MemoryPoolLocal : public MemoryPoolInterface {
   MemoryPoolLocal();
   virtual ~MemoryPoolLocal();
 
-  virtual CpuBuffer getBufferFromPool(const StreamIDView& id, size_t nrBytes) override;
+  using MemoryPoolInterface::getBufferFromPool;
+  using MemoryPoolInterface::setSharedMemoryPolicy;
+  using MemoryPoolInterface::setStreamNumaNode;
+  using MemoryPoolInterface::warmPool;
+
+  virtual CpuBuffer getBufferFromPool(StreamHandle handle, size_t nrBytes) override;
+  virtual void setStreamNumaNode(StreamHandle handle, int node) override;
+  // All buffers are local
+  virtual void setSharedMemoryPolicy(StreamHandle, SharedMemoryPolicy) override {}
+  virtual size_t warmPool(StreamHandle handle, size_t nrBytes, size_t count) override;
+  virtual bool lockMemory() override;
+  virtual MemoryPoolStats stats() const override;
   virtual GpuBuffer getGpuBufferFromPool(size_t nrBytes, bool device_local) override;
   virtual bool isBufferFromPool(const AnyBuffer& buf) const override;
 
@@ -38,8 +50,9 @@ class MemoryPoolLocal : public MemoryPoolInterface {
 
   GpuBuffer createGpuBuffer(const GpuBufferData& data);
 
-  // CPU Memory Pool
-  std::unique_ptr<MemoryPool> memoryPool_;
+  // CPU Memory Pools, one per NUMA node
+  std::vector<std::unique_ptr<MemoryPool>> memoryPools_;
+  NumaPlacement placement_;
 
   // GPU Memory Pool
   std::unique_ptr<VulkanUtil> vulkanUtil_;
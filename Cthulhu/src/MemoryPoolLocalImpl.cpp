@@ -2,8 +2,26 @@
 
 #include "MemoryPoolLocalImpl.h"
 
+#include <cthulhu/Numa.h>
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
 namespace cthulhu {
 
+bool lockRange(void* address, size_t length) {
+#ifdef _WIN32
+  return VirtualLock(address, length) != 0;
+#else
+  return mlock(address, length) == 0;
+#endif
+}
+
 MemoryPool::Reclaimer::Reclaimer(MemoryPool* _host, const std::shared_ptr<void>& _sentinel)
     : host(_host), sentinel(_sentinel) {}
 
@@ -55,22 +73,96 @@ std::shared_ptr<MemoryPool::ByteType> MemoryPool::request(size_t nrBytes) {
   // table is updated accordingly.
 
   if (!ptr) {
-    if (allocated_ + nrBytes > allocatedMax_)
+    if (*budget_ + nrBytes > allocatedMax_)
       shrink();
-    if (allocated_ + nrBytes <= allocatedMax_) {
-      if ((ptr = new (std::nothrow) MemoryPool::ByteType[nrBytes]{0})) {
-        allocated_ += nrBytes;
-        {
-          std::lock_guard<std::mutex> lock(sizesMutex_);
-          sizes_.emplace(reinterpret_cast<uintptr_t>(ptr), nrBytes);
-        }
-      }
+    if ((ptr = allocate(nrBytes))) {
+      demand_ += nrBytes;
     }
   }
 
   return std::shared_ptr<ByteType>(static_cast<ByteType*>(ptr), Reclaimer(this, sentinel_));
 }
 
+void* MemoryPool::allocate(size_t nrBytes) {
+  if (*budget_ + nrBytes > allocatedMax_) {
+    return nullptr;
+  }
+  // Bind the memory before it is first touched, so that its pages are placed on the node. Zeroing
+  // it then faults all of its pages in.
+  void* ptr = new (std::nothrow) MemoryPool::ByteType[nrBytes];
+  if (!ptr) {
+    return nullptr;
+  }
+  if (numaNode_ >= 0) {
+    Numa::bindMemory(ptr, nrBytes, numaNode_);
+  }
+  std::memset(ptr, 0, nrBytes);
+  allocated_ += nrBytes;
+  *budget_ += nrBytes;
+  {
+    // Checking locked_ under the mutex makes sure that an area is either locked here or by lock()
+    std::lock_guard<std::mutex> lock(areasMutex_);
+    const bool locked = locked_ && lockRange(ptr, nrBytes);
+    if (locked) {
+      lockedBytes_ += nrBytes;
+    }
+    areas_.emplace(reinterpret_cast<uintptr_t>(ptr), Area{nrBytes, locked});
+  }
+  return ptr;
+}
+
+size_t MemoryPool::warm(size_t nrBytes, size_t count) {
+  size_t available = 0;
+  {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    available = store_[nrBytes].size();
+  }
+
+  std::vector<void*> warmed;
+  for (size_t idx = available; idx < count; ++idx) {
+    void* ptr = allocate(nrBytes);
+    if (!ptr) {
+      break;
+    }
+    warmed.push_back(ptr);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    auto& ptrlist = store_[nrBytes];
+    ptrlist.insert(ptrlist.end(), warmed.begin(), warmed.end());
+  }
+  warmed_ += warmed.size() * nrBytes;
+  return warmed.size() * nrBytes;
+}
+
+bool MemoryPool::lock() {
+  bool success = true;
+  std::lock_guard<std::mutex> lock(areasMutex_);
+  locked_ = true;
+  // Areas that failed to lock before are retried, e.g. after RLIMIT_MEMLOCK was raised
+  for (auto& area : areas_) {
+    if (area.second.locked) {
+      continue;
+    }
+    if (lockRange(reinterpret_cast<void*>(area.first), area.second.size)) {
+      area.second.locked = true;
+      lockedBytes_ += area.second.size;
+    } else {
+      success = false;
+    }
+  }
+  return success;
+}
+
+MemoryPoolStats MemoryPool::stats() const {
+  MemoryPoolStats stats;
+  stats.warmedBytes = warmed_;
+  stats.demandBytes = demand_;
+  stats.lockedBytes = lockedBytes_;
+  return stats;
+}
+
 void MemoryPool::reclaim(void* ptr) {
   // This method is called from the reclaimer to recycle the pointer
   // (and its associated memory space, of course) to the memory pool.
@@ -78,10 +170,10 @@ void MemoryPool::reclaim(void* ptr) {
 
   size_t size = 0;
   {
-    std::lock_guard<std::mutex> lock(sizesMutex_);
-    const auto it = sizes_.find(reinterpret_cast<uintptr_t>(ptr));
-    if (it != sizes_.cend())
-      size = it->second;
+    std::lock_guard<std::mutex> lock(areasMutex_);
+    const auto it = areas_.find(reinterpret_cast<uintptr_t>(ptr));
+    if (it != areas_.cend())
+      size = it->second.size;
   }
   {
     std::lock_guard<std::mutex> lock(storeMutex_);
@@ -100,26 +192,35 @@ size_t MemoryPool::shrink() {
   // To avoid holding the mutex for an excessive amount of time, we first swap
   // the content of the memory pool with some local container; this means that
   // any operation on the previous memory pool will be on the local object that
-  // is not subject to thread-safety considerations. Also, a list of memory areas
-  // to be deallocated is maintained for deferred maintenance of the size table.
+  // is not subject to thread-safety considerations. The areas are removed from the
+  // area table before they are deallocated, so that an area allocated at a freed
+  // address can't collide with a stale entry.
+
+  {
+    std::lock_guard<std::mutex> lock(areasMutex_);
+    for (const auto& pair : empty) {
+      for (const auto& ptr : pair.second) {
+        const auto it = areas_.find(reinterpret_cast<uintptr_t>(ptr));
+        if (it == areas_.end())
+          continue;
+        if (it->second.locked) {
+          lockedBytes_ -= it->second.size;
+        }
+        areas_.erase(it);
+      }
+    }
+  }
 
-  std::vector<uintptr_t> to_deallocate;
   for (auto& pair : empty) {
     for (auto& ptr : pair.second) {
-      to_deallocate.push_back(reinterpret_cast<uintptr_t>(ptr));
       delete[] static_cast<MemoryPool::ByteType*>(ptr);
 
       allocated_ -= pair.first;
+      *budget_ -= pair.first;
       shrinked += pair.first;
     }
   }
 
-  {
-    std::lock_guard<std::mutex> lock(sizesMutex_);
-    for (const auto& address : to_deallocate)
-      sizes_.erase(address);
-  }
-
   return shrinked;
 }
 
@@ -131,7 +232,29 @@ MemoryPool::~MemoryPool() {
   shrink();
 }
 
-MemoryPool::MemoryPool(size_t allocatedMax)
-    : allocated_(0), allocatedMax_(allocatedMax), sentinel_(new size_t) {}
+MemoryPool::MemoryPool(
+    size_t allocatedMax,
+    int numaNode,
+    std::shared_ptr<std::atomic<size_t>> budget)
+    : allocated_(0),
+      allocatedMax_(allocatedMax),
+      budget_(budget ? std::move(budget) : std::make_shared<std::atomic<size_t>>(0)),
+      numaNode_(numaNode),
+      sentinel_(new size_t) {}
+
+std::vector<std::unique_ptr<MemoryPool>> createNodePools(size_t allocatedMax) {
+  std::vector<std::unique_ptr<MemoryPool>> pools;
+  const int nodes = Numa::numNodes();
+  if (nodes == 1) {
+    pools.push_back(std::make_unique<MemoryPool>(allocatedMax));
+  } else {
+    // One budget, so that spreading the pools across nodes doesn't multiply the process's limit
+    auto budget = std::make_shared<std::atomic<size_t>>(0);
+    for (int node = 0; node < nodes; ++node) {
+      pools.push_back(std::make_unique<MemoryPool>(allocatedMax, node, budget));
+    }
+  }
+  return pools;
+}
 
 } // namespace cthulhu
@@ -8,6 +8,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include <cthulhu/MemoryPoolInterface.h>
+
 namespace cthulhu {
 
 class MemoryPool {
@@ -27,12 +29,26 @@ class MemoryPool {
 
  public:
   static constexpr size_t ALLOCATED_MAX_BYTES = 1 << 30;
-  MemoryPool(size_t allocatedMax = ALLOCATED_MAX_BYTES);
+  // If numaNode is not negative, newly allocated memory is bound to that NUMA node. Pools given the
+  // same budget count their allocations against a single allocatedMax.
+  MemoryPool(
+      size_t allocatedMax = ALLOCATED_MAX_BYTES,
+      int numaNode = -1,
+      std::shared_ptr<std::atomic<size_t>> budget = nullptr);
   virtual ~MemoryPool();
 
   //! Request a memory area of the specified size from the memory pool.
   std::shared_ptr<ByteType> request(size_t nrBytes);
 
+  //! Make sure at least count free memory areas of the specified size are pooled. Returns the
+  //! number of bytes allocated to do so.
+  size_t warm(size_t nrBytes, size_t count);
+
+  //! Lock all the memory areas into RAM, including those allocated later.
+  bool lock();
+
+  MemoryPoolStats stats() const;
+
   //! Release all the memory areas that are allocated but not currently used.
   size_t shrink();
 
@@ -44,10 +60,24 @@ class MemoryPool {
   //! Reclaim a memory area back to the memory pool.
   void reclaim(void* ptr);
 
+  //! Allocate a new, pre-faulted memory area, or return null if the byte limit would be exceeded.
+  void* allocate(size_t nrBytes);
+
+  struct Area {
+    size_t size;
+    bool locked; //!< Whether the area was successfully locked into RAM.
+  };
+
   std::atomic<size_t> allocated_;
   std::atomic<size_t> allocatedMax_;
-  std::mutex storeMutex_, sizesMutex_;
-  std::unordered_map<uintptr_t, size_t> sizes_;
+  std::shared_ptr<std::atomic<size_t>> budget_; // The bytes allocated by the pools sharing it
+  const int numaNode_;
+  std::atomic<bool> locked_{false};
+  std::atomic<size_t> warmed_{0};
+  std::atomic<size_t> demand_{0};
+  std::atomic<size_t> lockedBytes_{0}; // The sum of the sizes of the locked areas
+  std::mutex storeMutex_, areasMutex_;
+  std::unordered_map<uintptr_t, Area> areas_;
   std::unordered_map<size_t, std::vector<void*>> store_;
   std::shared_ptr<void> sentinel_;
   // The reclaimer maintains a weak reference to this sentinel. The deletion
@@ -55,4 +85,12 @@ class MemoryPool {
   // invoke the reclaim method in this instance anymore.
 };
 
+// Locks the pages of [address, address + length) into RAM
+bool lockRange(void* address, size_t length);
+
+// Creates one pool per NUMA node, sharing allocatedMax, or a single unbound pool if the system has
+// only one node
+std::vector<std::unique_ptr<MemoryPool>> createNodePools(
+    size_t allocatedMax = MemoryPool::ALLOCATED_MAX_BYTES);
+
 } // namespace cthulhu
@@ -0,0 +1,799 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/NetworkBridge.h>
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+#include <cthulhu/Framework.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+namespace cthulhu {
+
+namespace {
+
+using bridge::FrameHeader;
+using bridge::RecordHeader;
+using bridge::RecordKind;
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+#ifdef IOV_MAX
+const size_t MAX_IOVECS = IOV_MAX;
+#else
+const size_t MAX_IOVECS = 1024;
+#endif
+
+// Largest UDP payload over IPv4
+const size_t MAX_DATAGRAM_BYTES = 65507;
+// Frames claiming to be larger than this are taken as a corrupt stream
+const size_t MAX_FRAME_BYTES = 256 * 1024 * 1024;
+const size_t RECEIVE_CHUNK_BYTES = 256 * 1024;
+const auto RECONNECT_INTERVAL = std::chrono::milliseconds(100);
+const auto REANNOUNCE_INTERVAL = std::chrono::seconds(1);
+const int POLL_TIMEOUT_MILLISECONDS = 50;
+
+int socketType(BridgeTransport transport) {
+  return transport == BridgeTransport::UDP ? SOCK_DGRAM : SOCK_STREAM;
+}
+
+void configureSocket(int socket, BridgeTransport transport) {
+  int one = 1;
+  if (transport == BridgeTransport::TCP) {
+    // Frames are batched already
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+#ifdef SO_NOSIGPIPE
+  setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+// Writes all of the given buffers, resuming after partial writes
+bool writeAll(int socket, std::vector<iovec>& iovecs) {
+  size_t first = 0;
+  while (first < iovecs.size()) {
+    msghdr message{};
+    message.msg_iov = &iovecs[first];
+    message.msg_iovlen = std::min(iovecs.size() - first, MAX_IOVECS);
+    ssize_t written = sendmsg(socket, &message, SEND_FLAGS);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    while (written > 0 && first < iovecs.size()) {
+      auto& iov = iovecs[first];
+      if (static_cast<size_t>(written) >= iov.iov_len) {
+        written -= iov.iov_len;
+        ++first;
+      } else {
+        iov.iov_base = static_cast<uint8_t*>(iov.iov_base) + written;
+        iov.iov_len -= written;
+        written = 0;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& body, const T& value) {
+  const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+  body.insert(body.end(), bytes, bytes + sizeof(T));
+}
+
+void appendString(std::vector<uint8_t>& body, const std::string& value) {
+  append(body, static_cast<uint16_t>(value.size()));
+  body.insert(body.end(), value.begin(), value.end());
+}
+
+template <typename T>
+bool read(const uint8_t* body, size_t length, size_t& offset, T& value) {
+  if (offset + sizeof(T) > length) {
+    return false;
+  }
+  std::memcpy(&value, body + offset, sizeof(T));
+  offset += sizeof(T);
+  return true;
+}
+
+bool readString(const uint8_t* body, size_t length, size_t& offset, std::string& value) {
+  uint16_t size;
+  if (!read(body, length, offset, size) || offset + size > length) {
+    return false;
+  }
+  value.assign(reinterpret_cast<const char*>(body + offset), size);
+  offset += size;
+  return true;
+}
+
+std::string peerName(const sockaddr_storage& address) {
+  char host[NI_MAXHOST];
+  char service[NI_MAXSERV];
+  if (getnameinfo(
+          reinterpret_cast<const sockaddr*>(&address),
+          sizeof(address),
+          host,
+          sizeof(host),
+          service,
+          sizeof(service),
+          NI_NUMERICHOST | NI_NUMERICSERV) != 0) {
+    return "unknown";
+  }
+  return std::string(host) + ":" + service;
+}
+
+} // namespace
+
+BridgeSender::BridgeSender(const std::string& host, uint16_t port, const BridgeOptions& options)
+    : host_(host), port_(port), options_(options) {
+  if (options_.transport == BridgeTransport::UDP) {
+    options_.maxFrameBytes = std::min(options_.maxFrameBytes, MAX_DATAGRAM_BYTES);
+  }
+  if (options_.compress) {
+    encoders_ = std::make_unique<CodecPool>(options_.encoderThreads);
+  }
+  thread_ = std::thread([this]() { run(); });
+}
+
+BridgeSender::~BridgeSender() {
+  // Unhook the consumers first, so that no callback runs into a stopped sender
+  for (auto& channel : channels_) {
+    channel->consumer.reset();
+  }
+  // Finishes the samples being encoded
+  encoders_.reset();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  pending_.notify_all();
+  thread_.join();
+  std::lock_guard<std::mutex> lock(mutex_);
+  disconnect();
+}
+
+bool BridgeSender::mirror(const StreamID& id) {
+  auto si = Framework::instance().streamRegistry()->getStream(id);
+  if (!si) {
+    XR_LOGE("Can't mirror stream {}, it isn't registered", id);
+    return false;
+  }
+  auto typeInfo = Framework::instance().typeRegistry()->findTypeID(si->description().type());
+  if (!typeInfo) {
+    XR_LOGE("Can't mirror stream {}, its type isn't registered", id);
+    return false;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (const auto& channel : channels_) {
+    if (channel->id == id) {
+      XR_LOGW("Stream {} is already mirrored", id);
+      return false;
+    }
+  }
+  if (channels_.size() > UINT16_MAX) {
+    XR_LOGE("Can't mirror stream {}, too many streams are mirrored", id);
+    return false;
+  }
+  const auto index = static_cast<uint16_t>(channels_.size());
+  channels_.push_back(std::make_unique<Channel>(
+      Channel{id, typeInfo->typeName(), typeChecksum(*typeInfo), std::nullopt, nullptr}));
+  auto& channel = *channels_.back();
+  lock.unlock();
+
+  // Hooking the consumer delivers the current config, if any, so it must not hold the lock
+  channel.consumer = std::make_unique<StreamConsumer>(
+      si,
+      [this, index](const StreamSample& sample) { enqueueSample(index, sample); },
+      [this, index](const StreamConfig& config) -> bool {
+        enqueueConfig(index, config);
+        return true;
+      });
+  pending_.notify_all();
+  return true;
+}
+
+void BridgeSender::enqueueConfig(uint16_t channel, const StreamConfig& config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& state = *channels_[channel];
+  state.config = config;
+  if (encoders_) {
+    auto typeInfo = Framework::instance().typeRegistry()->findTypeName(state.typeName);
+    state.codec = typeInfo ? selectCodec(*typeInfo, config) : nullptr;
+  }
+  // Configs are sent again with the announcement, if this isn't announced yet
+  if (!connected() || channel >= announced_) {
+    return;
+  }
+  Record record{RecordHeader{0, channel, RecordKind::CONFIG, CodecType::NONE}};
+  record.body = serializeConfig(state.typeName, config);
+  if (encoders_) {
+    // Keeps the config behind the samples still being encoded with the previous one
+    encoders_->submit(channel, [this, record]() mutable {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (connected()) {
+        push(std::move(record));
+      }
+    });
+    return;
+  }
+  push(std::move(record));
+}
+
+void BridgeSender::enqueueSample(uint16_t channel, const StreamSample& sample) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!connected() || queuedBytes_ + encodingBytes_ >= options_.maxQueuedBytes) {
+    samplesDropped_++;
+    return;
+  }
+  auto& state = *channels_[channel];
+  if (state.codec && state.config) {
+    const StreamConfig config = *state.config;
+    const size_t size = static_cast<size_t>(config.sampleSizeInBytes) * sample.numberOfSubSamples;
+    encodingBytes_ += size;
+    auto codec = state.codec;
+    lock.unlock();
+    submitEncoding(channel, state, sample, config, std::move(codec), size);
+    return;
+  }
+
+  Record record{RecordHeader{0, channel, RecordKind::SAMPLE, CodecType::NONE}, sample};
+  const size_t size = gatherSample(
+      state.typeName,
+      record.sample,
+      state.config ? &*state.config : nullptr,
+      record.ranges,
+      record.body);
+  if (size == 0) {
+    samplesDropped_++;
+    return;
+  }
+  record.header.bodyBytes = size;
+  push(std::move(record));
+}
+
+void BridgeSender::submitEncoding(
+    uint16_t channel,
+    const Channel& channelState,
+    const StreamSample& sample,
+    const StreamConfig& config,
+    std::shared_ptr<const Codec> codec,
+    size_t size) {
+  // Channels are never removed or moved, only the vector of their pointers grows
+  const Channel* state = &channelState;
+  encoders_->submit(channel, [this, state, channel, sample, config, codec, size]() {
+    Record record{RecordHeader{0, channel, RecordKind::SAMPLE, codec->type()}};
+    record.body = encodeSample(state->typeName, sample, &config, *codec);
+    std::lock_guard<std::mutex> lock(mutex_);
+    encodingBytes_ -= size;
+    if (record.body.empty() || !connected()) {
+      samplesDropped_++;
+      return;
+    }
+    push(std::move(record));
+  });
+}
+
+void BridgeSender::push(Record&& record) {
+  if (record.ranges.empty()) {
+    record.ranges.push_back(SerializedRange{record.body.data(), record.body.size()});
+    record.header.bodyBytes = record.body.size();
+  }
+  record.queued = std::chrono::steady_clock::now();
+  queuedBytes_ += record.size();
+  queue_.push_back(std::move(record));
+  pending_.notify_one();
+}
+
+void BridgeSender::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    if (!connected()) {
+      lock.unlock();
+      const bool success = connect();
+      lock.lock();
+      if (!success) {
+        pending_.wait_for(lock, RECONNECT_INTERVAL, [this]() { return stop_; });
+        continue;
+      }
+      announced_ = 0;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (options_.transport == BridgeTransport::UDP && now - lastAnnounced_ > REANNOUNCE_INTERVAL) {
+      announced_ = 0;
+    }
+    if (announced_ < channels_.size()) {
+      announce(announced_);
+      lastAnnounced_ = now;
+    }
+
+    if (queue_.empty()) {
+      pending_.wait_for(lock, REANNOUNCE_INTERVAL, [this]() {
+        return stop_ || !queue_.empty() || announced_ < channels_.size();
+      });
+      continue;
+    }
+    if (queuedBytes_ < options_.maxFrameBytes) {
+      const auto deadline = queue_.front().queued +
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(options_.maxBatchDelay);
+      if (pending_.wait_until(lock, deadline, [this]() {
+            return stop_ || queuedBytes_ >= options_.maxFrameBytes ||
+                announced_ < channels_.size();
+          })) {
+        continue;
+      }
+    }
+
+    if (!sendFrame(lock)) {
+      XR_LOGW("Lost connection to bridge receiver at {}:{}, reconnecting", host_, port_);
+      disconnect();
+    }
+  }
+}
+
+bool BridgeSender::connect() {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = socketType(options_.transport);
+  addrinfo* addresses = nullptr;
+  if (getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &addresses) != 0) {
+    XR_LOGE_ONCE("Failed to resolve bridge receiver address {}", host_);
+    return false;
+  }
+  int connectedSocket = -1;
+  for (auto address = addresses; address != nullptr; address = address->ai_next) {
+    int candidate = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (candidate < 0) {
+      continue;
+    }
+    if (::connect(candidate, address->ai_addr, address->ai_addrlen) == 0) {
+      connectedSocket = candidate;
+      break;
+    }
+    close(candidate);
+  }
+  freeaddrinfo(addresses);
+  if (connectedSocket < 0) {
+    return false;
+  }
+  configureSocket(connectedSocket, options_.transport);
+  socket_ = connectedSocket;
+  XR_LOGI("Connected to bridge receiver at {}:{}", host_, port_);
+  return true;
+}
+
+void BridgeSender::disconnect() {
+  const int previous = socket_.exchange(-1);
+  if (previous >= 0) {
+    close(previous);
+  }
+  for (const auto& record : queue_) {
+    if (record.header.kind == RecordKind::SAMPLE) {
+      samplesDropped_++;
+    }
+  }
+  queue_.clear();
+  queuedBytes_ = 0;
+}
+
+void BridgeSender::announce(size_t firstChannel) {
+  std::deque<Record> records;
+  const auto now = std::chrono::steady_clock::now();
+  for (size_t index = firstChannel; index < channels_.size(); ++index) {
+    const auto& channel = *channels_[index];
+    const auto channelIndex = static_cast<uint16_t>(index);
+    Record announcement{RecordHeader{0, channelIndex, RecordKind::ANNOUNCE, CodecType::NONE}};
+    append(announcement.body, static_cast<int32_t>(channel.checksum));
+    appendString(announcement.body, channel.id);
+    appendString(announcement.body, channel.typeName);
+    records.push_back(std::move(announcement));
+
+    if (channel.config) {
+      Record config{RecordHeader{0, channelIndex, RecordKind::CONFIG, CodecType::NONE}};
+      config.body = serializeConfig(channel.typeName, *channel.config);
+      records.push_back(std::move(config));
+    }
+  }
+  // Announcements go ahead of the samples already queued for these channels
+  for (auto record = records.rbegin(); record != records.rend(); ++record) {
+    record->ranges.push_back(SerializedRange{record->body.data(), record->body.size()});
+    record->header.bodyBytes = record->body.size();
+    record->queued = now;
+    queuedBytes_ += record->size();
+    queue_.push_front(std::move(*record));
+  }
+  announced_ = channels_.size();
+}
+
+bool BridgeSender::sendFrame(std::unique_lock<std::mutex>& lock) {
+  std::vector<Record> frame;
+  size_t frameBytes = sizeof(FrameHeader);
+  size_t numIovecs = 1;
+  while (!queue_.empty() && frame.size() < UINT16_MAX) {
+    auto& record = queue_.front();
+    const size_t recordIovecs = 1 + record.ranges.size();
+    if (!frame.empty() &&
+        (frameBytes + record.size() > options_.maxFrameBytes ||
+         numIovecs + recordIovecs > MAX_IOVECS)) {
+      break;
+    }
+    queuedBytes_ -= record.size();
+    if (options_.transport == BridgeTransport::UDP &&
+        (frameBytes + record.size() > options_.maxFrameBytes ||
+         numIovecs + recordIovecs > MAX_IOVECS)) {
+      XR_LOGW_EVERY_N(
+          100, "Dropping a record of {} bytes that doesn't fit a datagram", record.size());
+      if (record.header.kind == RecordKind::SAMPLE) {
+        samplesDropped_++;
+      }
+      queue_.pop_front();
+      continue;
+    }
+    frameBytes += record.size();
+    numIovecs += recordIovecs;
+    frame.push_back(std::move(record));
+    queue_.pop_front();
+  }
+  if (frame.empty()) {
+    return true;
+  }
+  const int socket = socket_;
+  lock.unlock();
+
+  FrameHeader header{bridge::kFrameMagic,
+                     bridge::kVersion,
+                     static_cast<uint16_t>(frame.size()),
+                     static_cast<uint32_t>(frameBytes - sizeof(FrameHeader))};
+  std::vector<iovec> iovecs;
+  iovecs.reserve(numIovecs);
+  iovecs.push_back(iovec{&header, sizeof(header)});
+  uint64_t numSamples = 0;
+  uint64_t sampleBytes = 0;
+  for (auto& record : frame) {
+    iovecs.push_back(iovec{&record.header, sizeof(record.header)});
+    for (const auto& range : record.ranges) {
+      iovecs.push_back(iovec{const_cast<uint8_t*>(range.data), range.size});
+    }
+    if (record.header.kind == RecordKind::SAMPLE) {
+      ++numSamples;
+      sampleBytes += record.header.bodyBytes;
+    }
+  }
+
+  bool success = true;
+  if (options_.transport == BridgeTransport::UDP) {
+    msghdr message{};
+    message.msg_iov = iovecs.data();
+    message.msg_iovlen = iovecs.size();
+    // Nobody listening yet isn't an error for a datagram, the frame is just lost
+    if (sendmsg(socket, &message, SEND_FLAGS) < 0 && errno != ECONNREFUSED) {
+      XR_LOGW_EVERY_N(100, "Failed to send bridge datagram: {}", std::strerror(errno));
+    }
+  } else {
+    success = writeAll(socket, iovecs);
+  }
+  if (success) {
+    samplesSent_ += numSamples;
+    sampleBytesSent_ += sampleBytes;
+  } else {
+    samplesDropped_ += numSamples;
+  }
+
+  // Release the sample buffers before taking the lock again
+  frame.clear();
+  lock.lock();
+  return success;
+}
+
+BridgeReceiver::BridgeReceiver(
+    uint16_t port,
+    const std::string& address,
+    const BridgeOptions& options)
+    : options_(options) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = socketType(options_.transport);
+  hints.ai_flags = AI_PASSIVE;
+  addrinfo* addresses = nullptr;
+  if (getaddrinfo(address.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0 ||
+      addresses == nullptr) {
+    XR_LOGE("Failed to resolve bridge address {}", address);
+    throw std::runtime_error("Failed to resolve bridge address " + address);
+  }
+  socket_ = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+  int one = 1;
+  const bool bound = socket_ >= 0 &&
+      setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0 &&
+      bind(socket_, addresses->ai_addr, addresses->ai_addrlen) == 0 &&
+      (options_.transport == BridgeTransport::UDP || listen(socket_, SOMAXCONN) == 0);
+  freeaddrinfo(addresses);
+  if (!bound) {
+    const std::string error = std::strerror(errno);
+    if (socket_ >= 0) {
+      close(socket_);
+    }
+    XR_LOGE("Failed to listen on {}:{}: {}", address, port, error);
+    throw std::runtime_error("Failed to listen on bridge address " + address);
+  }
+
+  sockaddr_storage boundAddress{};
+  socklen_t length = sizeof(boundAddress);
+  getsockname(socket_, reinterpret_cast<sockaddr*>(&boundAddress), &length);
+  if (boundAddress.ss_family == AF_INET6) {
+    port_ = ntohs(reinterpret_cast<sockaddr_in6*>(&boundAddress)->sin6_port);
+  } else {
+    port_ = ntohs(reinterpret_cast<sockaddr_in*>(&boundAddress)->sin_port);
+  }
+  XR_LOGI("Bridge receiver listening on {}:{}", address, port_);
+
+  thread_ = std::thread([this]() { run(); });
+}
+
+BridgeReceiver::~BridgeReceiver() {
+  stop_ = true;
+  thread_.join();
+  for (auto& connection : connections_) {
+    close(connection->socket);
+  }
+  close(socket_);
+}
+
+void BridgeReceiver::remap(const StreamID& remote, const StreamID& local) {
+  std::lock_guard<std::mutex> lock(remapMutex_);
+  remapped_[remote] = local;
+}
+
+void BridgeReceiver::run() {
+  std::vector<pollfd> descriptors;
+  while (!stop_) {
+    descriptors.clear();
+    descriptors.push_back(pollfd{socket_, POLLIN, 0});
+    for (const auto& connection : connections_) {
+      descriptors.push_back(pollfd{connection->socket, POLLIN, 0});
+    }
+    if (poll(descriptors.data(), descriptors.size(), POLL_TIMEOUT_MILLISECONDS) <= 0) {
+      continue;
+    }
+
+    // Connections are only added and removed below, so they still line up with the descriptors
+    for (size_t idx = descriptors.size() - 1; idx > 0; --idx) {
+      if (descriptors[idx].revents == 0) {
+        continue;
+      }
+      auto& connection = connections_[idx - 1];
+      if (!receiveStream(*connection)) {
+        close(connection->socket);
+        connections_.erase(connections_.begin() + (idx - 1));
+      }
+    }
+
+    if (descriptors[0].revents & POLLIN) {
+      if (options_.transport == BridgeTransport::UDP) {
+        receiveDatagram();
+      } else {
+        sockaddr_storage address{};
+        socklen_t length = sizeof(address);
+        int connection = accept(socket_, reinterpret_cast<sockaddr*>(&address), &length);
+        if (connection >= 0) {
+          configureSocket(connection, options_.transport);
+          XR_LOGI("Bridge sender connected from {}", peerName(address));
+          connections_.push_back(std::make_unique<Peer>());
+          connections_.back()->socket = connection;
+        }
+      }
+    }
+  }
+}
+
+bool BridgeReceiver::receiveStream(Peer& peer) {
+  const size_t previous = peer.buffer.size();
+  peer.buffer.resize(previous + RECEIVE_CHUNK_BYTES);
+  ssize_t received = recv(peer.socket, peer.buffer.data() + previous, RECEIVE_CHUNK_BYTES, 0);
+  if (received < 0 && errno == EINTR) {
+    peer.buffer.resize(previous);
+    return true;
+  }
+  if (received <= 0) {
+    XR_LOGI("Bridge sender disconnected");
+    return false;
+  }
+  peer.buffer.resize(previous + received);
+  return processFrames(peer);
+}
+
+void BridgeReceiver::receiveDatagram() {
+  sockaddr_storage address{};
+  socklen_t length = sizeof(address);
+  datagram_.resize(MAX_DATAGRAM_BYTES);
+  ssize_t received = recvfrom(
+      socket_,
+      datagram_.data(),
+      datagram_.size(),
+      0,
+      reinterpret_cast<sockaddr*>(&address),
+      &length);
+  if (received <= 0) {
+    return;
+  }
+  auto& peer = datagramPeers_[peerName(address)];
+  peer.buffer.assign(datagram_.begin(), datagram_.begin() + received);
+  // Each datagram holds whole frames, so anything left over is lost
+  if (!processFrames(peer) || !peer.buffer.empty()) {
+    XR_LOGW_EVERY_N(100, "Dropped a malformed bridge datagram");
+  }
+  peer.buffer.clear();
+}
+
+bool BridgeReceiver::processFrames(Peer& peer) {
+  size_t offset = 0;
+  bool valid = true;
+  while (peer.buffer.size() - offset >= sizeof(FrameHeader)) {
+    FrameHeader header;
+    std::memcpy(&header, peer.buffer.data() + offset, sizeof(header));
+    if (header.magic != bridge::kFrameMagic || header.version != bridge::kVersion ||
+        header.payloadBytes > MAX_FRAME_BYTES) {
+      XR_LOGE("Received a malformed bridge frame, dropping the connection");
+      valid = false;
+      break;
+    }
+    if (peer.buffer.size() - offset < sizeof(FrameHeader) + header.payloadBytes) {
+      break;
+    }
+
+    const uint8_t* payload = peer.buffer.data() + offset + sizeof(FrameHeader);
+    size_t recordOffset = 0;
+    for (uint16_t recordIdx = 0; valid && recordIdx < header.numRecords; ++recordIdx) {
+      RecordHeader record;
+      if (!read(payload, header.payloadBytes, recordOffset, record) ||
+          recordOffset + record.bodyBytes > header.payloadBytes) {
+        XR_LOGE("Received a malformed bridge record, dropping the connection");
+        valid = false;
+        break;
+      }
+      valid = processRecord(peer, record, payload + recordOffset);
+      recordOffset += record.bodyBytes;
+    }
+    if (!valid) {
+      break;
+    }
+    offset += sizeof(FrameHeader) + header.payloadBytes;
+  }
+  peer.buffer.erase(peer.buffer.begin(), peer.buffer.begin() + offset);
+  return valid;
+}
+
+bool BridgeReceiver::processRecord(Peer& peer, const RecordHeader& header, const uint8_t* body) {
+  if (header.kind == RecordKind::ANNOUNCE) {
+    announced(peer, header.channel, body, header.bodyBytes);
+    return true;
+  }
+  auto channel = peer.channels.find(header.channel);
+  if (channel == peer.channels.end()) {
+    XR_LOGW_EVERY_N(
+        100, "Received data for bridge channel {} before its announcement", header.channel);
+    return true;
+  }
+  auto& inbound = channel->second;
+  // Refused streams are announced, but not produced
+  if (!inbound.producer) {
+    return true;
+  }
+
+  if (header.kind == RecordKind::CONFIG) {
+    if (serializedConfigSize(inbound.typeName, body, header.bodyBytes) == 0) {
+      XR_LOGE("Received a truncated config for stream {}", inbound.id);
+      return false;
+    }
+    inbound.producer->configureStream(deserializeConfig(inbound.typeName, body));
+    inbound.configured = true;
+  } else if (header.kind == RecordKind::SAMPLE) {
+    const StreamConfig* config = inbound.configured ? inbound.producer->config() : nullptr;
+    if (header.codec != CodecType::NONE) {
+      const Codec* codec = decoderFor(header.codec);
+      StreamSample sample;
+      if (!codec) {
+        XR_LOGE("Received a sample of stream {} with an unknown codec", inbound.id);
+        return false;
+      }
+      if (!decodeSample(
+              inbound.typeName,
+              body,
+              header.bodyBytes,
+              config,
+              *codec,
+              sample,
+              inbound.producer->handle())) {
+        XR_LOGW_EVERY_N(
+            100, "Dropped a sample of stream {} that is malformed or has no config", inbound.id);
+        return true;
+      }
+      inbound.producer->produceSample(sample);
+      samplesReceived_++;
+      return true;
+    }
+    if (serializedSampleSize(inbound.typeName, body, header.bodyBytes, config) == 0) {
+      XR_LOGW_EVERY_N(
+          100, "Dropped a sample of stream {} that is truncated or has no config", inbound.id);
+      return true;
+    }
+    inbound.producer->produceSample(
+        deserializeSample(inbound.typeName, body, config, inbound.producer->handle()));
+    samplesReceived_++;
+  }
+  return true;
+}
+
+void BridgeReceiver::announced(Peer& peer, uint16_t channel, const uint8_t* body, size_t length) {
+  int32_t checksum;
+  std::string remoteID;
+  std::string typeName;
+  size_t offset = 0;
+  if (!read(body, length, offset, checksum) || !readString(body, length, offset, remoteID) ||
+      !readString(body, length, offset, typeName)) {
+    XR_LOGE("Received a malformed bridge announcement");
+    return;
+  }
+
+  StreamID id = remoteID;
+  {
+    std::lock_guard<std::mutex> lock(remapMutex_);
+    auto remapped = remapped_.find(remoteID);
+    if (remapped != remapped_.end()) {
+      id = remapped->second;
+    }
+  }
+  // Datagram senders announce their streams periodically
+  auto existing = peer.channels.find(channel);
+  if (existing != peer.channels.end() && existing->second.id == id &&
+      existing->second.typeName == typeName) {
+    return;
+  }
+
+  auto& inbound = peer.channels[channel];
+  inbound = Inbound{id, typeName};
+  auto typeInfo = Framework::instance().typeRegistry()->findTypeName(typeName);
+  if (!typeInfo) {
+    XR_LOGE("Refusing bridged stream {}, its type {} isn't registered", id, typeName);
+    return;
+  }
+  if (typeChecksum(*typeInfo) != checksum) {
+    XR_LOGE(
+        "Refusing bridged stream {}, its type {} differs from the local definition", id, typeName);
+    return;
+  }
+  auto si = Framework::instance().streamRegistry()->registerStream(
+      StreamDescription(id, typeInfo->typeID()));
+  if (si->description().type() != typeInfo->typeID()) {
+    XR_LOGE("Refusing bridged stream {}, it already exists with another type", id);
+    return;
+  }
+  auto producer = std::make_unique<StreamProducer>(si);
+  if (!producer->isActive()) {
+    XR_LOGE("Refusing bridged stream {}, it already has a producer", id);
+    return;
+  }
+  inbound.producer = std::move(producer);
+  XR_LOGI("Receiving bridged stream {} as {}", remoteID, id);
+}
+
+} // namespace cthulhu
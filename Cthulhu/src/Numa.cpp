@@ -0,0 +1,194 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/Numa.h>
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#define CTHULHU_NUMA_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace cthulhu {
+
+namespace {
+
+#ifdef CTHULHU_NUMA_LINUX
+const char* const NODE_PATH = "/sys/devices/system/node/node";
+// From linux/mempolicy.h, which isn't always installed
+const int MPOL_BIND_MODE = 2;
+const unsigned MPOL_MF_MOVE_FLAG = 1 << 1;
+#endif
+
+std::mutex placementMutex;
+std::map<ThreadRole, std::vector<int>> placements;
+
+} // namespace
+
+int Numa::numNodes() {
+#ifdef CTHULHU_NUMA_LINUX
+  static const int nodes = []() -> int {
+    int count = 0;
+    while (access((NODE_PATH + std::to_string(count)).c_str(), F_OK) == 0) {
+      ++count;
+    }
+    return std::max(count, 1);
+  }();
+  return nodes;
+#else
+  return 1;
+#endif
+}
+
+int Numa::currentNode() {
+#ifdef CTHULHU_NUMA_LINUX
+  if (numNodes() == 1) {
+    return 0;
+  }
+  // sched_getcpu is served from the vDSO, so with the node of each CPU looked up once, finding the
+  // node doesn't enter the kernel on every allocation
+  static const std::vector<int> nodeOfCpu = []() {
+    std::vector<int> nodes;
+    for (int node = 0; node < numNodes(); ++node) {
+      for (int cpu : cpusOfNode(node)) {
+        if (cpu >= static_cast<int>(nodes.size())) {
+          nodes.resize(cpu + 1, 0);
+        }
+        nodes[cpu] = node;
+      }
+    }
+    return nodes;
+  }();
+  const int cpu = sched_getcpu();
+  if (cpu >= 0 && cpu < static_cast<int>(nodeOfCpu.size())) {
+    return nodeOfCpu[cpu];
+  }
+#endif
+  return 0;
+}
+
+std::vector<int> Numa::cpusOfNode(int node) {
+  std::vector<int> cpus;
+#ifdef CTHULHU_NUMA_LINUX
+  // The list looks like "0-15,32-47"
+  std::ifstream file(NODE_PATH + std::to_string(node) + "/cpulist");
+  std::string range;
+  while (std::getline(file, range, ',')) {
+    std::istringstream stream(range);
+    int first = 0;
+    int last = 0;
+    char dash = 0;
+    if (!(stream >> first)) {
+      continue;
+    }
+    last = (stream >> dash >> last) ? last : first;
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+#endif
+  return cpus;
+}
+
+bool Numa::bindMemory(void* address, size_t length, int node) {
+#ifdef CTHULHU_NUMA_LINUX
+  if (node < 0 || node >= numNodes()) {
+    return false;
+  }
+  const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+  const uintptr_t begin = (reinterpret_cast<uintptr_t>(address) + pageSize - 1) & ~(pageSize - 1);
+  const uintptr_t end = (reinterpret_cast<uintptr_t>(address) + length) & ~(pageSize - 1);
+  if (end <= begin) {
+    return false;
+  }
+  constexpr size_t bitsPerWord = sizeof(unsigned long) * 8;
+  std::vector<unsigned long> mask(node / bitsPerWord + 1, 0);
+  mask[node / bitsPerWord] |= 1UL << (node % bitsPerWord);
+  if (syscall(
+          SYS_mbind,
+          begin,
+          end - begin,
+          MPOL_BIND_MODE,
+          mask.data(),
+          mask.size() * bitsPerWord + 1,
+          MPOL_MF_MOVE_FLAG) != 0) {
+    XR_LOGD_ONCE("mbind to NUMA node {} failed: {}", node, errno);
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool Numa::pinCurrentThread(const std::vector<int>& cpus) {
+#ifdef CTHULHU_NUMA_LINUX
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  if (CPU_COUNT(&set) == 0) {
+    return false;
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+void Numa::setThreadPlacement(ThreadRole role, const std::vector<int>& cpus) {
+  std::lock_guard<std::mutex> lock(placementMutex);
+  if (cpus.empty()) {
+    placements.erase(role);
+  } else {
+    placements[role] = cpus;
+  }
+}
+
+void Numa::applyThreadPlacement(ThreadRole role) {
+  std::vector<int> cpus;
+  {
+    std::lock_guard<std::mutex> lock(placementMutex);
+    auto it = placements.find(role);
+    if (it == placements.end()) {
+      return;
+    }
+    cpus = it->second;
+  }
+  if (!pinCurrentThread(cpus)) {
+    XR_LOGW_ONCE("Failed to pin Cthulhu thread to its CPU placement");
+  }
+}
+
+void NumaPlacement::setStreamNode(StreamHandle handle, int node) {
+  auto* slot = node < 0 ? streamNodes_.find(handle) : streamNodes_.at(handle);
+  if (slot) {
+    slot->node.store(node < 0 ? -1 : node, std::memory_order_relaxed);
+  }
+}
+
+int NumaPlacement::nodeFor(StreamHandle handle) const {
+  const auto* slot = streamNodes_.find(handle);
+  if (slot) {
+    const int node = slot->node.load(std::memory_order_relaxed);
+    if (node >= 0) {
+      return std::min(node, Numa::numNodes() - 1);
+    }
+  }
+  return Numa::currentNode();
+}
+
+} // namespace cthulhu
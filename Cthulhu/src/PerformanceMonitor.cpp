@@ -37,6 +37,11 @@ void PerformanceMonitor::sampleDropped() {
   summary_.numSamplesDropped++;
 }
 
+void PerformanceMonitor::deadlineMissed() {
+  std::scoped_lock<std::mutex> summaryLock(summaryMutex_);
+  summary_.numDeadlineMisses++;
+}
+
 PerformanceSummary PerformanceMonitor::getSummary() {
   std::scoped_lock<std::mutex> summaryLock(summaryMutex_);
   // Copy summary_ so that continued writes to it will not affect the returned summary
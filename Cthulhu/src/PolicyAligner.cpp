@@ -0,0 +1,134 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/PolicyAligner.h>
+
+#include <stdexcept>
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+namespace cthulhu {
+
+PolicyAligner::PolicyAligner(AlignPolicy policy, size_t queueSize, ThreadPolicy threadPolicy)
+    : Aligner(queueSize, threadPolicy), alignPolicy_(policy) {}
+
+PolicyAligner::~PolicyAligner() {}
+
+void PolicyAligner::setInterpolator(const AlignerInterpolator& interpolator) {
+  interpolator_ = interpolator;
+}
+
+void PolicyAligner::finalize() {
+  if (alignPolicy_ == AlignPolicy::INTERPOLATE && !interpolator_) {
+    const auto str = "PolicyAligner INTERPOLATE policy requires an interpolator.";
+    XR_LOGCE("Cthulhu", "{}", str);
+    throw std::runtime_error(str);
+  }
+  Aligner::finalize();
+}
+
+void PolicyAligner::align() {
+  if (!finalized_) {
+    return;
+  }
+  // The aligned samples are kept per thread, the same as for Aligner::align
+  thread_local std::vector<StreamSample> scratch;
+  std::vector<StreamSample> samples = std::move(scratch);
+  // Several reference samples may be waiting on the same late sample, so keep going until no
+  // more sets can be aligned
+  while (true) {
+    samples.clear();
+    {
+      std::lock_guard<std::mutex> lock(queueMutex_);
+      // Nothing was queued since the last attempt failed, so this one would too
+      if (queueVersion_ == alignedVersion_) {
+        break;
+      }
+      if (!alignNext(samples)) {
+        alignedVersion_ = queueVersion_;
+        break;
+      }
+
+      // Check to see if this set of samples should have a new config
+      checkConfig(samples);
+    }
+
+    execute(samples);
+  }
+  samples.clear();
+  scratch = std::move(samples);
+}
+
+bool PolicyAligner::alignNext(std::vector<StreamSample>& samples) {
+  if (queues_.empty()) {
+    return false;
+  }
+  for (const auto& queue : queues_) {
+    if (queue.samples.empty()) {
+      return false;
+    }
+  }
+
+  const StreamSample& reference = queues_[0].samples.front();
+  const double timestamp = reference.metadata->header.timestamp;
+  samples.push_back(reference);
+  for (size_t idx = 1; idx < queues_.size(); ++idx) {
+    samples.emplace_back(StreamSample::Unallocated());
+    const bool ready = alignPolicy_ == AlignPolicy::HOLD_LAST
+        ? selectLatest(idx, samples.back())
+        : selectNearest(idx, timestamp, samples.back());
+    if (!ready) {
+      return false;
+    }
+  }
+  queues_[0].samples.pop_front();
+  return true;
+}
+
+bool PolicyAligner::selectNearest(size_t idx, double timestamp, StreamSample& sample) {
+  auto& queue = queues_[idx].samples;
+  size_t after = 0;
+  while (after < queue.size() && queue[after].metadata->header.timestamp < timestamp) {
+    ++after;
+  }
+
+  if (after == queue.size()) {
+    // Wait for a sample at or after the reference, unless the queue is already full
+    if (queue.size() < queueSize_) {
+      return false;
+    }
+    sample = queue.back();
+    queue.erase(queue.begin(), queue.end() - 1);
+    return true;
+  }
+
+  const double afterTimestamp = queue[after].metadata->header.timestamp;
+  if (after == 0 || afterTimestamp == timestamp) {
+    sample = queue[after];
+  } else {
+    const StreamSample& before = queue[after - 1];
+    const double beforeTimestamp = before.metadata->header.timestamp;
+    if (alignPolicy_ == AlignPolicy::INTERPOLATE) {
+      sample = interpolator_(
+          idx,
+          before,
+          queue[after],
+          (timestamp - beforeTimestamp) / (afterTimestamp - beforeTimestamp));
+    } else {
+      sample = (timestamp - beforeTimestamp <= afterTimestamp - timestamp) ? before : queue[after];
+    }
+    // The sample before the reference may still bracket the next one, so keep it
+    --after;
+  }
+  queue.erase(queue.begin(), queue.begin() + after);
+  return true;
+}
+
+bool PolicyAligner::selectLatest(size_t idx, StreamSample& sample) {
+  auto& queue = queues_[idx].samples;
+  sample = queue.back();
+  queue.erase(queue.begin(), queue.end() - 1);
+  return true;
+}
+
+} // namespace cthulhu
@@ -0,0 +1,270 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "IPCEssentials.h"
+
+#include <cthulhu/ProcessTable.h>
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace cthulhu {
+
+namespace {
+
+constexpr uint32_t kTableMagic = 0x43505442;
+// Longest wait of waitForChange() between checks of the steady clock
+constexpr std::chrono::milliseconds kWaitSlice{100};
+// Longer timeouts of waitForChange() would overflow the steady clock, and are as good as forever
+constexpr double kMaxTimeout = 1e9;
+
+uint64_t steadyNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct ProcessSlot {
+  char name[ProcessTable::kMaxNameLength + 1];
+  uint32_t phase;
+  bool hasException;
+  uint32_t exceptionLength;
+  // Steady clock time of the last heartbeat, which every process reads from the same clock
+  std::atomic<uint64_t> heartbeatNs;
+  char exception[ProcessTable::kMaxExceptionLength + 1];
+};
+
+} // namespace
+
+struct ProcessTableData {
+  uint32_t magic;
+  uint32_t numProcesses;
+  uint64_t version;
+  mutable MutexIPC mutex;
+  mutable ConditionIPC changed;
+
+  ProcessSlot* slots() {
+    return reinterpret_cast<ProcessSlot*>(this + 1);
+  }
+  const ProcessSlot* slots() const {
+    return reinterpret_cast<const ProcessSlot*>(this + 1);
+  }
+};
+
+struct ProcessTable::Mapping {
+  boost::interprocess::mapped_region region;
+};
+
+ProcessTable::ProcessTable(const std::string& name, bool owner)
+    : name_(name), owner_(owner), mapping_(std::make_unique<Mapping>()) {}
+
+std::unique_ptr<ProcessTable> ProcessTable::create(
+    const std::string& name,
+    const std::vector<std::string>& processes,
+    uint32_t initialPhase) {
+  using namespace boost::interprocess;
+  for (const auto& process : processes) {
+    if (process.length() > kMaxNameLength) {
+      XR_LOGE("Process name {} is longer than {} characters", process, kMaxNameLength);
+      throw std::runtime_error("Process name is too long for the process table");
+    }
+  }
+
+  std::unique_ptr<ProcessTable> table(new ProcessTable(name, true));
+  shared_memory_object::remove(name.c_str());
+  shared_memory_object shm(create_only, name.c_str(), read_write);
+  shm.truncate(sizeof(ProcessTableData) + processes.size() * sizeof(ProcessSlot));
+  table->mapping_->region = mapped_region(shm, read_write);
+
+  auto* data = new (table->mapping_->region.get_address()) ProcessTableData();
+  data->numProcesses = static_cast<uint32_t>(processes.size());
+  data->version = 0;
+  const uint64_t now = steadyNs();
+  for (size_t index = 0; index < processes.size(); ++index) {
+    auto* slot = new (&data->slots()[index]) ProcessSlot();
+    std::memcpy(slot->name, processes[index].data(), processes[index].length());
+    slot->name[processes[index].length()] = '\0';
+    slot->phase = initialPhase;
+    slot->hasException = false;
+    slot->exceptionLength = 0;
+    slot->heartbeatNs.store(now, std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  data->magic = kTableMagic;
+  table->data_ = data;
+  return table;
+}
+
+std::unique_ptr<ProcessTable> ProcessTable::open(const std::string& name) {
+  using namespace boost::interprocess;
+  std::unique_ptr<ProcessTable> table(new ProcessTable(name, false));
+  shared_memory_object shm(open_only, name.c_str(), read_write);
+  table->mapping_->region = mapped_region(shm, read_write);
+  auto* data = static_cast<ProcessTableData*>(table->mapping_->region.get_address());
+  if (table->mapping_->region.get_size() < sizeof(ProcessTableData) ||
+      data->magic != kTableMagic ||
+      table->mapping_->region.get_size() <
+          sizeof(ProcessTableData) + data->numProcesses * sizeof(ProcessSlot)) {
+    XR_LOGE("Shared memory {} is not a process table", name);
+    throw std::runtime_error("Shared memory is not a process table");
+  }
+  table->data_ = data;
+  return table;
+}
+
+ProcessTable::~ProcessTable() {
+  mapping_.reset();
+  if (owner_) {
+    boost::interprocess::shared_memory_object::remove(name_.c_str());
+  }
+}
+
+size_t ProcessTable::slotOf(const std::string& process) const {
+  // Names are written once, before the table is shared, so they are read without the lock
+  for (size_t index = 0; index < data_->numProcesses; ++index) {
+    if (process == data_->slots()[index].name) {
+      return index;
+    }
+  }
+  throw std::out_of_range("Process " + process + " is not in process table " + name_);
+}
+
+std::vector<std::string> ProcessTable::processes() const {
+  std::vector<std::string> result;
+  for (size_t index = 0; index < data_->numProcesses; ++index) {
+    result.emplace_back(data_->slots()[index].name);
+  }
+  return result;
+}
+
+uint32_t ProcessTable::phase(const std::string& process) const {
+  const size_t index = slotOf(process);
+  ScopedLockIPC lock(data_->mutex);
+  return data_->slots()[index].phase;
+}
+
+std::map<std::string, uint32_t> ProcessTable::phases() const {
+  std::map<std::string, uint32_t> result;
+  ScopedLockIPC lock(data_->mutex);
+  for (size_t index = 0; index < data_->numProcesses; ++index) {
+    result.emplace(data_->slots()[index].name, data_->slots()[index].phase);
+  }
+  return result;
+}
+
+bool ProcessTable::setPhase(const std::string& process, uint32_t phase) {
+  const size_t index = slotOf(process);
+  ScopedLockIPC lock(data_->mutex);
+  auto& slot = data_->slots()[index];
+  if (phase <= slot.phase) {
+    return false;
+  }
+  slot.phase = phase;
+  data_->version++;
+  data_->changed.notify_all();
+  return true;
+}
+
+void ProcessTable::heartbeat(const std::string& process) {
+  data_->slots()[slotOf(process)].heartbeatNs.store(steadyNs(), std::memory_order_relaxed);
+}
+
+double ProcessTable::secondsSinceHeartbeat(const std::string& process) const {
+  const uint64_t last =
+      data_->slots()[slotOf(process)].heartbeatNs.load(std::memory_order_relaxed);
+  const uint64_t now = steadyNs();
+  return now > last ? (now - last) / 1e9 : 0.0;
+}
+
+std::optional<std::string> ProcessTable::exception(const std::string& process) const {
+  const size_t index = slotOf(process);
+  ScopedLockIPC lock(data_->mutex);
+  const auto& slot = data_->slots()[index];
+  if (!slot.hasException) {
+    return std::nullopt;
+  }
+  return std::string(slot.exception, slot.exceptionLength);
+}
+
+std::map<std::string, std::optional<std::string>> ProcessTable::exceptions() const {
+  std::map<std::string, std::optional<std::string>> result;
+  ScopedLockIPC lock(data_->mutex);
+  for (size_t index = 0; index < data_->numProcesses; ++index) {
+    const auto& slot = data_->slots()[index];
+    result.emplace(
+        slot.name,
+        slot.hasException ? std::make_optional<std::string>(slot.exception, slot.exceptionLength)
+                          : std::nullopt);
+  }
+  return result;
+}
+
+bool ProcessTable::setException(const std::string& process, const std::string& description) {
+  const size_t index = slotOf(process);
+  ScopedLockIPC lock(data_->mutex);
+  auto& slot = data_->slots()[index];
+  if (slot.hasException) {
+    return false;
+  }
+  size_t length = std::min(description.length(), kMaxExceptionLength);
+  // Truncates before the character that doesn't fit, so that the description stays valid UTF-8
+  while (length < description.length() && length > 0 &&
+         (static_cast<uint8_t>(description[length]) & 0xC0) == 0x80) {
+    --length;
+  }
+  std::memcpy(slot.exception, description.data(), length);
+  slot.exception[length] = '\0';
+  slot.exceptionLength = static_cast<uint32_t>(length);
+  slot.hasException = true;
+  data_->version++;
+  data_->changed.notify_all();
+  return true;
+}
+
+bool ProcessTable::hasException() const {
+  ScopedLockIPC lock(data_->mutex);
+  for (size_t index = 0; index < data_->numProcesses; ++index) {
+    if (data_->slots()[index].hasException) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t ProcessTable::version() const {
+  ScopedLockIPC lock(data_->mutex);
+  return data_->version;
+}
+
+uint64_t ProcessTable::waitForChange(uint64_t version, double timeout) const {
+  // The condition waits for deadlines of the system clock, which may be set forward or back. The
+  // timeout is measured with the steady clock instead, waiting in slices so that a clock set back
+  // delays the wake-up by a slice at most.
+  const std::chrono::duration<double> limit(std::clamp(timeout, 0.0, kMaxTimeout));
+  const auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(limit);
+  ScopedLockIPC lock(data_->mutex);
+  while (data_->version == version) {
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= remaining.zero()) {
+      break;
+    }
+    const auto slice = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::min<std::chrono::steady_clock::duration>(remaining, kWaitSlice));
+    data_->changed.timed_wait(
+        lock, boost::get_system_time() + boost::posix_time::microseconds(slice.count() + 1));
+  }
+  return data_->version;
+}
+
+} // namespace cthulhu
@@ -37,6 +37,7 @@ void QueueingAligner::registerConsumer(StreamInterface* si, int index) {
     return configCallback(index, config);
   };
   queues_[index].id = si->description().id();
+  queues_[index].handle = si->handle();
   queues_[index].consumer = std::make_unique<StreamConsumer>(si, callback, ccallback);
 }
 
@@ -96,7 +97,7 @@ void QueueingAligner::align() {
             0,
             [](int val, const StreamSample& next) -> int { return val + next.numberOfSubSamples; });
         sample.payload = Framework::instance().memoryPool()->getBufferFromPool(
-            queue.id, payloadSize * queue.config.sampleSizeInBytes);
+            queue.handle, payloadSize * queue.config.sampleSizeInBytes);
         meta.references.reserve(queue.samples.size());
         int index = 0;
         for (const auto& inputSample : queue.samples) {
@@ -136,6 +137,7 @@ void QueueingAligner::align() {
 }
 
 void QueueingAligner::sampleCallback(size_t idx, const StreamSample& sample) {
+  heartbeat_.arrive();
   {
     std::lock_guard<std::mutex> lock(queueMutex_);
     queues_[idx].latestSequence = sample.metadata->header.sequenceNumber;
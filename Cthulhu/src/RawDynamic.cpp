@@ -10,7 +10,8 @@ namespace cthulhu {
 
 template <>
 CpuBuffer RawDynamic<>::getBuffer() const {
-  return Framework::instance().memoryPool()->getBufferFromPool("", size());
+  return Framework::instance().memoryPool()->getBufferFromPool(
+      StreamHandles::anonymous(), size());
 }
 
 template <>
@@ -127,6 +127,128 @@ std::vector<uint8_t> serializeSample(
   return result;
 }
 
+namespace {
+
+// Advances offset past the dynamic fields serialized there. Returns false if they don't fit.
+bool skipDynamicFields(size_t numDynFields, size_t& offset, const uint8_t* source, size_t length) {
+  for (size_t fieldIdx = 0; fieldIdx < numDynFields; ++fieldIdx) {
+    uint32_t fieldSize;
+    if (offset + sizeof(uint32_t) > length) {
+      return false;
+    }
+    std::memcpy(&fieldSize, source + offset, sizeof(uint32_t));
+    offset += sizeof(uint32_t) + fieldSize;
+  }
+  return offset <= length;
+}
+
+} // namespace
+
+size_t serializedConfigSize(const std::string& typeName, const uint8_t* config, size_t length) {
+  auto typeInfo = Framework::instance().typeRegistry()->findTypeName(typeName);
+  if (!typeInfo) {
+    return 0;
+  }
+  size_t offset = typeInfo->configParameterSize();
+  if (!skipDynamicFields(typeInfo->configNumberDynamicFields(), offset, config, length)) {
+    return 0;
+  }
+  offset += sizeof(double) + sizeof(uint32_t);
+  return offset <= length ? offset : 0;
+}
+
+size_t gatherSample(
+    const std::string& typeName,
+    const StreamSample& sample,
+    const StreamConfig* const config,
+    std::vector<SerializedRange>& ranges,
+    std::vector<uint8_t>& header) {
+  auto typeInfo = Framework::instance().typeRegistry()->findTypeName(typeName);
+  if (!typeInfo) {
+    XR_LOGCE("Cthulhu", "Couldn't serialize sample, failed to find type in registry: ", typeName);
+    return 0;
+  }
+  if (!typeInfo->isBasic() && !config) {
+    XR_LOGCE(
+        "Cthulhu",
+        "Couldn't serialize sample for non-basic type without a corresponding config: ",
+        typeName);
+    return 0;
+  }
+  const size_t paramSize = typeInfo->sampleParameterSize();
+  const size_t numDynFields = typeInfo->sampleNumberDynamicFields();
+  const size_t payloadSize =
+      !typeInfo->isBasic() ? config->sampleSizeInBytes * sample.numberOfSubSamples : 0;
+
+  // Missing buffers are written as zeros, so the header may have to hold those too. Reserving it
+  // up front keeps the ranges pointing into it valid.
+  const size_t fixedSize = sizeof(uint32_t) * numDynFields + sizeof(uint32_t) + sizeof(double) +
+      sizeof(uint32_t) + (sample.parameters ? 0 : paramSize) + (sample.payload ? 0 : payloadSize);
+  header.clear();
+  header.reserve(fixedSize);
+  size_t total = 0;
+  auto addRange = [&ranges, &total](const uint8_t* data, size_t size) -> void {
+    if (size > 0) {
+      ranges.push_back(SerializedRange{data, size});
+      total += size;
+    }
+  };
+  auto addHeader = [&header, &addRange](const void* data, size_t size) -> void {
+    const size_t offset = header.size();
+    if (data) {
+      header.insert(header.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+    } else {
+      header.resize(offset + size, 0);
+    }
+    addRange(header.data() + offset, size);
+  };
+
+  if (sample.parameters) {
+    addRange(sample.parameters.get(), paramSize);
+  } else {
+    addHeader(nullptr, paramSize);
+  }
+  for (size_t fieldIdx = 0; fieldIdx < numDynFields; ++fieldIdx) {
+    const auto& field = sample.dynamicParameters.get()[fieldIdx];
+    uint32_t fieldSize = field.size();
+    addHeader(&fieldSize, sizeof(uint32_t));
+    addRange(field.raw.get(), fieldSize);
+  }
+  addHeader(&sample.numberOfSubSamples, sizeof(uint32_t));
+  if (sample.payload) {
+    addRange(((CpuBuffer)sample.payload).get(), payloadSize);
+  } else {
+    addHeader(nullptr, payloadSize);
+  }
+  addHeader(&sample.metadata->header.timestamp, sizeof(double));
+  addHeader(&sample.metadata->header.sequenceNumber, sizeof(uint32_t));
+  return total;
+}
+
+size_t serializedSampleSize(
+    const std::string& typeName,
+    const uint8_t* sample,
+    size_t length,
+    const StreamConfig* const config) {
+  auto typeInfo = Framework::instance().typeRegistry()->findTypeName(typeName);
+  if (!typeInfo || (!typeInfo->isBasic() && !config)) {
+    return 0;
+  }
+  size_t offset = typeInfo->sampleParameterSize();
+  uint32_t numberOfSubSamples;
+  if (!skipDynamicFields(typeInfo->sampleNumberDynamicFields(), offset, sample, length) ||
+      offset + sizeof(uint32_t) > length) {
+    return 0;
+  }
+  std::memcpy(&numberOfSubSamples, sample + offset, sizeof(uint32_t));
+  offset += sizeof(uint32_t);
+  if (!typeInfo->isBasic()) {
+    offset += static_cast<size_t>(config->sampleSizeInBytes) * numberOfSubSamples;
+  }
+  offset += sizeof(double) + sizeof(uint32_t);
+  return offset <= length ? offset : 0;
+}
+
 StreamConfig deserializeConfig(const std::string& typeName, const uint8_t* config) {
   auto typeInfo = Framework::instance().typeRegistry()->findTypeName(typeName);
   if (!typeInfo) {
@@ -150,7 +272,8 @@ StreamConfig deserializeConfig(const std::string& typeName, const uint8_t* confi
 StreamSample deserializeSample(
     const std::string& typeName,
     const uint8_t* sample,
-    const StreamConfig* const config) {
+    const StreamConfig* const config,
+    StreamHandle poolHandle) {
   StreamSample result;
   auto typeInfo = Framework::instance().typeRegistry()->findTypeName(typeName);
   if (!typeInfo) {
@@ -174,7 +297,7 @@ StreamSample deserializeSample(
   const auto& numDynFields = typeInfo->sampleNumberDynamicFields();
   if (paramSize > 0) {
     result.parameters =
-        Framework::instance().memoryPool()->getBufferFromPool(StreamID{""}, paramSize);
+        Framework::instance().memoryPool()->getBufferFromPool(poolHandle, paramSize);
     std::memcpy(result.parameters.get(), sample + offset, paramSize);
     offset += paramSize;
   }
@@ -189,7 +312,7 @@ StreamSample deserializeSample(
       !typeInfo->isBasic() ? config->sampleSizeInBytes * result.numberOfSubSamples : 0;
   if (payloadSize > 0) {
     result.payload =
-        Framework::instance().memoryPool()->getBufferFromPool(StreamID{""}, payloadSize);
+        Framework::instance().memoryPool()->getBufferFromPool(poolHandle, payloadSize);
     std::memcpy(((CpuBuffer)result.payload).get(), sample + offset, payloadSize);
     offset += payloadSize;
   }
@@ -1,29 +1,98 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
 
+#include <cstring>
 #include <memory>
 
 #include <cthulhu/StreamConfigEquality.h>
 
 namespace cthulhu {
 
+namespace {
+
+constexpr uint64_t HASH_MULTIPLIER = 0xc6a4a7935bd1e995ULL;
+constexpr int HASH_SHIFT = 47;
+
+uint64_t mixWord(uint64_t hash, uint64_t word) {
+  word *= HASH_MULTIPLIER;
+  word ^= word >> HASH_SHIFT;
+  word *= HASH_MULTIPLIER;
+  hash ^= word;
+  return hash * HASH_MULTIPLIER;
+}
+
+// MurmurHash64A, chained through the seed so that the fields of a config hash as one stream
+uint64_t hashBytes(uint64_t seed, const void* data, size_t size) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = seed ^ (size * HASH_MULTIPLIER);
+  const size_t numWords = size / sizeof(uint64_t);
+  for (size_t i = 0; i < numWords; ++i) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+    hash = mixWord(hash, word);
+  }
+  const size_t tail = size % sizeof(uint64_t);
+  if (tail > 0) {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes + numWords * sizeof(uint64_t), tail);
+    hash ^= word;
+    hash *= HASH_MULTIPLIER;
+  }
+  hash ^= hash >> HASH_SHIFT;
+  hash *= HASH_MULTIPLIER;
+  hash ^= hash >> HASH_SHIFT;
+  return hash;
+}
+
+template <typename T>
+uint64_t hashValue(uint64_t seed, const T& value) {
+  return hashBytes(seed, &value, sizeof(T));
+}
+
+} // namespace
+
+uint64_t streamConfigHash(const StreamConfig& config, const TypeInfoInterface& stream_type_info) {
+  uint64_t hash = hashValue(0, config.nominalSampleRate);
+  hash = hashValue(hash, config.sampleSizeInBytes);
+  if (stream_type_info.configParameterSize() > 0 && config.parameters) {
+    hash = hashBytes(hash, config.parameters.get(), stream_type_info.configParameterSize());
+  }
+  if (config.dynamicParameters) {
+    for (size_t i = 0; i < stream_type_info.configNumberDynamicFields(); ++i) {
+      const auto& raw_dynamic = *(config.dynamicParameters.get() + i);
+      hash = hashValue(hash, raw_dynamic.elementCount);
+      hash = hashValue(hash, raw_dynamic.elementSize);
+      if (raw_dynamic.raw) {
+        hash = hashBytes(hash, raw_dynamic.raw.get(), raw_dynamic.size());
+      }
+    }
+  }
+  return hash != 0 ? hash : 1;
+}
+
 bool streamConfigsEqual(
     const StreamConfig& lhs,
     const StreamConfig& rhs,
     const TypeInfoInterface& stream_type_info) {
+  // Configs are hashed once when they are configured, so comparing them is O(1) however large
+  // their dynamic fields are. A collision of 64-bit hashes is treated as impossible.
+  if (lhs.contentHash != 0 && rhs.contentHash != 0) {
+    return lhs.contentHash == rhs.contentHash;
+  }
   if (lhs.nominalSampleRate != rhs.nominalSampleRate) {
     return false;
   }
   if (lhs.sampleSizeInBytes != rhs.sampleSizeInBytes) {
     return false;
   }
-  if (stream_type_info.configParameterSize() > 0) {
+  if (stream_type_info.configParameterSize() > 0 && lhs.parameters != rhs.parameters) {
     if (std::memcmp(
             lhs.parameters.get(), rhs.parameters.get(), stream_type_info.configParameterSize()) !=
         0) {
       return false;
     }
   }
-  if (stream_type_info.configNumberDynamicFields() > 0) {
+  if (stream_type_info.configNumberDynamicFields() > 0 &&
+      lhs.dynamicParameters != rhs.dynamicParameters) {
     for (int i = 0; i < stream_type_info.configNumberDynamicFields(); ++i) {
       const auto& lhs_raw_dynamic = *(lhs.dynamicParameters.get() + i);
       const auto& rhs_raw_dynamic = *(rhs.dynamicParameters.get() + i);
@@ -0,0 +1,67 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/StreamHandle.h>
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace cthulhu {
+
+namespace {
+
+struct InternTable {
+  std::mutex mutex;
+  std::map<std::string, StreamHandle, std::less<>> handles;
+  // Indexed by handle
+  std::vector<std::string> ids;
+};
+
+InternTable& internTable() {
+  // Leaked so that handles stay valid for streams released during static destruction
+  static auto* table = new InternTable();
+  return *table;
+}
+
+} // namespace
+
+StreamHandle StreamHandles::intern(std::string_view id) {
+  auto& table = internTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto it = table.handles.find(id);
+  if (it != table.handles.end()) {
+    return it->second;
+  }
+  if (table.ids.size() >= MAX_STREAM_HANDLES) {
+    auto str = "Ran out of stream handles.";
+    XR_LOGE("{}", str);
+    throw std::runtime_error(str);
+  }
+  const auto handle = static_cast<StreamHandle>(table.ids.size());
+  table.ids.emplace_back(id);
+  table.handles.emplace(table.ids.back(), handle);
+  return handle;
+}
+
+StreamHandle StreamHandles::anonymous() {
+  static const StreamHandle handle = intern("");
+  return handle;
+}
+
+StreamHandle StreamHandles::find(std::string_view id) {
+  auto& table = internTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto it = table.handles.find(id);
+  return it != table.handles.end() ? it->second : INVALID_STREAM_HANDLE;
+}
+
+std::string StreamHandles::id(StreamHandle handle) {
+  auto& table = internTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return handle < table.ids.size() ? table.ids[handle] : std::string();
+}
+
+} // namespace cthulhu
@@ -2,10 +2,15 @@
 
 #include <cthulhu/StreamInterface.h>
 
+#include "DeliveryExecutor.h"
+
 #define DEFAULT_LOG_CHANNEL "Cthulhu"
 #include <logging/Log.h>
 
 #include <cthulhu/Framework.h>
+#include <cthulhu/Numa.h>
+#include <cthulhu/StreamConfigEquality.h>
+#include <cthulhu/Tracing.h>
 
 namespace cthulhu {
 
@@ -18,6 +23,7 @@ StreamProducer::StreamProducer(StreamInterface* si, bool async) : async_(async)
   if (async) {
     thread_ = std::thread(
         [this](std::future<void> signal) -> void {
+          Numa::applyThreadPlacement(ThreadRole::ASYNC_PRODUCER);
           while (signal.wait_for(std::chrono::milliseconds(1)) == std::future_status::timeout) {
             std::queue<DataVariant> tempQueue;
             {
@@ -52,14 +58,44 @@ StreamProducer::~StreamProducer() {
   }
 };
 
+namespace {
+
+// Number of samples to pre-allocate in the pool when a stream is configured (CTHULHU_POOL_WARM)
+size_t poolWarmCount() {
+  static const size_t count = []() -> size_t {
+    const char* value = std::getenv("CTHULHU_POOL_WARM");
+    return value ? std::strtoul(value, nullptr, 10) : 0;
+  }();
+  return count;
+}
+
+} // namespace
+
 // This should be called before producing any samples
 void StreamProducer::configureStream(const StreamConfig& config) const {
+  // Hash the config once here, so that consumers and the IPC path can compare and deduplicate
+  // configs without reading their content. A hash the config already carries is never trusted,
+  // since a config received from another stream may have been edited in place before being
+  // forwarded.
+  StreamConfig hashedConfig = config;
+  hashedConfig.contentHash = 0;
+  if (producedStream_) {
+    auto typeInfo =
+        Framework::instance().typeRegistry()->findTypeID(producedStream_->description().type());
+    if (typeInfo) {
+      hashedConfig.contentHash = streamConfigHash(hashedConfig, *typeInfo);
+    }
+  }
+  if (poolWarmCount() > 0 && producedStream_ && Framework::instance().memoryPool()) {
+    Framework::instance().memoryPool()->warmPool(
+        producedStream_->handle(), hashedConfig, poolWarmCount());
+  }
   if (!async_) {
-    producedStream_->configure(config);
+    producedStream_->configure(hashedConfig);
   } else {
     DataVariant item;
     item.type = DataVariant::Type::CONFIG;
-    item.config = std::move(config);
+    item.config = std::move(hashedConfig);
     std::lock_guard<std::mutex> lock(queueMutex_);
     queue_.push(std::move(item));
     if (queue_.size() > MAX_QUEUE_SIZE) {
@@ -70,6 +106,9 @@ void StreamProducer::configureStream(const StreamConfig& config) const {
 };
 
 void StreamProducer::produceSample(const StreamSample& sample) const {
+  if (producedStream_) {
+    Tracer::record(producedStream_->description().id(), sample, TracePhase::PRODUCE);
+  }
   if (!async_) {
     producedStream_->sendSample(sample);
   } else {
@@ -92,22 +131,35 @@ const StreamConfig* StreamProducer::config() const {
   return nullptr;
 };
 
+StreamHandle StreamProducer::handle() const {
+  return isActive() ? producedStream_->handle() : INVALID_STREAM_HANDLE;
+};
+
 StreamConsumer::StreamConsumer(
     StreamInterface* si,
     SampleCallback callback,
     ConfigCallback configCallback,
-    bool async)
+    bool async,
+    const ConsumerScheduling& scheduling)
     : callback_(callback),
       configCallback_(configCallback),
-      async_(async),
+      async_(async && !scheduling.scheduled),
       performanceMonitor_{},
-      queueCapacity_(DEFAULT_QUEUE_CAPACITY) {
+      queueCapacity_(DEFAULT_QUEUE_CAPACITY),
+      scheduling_(scheduling) {
   si->hookConsumer(this);
   consumedStream_ = si;
+  Watchdog::instance().watch(
+      this, WatchdogSubject::CONSUMER, si->description().id(), &heartbeat_, scheduling_.watchdog);
 
-  if (async) {
+  if (async_) {
     thread_ = std::thread(
         [this](std::future<void> signal) -> void {
+          Numa::applyThreadPlacement(ThreadRole::ASYNC_CONSUMER);
+          if (scheduling_.realtimeThread && scheduling_.priority == PriorityClass::REALTIME &&
+              !setCurrentThreadRealtime()) {
+            XR_LOGW("Failed to switch consumer thread to SCHED_FIFO");
+          }
           while (signal.wait_for(std::chrono::milliseconds(1)) == std::future_status::timeout) {
             try {
               Framework::validate();
@@ -121,16 +173,7 @@ StreamConsumer::StreamConsumer(
               std::swap(tempQueue, queue_);
             }
             while (!tempQueue.empty()) {
-              DataVariant& item = tempQueue.front();
-              if (item.type == DataVariant::Type::CONFIG) {
-                inhibitSampleCallback_ = !configCallback_(item.config);
-              } else if (item.type == DataVariant::Type::SAMPLE) {
-                if (!inhibitSampleCallback_) {
-                  performanceMonitor_.startMeasurement();
-                  callback_(item.sample);
-                  performanceMonitor_.endMeasurement();
-                }
-              }
+              deliver(tempQueue.front());
               tempQueue.pop();
             }
           }
@@ -143,6 +186,11 @@ StreamConsumer::~StreamConsumer() {
   if (consumedStream_ != nullptr) {
     consumedStream_->removeConsumer(this);
   }
+  Watchdog::instance().unwatch(this);
+
+  if (scheduling_.scheduled) {
+    DeliveryExecutor::instance().cancel(this);
+  }
 
   if (async_) {
     stopSignal_.set_value();
@@ -155,13 +203,18 @@ StreamConsumer::~StreamConsumer() {
 
 void StreamConsumer::receiveConfig(const StreamConfig& config) const {
   if (configCallback_ != nullptr) {
-    if (!async_) {
+    if (!async_ && !scheduling_.scheduled) {
       inhibitSampleCallback_ = !configCallback_(config);
     } else {
       DataVariant item;
       item.type = DataVariant::Type::CONFIG;
       item.config = std::move(config);
+      item.arrival = arrivalTime();
       std::lock_guard<std::mutex> lock(queueMutex_);
+      if (scheduling_.scheduled) {
+        enqueueScheduled(std::move(item));
+        return;
+      }
       queue_.push(std::move(item));
       if (queue_.size() > queueCapacity_) {
         queue_.pop();
@@ -171,25 +224,119 @@ void StreamConsumer::receiveConfig(const StreamConfig& config) const {
 };
 
 void StreamConsumer::consumeSample(const StreamSample& sample) const {
-  if (!async_) {
+  if (!async_ && !scheduling_.scheduled) {
     if (!inhibitSampleCallback_) {
-      performanceMonitor_.startMeasurement();
-      callback_(sample);
-      performanceMonitor_.endMeasurement();
+      heartbeat_.arrive();
+      deliverSample(sample, arrivalTime());
     }
   } else {
+    heartbeat_.arrive();
     DataVariant item;
     item.type = DataVariant::Type::SAMPLE;
     item.sample = std::move(sample);
+    item.arrival = arrivalTime();
     std::lock_guard<std::mutex> lock(queueMutex_);
+    if (scheduling_.scheduled) {
+      enqueueScheduled(std::move(item));
+      return;
+    }
     queue_.push(std::move(item));
     if (queue_.size() > queueCapacity_) {
       queue_.pop();
       performanceMonitor_.sampleDropped();
+      heartbeat_.drop();
     }
   }
 }
 
+void StreamConsumer::deliver(DataVariant& item) const {
+  if (item.type == DataVariant::Type::CONFIG) {
+    inhibitSampleCallback_ = !configCallback_(item.config);
+  } else if (item.type == DataVariant::Type::SAMPLE) {
+    if (!inhibitSampleCallback_) {
+      deliverSample(item.sample, item.arrival);
+    } else {
+      heartbeat_.drop();
+    }
+  }
+}
+
+std::chrono::steady_clock::time_point StreamConsumer::arrivalTime() const {
+  if (scheduling_.deadline.count() > 0) {
+    return std::chrono::steady_clock::now();
+  }
+  return std::chrono::steady_clock::time_point();
+}
+
+void StreamConsumer::deliverSample(
+    const StreamSample& sample,
+    std::chrono::steady_clock::time_point arrival) const {
+  const auto& id = consumedStream_->description().id();
+  Tracer::record(id, sample, TracePhase::CONSUME_BEGIN);
+  heartbeat_.begin();
+  performanceMonitor_.startMeasurement();
+  callback_(sample);
+  performanceMonitor_.endMeasurement();
+  heartbeat_.end();
+  Tracer::record(id, sample, TracePhase::CONSUME_END);
+
+  if (scheduling_.deadline.count() > 0 &&
+      std::chrono::steady_clock::now() - arrival > scheduling_.deadline) {
+    performanceMonitor_.deadlineMissed();
+    consumedStream_->deadlineMisses_++;
+  }
+}
+
+void StreamConsumer::enqueueScheduled(DataVariant&& item) const {
+  queue_.push(std::move(item));
+  if (queue_.size() > queueCapacity_) {
+    if (queue_.front().type == DataVariant::Type::SAMPLE) {
+      performanceMonitor_.sampleDropped();
+      heartbeat_.drop();
+    }
+    queue_.pop();
+  }
+  if (!submitted_) {
+    submitScheduled();
+  }
+}
+
+void StreamConsumer::submitScheduled() const {
+  auto deadline = DeliveryExecutor::Clock::time_point::max();
+  if (scheduling_.deadline.count() > 0) {
+    deadline = queue_.front().arrival +
+        std::chrono::duration_cast<DeliveryExecutor::Clock::duration>(scheduling_.deadline);
+  }
+  submitted_ = true;
+  DeliveryExecutor::instance().submit(
+      this, scheduling_.priority, deadline, scheduling_.realtimeThread, [this]() {
+        deliverScheduled();
+      });
+}
+
+void StreamConsumer::deliverScheduled() const {
+  DataVariant item;
+  {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    if (queue_.empty()) {
+      submitted_ = false;
+      return;
+    }
+    item = std::move(queue_.front());
+    queue_.pop();
+  }
+
+  deliver(item);
+
+  // Deliveries are submitted one at a time, so that they run in order and never concurrently
+  std::lock_guard<std::mutex> lock(queueMutex_);
+  if (queue_.empty()) {
+    submitted_ = false;
+  } else {
+    submitScheduled();
+  }
+}
+
 PerformanceSummary StreamConsumer::getPerformanceSummary() const {
   return performanceMonitor_.getSummary();
 }
@@ -8,6 +8,7 @@
 #include <logging/Log.h>
 
 #include <cthulhu/Framework.h>
+#include <cthulhu/Numa.h>
 
 #include <signal.h>
 #include <chrono>
@@ -48,6 +49,7 @@ StreamConsumerIPC::StreamConsumerIPC(
   }
 
   thread_ = std::thread([this] {
+    Numa::applyThreadPlacement(ThreadRole::IPC_LISTENER);
     while (!stopSignal_.load()) {
       update();
 
@@ -102,10 +104,15 @@ StreamProducerIPC::StreamProducerIPC(StreamInterfaceIPC* si) : streamInterface_(
   }
   streamInterface_->advertised_ = true;
   valid_ = true;
+
+  const auto& id = streamInterface_->description().id;
+  Watchdog::instance().watch(
+      this, WatchdogSubject::IPC_PRODUCER, std::string(id.begin(), id.end()), &heartbeat_);
 }
 
 StreamProducerIPC::~StreamProducerIPC() {
   if (valid_) {
+    Watchdog::instance().unwatch(this);
     ScopedLockIPC lock(streamInterface_->streamLock);
     streamInterface_->advertised_ = false;
   }
@@ -168,6 +175,7 @@ void StreamProducerIPC::publishValid(const StreamSampleIPC& sampleIn) {
 }
 
 void StreamProducerIPC::checkWaitForData(std::function<bool()> test) {
+  heartbeat_.begin();
   bool done = false;
   boost::system_time checkDelay =
       boost::get_system_time() + boost::posix_time::milliseconds(TIMEOUT_MILLISECONDS);
@@ -183,6 +191,7 @@ void StreamProducerIPC::checkWaitForData(std::function<bool()> test) {
     Framework::validate();
     checkDelay = boost::get_system_time() + boost::posix_time::milliseconds(TIMEOUT_MILLISECONDS);
   }
+  heartbeat_.end(true);
 
   // Clear our sample, since we don't want it to latch.
   {
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <cthulhu/StreamInterface.h>
+#include <cthulhu/Watchdog.h>
 #include "IPCEssentials.h"
 
 #include <boost/interprocess/containers/list.hpp>
@@ -67,6 +68,8 @@ struct StreamConfigIPC {
   uint32_t sampleSizeInBytes;
   SharedPtrIPC parameters;
   DynamicFields dynamicConfigParameters;
+  // StreamConfig::contentHash of the config this was copied from
+  uint64_t contentHash = 0;
 
   StreamConfigIPC(ManagedSHM::segment_manager* mgr) : dynamicConfigParameters(mgr) {}
 };
@@ -173,6 +176,8 @@ class StreamProducerIPC {
 
   StreamInterfaceIPC* streamInterface_ = nullptr;
   bool valid_ = false;
+  // Busy while waiting for consumers in checkWaitForData
+  Heartbeat heartbeat_;
 };
 
 } // namespace cthulhu
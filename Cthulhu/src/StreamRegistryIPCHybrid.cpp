@@ -3,15 +3,32 @@
 #include "StreamRegistryIPCHybrid.h"
 
 #include <cthulhu/Framework.h>
+#include <cthulhu/Tracing.h>
 
 #include <algorithm>
 #define DEFAULT_LOG_CHANNEL "Cthulhu"
 #include <logging/Log.h>
 
+#include <cstdlib>
 #include <iostream>
 
 namespace cthulhu {
 
+namespace {
+
+// How long a stream keeps allocating from shared memory after its last IPC subscriber left
+// (CTHULHU_IPC_DEACTIVATE_MS), so that a subscriber that reconnects, or briefly drops out, doesn't
+// bounce the allocations of the stream between shared and local memory
+std::chrono::steady_clock::duration deactivationDelay() {
+  static const std::chrono::steady_clock::duration delay = []() {
+    const char* value = std::getenv("CTHULHU_IPC_DEACTIVATE_MS");
+    return std::chrono::milliseconds(value ? std::strtoul(value, nullptr, 10) : 1000);
+  }();
+  return delay;
+}
+
+} // namespace
+
 StreamIPCHybrid::StreamIPCHybrid(
     const StreamDescription& desc,
     StreamInterfaceIPC* ipcStream,
@@ -20,10 +37,12 @@ StreamIPCHybrid::StreamIPCHybrid(
     size_t configParameterSize,
     size_t sampleDynamicFieldCount,
     size_t configDynamicFieldCount,
+    bool isBasic,
     ManagedSHM* shm)
     : StreamInterface(desc),
       ipcStream_(ipcStream),
       memoryPool_(memoryPool),
+      activation_(memoryPool->activation(handle_)),
       ipcActive_(false),
       ipcProducer_(nullptr),
       ipcConsumer_(nullptr),
@@ -31,23 +50,47 @@ StreamIPCHybrid::StreamIPCHybrid(
       configParameterSize_(configParameterSize),
       sampleDynamicFieldCount_(sampleDynamicFieldCount),
       configDynamicFieldCount_(configDynamicFieldCount),
-      shm_(shm) {}
+      isBasic_(isBasic),
+      shm_(shm) {
+  // Adaptive streams start out in local memory, until they see a subscriber in another process
+  if (activation_) {
+    activation_->shared.store(false, std::memory_order_release);
+  }
+}
 
 StreamIPCHybrid::~StreamIPCHybrid() = default;
 
 void StreamIPCHybrid::notifyMemoryPool() {
-  if (!ipcStream_) {
+  if (!ipcStream_ || !activation_) {
     return;
   }
-  if (ipcStream_->numSubscribers() > 0 && !ipcActive_) {
-    // Notify the memory pool that it should be allocating this on
-    // shared memory
-    memoryPool_->activateStream(description_.id(), true);
-    ipcActive_ = true;
-  } else if (ipcStream_->numSubscribers() == 0 && ipcActive_) {
-    memoryPool_->activateStream(description_.id(), false);
-    ipcActive_ = false;
+  ipcActive_ = ipcStream_->numSubscribers() > 0;
+  const bool shared = activation_->shared.load(std::memory_order_relaxed);
+  if (ipcActive_) {
+    idleSince_ = {};
+    if (!shared) {
+      activation_->shared.store(true, std::memory_order_release);
+    }
+    return;
   }
+  if (!shared) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  if (idleSince_ == std::chrono::steady_clock::time_point{}) {
+    idleSince_ = now;
+  } else if (now - idleSince_ >= deactivationDelay()) {
+    activation_->shared.store(false, std::memory_order_release);
+    idleSince_ = {};
+  }
+}
+
+bool StreamIPCHybrid::hasConsumers() const {
+  return StreamInterface::hasConsumers() || (ipcStream_ && ipcStream_->numSubscribers() > 0);
+}
+
+size_t StreamIPCHybrid::numConsumers() const {
+  return StreamInterface::numConsumers() + (ipcStream_ ? ipcStream_->numSubscribers() : 0);
 }
 
 bool StreamIPCHybrid::sendSample(const StreamSample& sample) {
@@ -81,7 +124,14 @@ void StreamIPCHybrid::sendSampleIPC(const StreamSample& sample) {
 
   switch (sample.payload.type) {
     case (BufferType::CPU): {
-      auto result = memoryPool_->convert(std::get<CpuBuffer>(sample.payload.data));
+      // Subscribers only ever see shared buffers, so a payload that was allocated locally (by
+      // policy, before the stream was activated, or while shared memory was exhausted) is promoted
+      const auto& payload = std::get<CpuBuffer>(sample.payload.data);
+      auto result = isBasic_
+          ? memoryPool_->convert(payload)
+          : memoryPool_->promote(
+                payload,
+                static_cast<size_t>(config_.sampleSizeInBytes) * sample.numberOfSubSamples);
       ipcSample.payload = result;
       ipcSample.payloadType = BufferType::CPU;
       lookupSuccess = result;
@@ -100,11 +150,10 @@ void StreamIPCHybrid::sendSampleIPC(const StreamSample& sample) {
     }
   }
 
-  if (sample.payload && !lookupSuccess &&
-      !Framework::instance().typeRegistry()->findTypeID(description_.type())->isBasic()) {
+  if (sample.payload && !lookupSuccess && !isBasic_) {
     if (ipcActive_) {
       XR_LOGW(
-          "StreamIPCHybrid - Failed to lookup shared memory pointer for payload of stream '{}'",
+          "StreamIPCHybrid - Failed to get a shared memory buffer for payload of stream '{}'",
           description_.id());
     }
     return;
@@ -118,16 +167,7 @@ void StreamIPCHybrid::sendSampleIPC(const StreamSample& sample) {
     ipcSample.processingStamps[key] = processingStamp.second;
   }
   if (sample.parameters) {
-    auto sharedParametersPtr = memoryPool_->convert(sample.parameters);
-    if (sharedParametersPtr) {
-      ipcSample.parameters = sharedParametersPtr;
-    } else {
-      XR_LOGW_ONCE(
-          "StreamIPCHybrid - Failed to lookup shared memory pointer when sending parameters of stream '{}'",
-          description_.id());
-      ipcSample.parameters = memoryPool_->getBufferFromSharedPoolDirect(sampleParameterSize_);
-      memcpy(ipcSample.parameters.get().get(), sample.parameters.get(), sampleParameterSize_);
-    }
+    ipcSample.parameters = memoryPool_->promote(sample.parameters, sampleParameterSize_);
   }
 
   if (sample.dynamicParameters) {
@@ -139,23 +179,11 @@ void StreamIPCHybrid::sendSampleIPC(const StreamSample& sample) {
       rawDynamicIPC.elementCount = rawDynamic.elementCount;
       rawDynamicIPC.elementSize = rawDynamic.elementSize;
 
-      auto sharedDynamicParameterPtr = memoryPool_->convert(rawDynamic.raw);
-      if (sharedDynamicParameterPtr) {
-        rawDynamicIPC.raw = sharedDynamicParameterPtr;
-      } else {
-        XR_LOGW_ONCE(
-            "StreamIPCHybrid - Failed to lookup shared memory pointer when sending dynamic parameter {} of stream '{}'",
-            idx,
-            description_.id());
-        rawDynamicIPC.raw = memoryPool_->getBufferFromSharedPoolDirect(
-            rawDynamicIPC.elementCount * rawDynamicIPC.elementSize);
-        std::memcpy(
-            rawDynamicIPC.raw.get().get(),
-            rawDynamic.raw.get(),
-            rawDynamicIPC.elementCount * rawDynamicIPC.elementSize);
-      }
+      rawDynamicIPC.raw = memoryPool_->promote(
+          rawDynamic.raw, rawDynamicIPC.elementCount * rawDynamicIPC.elementSize);
     }
   }
+  Tracer::record(description_.id(), sample, TracePhase::IPC_SEND);
   ipcProducer_->publish(ipcSample);
 }
 
@@ -181,17 +209,24 @@ void StreamIPCHybrid::configureIPC(const StreamConfig& config) {
     return;
   }
   notifyMemoryPool();
-  StreamConfigIPC ipcConfig(shm_->get_segment_manager());
-  ipcConfig.nominalSampleRate = config.nominalSampleRate;
-  ipcConfig.sampleSizeInBytes = config.sampleSizeInBytes;
-  ipcConfig.parameters = memoryPool_->getBufferFromSharedPoolDirect(configParameterSize_);
-  memcpy(ipcConfig.parameters.get().get(), config.parameters.get(), configParameterSize_);
+  if (config.contentHash != 0 && sentConfigIPC_ &&
+      sentConfigIPC_->contentHash == config.contentHash) {
+    ipcProducer_->configure(*sentConfigIPC_);
+    return;
+  }
+
+  auto ipcConfig = std::make_unique<StreamConfigIPC>(shm_->get_segment_manager());
+  ipcConfig->nominalSampleRate = config.nominalSampleRate;
+  ipcConfig->sampleSizeInBytes = config.sampleSizeInBytes;
+  ipcConfig->contentHash = config.contentHash;
+  ipcConfig->parameters = memoryPool_->getBufferFromSharedPoolDirect(configParameterSize_);
+  memcpy(ipcConfig->parameters.get().get(), config.parameters.get(), configParameterSize_);
 
   if (config.dynamicParameters) {
-    ipcConfig.dynamicConfigParameters =
+    ipcConfig->dynamicConfigParameters =
         DynamicFields(configDynamicFieldCount_, shm_->get_segment_manager());
-    for (size_t idx = 0; idx < ipcConfig.dynamicConfigParameters.size(); ++idx) {
-      auto& rawDynamicIPC = ipcConfig.dynamicConfigParameters[idx];
+    for (size_t idx = 0; idx < ipcConfig->dynamicConfigParameters.size(); ++idx) {
+      auto& rawDynamicIPC = ipcConfig->dynamicConfigParameters[idx];
       const auto& rawDynamic = *(config.dynamicParameters.get() + idx);
       rawDynamicIPC.elementCount = rawDynamic.elementCount;
       rawDynamicIPC.elementSize = rawDynamic.elementSize;
@@ -204,13 +239,19 @@ void StreamIPCHybrid::configureIPC(const StreamConfig& config) {
     }
   }
 
-  ipcProducer_->configure(ipcConfig);
+  ipcProducer_->configure(*ipcConfig);
+  sentConfigIPC_ = std::move(ipcConfig);
 }
 
 bool StreamIPCHybrid::receiveConfigIPC(const StreamConfigIPC& config) {
+  if (config.contentHash != 0 && receivedConfig_.contentHash == config.contentHash) {
+    return configure(receivedConfig_);
+  }
+
   StreamConfig local;
   local.nominalSampleRate = config.nominalSampleRate;
   local.sampleSizeInBytes = config.sampleSizeInBytes;
+  local.contentHash = config.contentHash;
   local.parameters.reset(new uint8_t[configParameterSize_], [](uint8_t* p) -> void { delete[] p; });
   memcpy(local.parameters.get(), config.parameters.get().get(), configParameterSize_);
 
@@ -231,10 +272,12 @@ bool StreamIPCHybrid::receiveConfigIPC(const StreamConfigIPC& config) {
     }
   }
 
+  receivedConfig_ = local;
   return configure(local);
 }
 
 bool StreamIPCHybrid::receiveSampleIPC(const StreamSampleIPC& sample) {
+  Tracer::record(description_.id(), sample.sequenceNumber, TracePhase::IPC_RECEIVE);
   StreamSample local;
   local.metadata.reset(new SampleMetadata());
   local.metadata->header.timestamp = sample.timestamp;
@@ -313,13 +356,12 @@ void StreamIPCHybrid::hookConsumer(const StreamConsumer* const consumer) {
   consumers_.push_back(consumer);
   // If this is a basic stream, none of the downstream consumers are expecting to use
   // the config, but we still need to produce the signal
-  bool isBasic = Framework::instance().typeRegistry()->findTypeID(description_.type())->isBasic();
-  if (isConfigured() || isBasic) {
+  if (isConfigured() || isBasic_) {
     consumer->receiveConfig(config_);
   }
   std::function<bool(const StreamConfigIPC&)> configCb = nullptr;
   if (ipcStream_) {
-    if (!isBasic) {
+    if (!isBasic_) {
       configCb = [this](const StreamConfigIPC& config) -> bool {
         return this->receiveConfigIPC(config);
       };
@@ -348,7 +390,7 @@ void StreamIPCHybrid::removeProducer(const StreamProducer* const producer) {
     ipcProducer_.reset();
     if (consumers_.size() > 0) {
       std::function<bool(const StreamConfigIPC&)> configCb = nullptr;
-      if (!Framework::instance().typeRegistry()->findTypeID(description_.type())->isBasic()) {
+      if (!isBasic_) {
         configCb = [this](const StreamConfigIPC& config) -> bool {
           return this->receiveConfigIPC(config);
         };
@@ -469,6 +511,7 @@ StreamInterface* StreamRegistryIPCHybrid::registerStream(const StreamDescription
           configSize,
           sampleDynamicFieldCount,
           configDynamicFieldCount,
+          type->isBasic(),
           shm_)));
   return static_cast<StreamInterface*>(&(streams_.find(desc.id())->second));
 }
@@ -523,6 +566,7 @@ StreamInterface* StreamRegistryIPCHybrid::getStream(const StreamID& id) {
           configSize,
           sampleDynamicFieldCount,
           configDynamicFieldCount,
+          type->isBasic(),
           shm_)));
   return static_cast<StreamInterface*>(&(streams_.find(desc.id())->second));
 }
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <mutex>
 
@@ -23,6 +24,7 @@ class StreamIPCHybrid : public StreamInterface {
       size_t configParameterSize,
       size_t sampleDynamicFieldCount,
       size_t configDynamicFieldCount,
+      bool isBasic,
       ManagedSHM*);
   virtual ~StreamIPCHybrid();
 
@@ -35,6 +37,8 @@ class StreamIPCHybrid : public StreamInterface {
       : StreamInterface(std::move(other)),
         ipcStream_(other.ipcStream_),
         memoryPool_(other.memoryPool_),
+        activation_(other.activation_),
+        idleSince_(other.idleSince_),
         ipcActive_(other.ipcActive_),
         ipcProducer_(std::move(other.ipcProducer_)),
         ipcConsumer_(std::move(other.ipcConsumer_)),
@@ -42,10 +46,17 @@ class StreamIPCHybrid : public StreamInterface {
         configParameterSize_(other.configParameterSize_),
         sampleDynamicFieldCount_(other.sampleDynamicFieldCount_),
         configDynamicFieldCount_(other.configDynamicFieldCount_),
-        shm_(other.shm_) {}
+        isBasic_(other.isBasic_),
+        shm_(other.shm_),
+        sentConfigIPC_(std::move(other.sentConfigIPC_)),
+        receivedConfig_(std::move(other.receivedConfig_)) {}
   // Non move assignable, shouldn't be needed
   StreamIPCHybrid& operator=(StreamIPCHybrid&& other) = delete;
 
+  virtual bool hasConsumers() const override;
+
+  virtual size_t numConsumers() const override;
+
  protected:
   virtual bool sendSample(const StreamSample& sample) override;
 
@@ -60,6 +71,8 @@ class StreamIPCHybrid : public StreamInterface {
   virtual void removeConsumer(const StreamConsumer* const consumer) override;
 
  private:
+  // Activates shared memory allocations as soon as the stream has IPC subscribers, and deactivates
+  // them once it has had none for a while. Called by the producer while it holds the stream lock.
   void notifyMemoryPool();
   void sendSampleIPC(const StreamSample& sample);
   void configureIPC(const StreamConfig& config);
@@ -69,6 +82,13 @@ class StreamIPCHybrid : public StreamInterface {
   StreamInterfaceIPC* ipcStream_;
   MemoryPoolIPCHybrid* memoryPool_;
 
+  // Owned by the memory pool, which reads it on every allocation of the stream
+  StreamActivation* activation_;
+  // When the stream was first seen without IPC subscribers since it last had some, while its
+  // buffers were still shared. Unset while it has subscribers.
+  std::chrono::steady_clock::time_point idleSince_;
+
+  // Whether the stream had IPC subscribers when it was last checked
   bool ipcActive_;
 
   std::unique_ptr<StreamProducerIPC> ipcProducer_;
@@ -78,7 +98,14 @@ class StreamIPCHybrid : public StreamInterface {
   size_t configParameterSize_;
   size_t sampleDynamicFieldCount_;
   size_t configDynamicFieldCount_;
+  // Whether the type of the stream is basic, i.e., has no config
+  bool isBasic_;
   ManagedSHM* shm_;
+
+  // The last config sent to and received from IPC subscribers. A config with the same contentHash
+  // reuses their buffers instead of being copied again.
+  std::unique_ptr<StreamConfigIPC> sentConfigIPC_;
+  StreamConfig receivedConfig_;
 };
 
 class StreamRegistryIPCHybrid : public StreamRegistryInterface {
@@ -4,6 +4,8 @@
 
 #include <cthulhu/Framework.h>
 
+#include <limits>
+
 namespace cthulhu {
 
 StreamConfig& ConfigAccessor::config(AutoStreamConfig* wrapper) {
@@ -11,6 +13,11 @@ StreamConfig& ConfigAccessor::config(AutoStreamConfig* wrapper) {
 }
 
 StreamSample& SampleAccessor::sample(AutoStreamSample* wrapper) {
+  // Writing through a borrowed sample would modify data we don't own, so take a copy first
+  if (wrapper->borrowed_) {
+    wrapper->sample_ = *wrapper->borrowed_;
+    wrapper->borrowed_ = nullptr;
+  }
   return wrapper->sample_;
 }
 
@@ -73,7 +80,8 @@ SampleSize& SampleSize::operator=(const uint32_t& value) {
 
 AutoStreamSample::AutoStreamSample(size_t size, size_t numberDynamicFields) {
   if (size > 0) {
-    sample_.parameters = Framework::instance().memoryPool()->getBufferFromPool("", size);
+    sample_.parameters =
+        Framework::instance().memoryPool()->getBufferFromPool(StreamHandles::anonymous(), size);
     memset(sample_.parameters.get(), 0, size);
   }
   if (numberDynamicFields > 0) {
@@ -87,7 +95,8 @@ AutoStreamSample::AutoStreamSample(
     size_t numberDynamicFields)
     : sample_(sample) {
   if (!sample_.parameters && size > 0) {
-    sample_.parameters = Framework::instance().memoryPool()->getBufferFromPool("", size);
+    sample_.parameters =
+        Framework::instance().memoryPool()->getBufferFromPool(StreamHandles::anonymous(), size);
     memset(sample_.parameters.get(), 0, size);
   }
   if (!sample_.dynamicParameters && numberDynamicFields > 0) {
@@ -95,14 +104,18 @@ AutoStreamSample::AutoStreamSample(
   }
 }
 
+AutoStreamSample::AutoStreamSample(details::borrowed_sample, const StreamSample* sample)
+    : sample_(StreamSample::Unallocated()), borrowed_(sample) {}
+
 AutoStreamSample ::~AutoStreamSample() {}
 
 const StreamSample& AutoStreamSample::getSample() const {
-  return sample_;
+  return borrowed_ ? *borrowed_ : sample_;
 }
 
 void AutoStreamSample::setSample(const StreamSample& sample) {
   sample_ = sample;
+  borrowed_ = nullptr;
 }
 
 HeaderTimestamp::HeaderTimestamp(AutoStreamSample* wrapper) {
@@ -149,16 +162,25 @@ HeaderSequence& HeaderSequence::operator=(const uint32_t& value) {
 
 ProcessingTimestamp::ProcessingTimestamp(const std::string& stampName, AutoStreamSample* wrapper)
     : stampName_(stampName), wrapper_(wrapper) {
-  // Add the named stamp to the sample if it doesn't exist
-  wrapper_->getSample().metadata->processingStamps[stampName_];
+  // Add the named stamp to the sample if it doesn't exist. Unbound views carry no metadata.
+  if (wrapper_->getSample().metadata) {
+    wrapper_->getSample().metadata->processingStamps[stampName_];
+  }
 }
 
 const double& ProcessingTimestamp::get() const {
-  return wrapper_->getSample().metadata->processingStamps.at(stampName_);
+  // A view rebound to another sample may find it without the stamp, or without metadata at all
+  static const double missing = std::numeric_limits<double>::quiet_NaN();
+  const auto& metadata = wrapper_->getSample().metadata;
+  if (!metadata) {
+    return missing;
+  }
+  const auto it = metadata->processingStamps.find(stampName_);
+  return it != metadata->processingStamps.end() ? it->second : missing;
 }
 
 ProcessingTimestamp::operator const double&() const {
-  return wrapper_->getSample().metadata->processingStamps.at(stampName_);
+  return get();
 }
 
 void ProcessingTimestamp::set(const double& value) {
@@ -91,6 +91,7 @@ void SubAligner::registerConsumer(StreamInterface* si, int index) {
     return configCallback(index, config);
   };
   streams_[index].streamID = si->description().id();
+  streams_[index].handle = si->handle();
   streams_[index].consumer = std::make_unique<StreamConsumer>(si, callback, ccallback);
 }
 
@@ -102,6 +103,32 @@ void SubAligner::setDefaultMetronome(bool value) {
   defaultUseMetronome_ = value;
 }
 
+void SubAligner::setDefaultLineage(const LineageSettings& settings, size_t lineageCapacity) {
+  std::lock_guard<std::mutex> lock(globalMutex_);
+  defaultLineage_ = settings;
+  lineageTable_.setCapacity(lineageCapacity);
+  for (size_t idx = 0; idx < streams_.size(); ++idx) {
+    streams_[idx].lineage = lineageSettings(idx);
+  }
+}
+
+std::optional<std::vector<LineageRecord>> SubAligner::lineage(size_t idx, uint32_t sequenceNumber)
+    const {
+  return lineageTable_.lookup(idx, sequenceNumber);
+}
+
+LineageSettings SubAligner::lineageSettings(size_t idx) const {
+  auto settings = defaultLineage_;
+  if (settings_.size() > idx && settings_[idx].lineage) {
+    settings = *settings_[idx].lineage;
+  }
+  auto hint = settingHints_.find(streams_[idx].streamID);
+  if (hint != settingHints_.end() && hint->second.lineage) {
+    settings = *hint->second.lineage;
+  }
+  return settings;
+}
+
 void SubAligner::align() {
   if (!finalized_) {
     return;
@@ -192,6 +219,13 @@ void SubAligner::processManifests(
         auto& sampleMap = context.streams.at(sindex).sampleMap;
         const uint32_t sampleSize = context.streams.at(sindex).config.sampleSizeInBytes;
         sampleMeta.references.resize(stream.second.size());
+        // The output sequence number is only assigned below, but it is already known
+        const bool keepLineage =
+            sample && streams_.at(sindex).lineage.shouldRecord(streams_.at(sindex).sequenceOut);
+        std::vector<LineageRecord> inputs;
+        if (keepLineage) {
+          inputs.reserve(stream.second.size());
+        }
         size_t ridx = 0;
         for (auto& r : stream.second) {
           if (sampleMap.find(r.buffer_tagged.sequence_number) == sampleMap.end()) {
@@ -207,11 +241,12 @@ void SubAligner::processManifests(
           sampleMeta.references[ridx].subSampleOffset = r.nrbytes_offset / sampleSize;
           sampleMeta.references[ridx].numSubSamples = r.nrbytes_length / sampleSize;
           length += r.nrbytes_length;
-          std::string sequenceString = std::to_string(r.buffer_tagged.sequence_number);
-          // Copy full history
+          if (keepLineage) {
+            inputs.push_back(LineageRecord{
+                static_cast<uint32_t>(sindex), sampleMeta.references[ridx].sequenceNumber});
+          }
           if (sample) {
-            sample->metadata->history["subaligner_" + sequenceString] =
-                sampleMap[r.buffer_tagged.sequence_number].metadata;
+            std::string sequenceString = std::to_string(r.buffer_tagged.sequence_number);
             sample->metadata->processingStamps["subaligner_" + sequenceString + "_start"] =
                 sampleMap[r.buffer_tagged.sequence_number]
                     .metadata->processingStamps["subaligner_start"];
@@ -224,7 +259,7 @@ void SubAligner::processManifests(
           sample->parameters = sampleMap[stream.second[0].buffer_tagged.sequence_number].parameters;
           sample->numberOfSubSamples = length / sampleSize;
           sample->payload = Framework::instance().memoryPool()->getBufferFromPool(
-              streams_.at(sindex).streamID, length);
+              streams_.at(sindex).handle, length);
           ptr = ((CpuBuffer)sample->payload).get();
         }
         for (auto& r : stream.second) {
@@ -253,6 +288,10 @@ void SubAligner::processManifests(
         if (sample) {
           sample->metadata->header.sequenceNumber = streams_.at(sindex).sequenceOut++;
           sample->metadata->header.timestamp = sample_timestamp;
+          if (keepLineage) {
+            lineageTable_.record(
+                sindex, sample->metadata->header.sequenceNumber, std::move(inputs));
+          }
         }
         // effective computed duration of the manifest for this sample
         sampleMeta.timestamp = sample_timestamp;
@@ -314,6 +353,8 @@ void SubAligner::enroll(
     metronome = settingHints_[sid].useMetronome;
   }
 
+  streams_[idx].lineage = lineageSettings(idx);
+
   auto& streamData = context.streams[idx];
   // Enroll in aligner and store interface
   streamData.interface = context.impl->enroll(
@@ -339,6 +380,7 @@ void SubAligner::enroll(
 }
 
 void SubAligner::sampleCallback(size_t idx, const StreamSample& sample) {
+  heartbeat_.arrive();
   int activeContext;
   {
     std::lock_guard<std::mutex> lock(globalMutex_);
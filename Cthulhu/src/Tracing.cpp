@@ -0,0 +1,267 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/Tracing.h>
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+#include <boost/interprocess/detail/os_thread_functions.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CTHULHU_TRACE_USE_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace cthulhu {
+
+namespace {
+
+const char* DEFAULT_SHM_NAME = "CthulhuSHM";
+const uint32_t DEFAULT_RING_CAPACITY = 1 << 16;
+
+uint64_t steadyNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint64_t readTicks() {
+#ifdef CTHULHU_TRACE_USE_TSC
+  return __rdtsc();
+#else
+  return steadyNs();
+#endif
+}
+
+// Measures the tick rate against the steady clock. This spins for a few milliseconds, but only
+// once per process, when the first ring is created.
+double ticksPerSecond() {
+#ifdef CTHULHU_TRACE_USE_TSC
+  static const double rate = []() -> double {
+    const uint64_t startNs = steadyNs();
+    const uint64_t startTicks = readTicks();
+    while (steadyNs() - startNs < 10000000) {
+    }
+    const uint64_t endNs = steadyNs();
+    const uint64_t endTicks = readTicks();
+    return (endTicks - startTicks) * 1e9 / (endNs - startNs);
+  }();
+  return rate;
+#else
+  return 1e9;
+#endif
+}
+
+uint32_t ringCapacity() {
+  const char* capacity = std::getenv("CTHULHU_TRACE_EVENTS");
+  if (capacity) {
+    const long value = std::strtol(capacity, nullptr, 10);
+    if (value > 0) {
+      return static_cast<uint32_t>(value);
+    }
+  }
+  return DEFAULT_RING_CAPACITY;
+}
+
+// Maps the index, creating it if no ring was created yet
+boost::interprocess::mapped_region mapIndex() {
+  using namespace boost::interprocess;
+  const auto indexName = Tracer::indexName();
+  shared_memory_object shm(open_or_create, indexName.c_str(), read_write);
+  offset_t size = 0;
+  if (!shm.get_size(size) || size < static_cast<offset_t>(sizeof(TraceIndex))) {
+    shm.truncate(sizeof(TraceIndex));
+  }
+  return mapped_region(shm, read_write, 0, sizeof(TraceIndex));
+}
+
+// A single-writer ring of trace events in shared memory, owned by the thread that writes to it.
+// The slot is handed back to the index when the ring is destroyed, on exit of its thread.
+class TraceRing {
+ public:
+  TraceRing(boost::interprocess::mapped_region index, uint32_t slot, uint32_t capacity)
+      : indexRegion_(std::move(index)),
+        index_(static_cast<TraceIndex*>(indexRegion_.get_address())),
+        slot_(slot) {
+    using namespace boost::interprocess;
+    const auto name = Tracer::ringName(slot);
+    shared_memory_object::remove(name.c_str());
+    shared_memory_object shm(create_only, name.c_str(), read_write);
+    shm.truncate(sizeof(TraceRingHeader) + capacity * sizeof(TraceEvent));
+    region_ = mapped_region(shm, read_write);
+
+    header_ = new (region_.get_address()) TraceRingHeader();
+    header_->magic = Tracer::kMagic;
+    header_->capacity = capacity;
+    header_->pid = static_cast<uint32_t>(ipcdetail::get_current_process_id());
+    header_->tid =
+        static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    header_->ticksPerSecond = ticksPerSecond();
+    header_->wallBaseNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::system_clock::now().time_since_epoch())
+                              .count();
+    header_->ticksBase = readTicks();
+    header_->head.store(0, std::memory_order_relaxed);
+    events_ = reinterpret_cast<TraceEvent*>(header_ + 1);
+  }
+
+  ~TraceRing() {
+    index_->released[slot_].store(1, std::memory_order_release);
+  }
+
+  void push(const StreamIDView& id, uint32_t sequenceNumber, TracePhase phase) {
+    const uint64_t head = header_->head.load(std::memory_order_relaxed);
+    TraceEvent& event = events_[head % header_->capacity];
+    event.ticks = readTicks();
+    event.sequenceNumber = sequenceNumber;
+    event.phase = phase;
+    const size_t length = std::min(id.size(), sizeof(event.streamID) - 1);
+    std::memcpy(event.streamID, id.data(), length);
+    event.streamID[length] = '\0';
+    header_->head.store(head + 1, std::memory_order_release);
+  }
+
+ private:
+  boost::interprocess::mapped_region indexRegion_;
+  TraceIndex* index_;
+  uint32_t slot_;
+  boost::interprocess::mapped_region region_;
+  TraceRingHeader* header_ = nullptr;
+  TraceEvent* events_ = nullptr;
+};
+
+std::unique_ptr<TraceRing> createRing() {
+  try {
+    auto region = mapIndex();
+    // Freshly created shared memory is zeroed, so the counter starts at 0
+    auto index = static_cast<TraceIndex*>(region.get_address());
+
+    // Take over the ring of a thread that exited, before creating a new one
+    uint32_t slot = kMaxTraceRings;
+    const uint32_t numRings = std::min(index->numRings.load(), kMaxTraceRings);
+    for (uint32_t candidate = 0; candidate < numRings; candidate++) {
+      uint8_t released = 1;
+      if (index->released[candidate].compare_exchange_strong(released, 0)) {
+        slot = candidate;
+        break;
+      }
+    }
+    if (slot == kMaxTraceRings) {
+      slot = index->numRings.fetch_add(1);
+      if (slot >= kMaxTraceRings) {
+        throw std::runtime_error(
+            "Too many threads are tracing, at most " + std::to_string(kMaxTraceRings));
+      }
+    }
+
+    try {
+      return std::make_unique<TraceRing>(std::move(region), slot, ringCapacity());
+    } catch (...) {
+      index->released[slot].store(1, std::memory_order_release);
+      throw;
+    }
+  } catch (const std::exception& e) {
+    XR_LOGW_ONCE("Failed to create trace ring, events on this thread are dropped: {}", e.what());
+    return nullptr;
+  }
+}
+
+} // namespace
+
+std::string Tracer::indexName() {
+  const char* shmName = std::getenv("CTHULHU_SHM_NAME");
+  return std::string(shmName ? shmName : DEFAULT_SHM_NAME) + "_trace";
+}
+
+std::string Tracer::ringName(uint32_t slot) {
+  return indexName() + "_" + std::to_string(slot);
+}
+
+uint32_t Tracer::numRings() {
+  using namespace boost::interprocess;
+  try {
+    shared_memory_object shm(open_only, indexName().c_str(), read_only);
+    mapped_region region(shm, read_only, 0, sizeof(uint32_t));
+    return std::min(
+        static_cast<const TraceIndex*>(region.get_address())->numRings.load(), kMaxTraceRings);
+  } catch (const interprocess_exception&) {
+    return 0;
+  }
+}
+
+bool Tracer::readRing(uint32_t slot, std::vector<CollectedTraceEvent>& events) {
+  using namespace boost::interprocess;
+  const auto name = ringName(slot);
+  try {
+    shared_memory_object shm(open_only, name.c_str(), read_only);
+    mapped_region region(shm, read_only);
+    if (region.get_size() < sizeof(TraceRingHeader)) {
+      return false;
+    }
+    auto header = static_cast<const TraceRingHeader*>(region.get_address());
+    if (header->magic != kMagic ||
+        region.get_size() < sizeof(TraceRingHeader) + header->capacity * sizeof(TraceEvent)) {
+      XR_LOGW("Skipping malformed trace ring {}", name);
+      return false;
+    }
+    auto ringEvents = reinterpret_cast<const TraceEvent*>(header + 1);
+    const uint64_t head = header->head.load(std::memory_order_acquire);
+    const uint64_t first = head > header->capacity ? head - header->capacity : 0;
+    for (uint64_t i = first; i < head; i++) {
+      const auto& event = ringEvents[i % header->capacity];
+      const double offsetUs =
+          static_cast<double>(event.ticks - header->ticksBase) / header->ticksPerSecond * 1e6;
+      events.push_back(CollectedTraceEvent{
+          header->wallBaseNs / 1e3 + offsetUs,
+          slot,
+          header->pid,
+          header->tid,
+          event.sequenceNumber,
+          event.phase,
+          std::string(event.streamID, strnlen(event.streamID, sizeof(event.streamID)))});
+    }
+    return true;
+  } catch (const interprocess_exception&) {
+    return false;
+  }
+}
+
+uint32_t Tracer::removeRings() {
+  using namespace boost::interprocess;
+  uint32_t removed = 0;
+  const uint32_t rings = numRings();
+  for (uint32_t slot = 0; slot < rings; slot++) {
+    if (shared_memory_object::remove(ringName(slot).c_str())) {
+      removed++;
+    }
+  }
+  shared_memory_object::remove(indexName().c_str());
+  return removed;
+}
+
+void Tracer::recordEvent(const StreamIDView& id, uint32_t sequenceNumber, TracePhase phase) {
+  thread_local bool initialized = false;
+  thread_local std::unique_ptr<TraceRing> ring;
+  if (!initialized) {
+    ring = createRing();
+    initialized = true;
+  }
+  if (ring) {
+    ring->push(id, sequenceNumber, phase);
+  }
+}
+
+} // namespace cthulhu
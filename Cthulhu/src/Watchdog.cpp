@@ -0,0 +1,204 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <cthulhu/Watchdog.h>
+
+#define DEFAULT_LOG_CHANNEL "Cthulhu"
+#include <logging/Log.h>
+
+#include <cthulhu/Numa.h>
+
+#include <cstdlib>
+
+namespace cthulhu {
+
+namespace {
+
+const long DEFAULT_PERIOD_MILLISECONDS = 10;
+
+std::chrono::milliseconds checkPeriod() {
+  const char* value = std::getenv("CTHULHU_WATCHDOG_PERIOD_MS");
+  if (value) {
+    const long period = std::strtol(value, nullptr, 10);
+    if (period > 0) {
+      return std::chrono::milliseconds(period);
+    }
+  }
+  return std::chrono::milliseconds(DEFAULT_PERIOD_MILLISECONDS);
+}
+
+const char* subjectName(WatchdogSubject subject) {
+  switch (subject) {
+    case WatchdogSubject::CONSUMER:
+      return "Consumer";
+    case WatchdogSubject::ALIGNER:
+      return "Aligner";
+    case WatchdogSubject::IPC_PRODUCER:
+      return "IPC producer";
+  }
+  return "Unknown";
+}
+
+// A field of the subject's own budget, or else of its stream's
+double budgetOf(
+    const std::chrono::duration<double>& own,
+    const std::chrono::duration<double>* stream) {
+  if (own.count() > 0) {
+    return own.count();
+  }
+  return stream ? stream->count() : 0.0;
+}
+
+} // namespace
+
+Watchdog& Watchdog::instance() {
+  // Leaked, since consumers unwatch themselves when they are destroyed, which may be during static
+  // destruction. The monitor thread is detached for the same reason.
+  static auto* watchdog = new Watchdog();
+  return *watchdog;
+}
+
+void Watchdog::setBudget(const std::string& streamID, const WatchdogBudget& budget) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (budget.empty()) {
+    budgets_.erase(streamID);
+  } else {
+    budgets_[streamID] = budget;
+    startMonitor();
+  }
+  for (const auto& entry : entries_) {
+    if (entry.second.name == streamID) {
+      updateHeartbeat(entry.second);
+    }
+  }
+}
+
+size_t Watchdog::addCallback(const WatchdogCallback& callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  callbacks_[nextCallbackID_] = callback;
+  return nextCallbackID_++;
+}
+
+void Watchdog::removeCallback(size_t callbackID) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_.erase(callbackID);
+  }
+  // Wait for a round of callbacks that may still hold a copy of it
+  std::lock_guard<std::mutex> lock(callbackMutex_);
+}
+
+void Watchdog::watch(
+    const void* owner,
+    WatchdogSubject subject,
+    const std::string& name,
+    Heartbeat* heartbeat,
+    const WatchdogBudget& budget) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto& entry = entries_[owner] = Entry{subject, name, heartbeat, budget};
+  updateHeartbeat(entry);
+  if (!budget.empty()) {
+    startMonitor();
+  }
+}
+
+void Watchdog::unwatch(const void* owner) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.erase(owner);
+}
+
+void Watchdog::updateHeartbeat(const Entry& entry) const {
+  entry.heartbeat->enable(!entry.budget.empty() || budgets_.count(entry.name) > 0);
+}
+
+void Watchdog::startMonitor() {
+  if (!monitorStarted_) {
+    monitorStarted_ = true;
+    std::thread([this]() { run(); }).detach();
+  }
+}
+
+void Watchdog::run() {
+  Numa::applyThreadPlacement(ThreadRole::WATCHDOG);
+  const auto period = checkPeriod();
+  std::vector<WatchdogAlert> alerts;
+  std::vector<WatchdogCallback> callbacks;
+  while (true) {
+    std::this_thread::sleep_for(period);
+
+    std::lock_guard<std::mutex> callbackLock(callbackMutex_);
+    alerts.clear();
+    callbacks.clear();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const int64_t now = Heartbeat::nowNs();
+      for (auto& entry : entries_) {
+        check(entry.second, now, alerts);
+      }
+      if (!alerts.empty()) {
+        for (const auto& callback : callbacks_) {
+          callbacks.push_back(callback.second);
+        }
+      }
+    }
+
+    for (const auto& alert : alerts) {
+      switch (alert.event) {
+        case WatchdogEvent::STALL:
+          XR_LOGW(
+              "{} of {} stalled: busy for {:.3f}s, budget {:.3f}s",
+              subjectName(alert.subject),
+              alert.name,
+              alert.observed,
+              alert.budget);
+          break;
+        case WatchdogEvent::LAG:
+          XR_LOGW(
+              "{} of {} is lagging: sample waiting for {:.3f}s, budget {:.3f}s",
+              subjectName(alert.subject),
+              alert.name,
+              alert.observed,
+              alert.budget);
+          break;
+        case WatchdogEvent::RECOVERED:
+          XR_LOGI("{} of {} recovered", subjectName(alert.subject), alert.name);
+          break;
+      }
+      for (const auto& callback : callbacks) {
+        callback(alert);
+      }
+    }
+  }
+}
+
+void Watchdog::check(Entry& entry, int64_t now, std::vector<WatchdogAlert>& alerts) const {
+  auto streamBudget = budgets_.find(entry.name);
+  const WatchdogBudget* stream = streamBudget == budgets_.end() ? nullptr : &streamBudget->second;
+  const double maxCallbackTime =
+      budgetOf(entry.budget.maxCallbackTime, stream ? &stream->maxCallbackTime : nullptr);
+  // Producers don't queue samples, so only their waits are checked
+  const double maxAge = entry.subject == WatchdogSubject::IPC_PRODUCER
+      ? 0.0
+      : budgetOf(entry.budget.maxAge, stream ? &stream->maxAge : nullptr);
+
+  const bool wasAlerting = entry.stalled || entry.lagging;
+  const double busy = entry.heartbeat->busy(now);
+  const bool stalled = maxCallbackTime > 0 && busy > maxCallbackTime;
+  if (stalled && !entry.stalled) {
+    alerts.push_back(
+        WatchdogAlert{entry.subject, WatchdogEvent::STALL, entry.name, busy, maxCallbackTime});
+  }
+  entry.stalled = stalled;
+
+  const double age = entry.heartbeat->age(now);
+  const bool lagging = maxAge > 0 && age > maxAge;
+  if (lagging && !entry.lagging) {
+    alerts.push_back(WatchdogAlert{entry.subject, WatchdogEvent::LAG, entry.name, age, maxAge});
+  }
+  entry.lagging = lagging;
+
+  if (wasAlerting && !stalled && !lagging) {
+    alerts.push_back(WatchdogAlert{entry.subject, WatchdogEvent::RECOVERED, entry.name});
+  }
+}
+
+} // namespace cthulhu
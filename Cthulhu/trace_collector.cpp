@@ -0,0 +1,162 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#define DEFAULT_LOG_CHANNEL "CthulhuTraceCollect"
+#include <cthulhu/Tracing.h>
+#include <logging/Log.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Merges the trace rings written by processes running with CTHULHU_TRACE set into a Chrome JSON
+// trace, which can be opened in Perfetto or chrome://tracing.
+//
+// Usage: CthulhuTraceCollect [--clear] [output.json]
+//
+// Each sample is followed through the graph by a flow, which links every event recorded for the
+// same stream and sequence number. --clear removes the rings once they have been read.
+
+namespace {
+
+using CollectedEvent = cthulhu::CollectedTraceEvent;
+
+const char* phaseName(cthulhu::TracePhase phase) {
+  switch (phase) {
+    case cthulhu::TracePhase::PRODUCE:
+      return "produce";
+    case cthulhu::TracePhase::CONSUME_BEGIN:
+    case cthulhu::TracePhase::CONSUME_END:
+      return "consume";
+    case cthulhu::TracePhase::ALIGN:
+      return "align";
+    case cthulhu::TracePhase::IPC_SEND:
+      return "ipc send";
+    case cthulhu::TracePhase::IPC_RECEIVE:
+      return "ipc receive";
+  }
+  return "unknown";
+}
+
+std::string escape(const std::string& input) {
+  std::string output;
+  output.reserve(input.size());
+  for (char c : input) {
+    if (c == '"' || c == '\\') {
+      output += '\\';
+      output += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      output += ' ';
+    } else {
+      output += c;
+    }
+  }
+  return output;
+}
+
+void writeTrace(std::vector<CollectedEvent>& events, std::ostream& output) {
+  std::sort(events.begin(), events.end(), [](const auto& a, const auto& b) {
+    return a.timestampUs < b.timestampUs;
+  });
+  const double origin = events.empty() ? 0.0 : events.front().timestampUs;
+
+  // Group the events of each sample, in time order, so they can be linked by a flow
+  std::map<std::pair<std::string, uint32_t>, std::vector<size_t>> samples;
+  for (size_t i = 0; i < events.size(); i++) {
+    if (events[i].phase != cthulhu::TracePhase::CONSUME_END) {
+      samples[{events[i].streamID, events[i].sequenceNumber}].push_back(i);
+    }
+  }
+
+  output << "{\"traceEvents\":[\n";
+  bool first = true;
+  auto emit = [&](const CollectedEvent& event, const std::string& fields) {
+    output << (first ? "" : ",\n") << "{\"pid\":" << event.pid << ",\"tid\":" << event.tid
+           << ",\"ts\":" << std::fixed << (event.timestampUs - origin) << fields << "}";
+    first = false;
+  };
+
+  for (const auto& event : events) {
+    const auto stream = escape(event.streamID);
+    const auto args = ",\"args\":{\"stream\":\"" + stream +
+        "\",\"sequenceNumber\":" + std::to_string(event.sequenceNumber) + "}";
+    switch (event.phase) {
+      case cthulhu::TracePhase::CONSUME_BEGIN:
+        emit(
+            event,
+            ",\"ph\":\"B\",\"cat\":\"cthulhu\",\"name\":\"consume " + stream + "\"" + args);
+        break;
+      case cthulhu::TracePhase::CONSUME_END:
+        emit(event, ",\"ph\":\"E\"");
+        break;
+      default:
+        // Zero-length slices rather than instants, so that flows can bind to them
+        emit(
+            event,
+            ",\"ph\":\"X\",\"dur\":0,\"cat\":\"cthulhu\",\"name\":\"" +
+                std::string(phaseName(event.phase)) + " " + stream + "\"" + args);
+        break;
+    }
+  }
+
+  uint64_t flowID = 0;
+  for (const auto& sample : samples) {
+    const auto& indices = sample.second;
+    if (indices.size() < 2) {
+      continue;
+    }
+    flowID++;
+    for (size_t i = 0; i < indices.size(); i++) {
+      const char* ph = i == 0 ? "s" : (i + 1 == indices.size() ? "f" : "t");
+      emit(
+          events[indices[i]],
+          std::string(",\"ph\":\"") + ph +
+              "\",\"bp\":\"e\",\"cat\":\"sample\",\"name\":\"sample\",\"id\":" +
+              std::to_string(flowID));
+    }
+  }
+  output << "\n]}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  bool clear = false;
+  std::string outputPath = "cthulhu_trace.json";
+  for (int argIdx = 1; argIdx < argc; argIdx++) {
+    if ("--clear" == std::string_view(argv[argIdx])) {
+      clear = true;
+    } else {
+      outputPath = argv[argIdx];
+    }
+  }
+
+  const uint32_t numRings = cthulhu::Tracer::numRings();
+  if (numRings == 0) {
+    XR_LOGW("No trace found. Was the graph run with CTHULHU_TRACE set?");
+    return 1;
+  }
+
+  std::vector<CollectedEvent> events;
+  uint32_t ringsRead = 0;
+  for (uint32_t slot = 0; slot < numRings; slot++) {
+    if (cthulhu::Tracer::readRing(slot, events)) {
+      ringsRead++;
+    }
+  }
+
+  std::ofstream output(outputPath);
+  if (!output) {
+    XR_LOGE("Failed to open {} for writing", outputPath);
+    return 1;
+  }
+  writeTrace(events, output);
+  XR_LOGI("Wrote {} events from {} rings to {}", events.size(), ringsRead, outputPath);
+
+  if (clear) {
+    cthulhu::Tracer::removeRings();
+  }
+  return 0;
+}
@@ -22,7 +22,12 @@ __all__ = [
     "FieldType",
     "FloatType",
     "Graph",
+    "GraphBenchmarkHarness",
     "ParallelRunner",
+    "PlacementPlan",
+    "PlacementProfile",
+    "plan_placement",
+    "ProbeSpec",
     "Group",
     "IntType",
     "HDF5Logger",
@@ -32,6 +37,7 @@ __all__ = [
     "Message",
     "Module",
     "LocalRunner",
+    "LoadSpec",
     "Node",
     "NodeTestHarness",
     "NormalTermination",
@@ -101,11 +107,17 @@ from .messages import (
 )
 from .runners import (
     Aligner,
+    GraphBenchmarkHarness,
+    LoadSpec,
     LocalRunner,
     NormalTermination,
     ParallelRunner,
+    PlacementPlan,
+    PlacementProfile,
+    ProbeSpec,
     RunnerOptions,
     TimestampAligner,
+    plan_placement,
     run,
 )
 from .util import LabGraphError
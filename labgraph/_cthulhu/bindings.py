@@ -6,6 +6,7 @@
 # when they are running simultaneously.
 
 import os
+import sys
 
 from ..util.random import random_string
 
@@ -28,28 +29,61 @@ import cthulhubindings  # noqa: E402
 # C++ extensions.
 Aligner = cthulhubindings.Aligner
 AlignerMode = cthulhubindings.AlignerMode
+AlignerQueue = cthulhubindings.AlignerQueue
+AlignerReferenceMeta = cthulhubindings.AlignerReferenceMeta
+AlignerSampleMeta = cthulhubindings.AlignerSampleMeta
+AlignerStreamMeta = cthulhubindings.AlignerStreamMeta
+AlignPolicy = cthulhubindings.AlignPolicy
+anonymousStreamHandle = cthulhubindings.anonymousStreamHandle
 AnyBuffer = cthulhubindings.AnyBuffer
+BridgeOptions = cthulhubindings.BridgeOptions
+BridgeReceiver = cthulhubindings.BridgeReceiver
+BridgeSender = cthulhubindings.BridgeSender
+BridgeTransport = cthulhubindings.BridgeTransport
 BufferType = cthulhubindings.BufferType
 Clock = cthulhubindings.Clock
 ClockAuthority = cthulhubindings.ClockAuthority
 ClockEvent = cthulhubindings.ClockEvent
 clockManager = cthulhubindings.clockManager
 ClockManager = cthulhubindings.ClockManager
+Codec = cthulhubindings.Codec
+CodecType = cthulhubindings.CodecType
+ConsumerScheduling = cthulhubindings.ConsumerScheduling
 ContextInfo = cthulhubindings.ContextInfo
+contextRegistry = cthulhubindings.contextRegistry
+ContextRegistry = cthulhubindings.ContextRegistry
+ContextRegistrySnapshot = cthulhubindings.ContextRegistrySnapshot
+convertAlignerMeta = cthulhubindings.convertAlignerMeta
 ControllableClock = cthulhubindings.ControllableClock
 CpuBuffer = cthulhubindings.CpuBuffer
+decodeAlignerConfigsMeta = cthulhubindings.decodeAlignerConfigsMeta
+decodeAlignerSamplesMeta = cthulhubindings.decodeAlignerSamplesMeta
 DynamicParameters = cthulhubindings.DynamicParameters
+encodeAlignerConfigsMeta = cthulhubindings.encodeAlignerConfigsMeta
+encodeAlignerSamplesMeta = cthulhubindings.encodeAlignerSamplesMeta
+EventScheduler = cthulhubindings.EventScheduler
+EventSchedulerOptions = cthulhubindings.EventSchedulerOptions
 Field = cthulhubindings.Field
 GpuBuffer = cthulhubindings.GpuBuffer
 ImageBuffer = cthulhubindings.ImageBuffer
+LatenessHistogram = cthulhubindings.LatenessHistogram
 memoryPool = cthulhubindings.memoryPool
 MemoryPool = cthulhubindings.MemoryPool
+MemoryPoolStats = cthulhubindings.MemoryPoolStats
+Numa = cthulhubindings.Numa
 PerformanceSummary = cthulhubindings.PerformanceSummary
+PolicyAligner = cthulhubindings.PolicyAligner
+PriorityClass = cthulhubindings.PriorityClass
+ProcessTable = cthulhubindings.ProcessTable
+readAlignerMetaLog = cthulhubindings.readAlignerMetaLog
 SampleHeader = cthulhubindings.SampleHeader
 SampleMetadata = cthulhubindings.SampleMetadata
+serializeAlignerMeta = cthulhubindings.serializeAlignerMeta
+SharedMemoryPolicy = cthulhubindings.SharedMemoryPolicy
 StreamConfig = cthulhubindings.StreamConfig
 StreamConsumer = cthulhubindings.StreamConsumer
 StreamDescription = cthulhubindings.StreamDescription
+streamHandle = cthulhubindings.streamHandle
 StreamInterface = cthulhubindings.StreamInterface
 StreamProducer = cthulhubindings.StreamProducer
 streamRegistry = cthulhubindings.streamRegistry
@@ -60,3 +94,15 @@ TypeDefinition = cthulhubindings.TypeDefinition
 TypeInfo = cthulhubindings.TypeInfo
 typeRegistry = cthulhubindings.typeRegistry
 TypeRegistry = cthulhubindings.TypeRegistry
+watchdog = cthulhubindings.watchdog
+Watchdog = cthulhubindings.Watchdog
+WatchdogAlert = cthulhubindings.WatchdogAlert
+WatchdogBudget = cthulhubindings.WatchdogBudget
+WatchdogEvent = cthulhubindings.WatchdogEvent
+WatchdogSubject = cthulhubindings.WatchdogSubject
+
+# Ingest sources are only built on Linux
+if sys.platform == "linux":
+    IngestOptions = cthulhubindings.IngestOptions
+    IngestSource = cthulhubindings.IngestSource
+    IngestStats = cthulhubindings.IngestStats
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import time
+from dataclasses import dataclass
+from typing import List
+
+import numpy as np
+
+from .bindings import Codec  # type: ignore
+
+
+DEFAULT_NUM_CHANNELS = 64
+DEFAULT_NUM_SUBSAMPLES = 16384
+DEFAULT_NUM_RUNS = 10
+SEED = 0
+
+
+@dataclass
+class CodecBenchmarkResult:
+    """
+    The compression ratio and bandwidths of a content block codec on one content
+    block.
+
+    Args:
+        name: The codec and its parameters.
+        size: The size in bytes of the content block.
+        encoded_size: The size in bytes of its encoding.
+        encode_bandwidth:
+            The bandwidth in bytes of content per second of the fastest encoding.
+        decode_bandwidth:
+            The bandwidth in bytes of content per second of the fastest decoding.
+    """
+
+    name: str
+    size: int
+    encoded_size: int
+    encode_bandwidth: float
+    decode_bandwidth: float
+
+    @property
+    def ratio(self) -> float:
+        return self.size / self.encoded_size
+
+    def report(self) -> str:
+        """
+        Returns a human-readable summary of the ratio and bandwidths.
+        """
+        return (
+            f"{self.name:24} ratio {self.ratio:6.2f}  "
+            f"encode {self.encode_bandwidth / 1e9:6.2f} GB/s  "
+            f"decode {self.decode_bandwidth / 1e9:6.2f} GB/s"
+        )
+
+
+def signal(num_channels: int, num_subsamples: int) -> np.ndarray:
+    """
+    A multichannel int16 recording: a random walk per channel, with the channels of
+    a subsample interleaved, as they are laid out in a content block.
+    """
+    rng = np.random.default_rng(SEED)
+    steps = rng.integers(-8, 9, size=(num_subsamples, num_channels))
+    return np.cumsum(steps, axis=0).astype(np.int16)
+
+
+def _measure(
+    name: str, codec: Codec, data: bytes, num_runs: int
+) -> CodecBenchmarkResult:
+    encode_durations: List[float] = []
+    decode_durations: List[float] = []
+    for _ in range(num_runs):
+        start = time.perf_counter()
+        encoded = codec.encode(data)
+        encode_durations.append(time.perf_counter() - start)
+
+        start = time.perf_counter()
+        decoded = codec.decode(encoded, len(data))
+        decode_durations.append(time.perf_counter() - start)
+        assert decoded == data, f"{name} didn't decode to the original content"
+    return CodecBenchmarkResult(
+        name=name,
+        size=len(data),
+        encoded_size=len(encoded),
+        encode_bandwidth=len(data) / min(encode_durations),
+        decode_bandwidth=len(data) / min(decode_durations),
+    )
+
+
+def benchmark_codecs(
+    num_channels: int = DEFAULT_NUM_CHANNELS,
+    num_subsamples: int = DEFAULT_NUM_SUBSAMPLES,
+    num_runs: int = DEFAULT_NUM_RUNS,
+) -> List[CodecBenchmarkResult]:
+    """
+    Measures LZ4 and delta bit-packing on a multichannel int16 signal, and LZ4 on
+    incompressible bytes of the same size. The bandwidths include copying the
+    result into Python bytes.
+
+    Args:
+        num_channels: The number of channels of the signal.
+        num_subsamples: The number of subsamples of the signal.
+        num_runs: The number of times each encoding and decoding is measured.
+    """
+    data = signal(num_channels, num_subsamples).tobytes()
+    noise = np.random.default_rng(SEED).bytes(len(data))
+    return [
+        _measure("lz4", Codec.lz4(), data, num_runs),
+        _measure(
+            f"delta_bitpack stride {num_channels}",
+            Codec.delta_bitpack(element_bytes=2, stride=num_channels),
+            data,
+            num_runs,
+        ),
+        _measure("lz4 incompressible", Codec.lz4(), noise, num_runs),
+    ]
+
+
+if __name__ == "__main__":
+    for result in benchmark_codecs():
+        print(result.report())
@@ -3,11 +3,12 @@
 
 from enum import Enum, auto
 from types import TracebackType
-from typing import Callable, Generic, Optional, Type, TypeVar
+from typing import Any, Callable, Generic, Optional, Type, TypeVar
 
 from ..messages.message import Message
 from ..util.error import LabGraphError
 from .bindings import (  # type: ignore
+    ConsumerScheduling,
     PerformanceSummary,
     StreamConsumer,
     StreamDescription,
@@ -40,6 +41,33 @@ class Mode(Enum):
     ASYNC = auto()
 
 
+def _is_message_type(arg_type: Any) -> bool:
+    return isinstance(arg_type, type) and issubclass(arg_type, Message)
+
+
+def _is_params_type(arg_type: Any) -> bool:
+    return getattr(arg_type, "__origin__", None) is LabGraphCallbackParams
+
+
+def _callback_message_type(callback: LabGraphCallback) -> Any:
+    """
+    Returns the message type a LabGraph callback accepts according to its annotations:
+    either a `Message` subclass or a parameterized `LabGraphCallbackParams`.
+    """
+    annotations = getattr(callback, "__annotations__", {})
+    message_types = [
+        arg_type
+        for arg, arg_type in annotations.items()
+        if arg != "return" and (_is_message_type(arg_type) or _is_params_type(arg_type))
+    ]
+    if len(message_types) != 1:
+        raise TypeError(
+            f"Expected callback taking type '{Message.__name__}' or "
+            f"'{LabGraphCallbackParams.__name__}', got annotations {annotations}"
+        )
+    return message_types[0]
+
+
 class Consumer(StreamConsumer):  # type: ignore
     """
     Convenience wrapper of Cthulhu's `StreamConsumer` that allows us to specify a
@@ -47,7 +75,12 @@ class Consumer(StreamConsumer):  # type: ignore
 
     Args:
         stream_interface: The stream interface to use.
-        sample_callback: The callback to use (uses LabGraph messages).
+        sample_callback:
+            The callback to use (uses LabGraph messages). Must be annotated with the
+            message type it accepts; raises `TypeError` otherwise.
+        mode: Whether the callback is called on the producing thread or Cthulhu's.
+        stream_id: The stream id passed to callbacks taking `LabGraphCallbackParams`.
+        scheduling: Priority, deadline and executor settings for delivering samples.
     """
 
     def __init__(
@@ -56,53 +89,40 @@ class Consumer(StreamConsumer):  # type: ignore
         sample_callback: LabGraphCallback,
         mode: Mode = Mode.SYNC,
         stream_id: Optional[str] = None,
+        scheduling: Optional[ConsumerScheduling] = None,
     ) -> None:
         super(Consumer, self).__init__(
             **{
                 "si": stream_interface,
-                "sampleCb": self._to_cthulhu_callback(sample_callback),
+                "sampleCb": self._to_cthulhu_callback(sample_callback, stream_id),
                 "async": mode == Mode.ASYNC,
+                "scheduling": scheduling or ConsumerScheduling(),
             }
         )
         self.stream_id = stream_id
 
-    def _to_cthulhu_callback(self, callback: LabGraphCallback) -> CthulhuCallback:
+    def _to_cthulhu_callback(
+        self, callback: LabGraphCallback, stream_id: Optional[str]
+    ) -> CthulhuCallback:
         """
         Given a LabGraph callback, creates a Cthulhu callback (accepting
-        `StreamSample`s).
+        `StreamSample`s). The message type is resolved from the callback's annotations
+        here rather than per sample, so the Cthulhu callback only constructs the
+        message and calls the LabGraph callback.
         """
+        message_type = _callback_message_type(callback)
+        if _is_params_type(message_type):
+            (arg_type,) = message_type.__args__
 
-        def wrapped_callback(sample: StreamSample) -> None:
-            assert hasattr(callback, "__annotations__")
-            annotated_types = {
-                arg: arg_type
-                for arg, arg_type in callback.__annotations__.items()
-                if not arg == "return"
-            }
+            def params_callback(sample: StreamSample) -> None:
+                callback(LabGraphCallbackParams(arg_type(__sample__=sample), stream_id))
+
+            return params_callback
+
+        def message_callback(sample: StreamSample) -> None:
+            callback(message_type(__sample__=sample))
 
-            message_types = [
-                arg_type
-                for arg_type in annotated_types.values()
-                if issubclass(arg_type, Message)
-                or issubclass(arg_type, LabGraphCallbackParams)
-            ]
-            assert len(message_types) == 1
-
-            message_type = message_types[0]
-            if issubclass(message_type, Message):
-                message = message_type(__sample__=sample)
-                callback(message)
-            elif issubclass(message_type, LabGraphCallbackParams):
-                (arg_type,) = message_type.__args__
-                message = arg_type(__sample__=sample)
-                params = LabGraphCallbackParams(message, self.stream_id)
-                callback(params)
-            else:
-                raise TypeError(
-                    f"Expected callback taking type '{Message.__name__}' or '{LabGraphCallbackParams.__name__}', got '{message_type.__name__}'"
-                )
-
-        return wrapped_callback
+        return message_callback
 
     def __enter__(self) -> "Consumer":
         return self
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import os
+import statistics
+import time
+from dataclasses import dataclass
+from typing import List, Optional
+
+import numpy as np
+
+from ..util.random import random_string
+from .bindings import memoryPool, Numa, streamHandle  # type: ignore
+
+
+DEFAULT_NUM_BUFFERS = 100000
+DEFAULT_BUFFER_SIZE = 4096
+DEFAULT_COPY_SIZE = 64 * 1024 * 1024
+DEFAULT_NUM_COPIES = 10
+STREAM_NAME_LENGTH = 32
+
+
+@dataclass
+class NumaBenchmarkResult:
+    """
+    The cost of allocating buffers from Cthulhu's per-NUMA-node pools, and the
+    bandwidth of copying between buffers on the same and on different nodes.
+
+    Args:
+        num_nodes: The number of NUMA nodes of the system.
+        num_buffers: The number of buffers allocated to measure each allocation time.
+        buffer_size: The size in bytes of each allocated buffer.
+        allocate_unplaced:
+            The median time in seconds to allocate and release a buffer of a stream
+            that wasn't placed on a node, which looks up the node of the allocating
+            thread.
+        allocate_placed:
+            The median time in seconds to allocate and release a buffer of a stream
+            placed on a node. This is the baseline the unplaced time is compared to.
+        copy_size: The size in bytes of each copy.
+        local_bandwidth:
+            The bandwidth in bytes per second of copying between two buffers on the
+            node of the copying thread.
+        remote_bandwidth:
+            The bandwidth in bytes per second of copying from a buffer on another node
+            to one on the node of the copying thread, or None on a single node.
+    """
+
+    num_nodes: int
+    num_buffers: int
+    buffer_size: int
+    allocate_unplaced: float
+    allocate_placed: float
+    copy_size: int
+    local_bandwidth: float
+    remote_bandwidth: Optional[float]
+
+    def report(self) -> str:
+        """
+        Returns a human-readable summary of the allocation times and bandwidths.
+        """
+        overhead = self.allocate_unplaced - self.allocate_placed
+        lines = [
+            f"{self.num_nodes} NUMA node(s)",
+            f"Median allocation of {self.buffer_size} bytes over {self.num_buffers} "
+            "buffers:",
+            f"  placed    {self.allocate_placed * 1e6:10.3f} us",
+            f"  unplaced  {self.allocate_unplaced * 1e6:10.3f} us  "
+            f"({overhead * 1e6:+.3f} us)",
+            f"Bandwidth copying {self.copy_size} bytes:",
+            f"  local     {self.local_bandwidth / 1e9:10.2f} GB/s",
+        ]
+        if self.remote_bandwidth is not None:
+            lines.append(f"  remote    {self.remote_bandwidth / 1e9:10.2f} GB/s")
+        return "\n".join(lines)
+
+
+def _new_stream(node: Optional[int] = None) -> str:
+    stream_id = random_string(length=STREAM_NAME_LENGTH)
+    if node is not None:
+        memoryPool().setStreamNumaNode(stream_id, node)
+    return stream_id
+
+
+def _measure_allocation(stream_id: str, buffer_size: int, num_buffers: int) -> float:
+    """
+    Allocates buffers one at a time, releasing each before allocating the next so that
+    they are all served from the pool. Returns the median time.
+    """
+    pool = memoryPool()
+    handle = streamHandle(stream_id)
+    # Fill the pool for the stream, so that no measured allocation maps new memory
+    pool.getBufferFromPool(handle, buffer_size)
+    durations: List[float] = []
+    for _ in range(num_buffers):
+        start = time.perf_counter()
+        buffer = pool.getBufferFromPool(handle, buffer_size)
+        del buffer
+        durations.append(time.perf_counter() - start)
+    return statistics.median(durations)
+
+
+def _measure_bandwidth(
+    source_node: int, target_node: int, copy_size: int, num_copies: int
+) -> float:
+    """
+    Copies between a buffer placed on `source_node` and one placed on `target_node`
+    from a thread running on `target_node`. Returns the best bandwidth.
+    """
+    pool = memoryPool()
+    source = np.frombuffer(
+        pool.getBufferFromPool(streamHandle(_new_stream(source_node)), copy_size),
+        dtype=np.uint8,
+    )
+    target = np.frombuffer(
+        pool.getBufferFromPool(streamHandle(_new_stream(target_node)), copy_size),
+        dtype=np.uint8,
+    )
+    # Touch every page, so that no copy is slowed down by page faults
+    source.fill(1)
+    target.fill(0)
+
+    durations: List[float] = []
+    for _ in range(num_copies):
+        start = time.perf_counter()
+        np.copyto(target, source)
+        durations.append(time.perf_counter() - start)
+    return copy_size / min(durations)
+
+
+def benchmark_numa(
+    num_buffers: int = DEFAULT_NUM_BUFFERS,
+    buffer_size: int = DEFAULT_BUFFER_SIZE,
+    copy_size: int = DEFAULT_COPY_SIZE,
+    num_copies: int = DEFAULT_NUM_COPIES,
+) -> NumaBenchmarkResult:
+    """
+    Measures the per-allocation cost of choosing the NUMA node of a buffer, and the
+    bandwidth of copying within and across nodes. The calling thread is pinned to the
+    CPUs of node 0 while measuring.
+
+    Args:
+        num_buffers: The number of buffers to allocate for each allocation time.
+        buffer_size: The size in bytes of each allocated buffer.
+        copy_size: The size in bytes of each copy.
+        num_copies: The number of copies to measure each bandwidth with.
+    """
+    num_nodes = Numa.numNodes()
+    affinity = os.sched_getaffinity(0)
+    node_cpus = set(Numa.cpusOfNode(0)) & affinity
+    try:
+        if node_cpus:
+            os.sched_setaffinity(0, node_cpus)
+        return NumaBenchmarkResult(
+            num_nodes=num_nodes,
+            num_buffers=num_buffers,
+            buffer_size=buffer_size,
+            allocate_unplaced=_measure_allocation(
+                _new_stream(), buffer_size, num_buffers
+            ),
+            allocate_placed=_measure_allocation(
+                _new_stream(0), buffer_size, num_buffers
+            ),
+            copy_size=copy_size,
+            local_bandwidth=_measure_bandwidth(0, 0, copy_size, num_copies),
+            remote_bandwidth=_measure_bandwidth(1, 0, copy_size, num_copies)
+            if num_nodes > 1
+            else None,
+        )
+    finally:
+        os.sched_setaffinity(0, affinity)
+
+
+if __name__ == "__main__":
+    print(benchmark_numa().report())
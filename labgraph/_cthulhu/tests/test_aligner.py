@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+from typing import List, Optional, Sequence, Tuple
+
+import pytest
+
+from ...messages.message import Message
+from ...util.random import random_string
+from ...util.testing import local_test
+from ..bindings import (  # type: ignore
+    Aligner,
+    AlignerMode,
+    AlignerQueue,
+    AlignerSampleMeta,
+    AlignPolicy,
+    PolicyAligner,
+    StreamInterface,
+    StreamSample,
+    ThreadPolicy,
+)
+from ..cthulhu import Producer, register_stream
+
+
+RANDOM_ID_LENGTH = 32
+QUEUE_SIZE = 10
+
+# The timestamp and sequence number of each sample of an aligned set
+AlignedSet = List[Tuple[float, int]]
+
+
+class MyMessage(Message):
+    int_field: int
+
+
+class MyFloatMessage(Message):
+    float_field: float
+
+
+def _set_header(message: Message, sequence_number: int, timestamp: float) -> None:
+    metadata = message.__sample__.metadata
+    header = metadata.header
+    header.timestamp = timestamp
+    header.sequenceNumber = sequence_number
+    metadata.header = header
+
+
+def _produce(producer: Producer, sequence_number: int, timestamp: float) -> None:
+    message = MyMessage(int_field=sequence_number)
+    _set_header(message, sequence_number, timestamp)
+    producer.produce_message(message)
+
+
+def _register_streams(aligner: Aligner, num_streams: int) -> List[StreamInterface]:
+    streams = [
+        register_stream(name=random_string(RANDOM_ID_LENGTH), message_type=MyMessage)
+        for _ in range(num_streams)
+    ]
+    for index, stream in enumerate(streams):
+        aligner.registerConsumer(stream, index)
+    return streams
+
+
+def _record_aligned(aligner: Aligner) -> List[AlignedSet]:
+    aligned: List[AlignedSet] = []
+
+    def callback(meta: Sequence[AlignerSampleMeta]) -> None:
+        aligned.append(
+            [
+                (sample_meta.timestamp, sample_meta.references[0].sequenceNumber)
+                for sample_meta in meta
+            ]
+        )
+
+    aligner.setSamplesMetaCallback(callback)
+    return aligned
+
+
+@local_test
+def test_align_callback_queue_views() -> None:
+    """
+    Tests that a Python align callback sees the queued samples through views, and that
+    the samples it aligns are consumed from the queues.
+    """
+    aligner = Aligner(QUEUE_SIZE, ThreadPolicy.THREAD_NEUTRAL, AlignerMode.TIMESTAMP)
+    streams = _register_streams(aligner, 2)
+    stream_ids = [stream.description.id for stream in streams]
+    queue_timestamps: List[List[List[float]]] = []
+
+    def align(queues: Sequence[AlignerQueue]) -> Optional[List[int]]:
+        assert [queue.id for queue in queues] == stream_ids
+        queue_timestamps.append(
+            [[queue.timestamp(i) for i in range(len(queue))] for queue in queues]
+        )
+        for queue in queues:
+            for i in range(len(queue)):
+                header = queue[i].metadata.header
+                assert header.timestamp == queue.timestamp(i)
+                assert header.sequenceNumber == queue.sequenceNumber(i)
+            with pytest.raises(IndexError):
+                queue[len(queue)]
+        first, second = queues
+        for i in range(len(first)):
+            for j in range(len(second)):
+                if first.timestamp(i) == second.timestamp(j):
+                    return [i, j]
+        return None
+
+    aligner.setAlignCallback(align)
+    aligned = _record_aligned(aligner)
+    aligner.finalize()
+
+    with Producer(stream_interface=streams[0]) as first, Producer(
+        stream_interface=streams[1]
+    ) as second:
+        _produce(first, 0, 1.0)
+        _produce(second, 0, 0.5)
+        _produce(second, 1, 1.0)
+        _produce(first, 1, 2.0)
+        _produce(second, 2, 2.0)
+
+    assert aligned == [[(1.0, 0), (1.0, 1)], [(2.0, 1), (2.0, 2)]]
+    assert queue_timestamps == [
+        [[1.0], []],
+        [[1.0], [0.5]],
+        [[1.0], [0.5, 1.0]],
+        [[2.0], []],
+        [[2.0], [2.0]],
+    ]
+
+
+@local_test
+def test_align_callback_invalid_indices() -> None:
+    """
+    Tests that nothing is aligned when a Python align callback returns the wrong number
+    of indices or an index past the end of a queue.
+    """
+    aligner = Aligner(QUEUE_SIZE, ThreadPolicy.THREAD_NEUTRAL, AlignerMode.TIMESTAMP)
+    streams = _register_streams(aligner, 2)
+    results = [[0], [0, 1]]
+    aligner.setAlignCallback(lambda queues: results.pop(0))
+    aligned = _record_aligned(aligner)
+    aligner.finalize()
+
+    with Producer(stream_interface=streams[0]) as first, Producer(
+        stream_interface=streams[1]
+    ) as second:
+        _produce(first, 0, 1.0)
+        _produce(second, 0, 1.0)
+
+    assert results == []
+    assert aligned == []
+
+
+@local_test
+def test_register_negative_index() -> None:
+    """
+    Tests that registering a consumer at a negative index raises instead of corrupting
+    the aligner.
+    """
+    stream = register_stream(
+        name=random_string(RANDOM_ID_LENGTH), message_type=MyMessage
+    )
+    with pytest.raises(IndexError):
+        Aligner().registerConsumer(stream, -1)
+    with pytest.raises(IndexError):
+        PolicyAligner(AlignPolicy.HOLD_LAST).registerConsumer(stream, -1)
+
+
+@local_test
+def test_policy_aligner_nearest_timestamp() -> None:
+    """
+    Tests that the nearest timestamp policy pairs each sample of the first stream with
+    the nearest sample of the other stream.
+    """
+    aligner = PolicyAligner(AlignPolicy.NEAREST_TIMESTAMP, QUEUE_SIZE)
+    streams = _register_streams(aligner, 2)
+    aligned = _record_aligned(aligner)
+    aligner.finalize()
+
+    with Producer(stream_interface=streams[0]) as reference, Producer(
+        stream_interface=streams[1]
+    ) as other:
+        _produce(other, 0, 0.9)
+        _produce(other, 1, 1.6)
+        _produce(other, 2, 2.1)
+        _produce(reference, 0, 1.0)
+        _produce(reference, 1, 2.0)
+
+    assert aligned == [[(1.0, 0), (0.9, 0)], [(2.0, 1), (2.1, 2)]]
+
+
+@local_test
+def test_policy_aligner_waits_for_later_sample() -> None:
+    """
+    Tests that the nearest timestamp policy waits for a sample at or after the reference
+    before aligning it.
+    """
+    aligner = PolicyAligner(AlignPolicy.NEAREST_TIMESTAMP, QUEUE_SIZE)
+    streams = _register_streams(aligner, 2)
+    aligned = _record_aligned(aligner)
+    aligner.finalize()
+
+    with Producer(stream_interface=streams[0]) as reference, Producer(
+        stream_interface=streams[1]
+    ) as other:
+        _produce(other, 0, 0.5)
+        _produce(reference, 0, 1.0)
+        assert aligned == []
+        _produce(other, 1, 1.1)
+
+    assert aligned == [[(1.0, 0), (1.1, 1)]]
+
+
+@local_test
+def test_policy_aligner_hold_last() -> None:
+    """
+    Tests that the hold last policy pairs each sample of the first stream with the
+    latest sample of the other stream.
+    """
+    aligner = PolicyAligner(AlignPolicy.HOLD_LAST, QUEUE_SIZE)
+    streams = _register_streams(aligner, 2)
+    aligned = _record_aligned(aligner)
+    aligner.finalize()
+
+    with Producer(stream_interface=streams[0]) as reference, Producer(
+        stream_interface=streams[1]
+    ) as other:
+        _produce(other, 0, 0.5)
+        _produce(other, 1, 0.7)
+        _produce(reference, 0, 1.0)
+        _produce(reference, 1, 2.0)
+        _produce(other, 2, 2.5)
+        _produce(reference, 2, 3.0)
+
+    assert aligned == [
+        [(1.0, 0), (0.7, 1)],
+        [(2.0, 1), (0.7, 1)],
+        [(3.0, 2), (2.5, 2)],
+    ]
+
+
+@local_test
+def test_policy_aligner_interpolate() -> None:
+    """
+    Tests that the interpolate policy passes the samples bracketing each sample of the
+    first stream to the interpolator, and aligns the sample it returns.
+    """
+    aligner = PolicyAligner(AlignPolicy.INTERPOLATE, QUEUE_SIZE)
+    reference_stream = register_stream(
+        name=random_string(RANDOM_ID_LENGTH), message_type=MyMessage
+    )
+    other_stream = register_stream(
+        name=random_string(RANDOM_ID_LENGTH), message_type=MyFloatMessage
+    )
+    aligner.registerConsumer(reference_stream, 0)
+    aligner.registerConsumer(other_stream, 1)
+    interpolated: List[Tuple[int, float, float, float, float]] = []
+
+    def interpolate(
+        idx: int, before: StreamSample, after: StreamSample, weight: float
+    ) -> StreamSample:
+        before_value = MyFloatMessage(__sample__=before).float_field
+        after_value = MyFloatMessage(__sample__=after).float_field
+        value = before_value + weight * (after_value - before_value)
+        interpolated.append((idx, before_value, after_value, weight, value))
+        before_header = before.metadata.header
+        timestamp = before_header.timestamp + weight * (
+            after.metadata.header.timestamp - before_header.timestamp
+        )
+        message = MyFloatMessage(float_field=value)
+        _set_header(message, before_header.sequenceNumber, timestamp)
+        return message.__sample__
+
+    aligner.setInterpolator(interpolate)
+    aligned = _record_aligned(aligner)
+    aligner.finalize()
+
+    with Producer(stream_interface=reference_stream) as reference, Producer(
+        stream_interface=other_stream
+    ) as other:
+        for sequence_number, (timestamp, value) in enumerate(
+            [(0.5, 10.0), (1.5, 20.0), (2.5, 40.0)]
+        ):
+            message = MyFloatMessage(float_field=value)
+            _set_header(message, sequence_number, timestamp)
+            other.produce_message(message)
+        _produce(reference, 0, 0.75)
+        _produce(reference, 1, 2.0)
+
+    assert interpolated == [
+        (1, 10.0, 20.0, 0.25, 12.5),
+        (1, 20.0, 40.0, 0.5, 30.0),
+    ]
+    # The interpolated samples are aligned at the timestamps of the references
+    assert aligned == [[(0.75, 0), (0.75, 0)], [(2.0, 1), (2.0, 1)]]
+
+
+@local_test
+def test_policy_aligner_interpolate_requires_interpolator() -> None:
+    """
+    Tests that an aligner with the interpolate policy can't be finalized without an
+    interpolator, rather than silently aligning the nearest samples.
+    """
+    aligner = PolicyAligner(AlignPolicy.INTERPOLATE, QUEUE_SIZE)
+    _register_streams(aligner, 2)
+    with pytest.raises(RuntimeError, match="interpolator"):
+        aligner.finalize()
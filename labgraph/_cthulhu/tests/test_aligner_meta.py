@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+from typing import List
+
+import pytest
+
+from ...util.testing import local_test
+from ..bindings import (  # type: ignore
+    AlignerReferenceMeta,
+    AlignerSampleMeta,
+    AlignerStreamMeta,
+    convertAlignerMeta,
+    decodeAlignerConfigsMeta,
+    decodeAlignerSamplesMeta,
+    encodeAlignerConfigsMeta,
+    encodeAlignerSamplesMeta,
+    readAlignerMetaLog,
+    serializeAlignerMeta,
+)
+
+
+NUM_STREAMS = 3
+NUM_OUTPUTS = 20
+
+
+def configs_meta() -> List[AlignerStreamMeta]:
+    configs = []
+    for index in range(NUM_STREAMS):
+        meta = AlignerStreamMeta()
+        meta.streamID = f"stream{index}" * (index + 1)
+        meta.subSampleSize = 4 * (index + 1)
+        configs.append(meta)
+    return configs
+
+
+def samples_meta(output: int) -> List[AlignerSampleMeta]:
+    """
+    The meta of one aligned output: one sample per stream, except that every third
+    output has none, to cover empty meta.
+    """
+    if output % 3 == 2:
+        return []
+    samples = []
+    for index in range(NUM_STREAMS):
+        sample = AlignerSampleMeta()
+        sample.timestamp = output * 0.125 + index
+        sample.duration = 0.5
+        references = []
+        # Streams take a growing number of references to their source samples
+        for ref_index in range(index + 1):
+            reference = AlignerReferenceMeta()
+            reference.timestamp = output * 0.125 + ref_index * 0.01
+            reference.sequenceNumber = output * 10 + ref_index
+            reference.subSampleOffset = ref_index * 7
+            reference.numSubSamples = 16 + ref_index
+            references.append(reference)
+        sample.references = references
+        samples.append(sample)
+    return samples
+
+
+def assert_configs_equal(
+    actual: List[AlignerStreamMeta], expected: List[AlignerStreamMeta]
+) -> None:
+    assert [(meta.streamID, meta.subSampleSize) for meta in actual] == [
+        (meta.streamID, meta.subSampleSize) for meta in expected
+    ]
+
+
+def assert_samples_equal(
+    actual: List[AlignerSampleMeta],
+    expected: List[AlignerSampleMeta],
+    legacy: bool = False,
+) -> None:
+    """
+    Compares aligner meta field by field. Meta converted from serialize() lacks the
+    durations and reference timestamps, which must be 0.
+    """
+    assert len(actual) == len(expected)
+    for sample, expected_sample in zip(actual, expected):
+        assert sample.timestamp == expected_sample.timestamp
+        assert sample.duration == (0.0 if legacy else expected_sample.duration)
+        assert len(sample.references) == len(expected_sample.references)
+        for reference, expected_reference in zip(
+            sample.references, expected_sample.references
+        ):
+            assert reference.timestamp == (
+                0.0 if legacy else expected_reference.timestamp
+            )
+            assert reference.sequenceNumber == expected_reference.sequenceNumber
+            assert reference.subSampleOffset == expected_reference.subSampleOffset
+            assert reference.numSubSamples == expected_reference.numSubSamples
+
+
+@local_test
+def test_encode_decode_round_trip() -> None:
+    """
+    Tests that the fixed-layout encoding of aligner meta decodes to the same meta,
+    including the fields serialize() drops.
+    """
+    configs = configs_meta()
+    assert_configs_equal(
+        decodeAlignerConfigsMeta(encodeAlignerConfigsMeta(configs)), configs
+    )
+    for output in range(NUM_OUTPUTS):
+        samples = samples_meta(output)
+        encoded = encodeAlignerSamplesMeta(samples)
+        assert_samples_equal(decodeAlignerSamplesMeta(encoded), samples)
+        # Truncated encodings are rejected
+        assert decodeAlignerSamplesMeta(encoded[:-1]) is None
+
+
+@local_test
+@pytest.mark.parametrize("has_configs", [True, False])
+def test_convert_legacy_aligner_meta(has_configs: bool) -> None:
+    """
+    Tests that a log written with serialize() converts to a log that reads back as
+    the same configs and samples meta, with the fields the old format lacks as 0.
+    """
+    configs = configs_meta()
+    samples = [samples_meta(output) for output in range(NUM_OUTPUTS)]
+    legacy = serializeAlignerMeta(configs if has_configs else None, samples)
+
+    converted, log = convertAlignerMeta(legacy, has_configs=has_configs)
+    assert converted == NUM_OUTPUTS
+
+    read_configs, read_samples = readAlignerMetaLog(log)
+    if has_configs:
+        assert len(read_configs) == 1
+        assert_configs_equal(read_configs[0], configs)
+    else:
+        assert read_configs == []
+    assert len(read_samples) == NUM_OUTPUTS
+    for actual, expected in zip(read_samples, samples):
+        assert_samples_equal(actual, expected, legacy=True)
+
+
+@local_test
+def test_convert_truncated_legacy_aligner_meta() -> None:
+    """
+    Tests that converting a log written with serialize() that was cut short fails,
+    rather than converting a partial record.
+    """
+    legacy = serializeAlignerMeta(
+        configs_meta(), [samples_meta(output) for output in range(NUM_OUTPUTS)]
+    )
+    with pytest.raises(RuntimeError):
+        convertAlignerMeta(legacy[:-1])
+    with pytest.raises(RuntimeError):
+        readAlignerMetaLog(legacy)
@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import time
+from typing import List
+
+import numpy as np
+import pytest
+
+from ...messages.message import Message
+from ...util.random import random_string
+from ...util.testing import local_test
+from ..bindings import (  # type: ignore
+    anonymousStreamHandle,
+    BridgeOptions,
+    BridgeReceiver,
+    BridgeSender,
+    BridgeTransport,
+    Field,
+    memoryPool,
+    StreamConfig,
+    StreamConsumer,
+    StreamDescription,
+    StreamProducer,
+    StreamSample,
+    streamRegistry,
+    TypeDefinition,
+    typeRegistry,
+)
+from ..cthulhu import Consumer, Producer, get_stream, register_stream
+
+
+RANDOM_ID_LENGTH = 128
+NUM_MESSAGES = 100
+SAMPLE_RATE = 100
+TIMEOUT = 5
+NUM_SUBSAMPLES = 1024
+ELEMENT_SIZE = 4
+
+
+class MyMessage(Message):
+    int_field: int
+    str_field: str
+
+
+def wait_for(condition) -> bool:  # type: ignore
+    deadline = time.time() + TIMEOUT
+    while not condition():
+        if time.time() > deadline:
+            return False
+        time.sleep(0.01)
+    return True
+
+
+@local_test
+@pytest.mark.parametrize("transport", [BridgeTransport.TCP, BridgeTransport.UDP])
+@pytest.mark.parametrize("compress", [False, True])
+def test_bridge_loopback(transport: BridgeTransport, compress: bool) -> None:
+    """
+    Tests that a bridge mirrors a stream over loopback, with the receiver in the same
+    process producing on a remapped stream.
+    """
+    source_name = random_string(length=RANDOM_ID_LENGTH)
+    mirror_name = random_string(length=RANDOM_ID_LENGTH)
+    source = register_stream(name=source_name, message_type=MyMessage)
+
+    options = BridgeOptions()
+    options.transport = transport
+    options.compress = compress
+    receiver = BridgeReceiver(port=0, address="127.0.0.1", options=options)
+    receiver.remap(source_name, mirror_name)
+    sender = BridgeSender(host="127.0.0.1", port=receiver.port, options=options)
+    assert sender.mirror(source_name)
+    assert wait_for(lambda: get_stream(mirror_name) is not None)
+
+    received_messages = []
+
+    def callback(message: MyMessage) -> None:
+        received_messages.append(message)
+
+    mirror = get_stream(mirror_name)
+    with Consumer(stream_interface=mirror, sample_callback=callback):
+        with Producer(stream_interface=source) as producer:
+            for i in range(NUM_MESSAGES):
+                producer.produce_message(MyMessage(int_field=i, str_field=str(i)))
+                time.sleep(1 / SAMPLE_RATE)
+
+        assert wait_for(lambda: len(received_messages) == NUM_MESSAGES)
+
+    sender.close()
+    receiver.close()
+
+    for i in range(NUM_MESSAGES):
+        assert received_messages[i].int_field == i
+        assert received_messages[i].str_field == str(i)
+
+
+def register_content_type(samples_in_content: bool) -> int:
+    """
+    Registers a stream type with a config and uint32 samples in its content block, which
+    the bridge compresses: with delta bit-packing if the samples are described as
+    fields, or else with LZ4. Returns its type ID.
+    """
+    type_definition = TypeDefinition()
+    type_definition.typeName = random_string(length=RANDOM_ID_LENGTH)
+    type_definition.hasContentBlock = True
+    # A config type is assumed for types with config fields
+    type_definition.configParameterSize = ELEMENT_SIZE
+    type_definition.configFields = {"gain": Field(0, ELEMENT_SIZE, "uint32_t", 1)}
+    if samples_in_content:
+        type_definition.hasSamplesInContentBlock = True
+        type_definition.sampleFields = {
+            "value": Field(0, ELEMENT_SIZE, "uint32_t", 1)
+        }
+    typeRegistry().registerType(type_definition)
+    return typeRegistry().findTypeName(type_definition.typeName).typeID
+
+
+def content(index: int) -> np.ndarray:
+    # Small and repetitive, so that either codec compresses it
+    return (np.arange(NUM_SUBSAMPLES, dtype=np.uint32) + index) % 16
+
+
+@local_test
+@pytest.mark.parametrize("samples_in_content", [False, True])
+def test_bridge_compression(samples_in_content: bool) -> None:
+    """
+    Tests that a bridge compresses the content blocks of a stream whose type has one,
+    and that the receiver decodes them to the original content.
+    """
+    type_id = register_content_type(samples_in_content)
+    source_name = random_string(length=RANDOM_ID_LENGTH)
+    mirror_name = random_string(length=RANDOM_ID_LENGTH)
+    source = streamRegistry().registerStream(StreamDescription(source_name, type_id))
+
+    options = BridgeOptions()
+    options.compress = True
+    receiver = BridgeReceiver(port=0, address="127.0.0.1", options=options)
+    receiver.remap(source_name, mirror_name)
+    sender = BridgeSender(host="127.0.0.1", port=receiver.port, options=options)
+    assert sender.mirror(source_name)
+    assert wait_for(lambda: get_stream(mirror_name) is not None)
+
+    received: List[bytes] = []
+
+    def callback(sample: StreamSample) -> None:
+        received.append(bytes(memoryview(sample.payload.cpuBuffer())))
+
+    consumer = StreamConsumer(
+        si=get_stream(mirror_name), sampleCb=callback, configCb=lambda config: True
+    )
+    producer = StreamProducer(si=source)
+    config = StreamConfig(
+        memoryPool().getBufferFromPool(anonymousStreamHandle(), ELEMENT_SIZE)
+    )
+    config.sampleSizeInBytes = ELEMENT_SIZE
+    producer.configureStream(config)
+    for i in range(NUM_MESSAGES):
+        payload = memoryPool().getBufferFromPool(
+            anonymousStreamHandle(), NUM_SUBSAMPLES * ELEMENT_SIZE
+        )
+        np.frombuffer(payload, dtype=np.uint32)[:] = content(i)
+        sample = StreamSample()
+        sample.payload = payload.toAny()
+        sample.numberOfSubSamples = NUM_SUBSAMPLES
+        producer.produceSample(sample)
+        time.sleep(1 / SAMPLE_RATE)
+
+    assert wait_for(lambda: len(received) == NUM_MESSAGES)
+    # Each encoded body carries the sample's header and metadata besides its content
+    assert sender.sample_bytes_sent < NUM_MESSAGES * NUM_SUBSAMPLES * ELEMENT_SIZE / 2
+
+    producer.close()
+    consumer.close()
+    sender.close()
+    receiver.close()
+
+    for i in range(NUM_MESSAGES):
+        assert received[i] == content(i).tobytes()
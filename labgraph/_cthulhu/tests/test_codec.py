@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+from typing import List
+
+import numpy as np
+import pytest
+
+from ...util.testing import local_test
+from ..bindings import Codec, CodecType  # type: ignore
+from ..codec_benchmark import benchmark_codecs, signal
+
+
+SEED = 0
+NUM_CHANNELS = 8
+# Not a multiple of the 128 elements of a delta bit-packing block
+NUM_SUBSAMPLES = 301
+
+
+def codecs() -> List[Codec]:
+    return [
+        Codec.lz4(),
+        Codec.delta_bitpack(element_bytes=1),
+        Codec.delta_bitpack(element_bytes=2),
+        Codec.delta_bitpack(element_bytes=2, stride=NUM_CHANNELS),
+        Codec.delta_bitpack(element_bytes=4, stride=3),
+        Codec.delta_bitpack(element_bytes=8),
+    ]
+
+
+def contents() -> List[bytes]:
+    rng = np.random.default_rng(SEED)
+    return [
+        b"",
+        b"\x01",
+        # Incompressible
+        rng.bytes(4096),
+        rng.bytes(1001),
+        # Odd sizes, which leave a partial element after the last whole one
+        signal(NUM_CHANNELS, NUM_SUBSAMPLES).tobytes() + b"\x07",
+        signal(NUM_CHANNELS, NUM_SUBSAMPLES).tobytes()[:-3],
+        # Large differences, and differences of either sign
+        np.array([0, -1, 2**31 - 1, -(2**31), 5] * 100, dtype=np.int32).tobytes(),
+        bytes(range(256)) * 7,
+        b"\x00" * 65536,
+    ]
+
+
+@local_test
+@pytest.mark.parametrize("codec", codecs())
+@pytest.mark.parametrize("content", contents())
+def test_codec_round_trip(codec: Codec, content: bytes) -> None:
+    """
+    Tests that every codec decodes its encoding of a content block to the original
+    bytes, including empty, incompressible and odd-sized blocks.
+    """
+    encoded = codec.encode(content)
+    assert codec.decode(encoded, len(content)) == content
+
+
+@local_test
+def test_codec_round_trip_numpy() -> None:
+    """
+    Tests that codecs take contiguous numpy arrays, and reject strided ones.
+    """
+    data = signal(NUM_CHANNELS, NUM_SUBSAMPLES)
+    codec = Codec.delta_bitpack(element_bytes=2, stride=NUM_CHANNELS)
+    encoded = codec.encode(data)
+    assert codec.decode(encoded, data.nbytes) == data.tobytes()
+    with pytest.raises(ValueError):
+        codec.encode(data[:, 0])
+
+
+@local_test
+@pytest.mark.parametrize("codec", codecs())
+def test_codec_rejects_malformed(codec: Codec) -> None:
+    """
+    Tests that decoding fails, rather than reading or writing out of bounds, for the
+    wrong decoded size and for truncated encodings.
+    """
+    content = signal(NUM_CHANNELS, NUM_SUBSAMPLES).tobytes()
+    encoded = codec.encode(content)
+    assert codec.decode(encoded, len(content) + 1) is None
+    assert codec.decode(encoded, len(content) - 1) is None
+    assert codec.decode(encoded[: len(encoded) // 2], len(content)) is None
+    assert codec.decode(b"", len(content)) is None
+
+
+@local_test
+def test_codec_types() -> None:
+    assert Codec.lz4().type == CodecType.LZ4
+    assert Codec.delta_bitpack().type == CodecType.DELTA_BITPACK
+    with pytest.raises(RuntimeError):
+        Codec.delta_bitpack(element_bytes=3)
+    with pytest.raises(RuntimeError):
+        Codec.delta_bitpack(stride=0)
+
+
+@local_test
+def test_benchmark_codecs() -> None:
+    """
+    Tests that the codec benchmark measures every codec, and that delta bit-packing
+    compresses a multichannel signal better than LZ4.
+    """
+    lz4, delta, incompressible = benchmark_codecs(
+        num_channels=NUM_CHANNELS, num_subsamples=1024, num_runs=2
+    )
+    for result in (lz4, delta, incompressible):
+        assert result.encode_bandwidth > 0
+        assert result.decode_bandwidth > 0
+        assert result.name in result.report()
+    assert delta.ratio > lz4.ratio
+    assert delta.ratio > 1
+    # Incompressible content is stored with little overhead
+    assert 0.95 < incompressible.ratio <= 1
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+from typing import Tuple
+
+from MyCPPNodes import RegistrationContext  # type: ignore
+
+from ...util.random import random_string
+from ...util.testing import local_test
+from ..bindings import contextRegistry  # type: ignore
+
+
+RANDOM_ID_LENGTH = 32
+
+
+def new_context() -> Tuple[str, RegistrationContext]:
+    name = random_string(length=RANDOM_ID_LENGTH)
+    return name, RegistrationContext(name)
+
+
+def new_stream() -> str:
+    return random_string(length=RANDOM_ID_LENGTH)
+
+
+@local_test
+def test_version_changes_on_registration() -> None:
+    """
+    Tests that the registry version increases when a context is registered, registers
+    streams, and is removed, and only then.
+    """
+    registry = contextRegistry()
+    version = registry.version
+    assert registry.version == version
+
+    _, context = new_context()
+    assert registry.version > version
+
+    for register in (
+        lambda: context.subscribe(new_stream()),
+        lambda: context.advertise(new_stream()),
+        lambda: context.transform(new_stream(), new_stream()),
+    ):
+        version = registry.version
+        register()
+        assert registry.version > version
+
+    version = registry.version
+    del context
+    assert registry.version > version
+
+
+@local_test
+def test_snapshot_iteration() -> None:
+    """
+    Tests that a snapshot lists the subscriptions, publications and transformations of
+    each context under its name, and that it is taken at the registry version.
+    """
+    registry = contextRegistry()
+    name, context = new_context()
+    subscribed, published = new_stream(), new_stream()
+    transform_input, transform_output = new_stream(), new_stream()
+    context.subscribe(subscribed)
+    context.advertise(published)
+    context.transform(transform_input, transform_output)
+
+    snapshot = registry.snapshot()
+    assert snapshot.version == registry.version
+    assert name in [info.name for info in snapshot.contexts]
+    assert (name, [subscribed]) in snapshot.subscriptions()
+    assert (name, [published]) in snapshot.publications()
+    assert (name, [transform_input], [transform_output]) in snapshot.transformations()
+
+    # Nothing changed, so the same registrations are listed again
+    again = registry.snapshot()
+    assert again.version == snapshot.version
+    assert again.subscriptions() == snapshot.subscriptions()
+    assert again.publications() == snapshot.publications()
+    assert again.transformations() == snapshot.transformations()
+
+    # A snapshot is immutable, and outlives the context it lists
+    del context
+    assert (name, [subscribed]) in snapshot.subscriptions()
+    assert name not in [info.name for info in registry.snapshot().contexts]
+    assert registry.snapshot().version > snapshot.version
+
+
+@local_test
+def test_subscribers_and_publishers() -> None:
+    """
+    Tests that the contexts subscribing to and publishing on a stream are found
+    through the snapshot, including transformers, and that removed contexts aren't.
+    """
+    registry = contextRegistry()
+    stream, other = new_stream(), new_stream()
+    subscriber_name, subscriber = new_context()
+    publisher_name, publisher = new_context()
+    transformer_name, transformer = new_context()
+    subscriber.subscribe(stream)
+    publisher.advertise(stream)
+    transformer.transform(stream, other)
+
+    assert sorted(registry.subscribers(stream)) == sorted(
+        [subscriber_name, transformer_name]
+    )
+    assert registry.publishers(stream) == [publisher_name]
+    assert registry.subscribers(other) == []
+    assert registry.publishers(other) == [transformer_name]
+    assert registry.subscribers(new_stream()) == []
+
+    del subscriber
+    assert registry.subscribers(stream) == [transformer_name]
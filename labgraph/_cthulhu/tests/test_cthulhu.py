@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 # Copyright 2004-present Facebook. All Rights Reserved.
 
+import threading
 import time
 
 import pytest
@@ -8,12 +9,25 @@ import pytest
 from ...messages.message import Message
 from ...util.random import random_string
 from ...util.testing import local_test
+from ..bindings import (  # type: ignore
+    anonymousStreamHandle,
+    ConsumerScheduling,
+    memoryPool,
+    StreamConfig,
+    StreamConsumer,
+    StreamDescription,
+    StreamProducer,
+    streamRegistry,
+    TypeDefinition,
+    typeRegistry,
+)
 from ..cthulhu import Consumer, LabGraphCallbackParams, Producer, register_stream
 
 
 RANDOM_ID_LENGTH = 128
 NUM_MESSAGES = 100
 SAMPLE_RATE = 100
+CONFIG_SIZE = 8
 
 
 class MyMessage(Message):
@@ -84,3 +98,136 @@ def test_complex_graph() -> None:
 
     for i in range(NUM_MESSAGES):
         assert received_messages[i].int_field == i * 2
+
+
+@local_test
+def test_consumer_requires_message_type() -> None:
+    """
+    Tests that a consumer rejects a callback that doesn't accept a message when it is
+    created rather than when it receives a sample.
+    """
+    stream_name = random_string(length=RANDOM_ID_LENGTH)
+    stream_interface = register_stream(name=stream_name, message_type=MyMessage)
+
+    def callback(message: int) -> None:
+        pass
+
+    with pytest.raises(TypeError) as err:
+        Consumer(stream_interface=stream_interface, sample_callback=callback)
+    assert "Expected callback taking type 'Message'" in str(err.value)
+
+
+@local_test
+def test_scheduled_consumer_close_while_delivering() -> None:
+    """
+    Tests that closing a scheduled consumer waits for its running delivery, while every
+    delivery queues the next one on the executor.
+    """
+    stream_name = random_string(length=RANDOM_ID_LENGTH)
+    stream_interface = register_stream(name=stream_name, message_type=MyMessage)
+
+    scheduling = ConsumerScheduling()
+    scheduling.scheduled = True
+
+    delivering = threading.Event()
+    received_messages = []
+
+    def callback(message: MyMessage) -> None:
+        delivering.set()
+        time.sleep(0.001)
+        received_messages.append(message)
+        delivering.clear()
+
+    done = threading.Event()
+
+    with Producer(stream_interface=stream_interface) as producer:
+
+        def produce() -> None:
+            i = 0
+            while not done.is_set():
+                producer.produce_message(MyMessage(int_field=i))
+                i += 1
+
+        producer_thread = threading.Thread(target=produce)
+        producer_thread.start()
+        try:
+            for _ in range(10):
+                consumer = Consumer(
+                    stream_interface=stream_interface,
+                    sample_callback=callback,
+                    scheduling=scheduling,
+                )
+                while len(received_messages) < 10:
+                    time.sleep(0.001)
+                consumer.close()
+
+                assert not delivering.is_set()
+                num_received = len(received_messages)
+                time.sleep(0.01)
+                assert len(received_messages) == num_received
+                received_messages.clear()
+        finally:
+            done.set()
+            producer_thread.join()
+
+
+@local_test
+def test_forwarded_config_is_rehashed() -> None:
+    """
+    Tests that a config received from one stream, edited in place and forwarded to
+    another, reaches the consumers of the other with its new content and hash.
+    """
+    type_definition = TypeDefinition()
+    type_definition.typeName = random_string(length=RANDOM_ID_LENGTH)
+    type_definition.configParameterSize = CONFIG_SIZE
+    typeRegistry().registerType(type_definition)
+    type_id = typeRegistry().findTypeName(type_definition.typeName).typeID
+
+    stream1 = streamRegistry().registerStream(
+        StreamDescription(random_string(length=RANDOM_ID_LENGTH), type_id)
+    )
+    stream2 = streamRegistry().registerStream(
+        StreamDescription(random_string(length=RANDOM_ID_LENGTH), type_id)
+    )
+
+    received_hashes = []
+    forwarded = []
+
+    producer2 = StreamProducer(si=stream2)
+
+    # Consumers of streams of basic types receive an empty config when hooked, which
+    # has no content hash
+    def forward(config: StreamConfig) -> bool:
+        if config.contentHash == 0:
+            return True
+        received_hashes.append(config.contentHash)
+        memoryview(config.parameters)[0] += 1
+        producer2.configureStream(config)
+        return True
+
+    def receive(config: StreamConfig) -> bool:
+        if config.contentHash == 0:
+            return True
+        forwarded.append((bytes(config.parameters), config.contentHash))
+        return True
+
+    consumer1 = StreamConsumer(si=stream1, sampleCb=lambda sample: None, configCb=forward)
+    consumer2 = StreamConsumer(si=stream2, sampleCb=lambda sample: None, configCb=receive)
+    producer1 = StreamProducer(si=stream1)
+
+    config = StreamConfig(
+        memoryPool().getBufferFromPool(anonymousStreamHandle(), CONFIG_SIZE)
+    )
+    memoryview(config.parameters)[:] = bytes(CONFIG_SIZE)
+    producer1.configureStream(config)
+
+    assert len(forwarded) == 1
+    parameters, content_hash = forwarded[0]
+    assert parameters == bytes([1]) + bytes(CONFIG_SIZE - 1)
+    assert received_hashes[0] != 0
+    assert content_hash not in (0, received_hashes[0])
+
+    producer1.close()
+    consumer2.close()
+    consumer1.close()
+    producer2.close()
@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import json
+import subprocess
+import sys
+import threading
+import time
+from typing import List, Optional, Tuple
+
+import pytest
+
+from ...messages.message import Message
+from ...runners.launch import launch
+from ...util.random import random_string
+from ...util.testing import local_test
+from ..bindings import (  # type: ignore
+    ConsumerScheduling,
+    PriorityClass,
+    StreamInterface,
+)
+from ..cthulhu import Consumer, Producer, register_stream
+
+
+RANDOM_ID_LENGTH = 128
+NUM_MESSAGES = 6
+DEADLINE = 0.05
+OVER_DEADLINE = 0.1
+LONG_DEADLINE = 10.0
+SHORT_DEADLINE = 1.0
+TIMEOUT = 5.0
+
+# The name, priority class and deadline of each consumer queued behind a blocked
+# delivery, in the order their samples are produced
+QUEUED_CONSUMERS: List[Tuple[str, PriorityClass, Optional[float]]] = [
+    ("background", PriorityClass.BACKGROUND, None),
+    ("normal", PriorityClass.NORMAL, None),
+    ("normal_long_deadline", PriorityClass.NORMAL, LONG_DEADLINE),
+    ("normal_short_deadline", PriorityClass.NORMAL, SHORT_DEADLINE),
+    ("realtime", PriorityClass.REALTIME, None),
+]
+
+
+class MyMessage(Message):
+    int_field: int
+
+
+def _scheduling(
+    priority: PriorityClass = PriorityClass.NORMAL, deadline: Optional[float] = None
+) -> ConsumerScheduling:
+    scheduling = ConsumerScheduling()
+    scheduling.scheduled = True
+    scheduling.priority = priority
+    if deadline is not None:
+        scheduling.deadline = deadline
+    return scheduling
+
+
+def _wait_for(condition: threading.Event) -> None:
+    if not condition.wait(TIMEOUT):
+        raise TimeoutError("Timed out waiting for a delivery")
+
+
+def _wait_for_accounting(consumer: Consumer, stream_interface: StreamInterface) -> None:
+    # A delivery is measured, and its deadline checked, after its callback returns
+    deadline = time.time() + TIMEOUT
+    while time.time() < deadline:
+        summary = consumer.get_performance_summary()
+        if (
+            summary.num_calls == NUM_MESSAGES
+            and stream_interface.deadline_misses == summary.num_deadline_misses
+        ):
+            return
+        time.sleep(0.01)
+
+
+@local_test
+def test_delivery_order(monkeypatch: pytest.MonkeyPatch) -> None:
+    """
+    Tests that the executor runs pending deliveries by priority class, REALTIME before
+    NORMAL before BACKGROUND, and earliest deadline first within a class, with
+    deliveries without a deadline last. The deliveries queue up behind a blocked one,
+    in a subprocess whose executor has a single thread so that they run one at a time.
+    """
+    monkeypatch.setenv("CTHULHU_EXECUTOR_THREADS", "1")
+    monkeypatch.setenv("CTHULHU_DISABLE_SHARED_MEMORY", "1")
+    process = launch(__name__, stdout=subprocess.PIPE)
+    output, _ = process.communicate()
+    assert process.returncode == 0
+    order = json.loads(output.decode().strip().splitlines()[-1])
+
+    assert order == [
+        "realtime",
+        "normal_short_deadline",
+        "normal_long_deadline",
+        "normal",
+        "background",
+    ]
+
+
+@local_test
+def test_deadline_misses() -> None:
+    """
+    Tests that the deliveries whose callback returns past the deadline of their
+    consumer are counted as deadline misses, both by the consumer and by its stream.
+    """
+    stream_interface = register_stream(
+        name=random_string(length=RANDOM_ID_LENGTH), message_type=MyMessage
+    )
+    delivered = threading.Event()
+
+    # Every other message takes longer than the deadline
+    def callback(message: MyMessage) -> None:
+        if message.int_field % 2 == 0:
+            time.sleep(OVER_DEADLINE)
+        delivered.set()
+
+    with Producer(stream_interface=stream_interface) as producer:
+        with Consumer(
+            stream_interface=stream_interface,
+            sample_callback=callback,
+            scheduling=_scheduling(deadline=DEADLINE),
+        ) as consumer:
+            # One at a time, so that no message waits behind a slow one
+            for i in range(NUM_MESSAGES):
+                delivered.clear()
+                producer.produce_message(MyMessage(int_field=i))
+                _wait_for(delivered)
+            _wait_for_accounting(consumer, stream_interface)
+            summary = consumer.get_performance_summary()
+
+    assert summary.num_calls == NUM_MESSAGES
+    assert summary.num_deadline_misses == NUM_MESSAGES // 2
+    assert stream_interface.deadline_misses == NUM_MESSAGES // 2
+
+
+def _record_delivery_order() -> None:
+    order: List[str] = []
+    blocking = threading.Event()
+    unblocked = threading.Event()
+    delivered = threading.Event()
+
+    def block(message: MyMessage) -> None:
+        blocking.set()
+        unblocked.wait()
+
+    def record(name: str):  # type: ignore
+        def callback(message: MyMessage) -> None:
+            order.append(name)
+            if len(order) == len(QUEUED_CONSUMERS):
+                delivered.set()
+
+        return callback
+
+    blocker = register_stream(
+        name=random_string(length=RANDOM_ID_LENGTH), message_type=MyMessage
+    )
+    streams = [
+        register_stream(
+            name=random_string(length=RANDOM_ID_LENGTH), message_type=MyMessage
+        )
+        for _ in QUEUED_CONSUMERS
+    ]
+    consumers = [
+        Consumer(
+            stream_interface=blocker, sample_callback=block, scheduling=_scheduling()
+        )
+    ]
+    for stream, (name, priority, deadline) in zip(streams, QUEUED_CONSUMERS):
+        consumers.append(
+            Consumer(
+                stream_interface=stream,
+                sample_callback=record(name),
+                scheduling=_scheduling(priority, deadline),
+            )
+        )
+    producers = [Producer(stream_interface=stream) for stream in streams]
+
+    with Producer(stream_interface=blocker) as producer:
+        producer.produce_message(MyMessage(int_field=0))
+        _wait_for(blocking)
+    for producer in producers:
+        producer.produce_message(MyMessage(int_field=0))
+    unblocked.set()
+    _wait_for(delivered)
+
+    for producer in producers:
+        producer.close()
+    for consumer in consumers:
+        consumer.close()
+    # Cthulhu's warnings about looking up the new streams don't end their lines
+    print()
+    print(json.dumps(order))
+    sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    _record_delivery_order()
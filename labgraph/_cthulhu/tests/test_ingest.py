@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import socket
+import sys
+import time
+from typing import List, Tuple
+
+import numpy as np
+import pytest
+
+from ...util.random import random_string
+from ...util.testing import local_test
+from ..bindings import (  # type: ignore
+    anonymousStreamHandle,
+    Field,
+    memoryPool,
+    StreamConfig,
+    StreamConsumer,
+    StreamDescription,
+    StreamSample,
+    streamRegistry,
+    TypeDefinition,
+    typeRegistry,
+)
+
+
+if sys.platform != "linux":
+    pytest.skip("Ingest sources are only built on Linux", allow_module_level=True)
+
+from ..bindings import IngestOptions, IngestSource  # type: ignore  # noqa: E402
+
+
+RANDOM_ID_LENGTH = 128
+NUM_DATAGRAMS = 200
+NUM_SUBSAMPLES = 256
+ELEMENT_SIZE = 4
+READ_BYTES = NUM_SUBSAMPLES * ELEMENT_SIZE
+TIMEOUT = 5
+
+
+def wait_for(condition) -> bool:  # type: ignore
+    deadline = time.time() + TIMEOUT
+    while not condition():
+        if time.time() > deadline:
+            return False
+        time.sleep(0.01)
+    return True
+
+
+def register_ingest_stream() -> str:
+    """
+    Registers a stream whose uint32 samples are in its content block, like the
+    datagrams of a sensor. Returns its ID.
+    """
+    type_definition = TypeDefinition()
+    type_definition.typeName = random_string(length=RANDOM_ID_LENGTH)
+    type_definition.hasContentBlock = True
+    type_definition.configParameterSize = ELEMENT_SIZE
+    type_definition.configFields = {"gain": Field(0, ELEMENT_SIZE, "uint32_t", 1)}
+    type_definition.hasSamplesInContentBlock = True
+    type_definition.sampleFields = {"value": Field(0, ELEMENT_SIZE, "uint32_t", 1)}
+    typeRegistry().registerType(type_definition)
+    type_id = typeRegistry().findTypeName(type_definition.typeName).typeID
+    stream_id = random_string(length=RANDOM_ID_LENGTH)
+    streamRegistry().registerStream(StreamDescription(stream_id, type_id))
+    return stream_id
+
+
+def start_ingest(stream_id: str, options: IngestOptions) -> IngestSource:
+    source = IngestSource(
+        stream_id=stream_id,
+        address="127.0.0.1",
+        sub_sample_bytes=ELEMENT_SIZE,
+        options=options,
+    )
+    config = StreamConfig(
+        memoryPool().getBufferFromPool(anonymousStreamHandle(), ELEMENT_SIZE)
+    )
+    config.sampleSizeInBytes = ELEMENT_SIZE
+    source.configureStream(config)
+    source.start()
+    return source
+
+
+def datagram(index: int) -> bytes:
+    return (np.arange(NUM_SUBSAMPLES, dtype=np.uint32) + index).tobytes()
+
+
+@local_test
+@pytest.mark.parametrize("disable_io_uring", [False, True])
+def test_ingest_udp_loopback(disable_io_uring: bool) -> None:
+    """
+    Tests that an ingest source publishes every datagram sent to it over loopback as a
+    sample, in order and with consecutive sequence numbers, with io_uring and with the
+    poll fallback.
+    """
+    stream_id = register_ingest_stream()
+    options = IngestOptions()
+    options.read_bytes = READ_BYTES
+    options.disable_io_uring = disable_io_uring
+    source = start_ingest(stream_id, options)
+
+    received: List[Tuple[int, bytes]] = []
+
+    def callback(sample: StreamSample) -> None:
+        received.append(
+            (
+                sample.metadata.header.sequenceNumber,
+                bytes(memoryview(sample.payload.cpuBuffer())),
+            )
+        )
+
+    consumer = StreamConsumer(
+        si=streamRegistry().getStream(stream_id),
+        sampleCb=callback,
+        configCb=lambda config: True,
+    )
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as generator:
+        for i in range(NUM_DATAGRAMS):
+            generator.sendto(datagram(i), ("127.0.0.1", source.port))
+            # Paces the generator so that no datagram overflows the socket buffer
+            if i % 10 == 9:
+                time.sleep(0.001)
+
+        assert wait_for(lambda: len(received) == NUM_DATAGRAMS)
+
+    stats = source.stats()
+    source.close()
+    consumer.close()
+
+    assert stats.reads == NUM_DATAGRAMS
+    assert stats.samples == NUM_DATAGRAMS
+    assert stats.bytes == NUM_DATAGRAMS * READ_BYTES
+    assert stats.truncated == 0
+    assert not (disable_io_uring and stats.io_uring)
+    for i, (sequence_number, payload) in enumerate(received):
+        assert sequence_number == i
+        assert payload == datagram(i)
+
+
+@local_test
+@pytest.mark.parametrize("disable_io_uring", [False, True])
+def test_ingest_truncates_long_datagrams(disable_io_uring: bool) -> None:
+    """
+    Tests that datagrams longer than the read size are counted as truncated and
+    published cut to the read size.
+    """
+    stream_id = register_ingest_stream()
+    options = IngestOptions()
+    options.read_bytes = READ_BYTES // 2
+    options.disable_io_uring = disable_io_uring
+    source = start_ingest(stream_id, options)
+
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as generator:
+        generator.sendto(datagram(0), ("127.0.0.1", source.port))
+        assert wait_for(lambda: source.stats().samples == 1)
+
+    stats = source.stats()
+    source.close()
+    assert stats.truncated == 1
+    assert stats.bytes == READ_BYTES // 2
+
+
+@local_test
+@pytest.mark.parametrize("disable_io_uring", [False, True])
+def test_ingest_close_with_reads_in_flight(disable_io_uring: bool) -> None:
+    """
+    Tests that closing an idle ingest source cancels its pending reads and returns,
+    and that a new source can take over the stream afterwards.
+    """
+    stream_id = register_ingest_stream()
+    options = IngestOptions()
+    options.read_bytes = READ_BYTES
+    options.disable_io_uring = disable_io_uring
+    for _ in range(3):
+        source = start_ingest(stream_id, options)
+        start = time.time()
+        source.close()
+        assert source.closed
+        assert time.time() - start < TIMEOUT
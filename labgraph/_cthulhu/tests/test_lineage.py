@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+from typing import Dict
+
+import pytest
+from MyCPPNodes import (  # type: ignore
+    align_with_lineage,
+    benchmark_lineage_record,
+    benchmark_subaligner_lineage,
+    LineageMode,
+    LineagePolicy,
+    SubAlignerLineageCost,
+)
+
+from ...util.random import random_string
+from ...util.testing import local_test
+
+
+NUM_RECORDS = 100000
+CAPACITY = 4096
+RANDOM_ID_LENGTH = 16
+
+# The aligned streams: a reference stream, and one with 4 samples per reference sample
+NUM_STREAMS = 2
+SAMPLES_PER_REFERENCE = 4
+NUM_SAMPLES = 10
+SAMPLE_INTERVAL = 3
+
+# Matches the sample interval of LineageMode.SAMPLED
+BENCHMARK_SAMPLE_INTERVAL = 10
+BENCHMARK_SAMPLES = 1000
+BENCHMARK_RETAINED = 100
+
+
+@local_test
+def test_benchmark_lineage_record() -> None:
+    """
+    Tests that recording lineage while another thread changes the capacity of the
+    lineage table never lets it grow past its largest capacity.
+    """
+    times = benchmark_lineage_record(num_records=NUM_RECORDS, capacity=CAPACITY)
+    print(
+        f"Median lineage record: {times.record * 1e6:.3f} us, "
+        f"while resizing {times.record_resizing * 1e6:.3f} us"
+    )
+    assert 0 < times.record
+    assert 0 < times.record_resizing
+    assert times.max_size <= CAPACITY
+
+
+@local_test
+@pytest.mark.parametrize(
+    "policy,sample_interval",
+    [
+        (LineagePolicy.OFF, 1),
+        (LineagePolicy.SAMPLED, SAMPLE_INTERVAL),
+        (LineagePolicy.FULL, 1),
+    ],
+)
+def test_subaligner_lineage(policy: LineagePolicy, sample_interval: int) -> None:
+    """
+    Tests that the SubAligner keeps the lineage of the output samples its policy
+    selects, and that looking one up returns the inputs the output was aligned from.
+    """
+    outputs = align_with_lineage(
+        prefix=random_string(RANDOM_ID_LENGTH),
+        policy=policy,
+        sample_interval=sample_interval,
+        num_samples=NUM_SAMPLES,
+    )
+    assert {output.stream_index for output in outputs} == set(range(NUM_STREAMS))
+    # The outputs of the other stream are each assembled from several inputs
+    assert {len(output.inputs) for output in outputs if output.stream_index == 1} == {
+        SAMPLES_PER_REFERENCE
+    }
+
+    for output in outputs:
+        if policy == LineagePolicy.FULL or (
+            policy == LineagePolicy.SAMPLED
+            and output.sequence_number % sample_interval == 0
+        ):
+            assert output.lineage == [
+                (output.stream_index, sequence_number)
+                for sequence_number in output.inputs
+            ]
+        else:
+            assert output.lineage is None
+
+
+@local_test
+def test_benchmark_subaligner_lineage() -> None:
+    """
+    Compares the cost of linking the outputs of a SubAligner to their inputs through the
+    lineage table against the history maps it used to fill in. Outputs that are held on
+    to keep their inputs alive through the history maps, but not through the table.
+    """
+    costs: Dict[LineageMode, SubAlignerLineageCost] = {}
+    for mode in (
+        LineageMode.HISTORY,
+        LineageMode.OFF,
+        LineageMode.SAMPLED,
+        LineageMode.FULL,
+    ):
+        costs[mode] = benchmark_subaligner_lineage(
+            prefix=random_string(RANDOM_ID_LENGTH),
+            mode=mode,
+            num_samples=BENCHMARK_SAMPLES,
+            num_retained=BENCHMARK_RETAINED,
+        )
+        cost = costs[mode]
+        print(
+            f"{mode}: {cost.time_per_sample * 1e6:.3f} us per sample, "
+            f"{cost.allocations_per_output:.2f} allocations per output, "
+            f"{cost.retained_inputs} inputs retained"
+        )
+
+    num_outputs = BENCHMARK_SAMPLES * NUM_STREAMS
+    assert all(cost.num_outputs == num_outputs for cost in costs.values())
+    # Each retained set of outputs holds on to one reference sample and the samples of
+    # the other stream up to the next one
+    assert costs[LineageMode.HISTORY].retained_inputs == BENCHMARK_RETAINED * (
+        1 + SAMPLES_PER_REFERENCE
+    )
+    for mode in (LineageMode.OFF, LineageMode.SAMPLED, LineageMode.FULL):
+        assert costs[mode].retained_inputs == 0
+    assert costs[LineageMode.HISTORY].lineage_entries == 0
+    assert costs[LineageMode.OFF].lineage_entries == 0
+    assert (
+        costs[LineageMode.SAMPLED].lineage_entries
+        == num_outputs // BENCHMARK_SAMPLE_INTERVAL
+    )
+    assert costs[LineageMode.FULL].lineage_entries == num_outputs
+    assert (
+        costs[LineageMode.OFF].allocations_per_output
+        < costs[LineageMode.HISTORY].allocations_per_output
+    )
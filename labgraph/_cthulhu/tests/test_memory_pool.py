@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import json
+import os
+import resource
+import subprocess
+import sys
+
+import pytest
+
+from ...runners.launch import launch
+from ...util.random import random_string
+from ...util.testing import local_test
+from ..bindings import memoryPool, streamHandle  # type: ignore
+
+
+AREA_BYTES = 256 * 1024
+NUM_AREAS = 8
+NUM_LOCKABLE_AREAS = 4
+# The byte limit of a process-local memory pool, past which it releases its free areas
+ALLOCATED_MAX_BYTES = 1 << 30
+NOBODY = 65534
+
+
+@local_test
+def test_locked_bytes_with_failed_locks(monkeypatch: pytest.MonkeyPatch) -> None:
+    """
+    Tests that only the areas that were locked into RAM count as locked bytes, when
+    RLIMIT_MEMLOCK lets only some of them be locked. The pool runs in a subprocess
+    without shared memory and without the privilege to exceed the limit.
+    """
+    _, hard = resource.getrlimit(resource.RLIMIT_MEMLOCK)
+    if hard != resource.RLIM_INFINITY and hard < 2 * NUM_LOCKABLE_AREAS * AREA_BYTES:
+        pytest.skip("The hard RLIMIT_MEMLOCK is too low to lock the areas")
+    monkeypatch.setenv("CTHULHU_DISABLE_SHARED_MEMORY", "1")
+    process = launch(__name__, stdout=subprocess.PIPE)
+    output, _ = process.communicate()
+    assert process.returncode == 0
+    locked = json.loads(output.decode().strip().splitlines()[-1])
+
+    # Some, but not all, areas fit within the limit
+    assert not locked["locked"]
+    assert 0 < locked["partial"] < NUM_AREAS * AREA_BYTES
+    assert locked["partial"] % AREA_BYTES == 0
+
+    # Locking again neither counts the locked areas twice nor drops them
+    assert not locked["relocked"]
+    assert locked["partial_relocked"] == locked["partial"]
+
+    # Areas allocated past the limit aren't counted
+    assert locked["partial_warmed"] == locked["partial"]
+
+    # Releasing the free areas only subtracts the ones that were locked
+    assert locked["shrunk"] == 0
+
+    # Once the limit is raised, areas allocated while locked are counted once
+    assert locked["raised"] == NUM_LOCKABLE_AREAS * AREA_BYTES
+    assert locked["raised_locked"]
+    assert locked["raised_relocked"] == NUM_LOCKABLE_AREAS * AREA_BYTES
+
+
+def _lock_with_limit() -> None:
+    _, hard = resource.getrlimit(resource.RLIMIT_MEMLOCK)
+    resource.setrlimit(resource.RLIMIT_MEMLOCK, (4 * AREA_BYTES, hard))
+    if os.geteuid() == 0:
+        # Root isn't held to RLIMIT_MEMLOCK, so the pool runs as nobody
+        os.setgid(NOBODY)
+        os.setuid(NOBODY)
+
+    pool = memoryPool()
+    stream_id = random_string(length=32)
+    locked = {}
+    pool.warmPool(stream_id, AREA_BYTES, NUM_AREAS)
+    locked["locked"] = pool.lockMemory()
+    locked["partial"] = pool.stats().locked_bytes
+    locked["relocked"] = pool.lockMemory()
+    locked["partial_relocked"] = pool.stats().locked_bytes
+    pool.warmPool(stream_id, AREA_BYTES, 2 * NUM_AREAS)
+    locked["partial_warmed"] = pool.stats().locked_bytes
+
+    # Requesting more than the pool may allocate releases all of its free areas
+    pool.getBufferFromPool(streamHandle(stream_id), ALLOCATED_MAX_BYTES + 1)
+    locked["shrunk"] = pool.stats().locked_bytes
+
+    resource.setrlimit(resource.RLIMIT_MEMLOCK, (hard, hard))
+    pool.warmPool(stream_id, AREA_BYTES, NUM_LOCKABLE_AREAS)
+    locked["raised"] = pool.stats().locked_bytes
+    locked["raised_locked"] = pool.lockMemory()
+    locked["raised_relocked"] = pool.stats().locked_bytes
+    print(json.dumps(locked))
+    sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    _lock_with_limit()
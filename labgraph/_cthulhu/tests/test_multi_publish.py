@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+from MyCPPNodes import (  # type: ignore
+    count_multi_stream_allocations,
+    multi_publish_concurrently,
+    multi_publish_nested,
+)
+
+from ...util.testing import local_test
+
+
+NUM_CALLS = 1000
+NUM_PUBLISHES = 1000
+NUM_THREADS = 4
+NUM_WARMUPS = 100
+
+
+@local_test
+def test_multi_publish_concurrently() -> None:
+    """
+    Tests that threads publishing through the same multi-publisher each publish their
+    own samples on every stream. Subscribers run on the publishing thread, so a thread
+    publishing another thread's samples would deliver values outside its own range, or
+    deliver them twice or out of order. Streams drop samples when sends contend for too
+    long, so not every sample has to arrive.
+    """
+    values = multi_publish_concurrently(
+        num_threads=NUM_THREADS, num_publishes=NUM_PUBLISHES
+    )
+    assert len(values) == 2
+    for stream_values in values:
+        delivered = [value.value for value in stream_values]
+        assert len(delivered) == len(set(delivered))
+        for thread in range(NUM_THREADS):
+            thread_values = [
+                value.value for value in stream_values if value.thread == thread
+            ]
+            assert len(thread_values) > 0
+            assert all(value // NUM_PUBLISHES == thread for value in thread_values)
+            assert thread_values == sorted(thread_values)
+
+
+@local_test
+def test_multi_publish_nested() -> None:
+    """
+    Tests that publishing through a multi-publisher from a subscriber of another one
+    doesn't overwrite the samples the outer publish is still delivering.
+    """
+    values = multi_publish_nested(num_publishes=NUM_PUBLISHES)
+    outer = list(range(NUM_PUBLISHES))
+    inner = list(range(NUM_PUBLISHES, 2 * NUM_PUBLISHES))
+    assert [sorted(stream_values) for stream_values in values] == [
+        outer,
+        outer,
+        inner,
+        inner,
+    ]
+
+
+@local_test
+def test_multi_stream_callbacks_do_not_allocate() -> None:
+    """
+    Tests that once warmed up, publishing through a multi-publisher and running the
+    aligned callback of a multi-subscriber don't allocate from the heap, and that a
+    multi-transformer allocates no more than its output sample needs.
+    """
+    allocations = count_multi_stream_allocations(
+        num_warmups=NUM_WARMUPS, num_calls=NUM_CALLS
+    )
+    assert allocations.multi_publish == 0
+    assert allocations.subscriber_callback == 0
+    assert allocations.transformer_callback == allocations.transformer_output
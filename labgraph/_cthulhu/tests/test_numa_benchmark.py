@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+from ...util.testing import local_test
+from ..bindings import Numa  # type: ignore
+from ..numa_benchmark import benchmark_numa
+
+
+NUM_BUFFERS = 100
+BUFFER_SIZE = 1024
+COPY_SIZE = 1024 * 1024
+NUM_COPIES = 2
+
+
+@local_test
+def test_current_node() -> None:
+    """
+    Tests that the node of the calling thread is a valid node that has CPUs.
+    """
+    node = Numa.currentNode()
+    assert 0 <= node < Numa.numNodes()
+    assert len(Numa.cpusOfNode(node)) > 0 or Numa.numNodes() == 1
+
+
+@local_test
+def test_benchmark_numa() -> None:
+    """
+    Tests that the NUMA benchmark measures every allocation and copy it reports.
+    """
+    result = benchmark_numa(
+        num_buffers=NUM_BUFFERS,
+        buffer_size=BUFFER_SIZE,
+        copy_size=COPY_SIZE,
+        num_copies=NUM_COPIES,
+    )
+    assert result.num_nodes == Numa.numNodes()
+    assert 0 < result.allocate_unplaced
+    assert 0 < result.allocate_placed
+    assert 0 < result.local_bandwidth
+    assert (result.remote_bandwidth is None) == (result.num_nodes == 1)
+    assert "unplaced" in result.report()
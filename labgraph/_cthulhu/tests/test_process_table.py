@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import threading
+import time
+
+from ...util.random import random_string
+from ...util.testing import local_test
+from ..bindings import ProcessTable  # type: ignore
+
+
+RANDOM_ID_LENGTH = 16
+WAKE_UP_DELAY = 0.05
+TIMEOUT = 5
+# ProcessTable::kMaxExceptionLength, in bytes
+MAX_EXCEPTION_LENGTH = 16 * 1024 - 1
+
+
+@local_test
+def test_process_table_phases() -> None:
+    """
+    Tests that phases only move forward, and that exceptions are set once.
+    """
+    table = ProcessTable.create(
+        f"test_process_table_{random_string(RANDOM_ID_LENGTH)}", ["a", "b"], 1
+    )
+    other = ProcessTable.open(table.name)
+    assert other.processes == ["a", "b"]
+    assert other.phases() == {"a": 1, "b": 1}
+
+    assert table.set_phase("a", 2)
+    assert other.phase("a") == 2
+    assert not other.set_phase("a", 1)
+    assert not other.has_exception
+
+    assert other.set_exception("b", "failure")
+    assert not table.set_exception("b", "another failure")
+    assert table.exceptions() == {"a": None, "b": "failure"}
+
+
+@local_test
+def test_process_table_wait_for_change() -> None:
+    """
+    Tests that a phase change wakes up a waiting thread before the timeout.
+    """
+    table = ProcessTable.create(
+        f"test_process_table_{random_string(RANDOM_ID_LENGTH)}", ["a"], 1
+    )
+
+    def set_phase() -> None:
+        time.sleep(WAKE_UP_DELAY)
+        table.set_phase("a", 2)
+
+    version = table.version
+    thread = threading.Thread(target=set_phase)
+    start_time = time.perf_counter()
+    thread.start()
+    assert table.wait_for_change(version, TIMEOUT) != version
+    assert time.perf_counter() - start_time < TIMEOUT
+    assert table.phase("a") == 2
+    thread.join()
+
+
+@local_test
+def test_process_table_wait_for_change_timeout() -> None:
+    """
+    Tests that waiting without a change returns after the timeout, and no earlier.
+    """
+    table = ProcessTable.create(
+        f"test_process_table_{random_string(RANDOM_ID_LENGTH)}", ["a"], 1
+    )
+    version = table.version
+    start_time = time.monotonic()
+    assert table.wait_for_change(version, WAKE_UP_DELAY) == version
+    elapsed = time.monotonic() - start_time
+    assert WAKE_UP_DELAY <= elapsed < TIMEOUT
+    assert table.wait_for_change(version, 0) == version
+
+
+@local_test
+def test_process_table_truncates_exception_at_character() -> None:
+    """
+    Tests that an exception description longer than the table holds is truncated
+    before the character that doesn't fit, rather than in the middle of it.
+    """
+    table = ProcessTable.create(
+        f"test_process_table_{random_string(RANDOM_ID_LENGTH)}", ["a", "b", "c"], 1
+    )
+    # A two-byte character, then three-byte ones, across the end of the description
+    short_by_one = "x" * (MAX_EXCEPTION_LENGTH - 1) + "é" + "€" * 10
+    assert table.set_exception("a", short_by_one)
+    assert table.exception("a") == "x" * (MAX_EXCEPTION_LENGTH - 1)
+
+    short_by_two = "x" * (MAX_EXCEPTION_LENGTH - 2) + "€€"
+    assert table.set_exception("b", short_by_two)
+    assert table.exception("b") == "x" * (MAX_EXCEPTION_LENGTH - 2)
+
+    fits = "x" * (MAX_EXCEPTION_LENGTH - 3) + "€"
+    assert table.set_exception("c", fits + "€")
+    assert table.exception("c") == fits
@@ -0,0 +1,26 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import math
+
+from MyCPPNodes import read_arrival_stamps  # type: ignore
+
+from ...util.testing import local_test
+
+
+@local_test
+def test_rebound_view_reads_missing_stamp_as_nan() -> None:
+    """
+    Tests that a view rebound to samples with and without a processing stamp reads
+    the stamp where it is set and NaN where it isn't, instead of throwing.
+    """
+    values = read_arrival_stamps(stamps=[1.5, None, 2.5, None, None, 3.5])
+
+    # The view isn't bound to a sample yet
+    assert math.isnan(values[0])
+    assert values[1] == 1.5
+    assert math.isnan(values[2])
+    assert values[3] == 2.5
+    assert math.isnan(values[4])
+    assert math.isnan(values[5])
+    assert values[6] == 3.5
@@ -0,0 +1,35 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+from typing import Tuple
+
+import pytest
+from MyCPPNodes import measure_received_use_counts, ReceiveMode  # type: ignore
+
+from ...util.random import random_string
+from ...util.testing import local_test
+
+
+def _use_counts(mode: ReceiveMode) -> Tuple[int, int, int]:
+    counts = measure_received_use_counts(prefix=random_string(length=32), mode=mode)
+    return (counts.metadata, counts.parameters, counts.payload)
+
+
+@local_test
+@pytest.mark.parametrize(
+    "owned_mode,view_mode",
+    [
+        (ReceiveMode.SUBSCRIBE_OWNED, ReceiveMode.SUBSCRIBE_VIEW),
+        (ReceiveMode.TRANSFORM_OWNED, ReceiveMode.TRANSFORM_VIEW),
+    ],
+)
+def test_sample_view_borrows(owned_mode: ReceiveMode, view_mode: ReceiveMode) -> None:
+    """
+    Tests that a subscriber or transformer taking a SampleView sees the same use
+    counts on the metadata, parameters and payload of a sample as a generic
+    subscriber, which is handed the delivered sample itself, while one taking an
+    owning sample holds a reference more to each.
+    """
+    delivered = _use_counts(ReceiveMode.GENERIC)
+    assert _use_counts(view_mode) == delivered
+    assert _use_counts(owned_mode) == tuple(count + 1 for count in delivered)
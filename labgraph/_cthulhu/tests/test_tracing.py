@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import json
+import subprocess
+import sys
+from typing import Dict, List, Tuple
+
+import pytest
+from MyCPPNodes import (  # type: ignore
+    collect_trace_events,
+    num_trace_rings,
+    record_trace_events,
+    remove_trace_rings,
+)
+
+from ...runners.launch import launch
+from ...util.random import random_string
+from ...util.testing import local_test
+
+
+NUM_EVENTS = 100
+NUM_THREADS = 4
+RANDOM_ID_LENGTH = 16
+
+
+@local_test
+def test_trace_round_trip(monkeypatch: pytest.MonkeyPatch) -> None:
+    """
+    Tests that the events recorded by each thread are read back from its ring, and
+    that the ring of a thread that exited is taken over by the next thread to record
+    rather than adding a ring. Tracing is only enabled at startup, so the events are
+    recorded in a subprocess with its own trace index and no other shared memory.
+    """
+    monkeypatch.setenv("CTHULHU_TRACE", "1")
+    monkeypatch.setenv("CTHULHU_DISABLE_SHARED_MEMORY", "1")
+    monkeypatch.setenv("CTHULHU_SHM_NAME", random_string(RANDOM_ID_LENGTH))
+    process = launch(__name__, stdout=subprocess.PIPE)
+    output, _ = process.communicate()
+    assert process.returncode == 0
+    trace = json.loads(output.decode().strip().splitlines()[-1])
+    sequence_numbers = list(range(NUM_EVENTS))
+
+    # Threads that run one after another all write to the same ring, which only keeps
+    # the events of the last one
+    assert trace["sequential_rings"] == 1
+    (sequential,) = trace["sequential"].values()
+    assert [stream for stream, _, _ in sequential] == [
+        f"sequential/{NUM_THREADS - 1}"
+    ] * NUM_EVENTS
+    assert [sequence for _, sequence, _ in sequential] == sequence_numbers
+
+    # Threads that run at the same time each get a ring, starting with the released one
+    assert trace["concurrent_rings"] == NUM_THREADS
+    concurrent = trace["concurrent"]
+    assert sorted(concurrent.keys()) == [str(slot) for slot in range(NUM_THREADS)]
+    streams = set()
+    tids = set()
+    for events in concurrent.values():
+        assert len({stream for stream, _, _ in events}) == 1
+        assert len({tid for _, _, tid in events}) == 1
+        assert [sequence for _, sequence, _ in events] == sequence_numbers
+        streams.add(events[0][0])
+        tids.add(events[0][2])
+    assert streams == {f"concurrent/{thread}" for thread in range(NUM_THREADS)}
+    assert len(tids) == NUM_THREADS
+
+    assert trace["removed"] == NUM_THREADS
+    assert trace["rings_after_removal"] == 0
+
+
+def _collect() -> Dict[str, List[Tuple[str, int, int]]]:
+    rings: Dict[str, List[Tuple[str, int, int]]] = {}
+    for event in collect_trace_events():
+        rings.setdefault(str(event.slot), []).append(
+            (event.stream_id, event.sequence_number, event.tid)
+        )
+    return rings
+
+
+def _record_and_collect() -> None:
+    trace = {}
+    record_trace_events(
+        prefix="sequential",
+        num_threads=NUM_THREADS,
+        num_events=NUM_EVENTS,
+        concurrently=False,
+    )
+    trace["sequential_rings"] = num_trace_rings()
+    trace["sequential"] = _collect()
+    record_trace_events(
+        prefix="concurrent",
+        num_threads=NUM_THREADS,
+        num_events=NUM_EVENTS,
+        concurrently=True,
+    )
+    trace["concurrent_rings"] = num_trace_rings()
+    trace["concurrent"] = _collect()
+    trace["removed"] = remove_trace_rings()
+    trace["rings_after_removal"] = num_trace_rings()
+    print(json.dumps(trace))
+    sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    _record_and_collect()
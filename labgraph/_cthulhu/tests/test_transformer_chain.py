@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import pytest
+from MyCPPNodes import run_fused_chain  # type: ignore
+
+from ...util.random import random_string
+from ...util.testing import local_test
+
+
+VALUES = list(range(100))
+
+
+@local_test
+@pytest.mark.parametrize("observe_intermediate", [False, True])
+def test_fused_chain(observe_intermediate: bool) -> None:
+    """
+    Tests that a fused chain runs its stages in order on every sample, and that the
+    intermediate stream is only published on while it has a subscriber.
+    """
+    values = run_fused_chain(
+        prefix=random_string(length=32),
+        values=VALUES,
+        observe_intermediate=observe_intermediate,
+    )
+    assert values.output == [(value + 1) * 2 for value in VALUES]
+    if observe_intermediate:
+        assert values.intermediate == [value + 1 for value in VALUES]
+    else:
+        assert values.intermediate == []
+
+
+@local_test
+def test_fused_chain_reuses_intermediate_buffer() -> None:
+    """
+    Tests that the output of a stage nobody outside the chain observes is reused in
+    place across samples rather than allocated for each of them.
+    """
+    values = run_fused_chain(
+        prefix=random_string(length=32), values=VALUES, observe_intermediate=False
+    )
+    assert values.output == [(value + 1) * 2 for value in VALUES]
+    assert values.intermediate_buffers == 1
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import threading
+import time
+from typing import Iterator, List, Tuple
+
+import pytest
+
+from ...messages.message import Message
+from ...util.random import random_string
+from ...util.testing import local_test
+from ..bindings import (  # type: ignore
+    ConsumerScheduling,
+    watchdog,
+    WatchdogAlert,
+    WatchdogBudget,
+    WatchdogEvent,
+    WatchdogSubject,
+)
+from ..cthulhu import Consumer, Mode, Producer, register_stream
+
+
+RANDOM_ID_LENGTH = 128
+BUDGET = 0.05
+# Long enough past the budget for the monitor thread to notice, every 10 ms by default
+OVER_BUDGET = 0.3
+NUM_MESSAGES = 10
+TIMEOUT = 5.0
+
+
+# The (subject, event, name) of the alerts received by a test
+Alerts = List[Tuple[WatchdogSubject, WatchdogEvent, str]]
+
+
+class MyMessage(Message):
+    int_field: int
+
+
+@pytest.fixture
+def alerts() -> Iterator[Alerts]:
+    received: Alerts = []
+
+    def callback(alert: WatchdogAlert) -> None:
+        received.append((alert.subject, alert.event, alert.name))
+
+    callback_id = watchdog().addCallback(callback)
+    yield received
+    watchdog().removeCallback(callback_id)
+
+
+def wait_for_recovery(alerts: Alerts, name: str) -> List[WatchdogEvent]:
+    deadline = time.time() + TIMEOUT
+    while time.time() < deadline:
+        events = [event for _, event, alert_name in alerts if alert_name == name]
+        if WatchdogEvent.RECOVERED in events:
+            return events
+        time.sleep(0.01)
+    raise TimeoutError(f"{name} didn't recover")
+
+
+@local_test
+def test_watchdog_slow_callback(alerts: Alerts) -> None:
+    """
+    Tests that a consumer whose callback runs past the callback time budget of its
+    stream raises a single stall alert, and a single recovery once it returns.
+    """
+    stream_name = random_string(length=RANDOM_ID_LENGTH)
+    stream_interface = register_stream(name=stream_name, message_type=MyMessage)
+    budget = WatchdogBudget()
+    budget.max_callback_time = BUDGET
+    watchdog().setBudget(stream_name, budget)
+
+    def callback(message: MyMessage) -> None:
+        time.sleep(OVER_BUDGET)
+
+    try:
+        with Producer(stream_interface=stream_interface) as producer:
+            with Consumer(stream_interface=stream_interface, sample_callback=callback):
+                producer.produce_message(MyMessage(int_field=0))
+                events = wait_for_recovery(alerts, stream_name)
+    finally:
+        watchdog().setBudget(stream_name, WatchdogBudget())
+
+    assert events == [WatchdogEvent.STALL, WatchdogEvent.RECOVERED]
+    assert all(
+        subject == WatchdogSubject.CONSUMER
+        for subject, _, name in alerts
+        if name == stream_name
+    )
+
+
+@local_test
+def test_watchdog_backed_up_consumer(alerts: Alerts) -> None:
+    """
+    Tests that a consumer whose samples wait past the age budget it was created with
+    raises a single lag alert while it is backed up, and a single recovery once it
+    has caught up.
+    """
+    stream_name = random_string(length=RANDOM_ID_LENGTH)
+    stream_interface = register_stream(name=stream_name, message_type=MyMessage)
+    scheduling = ConsumerScheduling()
+    scheduling.watchdog.max_age = BUDGET
+    blocked = threading.Event()
+    received = []
+
+    def callback(message: MyMessage) -> None:
+        blocked.wait()
+        received.append(message.int_field)
+
+    with Producer(stream_interface=stream_interface) as producer:
+        with Consumer(
+            stream_interface=stream_interface,
+            sample_callback=callback,
+            mode=Mode.ASYNC,
+            scheduling=scheduling,
+        ):
+            for i in range(NUM_MESSAGES):
+                producer.produce_message(MyMessage(int_field=i))
+            time.sleep(OVER_BUDGET)
+            blocked.set()
+            events = wait_for_recovery(alerts, stream_name)
+
+    assert events == [WatchdogEvent.LAG, WatchdogEvent.RECOVERED]
+    assert received == list(range(NUM_MESSAGES))
@@ -0,0 +1,88 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <cthulhu/Framework.h>
+#include <cthulhu/RawDynamic.h>
+#include <labgraph/LoadGenerator.h>
+
+namespace labgraph {
+
+namespace {
+
+const std::string kOutputTopic = "OUTPUT";
+
+} // namespace
+
+LoadGenerator::LoadGenerator(
+    double rate,
+    uint32_t numSamples,
+    size_t parameterSize,
+    std::vector<size_t> dynamicSizes)
+    : rate_(rate),
+      numSamples_(numSamples),
+      parameterSize_(parameterSize),
+      dynamicSizes_(std::move(dynamicSizes)) {
+  if (rate_ <= 0) {
+    throw std::invalid_argument("LoadGenerator rate must be positive");
+  }
+}
+
+std::vector<std::string> LoadGenerator::getTopics() const {
+  return {kOutputTopic};
+}
+
+std::vector<PublisherInfo> LoadGenerator::getPublishers() {
+  return {{{kOutputTopic}, [this]() { publishSamples(); }}};
+}
+
+void LoadGenerator::cleanup() {
+  stopped_ = true;
+}
+
+uint32_t LoadGenerator::numPublished() const {
+  return numPublished_;
+}
+
+void LoadGenerator::publishSamples() {
+  auto* memoryPool = cthulhu::Framework::instance().memoryPool();
+  const auto handle = cthulhu::StreamHandles::intern(streamIDsByTopic_.at(kOutputTopic));
+  const auto period = std::chrono::duration<double>(1.0 / rate_);
+  const auto start = std::chrono::steady_clock::now();
+
+  for (uint32_t index = 0; index < numSamples_ && !stopped_; index++) {
+    // Publish on a fixed schedule, so that a slow publish delays the next sample without
+    // lowering the rate of the ones after it
+    std::this_thread::sleep_until(
+        start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(period * index));
+
+    cthulhu::StreamSample sample;
+    sample.numberOfSubSamples = 1;
+    if (parameterSize_ > 0) {
+      sample.parameters = memoryPool->getBufferFromPool(handle, parameterSize_);
+      std::memset(sample.parameters.get(), 0, parameterSize_);
+    }
+    if (!dynamicSizes_.empty()) {
+      sample.dynamicParameters = cthulhu::makeSharedRawDynamicArray(dynamicSizes_.size());
+      for (size_t field = 0; field < dynamicSizes_.size(); field++) {
+        if (dynamicSizes_[field] == 0) {
+          continue;
+        }
+        auto buffer = memoryPool->getBufferFromPool(handle, dynamicSizes_[field]);
+        std::memset(buffer.get(), 0, dynamicSizes_[field]);
+        sample.dynamicParameters.get()[field] = cthulhu::RawDynamic<>(buffer, dynamicSizes_[field]);
+      }
+    }
+    sample.metadata->header.sequenceNumber = index;
+    sample.metadata->header.timestamp =
+        std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    cthulhuPublishersByTopic_.at(kOutputTopic)->publish(sample);
+    numPublished_++;
+  }
+}
+
+} // namespace labgraph
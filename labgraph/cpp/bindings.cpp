@@ -2,6 +2,7 @@
 
 #include <labgraph/bindings.h>
 
+#include <labgraph/LoadGenerator.h>
 #include <labgraph/Node.h>
 #include <pybind11/stl.h>
 
@@ -29,6 +30,15 @@ void bindings(py::module_& m) {
   py::class_<NodeBootstrapInfo>(m, "NodeBootstrapInfo")
       .def(py::init<std::vector<NodeTopic>>(), py::arg("topics"))
       .def_readonly("topics", &NodeBootstrapInfo::topics);
+
+  bindNode<LoadGenerator>(m, "LoadGenerator", {"OUTPUT"})
+      .def(
+          py::init<double, uint32_t, size_t, std::vector<size_t>>(),
+          py::arg("rate"),
+          py::arg("num_samples"),
+          py::arg("parameter_size"),
+          py::arg("dynamic_sizes"))
+      .def_property_readonly("num_published", &LoadGenerator::numPublished);
 }
 
 } // namespace labgraph
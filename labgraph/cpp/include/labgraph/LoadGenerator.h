@@ -0,0 +1,55 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <labgraph/Node.h>
+
+namespace labgraph {
+
+/**
+ * class LoadGenerator
+ *
+ * A C++ node that publishes synthetic samples to its OUTPUT topic at a fixed rate, for
+ * benchmarking the graph it is connected to. Samples have the layout of the subscribers'
+ * message type, given as the size of its fixed-length fields and of each of its
+ * dynamic-length fields, and are filled with zeros. Each sample's header carries its
+ * sequence number and the wall-clock time it was published at, so that subscribers can
+ * measure latency.
+ */
+class LoadGenerator : public Node {
+ public:
+  /**
+   * @param rate The number of samples to publish per second
+   * @param numSamples The number of samples to publish before stopping
+   * @param parameterSize The size in bytes of the fixed-length fields of each sample
+   * @param dynamicSizes The size in bytes of each dynamic-length field of each sample
+   */
+  LoadGenerator(
+      double rate,
+      uint32_t numSamples,
+      size_t parameterSize,
+      std::vector<size_t> dynamicSizes);
+
+  std::vector<std::string> getTopics() const override;
+  std::vector<PublisherInfo> getPublishers() override;
+  void cleanup() override;
+
+  /*** The number of samples published so far. */
+  uint32_t numPublished() const;
+
+ private:
+  void publishSamples();
+
+  double rate_;
+  uint32_t numSamples_;
+  size_t parameterSize_;
+  std::vector<size_t> dynamicSizes_;
+  std::atomic<uint32_t> numPublished_{0};
+  std::atomic<bool> stopped_{false};
+};
+
+} // namespace labgraph
@@ -0,0 +1,72 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local bool counting = false;
+thread_local size_t allocations = 0;
+
+void* allocate(size_t size) noexcept {
+  if (counting) {
+    ++allocations;
+  }
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void* allocateOrThrow(size_t size) {
+  void* ptr = allocate(size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+  return allocateOrThrow(size);
+}
+
+void* operator new[](size_t size) {
+  return allocateOrThrow(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+AllocationCounter::AllocationCounter() : start_(allocations), wasCounting_(counting) {
+  counting = true;
+}
+
+AllocationCounter::~AllocationCounter() {
+  counting = wasCounting_;
+}
+
+size_t AllocationCounter::count() const {
+  return allocations - start_;
+}
@@ -0,0 +1,22 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+
+// Counts the heap allocations made through operator new on the calling thread while it is in
+// scope. MyCPPNodes replaces the global operator new to do so.
+class AllocationCounter {
+ public:
+  AllocationCounter();
+  ~AllocationCounter();
+
+  AllocationCounter(const AllocationCounter&) = delete;
+  AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+  size_t count() const;
+
+ private:
+  const size_t start_;
+  const bool wasCounting_;
+};
@@ -0,0 +1,92 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "BorrowedSamples.h"
+
+#include <optional>
+#include <stdexcept>
+#include <variant>
+
+#include <cthulhu/Context.h>
+#include <cthulhu/SampleView.h>
+
+#include "TestSample.h"
+
+namespace {
+
+using Config = cthulhu::DefaultStreamConfig;
+using View = cthulhu::SampleView<TestSample>;
+
+constexpr size_t kPayloadBytes = 64;
+
+ReceivedUseCounts useCounts(const cthulhu::StreamSample& sample) {
+  return {
+      sample.metadata.use_count(),
+      sample.parameters.use_count(),
+      std::get<cthulhu::CpuBuffer>(sample.payload.data).use_count()};
+}
+
+bool forwardConfig(const Config& in, Config& out) {
+  out.setConfig(in.getConfig());
+  return true;
+}
+
+} // namespace
+
+ReceivedUseCounts measureReceivedUseCounts(const std::string& prefix, ReceiveMode mode) {
+  cthulhu::Context context("BorrowedSamples");
+  const cthulhu::StreamID inputID = prefix + "/in";
+  const cthulhu::StreamID outputID = prefix + "/out";
+  auto publisher = context.advertise<TestSample>(inputID);
+
+  std::optional<ReceivedUseCounts> counts;
+  std::optional<cthulhu::Subscriber> subscriber;
+  std::optional<cthulhu::Transformer> transformer;
+  switch (mode) {
+    case ReceiveMode::GENERIC:
+      subscriber.emplace(context.subscribeGeneric(
+          inputID, [&](const cthulhu::StreamSample& sample) { counts = useCounts(sample); }));
+      break;
+    case ReceiveMode::SUBSCRIBE_OWNED:
+      subscriber.emplace(context.subscribe<TestSample>(
+          inputID, [&](const TestSample& sample) { counts = useCounts(sample.getSample()); }));
+      break;
+    case ReceiveMode::SUBSCRIBE_VIEW:
+      subscriber.emplace(context.subscribe<View>(
+          inputID, [&](const View& view) { counts = useCounts(view.getSample()); }));
+      break;
+    case ReceiveMode::TRANSFORM_OWNED:
+      transformer.emplace(context.transform<TestSample, TestSample, Config, Config>(
+          inputID,
+          outputID,
+          [&](const TestSample& in, TestSample& out) {
+            counts = useCounts(in.getSample());
+            out.value = in.value;
+          },
+          forwardConfig));
+      break;
+    case ReceiveMode::TRANSFORM_VIEW:
+      transformer.emplace(context.transform<View, TestSample, Config, Config>(
+          inputID,
+          outputID,
+          [&](const View& in, TestSample& out) {
+            counts = useCounts(in.getSample());
+            out.value = in->value;
+          },
+          forwardConfig));
+      break;
+  }
+
+  publisher.configure(Config());
+  auto* memoryPool = cthulhu::Framework::instance().memoryPool();
+  cthulhu::StreamSample sample;
+  sample.parameters =
+      memoryPool->getBufferFromPool(cthulhu::StreamHandles::anonymous(), sizeof(uint32_t));
+  sample.payload = memoryPool->getBufferFromPool(cthulhu::StreamHandles::anonymous(), kPayloadBytes);
+  sample.numberOfSubSamples = 1;
+  publisher.publish(TestSample(sample));
+
+  if (!counts) {
+    throw std::runtime_error("The sample published on " + inputID + " wasn't received");
+  }
+  return *counts;
+}
@@ -0,0 +1,28 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// How measureReceivedUseCounts receives the sample it publishes
+enum class ReceiveMode : uint8_t {
+  // A generic subscriber, which is handed the delivered StreamSample itself
+  GENERIC = 0,
+  SUBSCRIBE_OWNED = 1,
+  SUBSCRIBE_VIEW = 2,
+  TRANSFORM_OWNED = 3,
+  TRANSFORM_VIEW = 4,
+};
+
+// The use_count() of the metadata, parameters and payload of a sample, read in the callback that
+// received it
+struct ReceivedUseCounts {
+  long metadata;
+  long parameters;
+  long payload;
+};
+
+// Publishes a sample with a payload on prefix/in, and returns the use counts of its buffers as
+// seen by a subscriber of prefix/in, or a transformer from prefix/in to prefix/out
+ReceivedUseCounts measureReceivedUseCounts(const std::string& prefix, ReceiveMode mode);
@@ -0,0 +1,116 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "FusedChain.h"
+
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <type_traits>
+#include <utility>
+
+#include <cthulhu/Context.h>
+
+#include "TestSample.h"
+
+namespace {
+
+using Chain = cthulhu::TransformerChain<TestSample>;
+using Config = cthulhu::DefaultStreamConfig;
+using StageCallback = std::function<void(const TestSample&, TestSample&)>;
+
+template <typename C, typename = void>
+struct CanThen : std::false_type {};
+template <typename C>
+struct CanThen<
+    C,
+    std::void_t<decltype(std::declval<C>().template then<TestSample>(
+        std::declval<const cthulhu::StreamID&>(),
+        std::declval<const StageCallback&>()))>> : std::true_type {};
+
+template <typename C, typename = void>
+struct CanBuild : std::false_type {};
+template <typename C>
+struct CanBuild<C, std::void_t<decltype(std::declval<C>().build())>> : std::true_type {};
+
+// then() and build() move out of the chain, so they must not be callable on an lvalue
+static_assert(CanThen<Chain&&>::value, "TransformerChain::then must accept an rvalue");
+static_assert(!CanThen<Chain&>::value, "TransformerChain::then must reject an lvalue");
+static_assert(CanBuild<Chain&&>::value, "TransformerChain::build must accept an rvalue");
+static_assert(!CanBuild<Chain&>::value, "TransformerChain::build must reject an lvalue");
+
+bool forwardConfig(const Config& in, Config& out) {
+  out.setConfig(in.getConfig());
+  return true;
+}
+
+class ValueRecorder {
+ public:
+  ValueRecorder(const cthulhu::Context& context, const cthulhu::StreamID& id)
+      : subscriber_(context.subscribe<TestSample>(id, [this](const TestSample& sample) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          values_.push_back(sample.value);
+        })) {}
+
+  std::vector<uint32_t> values() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return values_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<uint32_t> values_;
+  cthulhu::Subscriber subscriber_;
+};
+
+} // namespace
+
+FusedChainValues runFusedChain(
+    const std::string& prefix,
+    const std::vector<uint32_t>& values,
+    bool observeIntermediate) {
+  cthulhu::Context context("FusedChain");
+  const cthulhu::StreamID inputID = prefix + "/in";
+  const cthulhu::StreamID intermediateID = prefix + "/plus_one";
+  const cthulhu::StreamID outputID = prefix + "/doubled";
+  auto publisher = context.advertise<TestSample>(inputID);
+
+  // Extends a chain held in a variable, which has to be moved from
+  auto chain = context.chain<TestSample>(inputID);
+  auto plusOne = std::move(chain).then<TestSample, Config, Config>(
+      intermediateID,
+      [](const TestSample& in, TestSample& out) { out.value = in.value + 1; },
+      forwardConfig);
+  std::mutex buffersMutex;
+  std::set<const void*> buffers;
+  auto node = std::move(plusOne)
+                  .then<TestSample, Config, Config>(
+                      outputID,
+                      [&](const TestSample& in, TestSample& out) {
+                        {
+                          std::lock_guard<std::mutex> lock(buffersMutex);
+                          buffers.insert(in.getSample().parameters.get());
+                        }
+                        out.value = in.value * 2;
+                      },
+                      forwardConfig)
+                  .build();
+
+  std::optional<ValueRecorder> intermediate;
+  if (observeIntermediate) {
+    intermediate.emplace(context, intermediateID);
+  }
+  ValueRecorder output(context, outputID);
+
+  publisher.configure(Config());
+  for (const auto value : values) {
+    TestSample sample;
+    sample.value = value;
+    publisher.publish(sample);
+  }
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  return {
+      intermediate ? intermediate->values() : std::vector<uint32_t>(),
+      output.values(),
+      buffers.size()};
+}
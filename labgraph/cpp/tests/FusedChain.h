@@ -0,0 +1,22 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The values received on the streams of a fused transformer chain, and the number of distinct
+// buffers the second stage read its input from
+struct FusedChainValues {
+  std::vector<uint32_t> intermediate;
+  std::vector<uint32_t> output;
+  size_t intermediateBuffers;
+};
+
+// Publishes values on prefix/in through a fused chain that adds 1 on prefix/plus_one, then doubles
+// on prefix/doubled. The intermediate stream is only subscribed to if observeIntermediate is set.
+FusedChainValues runFusedChain(
+    const std::string& prefix,
+    const std::vector<uint32_t>& values,
+    bool observeIntermediate);
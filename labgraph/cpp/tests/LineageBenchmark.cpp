@@ -0,0 +1,60 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "LineageBenchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <cthulhu/Lineage.h>
+
+namespace {
+
+double median(std::vector<double>& durations) {
+  std::nth_element(durations.begin(), durations.begin() + durations.size() / 2, durations.end());
+  return durations[durations.size() / 2];
+}
+
+// Records the lineage of numRecords output samples, each produced from a sample of two input
+// streams. Returns the median time to record one, and the largest size of the table after a record.
+double recordLineage(cthulhu::LineageTable& table, uint32_t numRecords, size_t& maxSize) {
+  std::vector<double> durations;
+  durations.reserve(numRecords);
+  for (uint32_t sequenceNumber = 0; sequenceNumber < numRecords; sequenceNumber++) {
+    std::vector<cthulhu::LineageRecord> inputs{{0, sequenceNumber}, {1, sequenceNumber}};
+    const auto start = std::chrono::steady_clock::now();
+    table.record(0, sequenceNumber, std::move(inputs));
+    durations.push_back(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    maxSize = std::max(maxSize, table.size());
+  }
+  return median(durations);
+}
+
+} // namespace
+
+LineageRecordTimes benchmarkLineageRecord(uint32_t numRecords, size_t capacity) {
+  LineageRecordTimes times{};
+
+  cthulhu::LineageTable table(capacity);
+  times.record = recordLineage(table, numRecords, times.maxSize);
+
+  // Cycles the capacity through off, half and full while recording, as reconfiguring a running
+  // aligner does
+  cthulhu::LineageTable resized(capacity);
+  std::atomic<bool> done{false};
+  std::thread resizer([&]() {
+    const size_t capacities[] = {0, capacity / 2, capacity};
+    for (size_t index = 0; !done; index++) {
+      resized.setCapacity(capacities[index % 3]);
+      std::this_thread::yield();
+    }
+  });
+  times.maxSize = 0;
+  times.recordResizing = recordLineage(resized, numRecords, times.maxSize);
+  done = true;
+  resizer.join();
+  return times;
+}
@@ -0,0 +1,17 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// The median time in seconds to record the lineage of an output sample in a LineageTable, alone
+// and while another thread keeps changing the capacity of the table, and the largest number of
+// entries the table held while its capacity changed
+struct LineageRecordTimes {
+  double record;
+  double recordResizing;
+  size_t maxSize;
+};
+
+LineageRecordTimes benchmarkLineageRecord(uint32_t numRecords, size_t capacity);
@@ -0,0 +1,221 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "MultiPublishBenchmark.h"
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <cthulhu/Context.h>
+
+#include "AllocationCounter.h"
+#include "TestSample.h"
+
+namespace {
+
+std::vector<cthulhu::StreamID> streamIDs(const std::string& prefix, uint32_t numStreams) {
+  std::vector<cthulhu::StreamID> ids;
+  for (uint32_t stream = 0; stream < numStreams; stream++) {
+    ids.push_back(prefix + "/" + std::to_string(stream));
+  }
+  return ids;
+}
+
+// Runs call numWarmups times, then returns the allocations per call over numCalls more calls
+double allocationsPerCall(
+    uint32_t numWarmups,
+    uint32_t numCalls,
+    const std::function<void()>& call) {
+  for (uint32_t index = 0; index < numWarmups; index++) {
+    call();
+  }
+  AllocationCounter counter;
+  for (uint32_t index = 0; index < numCalls; index++) {
+    call();
+  }
+  return static_cast<double>(counter.count()) / numCalls;
+}
+
+// Configured publishers of TestSamples on each of the given streams
+std::vector<cthulhu::Publisher> advertise(
+    const cthulhu::Context& context,
+    const std::vector<cthulhu::StreamID>& ids) {
+  std::vector<cthulhu::Publisher> publishers;
+  for (const auto& id : ids) {
+    publishers.push_back(context.advertise<TestSample>(id));
+    publishers.back().configure(cthulhu::DefaultStreamConfig());
+  }
+  return publishers;
+}
+
+// Records the values received on each of the given streams
+class Recorder {
+ public:
+  Recorder(const cthulhu::Context& context, const std::vector<cthulhu::StreamID>& ids)
+      : values_(ids.size()) {
+    for (size_t stream = 0; stream < ids.size(); stream++) {
+      subscribers_.push_back(context.subscribe<TestSample>(
+          ids[stream], [this, stream](const TestSample& sample) { record(stream, sample.value); }));
+    }
+  }
+
+  void record(size_t stream, uint32_t value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_[stream].push_back(value);
+  }
+
+  std::vector<std::vector<uint32_t>> values() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return values_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::vector<uint32_t>> values_;
+  std::vector<cthulhu::Subscriber> subscribers_;
+};
+
+std::vector<TestSample> makeSamples(size_t numSamples, uint32_t value) {
+  std::vector<TestSample> samples(numSamples);
+  for (auto& sample : samples) {
+    sample.value = value;
+  }
+  return samples;
+}
+
+} // namespace
+
+MultiStreamAllocations countMultiStreamAllocations(uint32_t numWarmups, uint32_t numCalls) {
+  cthulhu::Context context("MultiStreamAllocations");
+  const auto samples = makeSamples(2, 0);
+  MultiStreamAllocations allocations;
+
+  // Publishing on two streams, each delivering to a subscriber
+  const auto multiIDs = streamIDs("allocations/multi", 2);
+  auto multiPublisher = context.advertise<std::vector<TestSample>>(multiIDs);
+  size_t received = 0;
+  std::vector<cthulhu::Subscriber> subscribers;
+  for (const auto& id : multiIDs) {
+    subscribers.push_back(
+        context.subscribe<TestSample>(id, [&received](const TestSample&) { received++; }));
+  }
+  allocations.multiPublish = allocationsPerCall(
+      numWarmups, numCalls, [&multiPublisher, &samples]() { multiPublisher.publish(samples); });
+
+  // Publishing a sample on each input of a multi-subscriber runs its aligned callback once
+  const auto subscriberIDs = streamIDs("allocations/subscriber", 2);
+  auto subscriberInputs = advertise(context, subscriberIDs);
+  size_t subscriberCallbacks = 0;
+  auto multiSubscriber = context.subscribe<2>(
+      std::array<cthulhu::StreamID, 2>{subscriberIDs[0], subscriberIDs[1]},
+      std::function<void(const TestSample&, const TestSample&)>(
+          [&subscriberCallbacks](const TestSample&, const TestSample&) { subscriberCallbacks++; }));
+  allocations.subscriberCallback =
+      allocationsPerCall(numWarmups, numCalls, [&subscriberInputs, &samples]() {
+        subscriberInputs[0].publish(samples[0]);
+        subscriberInputs[1].publish(samples[1]);
+      });
+
+  // The same for a multi-transformer, whose output is published on a stream nobody subscribes to.
+  // Its output is a basic stream, so it is configured up front by a publisher released right after
+  const auto transformerIDs = streamIDs("allocations/transformer", 3);
+  auto transformerInputs = advertise(context, {transformerIDs[0], transformerIDs[1]});
+  advertise(context, {transformerIDs[2]});
+  size_t transformerCallbacks = 0;
+  {
+    auto multiTransformer = context.transform(
+        {std::vector<cthulhu::StreamID>{transformerIDs[0], transformerIDs[1]}},
+        {std::vector<cthulhu::StreamID>{transformerIDs[2]}},
+        std::function<void(const std::vector<TestSample>&, std::vector<TestSample>&)>(
+            [&transformerCallbacks](
+                const std::vector<TestSample>& in, std::vector<TestSample>& out) {
+              out[0].value = in[0].value + in[1].value;
+              transformerCallbacks++;
+            }));
+    allocations.transformerCallback =
+        allocationsPerCall(numWarmups, numCalls, [&transformerInputs, &samples]() {
+          transformerInputs[0].publish(samples[0]);
+          transformerInputs[1].publish(samples[1]);
+        });
+  }
+
+  // What the transformer has to allocate for its output
+  auto outputPublisher = context.advertise<TestSample>(transformerIDs[2]);
+  const cthulhu::StreamIDView firstID(transformerIDs[0]);
+  const cthulhu::StreamIDView secondID(transformerIDs[1]);
+  allocations.transformerOutput =
+      allocationsPerCall(numWarmups, numCalls, [&outputPublisher, &samples, &firstID, &secondID]() {
+        auto output = outputPublisher.allocateSample<TestSample>();
+        auto& history = output.getSample().metadata->history;
+        history.emplace(firstID, samples[0].getSample().metadata);
+        history.emplace(secondID, samples[1].getSample().metadata);
+      });
+
+  if (received != 2 * (numWarmups + numCalls) ||
+      subscriberCallbacks != numWarmups + numCalls ||
+      transformerCallbacks != numWarmups + numCalls) {
+    throw std::runtime_error("Not every sample was delivered");
+  }
+  return allocations;
+}
+
+std::vector<std::vector<DeliveredValue>> multiPublishConcurrently(
+    uint32_t numThreads,
+    uint32_t numPublishes) {
+  cthulhu::Context context("MultiPublishConcurrently");
+  const auto ids = streamIDs("concurrent", 2);
+  auto multiPublisher = context.advertise<std::vector<TestSample>>(ids);
+
+  // Samples are delivered synchronously, so each subscriber callback runs on the thread that
+  // published the sample
+  static thread_local uint32_t publishingThread = 0;
+  std::mutex mutex;
+  std::vector<std::vector<DeliveredValue>> values(ids.size());
+  std::vector<cthulhu::Subscriber> subscribers;
+  for (size_t stream = 0; stream < ids.size(); stream++) {
+    subscribers.push_back(context.subscribe<TestSample>(
+        ids[stream], [&mutex, &values, stream](const TestSample& sample) {
+          std::lock_guard<std::mutex> lock(mutex);
+          values[stream].push_back({publishingThread, sample.value});
+        }));
+  }
+
+  std::vector<std::thread> threads;
+  for (uint32_t thread = 0; thread < numThreads; thread++) {
+    threads.emplace_back([&multiPublisher, thread, numPublishes]() {
+      publishingThread = thread;
+      for (uint32_t index = 0; index < numPublishes; index++) {
+        multiPublisher.publish(makeSamples(2, thread * numPublishes + index));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  return values;
+}
+
+std::vector<std::vector<uint32_t>> multiPublishNested(uint32_t numPublishes) {
+  cthulhu::Context context("MultiPublishNested");
+  const auto outerIDs = streamIDs("outer", 2);
+  const auto innerIDs = streamIDs("inner", 2);
+  auto outerPublisher = context.advertise<std::vector<TestSample>>(outerIDs);
+  auto innerPublisher = context.advertise<std::vector<TestSample>>(innerIDs);
+  auto ids = outerIDs;
+  ids.insert(ids.end(), innerIDs.begin(), innerIDs.end());
+  Recorder recorder(context, ids);
+  // Publishes on the inner streams while the outer publish() is delivering its first sample
+  auto subscriber = context.subscribe<TestSample>(
+      outerIDs[0], [&innerPublisher, numPublishes](const TestSample& sample) {
+        innerPublisher.publish(makeSamples(2, sample.value + numPublishes));
+      });
+
+  for (uint32_t index = 0; index < numPublishes; index++) {
+    outerPublisher.publish(makeSamples(2, index));
+  }
+  return recorder.values();
+}
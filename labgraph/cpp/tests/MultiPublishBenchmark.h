@@ -0,0 +1,37 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// The heap allocations per call in steady state, on two streams, of publishing through a
+// MultiPublisher, and of the aligned callbacks of a MultiSubscriber and of a MultiTransformer with
+// one output. A transformer has to allocate its output and record its inputs in the output's
+// history on every callback, so transformerOutput counts the allocations of doing just that.
+struct MultiStreamAllocations {
+  double multiPublish;
+  double subscriberCallback;
+  double transformerCallback;
+  double transformerOutput;
+};
+
+MultiStreamAllocations countMultiStreamAllocations(uint32_t numWarmups, uint32_t numCalls);
+
+// A value received on a stream, with the index of the thread that delivered it
+struct DeliveredValue {
+  uint32_t thread;
+  uint32_t value;
+};
+
+// Publishes numPublishes pairs of samples on two streams through a MultiPublisher shared by
+// numThreads threads, and returns the values received on each stream. Thread i publishes the
+// values from i * numPublishes.
+std::vector<std::vector<DeliveredValue>> multiPublishConcurrently(
+    uint32_t numThreads,
+    uint32_t numPublishes);
+
+// Publishes numPublishes pairs of samples on two streams through a MultiPublisher, and a pair on
+// two other streams through another MultiPublisher from the subscriber of the first stream. Returns
+// the values received on each of the four streams.
+std::vector<std::vector<uint32_t>> multiPublishNested(uint32_t numPublishes);
@@ -0,0 +1,40 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "ProcessingStamps.h"
+
+#include <cthulhu/Framework.h>
+#include <cthulhu/SampleView.h>
+#include <cthulhu/StreamType.h>
+
+struct StampedSample : public cthulhu::AutoStreamSample {
+  using T = StampedSample;
+
+  cthulhu::FieldsBegin<T> begin;
+  cthulhu::SampleField<uint32_t, T> value{"value", this};
+  cthulhu::FieldsEnd<T> end;
+
+  cthulhu::ProcessingTimestamp arrival{"arrival", this};
+
+  CTHULHU_AUTOSTREAM_SAMPLE(StampedSample);
+};
+
+CTHULHU_REGISTER_BASIC_STREAM_TYPE(Stamped, StampedSample);
+
+std::vector<double> readArrivalStamps(const std::vector<std::optional<double>>& stamps) {
+  std::vector<StampedSample> samples(stamps.size());
+  for (size_t i = 0; i < stamps.size(); ++i) {
+    if (stamps[i].has_value()) {
+      samples[i].arrival.set(*stamps[i]);
+    } else {
+      samples[i].getSample().metadata->processingStamps.erase("arrival");
+    }
+  }
+
+  cthulhu::SampleView<StampedSample> view;
+  std::vector<double> values{view->arrival.get()};
+  for (const auto& sample : samples) {
+    view.setSample(sample.getSample());
+    values.push_back(view->arrival.get());
+  }
+  return values;
+}
@@ -0,0 +1,11 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+// Reads the "arrival" processing stamp through a SampleView that is rebound to one sample per
+// stamp, the way the aligner callbacks reuse views. Samples whose stamp is empty don't carry it.
+// The first value is read before the view is bound to any sample.
+std::vector<double> readArrivalStamps(const std::vector<std::optional<double>>& stamps);
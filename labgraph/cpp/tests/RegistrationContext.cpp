@@ -0,0 +1,21 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "RegistrationContext.h"
+
+#include "TestSample.h"
+
+RegistrationContext::RegistrationContext(const std::string& name) : context_(name) {}
+
+void RegistrationContext::subscribe(const std::string& id) {
+  subscribers_.push_back(context_.subscribe<TestSample>(id, [](const TestSample&) {}));
+}
+
+void RegistrationContext::advertise(const std::string& id) {
+  publishers_.push_back(context_.advertise<TestSample>(id));
+}
+
+void RegistrationContext::transform(const std::string& input, const std::string& output) {
+  transformers_.push_back(std::make_unique<cthulhu::Transformer>(
+      context_.transform<TestSample, TestSample>(
+          input, output, [](const TestSample& in, TestSample& out) { out.value = in.value; })));
+}
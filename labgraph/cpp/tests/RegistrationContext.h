@@ -0,0 +1,26 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <cthulhu/Context.h>
+
+// A Context that registers subscriptions, publications and transformations of TestSample streams
+// on request, for tests of the context registry. The context is removed from the registry when
+// this is destroyed.
+class RegistrationContext {
+ public:
+  explicit RegistrationContext(const std::string& name);
+
+  void subscribe(const std::string& id);
+  void advertise(const std::string& id);
+  void transform(const std::string& input, const std::string& output);
+
+ private:
+  cthulhu::Context context_;
+  std::vector<cthulhu::Subscriber> subscribers_;
+  std::vector<cthulhu::Publisher> publishers_;
+  std::vector<cthulhu::TransformerPtr> transformers_;
+};
@@ -0,0 +1,218 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "SubAlignerLineage.h"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+#include <cthulhu/Framework.h>
+#include <cthulhu/SubAligner.h>
+
+#include "AllocationCounter.h"
+
+namespace {
+
+constexpr double kReferenceRate = 1.0;
+// Samples of the other stream per reference sample
+constexpr uint32_t kSamplesPerReference = 4;
+constexpr size_t kNumStreams = 2;
+// Inputs are numbered from here, so that they can't be mistaken for output sequence numbers
+constexpr uint32_t kFirstInputSequenceNumber = 1000;
+// Sample interval of LineageMode::SAMPLED
+constexpr uint32_t kBenchmarkSampleInterval = 10;
+
+using InputCallback =
+    std::function<void(size_t idx, const std::shared_ptr<cthulhu::SampleMetadata>&)>;
+using OutputCallback = std::function<
+    void(const cthulhu::AlignerSamplesMeta&, const std::vector<cthulhu::StreamSample>&)>;
+
+// A thread neutral SubAligner on a 1 Hz reference stream and a 4 Hz stream of TestSamples, fed by
+// producers of its own
+class LineageHarness {
+ public:
+  LineageHarness(const std::string& prefix, const cthulhu::LineageSettings& lineage)
+      : aligner_({}, cthulhu::ThreadPolicy::THREAD_NEUTRAL) {
+    auto& framework = cthulhu::Framework::instance();
+    const auto typeID = framework.typeRegistry()->findTypeName("Test")->typeID();
+    for (size_t idx = 0; idx < kNumStreams; ++idx) {
+      auto* si = framework.streamRegistry()->registerStream(
+          cthulhu::StreamDescription(prefix + "/" + std::to_string(idx), typeID));
+      if (si == nullptr) {
+        throw std::runtime_error("Failed to register stream " + prefix);
+      }
+      aligner_.registerConsumer(si, idx);
+      producers_.push_back(std::make_unique<cthulhu::StreamProducer>(si));
+    }
+    aligner_.setDefaultMetronome(true);
+    aligner_.setDefaultLineage(lineage);
+  }
+
+  // The aligned meta of a set is always passed before its samples
+  void setOutputCallback(const OutputCallback& callback) {
+    aligner_.setSamplesMetaCallback(
+        [this](const cthulhu::AlignerSamplesMeta& meta) { meta_ = meta; });
+    aligner_.setCallback([this, callback](const std::vector<cthulhu::StreamSample>& samples) {
+      callback(meta_, samples);
+    });
+  }
+
+  // Produces numSamples reference samples, and the samples of the other stream between them
+  void run(uint32_t numSamples, const InputCallback& onInput) {
+    aligner_.finalize();
+    for (size_t idx = 0; idx < kNumStreams; ++idx) {
+      cthulhu::StreamConfig config;
+      config.nominalSampleRate = idx == 0 ? kReferenceRate : kReferenceRate * kSamplesPerReference;
+      config.sampleSizeInBytes = sizeof(uint32_t);
+      producers_[idx]->configureStream(config);
+    }
+    uint32_t sequenceNumbers[kNumStreams] = {kFirstInputSequenceNumber, kFirstInputSequenceNumber};
+    for (uint32_t tick = 0; tick < numSamples * kSamplesPerReference; ++tick) {
+      const double timestamp = tick / (kReferenceRate * kSamplesPerReference);
+      for (size_t idx = 0; idx < kNumStreams; ++idx) {
+        if (idx == 0 && tick % kSamplesPerReference != 0) {
+          continue;
+        }
+        cthulhu::StreamSample sample;
+        sample.metadata->header.timestamp = timestamp;
+        sample.metadata->header.sequenceNumber = sequenceNumbers[idx]++;
+        sample.numberOfSubSamples = 1;
+        sample.payload = cthulhu::Framework::instance().memoryPool()->getBufferFromPool(
+            producers_[idx]->handle(), sizeof(uint32_t));
+        if (onInput) {
+          onInput(idx, sample.metadata);
+        }
+        producers_[idx]->produceSample(sample);
+      }
+    }
+  }
+
+  std::optional<std::vector<LineageInput>> lineage(size_t idx, uint32_t sequenceNumber) const {
+    const auto records = aligner_.lineage(idx, sequenceNumber);
+    if (!records) {
+      return std::nullopt;
+    }
+    std::vector<LineageInput> inputs;
+    for (const auto& record : *records) {
+      inputs.emplace_back(record.streamIndex, record.sequenceNumber);
+    }
+    return inputs;
+  }
+
+ private:
+  cthulhu::SubAligner aligner_;
+  std::vector<std::unique_ptr<cthulhu::StreamProducer>> producers_;
+  cthulhu::AlignerSamplesMeta meta_;
+};
+
+} // namespace
+
+std::vector<AlignedLineage> alignWithLineage(
+    const std::string& prefix,
+    cthulhu::LineagePolicy policy,
+    uint32_t sampleInterval,
+    uint32_t numSamples) {
+  LineageHarness harness(prefix, cthulhu::LineageSettings{policy, sampleInterval});
+  std::vector<AlignedLineage> outputs;
+  harness.setOutputCallback([&outputs](
+                                const cthulhu::AlignerSamplesMeta& meta,
+                                const std::vector<cthulhu::StreamSample>& samples) {
+    for (size_t idx = 0; idx < samples.size(); ++idx) {
+      // Streams without references in the set have no output sample
+      if (meta[idx].references.empty()) {
+        continue;
+      }
+      AlignedLineage output{
+          static_cast<uint32_t>(idx), samples[idx].metadata->header.sequenceNumber, {}, {}};
+      for (const auto& reference : meta[idx].references) {
+        output.inputs.push_back(reference.sequenceNumber);
+      }
+      outputs.push_back(std::move(output));
+    }
+  });
+  harness.run(numSamples, nullptr);
+
+  for (auto& output : outputs) {
+    output.lineage = harness.lineage(output.streamIndex, output.sequenceNumber);
+  }
+  return outputs;
+}
+
+SubAlignerLineageCost benchmarkSubAlignerLineage(
+    const std::string& prefix,
+    LineageMode mode,
+    uint32_t numSamples,
+    size_t numRetained) {
+  cthulhu::LineageSettings lineage;
+  if (mode == LineageMode::SAMPLED) {
+    lineage = {cthulhu::LineagePolicy::SAMPLED, kBenchmarkSampleInterval};
+  } else if (mode == LineageMode::FULL) {
+    lineage = {cthulhu::LineagePolicy::FULL, 1};
+  }
+  LineageHarness harness(prefix, lineage);
+
+  // Every input is kept alive until the end of the run, so that the history maps can point to it.
+  // History keys are views, so the key of each input is kept alive along with it.
+  std::vector<std::shared_ptr<cthulhu::SampleMetadata>> inputs[kNumStreams];
+  std::vector<std::string> keys[kNumStreams];
+  for (size_t idx = 0; idx < kNumStreams; ++idx) {
+    inputs[idx].reserve(numSamples * kSamplesPerReference);
+    keys[idx].reserve(numSamples * kSamplesPerReference);
+  }
+  std::deque<std::vector<cthulhu::StreamSample>> retained;
+  SubAlignerLineageCost cost{};
+  harness.setOutputCallback([&](const cthulhu::AlignerSamplesMeta& meta,
+                                const std::vector<cthulhu::StreamSample>& samples) {
+    for (size_t idx = 0; idx < samples.size(); ++idx) {
+      if (meta[idx].references.empty()) {
+        continue;
+      }
+      ++cost.numOutputs;
+      if (mode != LineageMode::HISTORY) {
+        continue;
+      }
+      for (const auto& reference : meta[idx].references) {
+        const size_t input = reference.sequenceNumber - kFirstInputSequenceNumber;
+        samples[idx].metadata->history[keys[idx][input]] = inputs[idx][input];
+      }
+    }
+    retained.push_back(samples);
+    if (retained.size() > numRetained) {
+      retained.pop_front();
+    }
+  });
+
+  const auto start = std::chrono::steady_clock::now();
+  {
+    AllocationCounter counter;
+    harness.run(numSamples, [&](size_t idx, const std::shared_ptr<cthulhu::SampleMetadata>& input) {
+      inputs[idx].push_back(input);
+      if (mode == LineageMode::HISTORY) {
+        keys[idx].push_back("subaligner_" + std::to_string(input->header.sequenceNumber));
+      }
+    });
+    cost.allocationsPerOutput =
+        cost.numOutputs == 0 ? 0.0 : static_cast<double>(counter.count()) / cost.numOutputs;
+  }
+  cost.timePerSample =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() /
+      numSamples;
+
+  std::vector<std::weak_ptr<cthulhu::SampleMetadata>> released;
+  for (auto& streamInputs : inputs) {
+    released.insert(released.end(), streamInputs.begin(), streamInputs.end());
+    streamInputs.clear();
+  }
+  for (const auto& input : released) {
+    cost.retainedInputs += input.expired() ? 0 : 1;
+  }
+  cost.lineageEntries = 0;
+  for (size_t idx = 0; idx < kNumStreams; ++idx) {
+    for (uint32_t sequenceNumber = 0; sequenceNumber < cost.numOutputs; ++sequenceNumber) {
+      cost.lineageEntries += harness.lineage(idx, sequenceNumber) ? 1 : 0;
+    }
+  }
+  return cost;
+}
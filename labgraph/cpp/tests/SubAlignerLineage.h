@@ -0,0 +1,62 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cthulhu/Lineage.h>
+
+// (stream index, sequence number) of a sample that went into an aligned output
+using LineageInput = std::pair<uint32_t, uint32_t>;
+
+// An output sample of a SubAligner, with the sequence numbers of the inputs its aligned meta
+// references and the lineage the aligner kept for it, if any
+struct AlignedLineage {
+  uint32_t streamIndex;
+  uint32_t sequenceNumber;
+  std::vector<uint32_t> inputs;
+  std::optional<std::vector<LineageInput>> lineage;
+};
+
+// Aligns numSamples samples of a 1 Hz reference stream with the samples of a 4 Hz stream, keeping
+// lineage with the given policy, and returns every output sample of both streams
+std::vector<AlignedLineage> alignWithLineage(
+    const std::string& prefix,
+    cthulhu::LineagePolicy policy,
+    uint32_t sampleInterval,
+    uint32_t numSamples);
+
+// How to link the outputs of the SubAligner to their inputs in benchmarkSubAlignerLineage
+enum class LineageMode : uint8_t {
+  // SampleMetadata::history["subaligner_<seq>"] on every output, which the SubAligner used to do
+  HISTORY = 0,
+  OFF = 1,
+  SAMPLED = 2,
+  FULL = 3,
+};
+
+struct SubAlignerLineageCost {
+  // Mean time in seconds to produce a reference sample, along with the samples of the other
+  // stream up to the next one, and align them
+  double timePerSample;
+  // Heap allocations per output sample, including the ones made to produce the inputs
+  double allocationsPerOutput;
+  size_t numOutputs;
+  // The input metadata still alive once only the last numRetained outputs are held on to
+  size_t retainedInputs;
+  // The outputs whose lineage can still be looked up at the end
+  size_t lineageEntries;
+};
+
+// Aligns numSamples samples of the same streams as alignWithLineage, holding on to the last
+// numRetained outputs the way a downstream queue would, with the given lineage mode
+SubAlignerLineageCost benchmarkSubAlignerLineage(
+    const std::string& prefix,
+    LineageMode mode,
+    uint32_t numSamples,
+    size_t numRetained);
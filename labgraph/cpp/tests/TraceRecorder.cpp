@@ -0,0 +1,51 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include "TraceRecorder.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+void recordTraceEvents(
+    const std::string& prefix,
+    uint32_t numThreads,
+    uint32_t numEvents,
+    bool concurrently) {
+  std::mutex mutex;
+  std::condition_variable allRecorded;
+  uint32_t numRecorded = 0;
+  auto record = [&](uint32_t thread) {
+    const auto id = prefix + "/" + std::to_string(thread);
+    for (uint32_t index = 0; index < numEvents; index++) {
+      cthulhu::Tracer::record(id, index, cthulhu::TracePhase::PRODUCE);
+    }
+    if (concurrently) {
+      std::unique_lock<std::mutex> lock(mutex);
+      numRecorded++;
+      allRecorded.notify_all();
+      allRecorded.wait(lock, [&]() { return numRecorded == numThreads; });
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t thread = 0; thread < numThreads; thread++) {
+    threads.emplace_back(record, thread);
+    if (!concurrently) {
+      threads.back().join();
+    }
+  }
+  for (auto& thread : threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+std::vector<cthulhu::CollectedTraceEvent> collectTraceEvents() {
+  std::vector<cthulhu::CollectedTraceEvent> events;
+  const uint32_t numRings = cthulhu::Tracer::numRings();
+  for (uint32_t slot = 0; slot < numRings; slot++) {
+    cthulhu::Tracer::readRing(slot, events);
+  }
+  return events;
+}
@@ -0,0 +1,21 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <cthulhu/Tracing.h>
+
+// Records numEvents produce events, numbered from 0, on the stream "<prefix>/<thread>" from each
+// of numThreads threads. The threads run one after another, unless concurrently is set, in which
+// case none of them exits before all of them have recorded their events. Tracing must be enabled.
+void recordTraceEvents(
+    const std::string& prefix,
+    uint32_t numThreads,
+    uint32_t numEvents,
+    bool concurrently);
+
+// Reads back the events held by every ring in the trace index
+std::vector<cthulhu::CollectedTraceEvent> collectTraceEvents();
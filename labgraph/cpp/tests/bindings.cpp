@@ -2,8 +2,17 @@
 
 #include <labgraph/bindings.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "BorrowedSamples.h"
+#include "FusedChain.h"
+#include "LineageBenchmark.h"
+#include "MultiPublishBenchmark.h"
 #include "MyCPPSink.h"
 #include "MyCPPSource.h"
+#include "ProcessingStamps.h"
+#include "RegistrationContext.h"
+#include "SubAlignerLineage.h"
+#include "TraceRecorder.h"
 
 namespace py = pybind11;
 
@@ -18,4 +27,132 @@ PYBIND11_MODULE(MyCPPNodes, m) {
   std::vector<std::string> sinkTopics = {"B"};
   labgraph::bindNode<MyCPPSink>(m, "MyCPPSink", sinkTopics)
       .def(py::init<const std::string&>(), py::arg("filename"));
+
+  py::class_<MultiStreamAllocations>(m, "MultiStreamAllocations")
+      .def_readonly("multi_publish", &MultiStreamAllocations::multiPublish)
+      .def_readonly("subscriber_callback", &MultiStreamAllocations::subscriberCallback)
+      .def_readonly("transformer_callback", &MultiStreamAllocations::transformerCallback)
+      .def_readonly("transformer_output", &MultiStreamAllocations::transformerOutput);
+  m.def(
+      "count_multi_stream_allocations",
+      &countMultiStreamAllocations,
+      py::arg("num_warmups"),
+      py::arg("num_calls"),
+      py::call_guard<py::gil_scoped_release>());
+  py::class_<DeliveredValue>(m, "DeliveredValue")
+      .def_readonly("thread", &DeliveredValue::thread)
+      .def_readonly("value", &DeliveredValue::value);
+  m.def(
+      "multi_publish_concurrently",
+      &multiPublishConcurrently,
+      py::arg("num_threads"),
+      py::arg("num_publishes"),
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "multi_publish_nested",
+      &multiPublishNested,
+      py::arg("num_publishes"),
+      py::call_guard<py::gil_scoped_release>());
+
+  py::class_<FusedChainValues>(m, "FusedChainValues")
+      .def_readonly("intermediate", &FusedChainValues::intermediate)
+      .def_readonly("output", &FusedChainValues::output)
+      .def_readonly("intermediate_buffers", &FusedChainValues::intermediateBuffers);
+  m.def(
+      "run_fused_chain",
+      &runFusedChain,
+      py::arg("prefix"),
+      py::arg("values"),
+      py::arg("observe_intermediate"),
+      py::call_guard<py::gil_scoped_release>());
+
+  py::enum_<ReceiveMode>(m, "ReceiveMode")
+      .value("GENERIC", ReceiveMode::GENERIC)
+      .value("SUBSCRIBE_OWNED", ReceiveMode::SUBSCRIBE_OWNED)
+      .value("SUBSCRIBE_VIEW", ReceiveMode::SUBSCRIBE_VIEW)
+      .value("TRANSFORM_OWNED", ReceiveMode::TRANSFORM_OWNED)
+      .value("TRANSFORM_VIEW", ReceiveMode::TRANSFORM_VIEW);
+  py::class_<ReceivedUseCounts>(m, "ReceivedUseCounts")
+      .def_readonly("metadata", &ReceivedUseCounts::metadata)
+      .def_readonly("parameters", &ReceivedUseCounts::parameters)
+      .def_readonly("payload", &ReceivedUseCounts::payload);
+  m.def(
+      "measure_received_use_counts",
+      &measureReceivedUseCounts,
+      py::arg("prefix"),
+      py::arg("mode"),
+      py::call_guard<py::gil_scoped_release>());
+
+  py::class_<LineageRecordTimes>(m, "LineageRecordTimes")
+      .def_readonly("record", &LineageRecordTimes::record)
+      .def_readonly("record_resizing", &LineageRecordTimes::recordResizing)
+      .def_readonly("max_size", &LineageRecordTimes::maxSize);
+  m.def(
+      "benchmark_lineage_record",
+      &benchmarkLineageRecord,
+      py::arg("num_records"),
+      py::arg("capacity"),
+      py::call_guard<py::gil_scoped_release>());
+
+  py::enum_<cthulhu::LineagePolicy>(m, "LineagePolicy")
+      .value("OFF", cthulhu::LineagePolicy::OFF)
+      .value("SAMPLED", cthulhu::LineagePolicy::SAMPLED)
+      .value("FULL", cthulhu::LineagePolicy::FULL);
+  py::class_<AlignedLineage>(m, "AlignedLineage")
+      .def_readonly("stream_index", &AlignedLineage::streamIndex)
+      .def_readonly("sequence_number", &AlignedLineage::sequenceNumber)
+      .def_readonly("inputs", &AlignedLineage::inputs)
+      .def_readonly("lineage", &AlignedLineage::lineage);
+  m.def(
+      "align_with_lineage",
+      &alignWithLineage,
+      py::arg("prefix"),
+      py::arg("policy"),
+      py::arg("sample_interval"),
+      py::arg("num_samples"),
+      py::call_guard<py::gil_scoped_release>());
+  py::enum_<LineageMode>(m, "LineageMode")
+      .value("HISTORY", LineageMode::HISTORY)
+      .value("OFF", LineageMode::OFF)
+      .value("SAMPLED", LineageMode::SAMPLED)
+      .value("FULL", LineageMode::FULL);
+  py::class_<SubAlignerLineageCost>(m, "SubAlignerLineageCost")
+      .def_readonly("time_per_sample", &SubAlignerLineageCost::timePerSample)
+      .def_readonly("allocations_per_output", &SubAlignerLineageCost::allocationsPerOutput)
+      .def_readonly("num_outputs", &SubAlignerLineageCost::numOutputs)
+      .def_readonly("retained_inputs", &SubAlignerLineageCost::retainedInputs)
+      .def_readonly("lineage_entries", &SubAlignerLineageCost::lineageEntries);
+  m.def(
+      "benchmark_subaligner_lineage",
+      &benchmarkSubAlignerLineage,
+      py::arg("prefix"),
+      py::arg("mode"),
+      py::arg("num_samples"),
+      py::arg("num_retained"),
+      py::call_guard<py::gil_scoped_release>());
+
+  m.def("read_arrival_stamps", &readArrivalStamps, py::arg("stamps"));
+
+  py::class_<cthulhu::CollectedTraceEvent>(m, "CollectedTraceEvent")
+      .def_readonly("slot", &cthulhu::CollectedTraceEvent::slot)
+      .def_readonly("tid", &cthulhu::CollectedTraceEvent::tid)
+      .def_readonly("sequence_number", &cthulhu::CollectedTraceEvent::sequenceNumber)
+      .def_readonly("stream_id", &cthulhu::CollectedTraceEvent::streamID);
+  m.def(
+      "record_trace_events",
+      &recordTraceEvents,
+      py::arg("prefix"),
+      py::arg("num_threads"),
+      py::arg("num_events"),
+      py::arg("concurrently"),
+      py::call_guard<py::gil_scoped_release>());
+  m.def("collect_trace_events", &collectTraceEvents);
+  m.def("num_trace_rings", &cthulhu::Tracer::numRings);
+  m.def("remove_trace_rings", &cthulhu::Tracer::removeRings);
+
+  py::class_<RegistrationContext>(m, "RegistrationContext")
+      .def(py::init<const std::string&>(), py::arg("name"))
+      .def("subscribe", &RegistrationContext::subscribe, py::arg("id"))
+      .def("advertise", &RegistrationContext::advertise, py::arg("id"))
+      .def("transform", &RegistrationContext::transform, py::arg("input"), py::arg("output"));
 }
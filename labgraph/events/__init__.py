@@ -9,6 +9,7 @@ __all__ = [
     "BaseEventGeneratorNode",
     "EventPublishingHeap",
     "EventPublishingHeapEntry",
+    "NativeEventGeneratorNode",
     "WaitBeginMessage",
     "WaitEndMessage",
     "TerminationMessage",
@@ -23,4 +24,5 @@ from .event_generator import (
     EventPublishingHeapEntry,
 )
 from .event_generator_node import BaseEventGeneratorNode
+from .native_event_generator_node import NativeEventGeneratorNode
 from .event_messages import WaitBeginMessage, WaitEndMessage, TerminationMessage
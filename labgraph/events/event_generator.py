@@ -26,12 +26,22 @@ class DeferredMessage:
         self._kwargs = kwargs
         self._message: Optional[Message] = None
 
-    def build_message(self) -> Message:
+    def build_message(self, timestamp: Optional[float] = None) -> Message:
+        """
+        Builds the message, if it wasn't built already.
+
+        Args:
+            timestamp:
+                The timestamp of a `TimestampedMessage`, for a message built ahead of
+                the time it is published at. Defaults to the current time.
+        """
         if not self._message:
             if issubclass(self._message_type, TimestampedMessage):
                 # TimestampedMessage has timestamp as the first field/argument
                 # - Add timestamp at the front of args to satisfy this
-                self._args = (time.time(),) + self._args
+                if timestamp is None:
+                    timestamp = time.time()
+                self._args = (timestamp,) + self._args
             self._message = self._message_type(*self._args, **self._kwargs)
             del self._args
             del self._kwargs
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import asyncio
+import time
+from typing import Dict, List, Optional, Tuple
+
+from .._cthulhu.bindings import (  # type: ignore
+    clockManager,
+    EventScheduler,
+    EventSchedulerOptions,
+    LatenessHistogram,
+    StreamInterface,
+    StreamSample,
+)
+from ..graphs.method import AsyncPublisher
+from ..util.error import LabGraphError
+from .event_generator_node import (
+    BaseEventGeneratorNode,
+    CHECK_FOR_WAIT_COMPLETION_DELAY,
+)
+
+
+SCHEDULE_LEAD_TIME = 0.01
+
+ScheduleEntry = Tuple[float, StreamInterface, StreamSample]
+"""
+An entry of the schedule of a NativeEventGeneratorNode, composed as (offset, stream,
+sample), where offset is in seconds after the start of the schedule.
+"""
+
+
+class NativeEventGeneratorNode(BaseEventGeneratorNode):
+    """
+    An event generator node whose events are published from C++ by a Cthulhu
+    `EventScheduler`, each at its deadline against the Cthulhu clock, rather than from
+    the event loop. The messages of all events are built ahead of time, with the
+    deadline of their event as the timestamp of `TimestampedMessage`s.
+
+    Like for other event generator nodes, subclasses define `publish_events`, and
+    delegate it to this class:
+
+        async def publish_events(self) -> AsyncPublisher:
+            async for topic_message in super().publish_events():
+                yield topic_message
+
+    Once all events are published, `lateness` holds a histogram of how late they were
+    published after their deadlines, and `topic_lateness` one per topic name.
+    """
+
+    def __init__(self) -> None:
+        super(NativeEventGeneratorNode, self).__init__()
+        self._stream_interfaces: Optional[Dict[str, StreamInterface]] = None
+        self.lateness: Optional[LatenessHistogram] = None
+        self.topic_lateness: Dict[str, LatenessHistogram] = {}
+
+    def scheduler_options(self) -> EventSchedulerOptions:
+        """
+        Returns the options of the `EventScheduler` that publishes the events. Can be
+        overridden to tune how the scheduler waits for deadlines.
+        """
+        return EventSchedulerOptions()
+
+    def _bootstrap_streams(self, stream_interfaces: Dict[str, StreamInterface]) -> None:
+        """
+        Called by the runner with the Cthulhu streams the events are published on, by
+        topic name. The runner leaves producing on these streams to the node.
+        """
+        self._stream_interfaces = stream_interfaces
+
+    def _build_schedule(self, start_time: float) -> List[ScheduleEntry]:
+        """
+        Builds the messages of the events returned from `generate_events`, for a
+        schedule starting at `start_time` on the Cthulhu clock.
+        """
+        if self._stream_interfaces is None:
+            raise LabGraphError(
+                f"{type(self).__name__} was not given its streams - it must be run by "
+                "a LabGraph runner"
+            )
+        schedule: List[ScheduleEntry] = []
+        heap = self.generate_events()
+        while len(heap) > 0:
+            offset, _, event = heap.pop()
+            stream_interface = self._stream_interfaces.get(event.topic.name)
+            if stream_interface is None:
+                raise LabGraphError(
+                    f"Event published to topic '{event.topic.name}', which "
+                    f"{type(self).__name__} doesn't publish"
+                )
+            message = event._message.build_message(timestamp=start_time + offset)
+            schedule.append((offset, stream_interface, message.__sample__))
+        return schedule
+
+    async def publish_events(self) -> AsyncPublisher:
+        """
+        Publishes the events returned from `generate_events` from C++, and waits for
+        all of them to be published.
+        """
+        # Without a clock authority the scheduler runs on the wall time
+        clock = clockManager().clock()
+        start_time = SCHEDULE_LEAD_TIME + (
+            clock.getTime() if clock is not None else time.time()
+        )
+        scheduler = EventScheduler(
+            self._build_schedule(start_time), self.scheduler_options()
+        )
+        try:
+            scheduler.start(start_time)
+            while not scheduler.finished:
+                await asyncio.sleep(CHECK_FOR_WAIT_COMPLETION_DELAY)
+            self.lateness = scheduler.lateness()
+            self.topic_lateness = {
+                topic_name: scheduler.lateness(stream_interface.description.id)
+                for topic_name, stream_interface in self._stream_interfaces.items()
+            }
+        finally:
+            scheduler.close()
+        return
+        yield  # Makes this an async generator, like other publishers
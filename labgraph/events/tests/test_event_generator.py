@@ -76,6 +76,17 @@ def test_deferred_message_build_timestamped(mocker: Any) -> None:
     assert built == expected
 
 
+def test_deferred_message_build_timestamped_ahead(mocker: Any) -> None:
+    message = DeferredMessage(
+        MyTimestampedMessage, "unittest_args", kwargs_field="unittest_kwargs"
+    )
+    built = message.build_message(timestamp=5.0)
+    expected = MyTimestampedMessage(
+        5.0, "unittest_args", kwargs_field="unittest_kwargs"
+    )
+    assert built == expected
+
+
 def test_event_init(mocker: Any) -> None:
     message = DeferredMessage(
         MyMessage, "unittest_args", kwargs_field="unittest_kwargs"
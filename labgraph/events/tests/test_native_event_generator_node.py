@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import asyncio
+import time
+from typing import List, Tuple
+
+import pytest
+
+from ..._cthulhu.bindings import clockManager  # type: ignore
+from ..._cthulhu.clock import ClockController
+from ...graphs import AsyncPublisher, Connections, Graph, Node, subscriber, Topic
+from ...graphs.method import get_method_metadata
+from ...messages import Message, TimestampedMessage
+from ...runners import LocalRunner, NormalTermination
+from ...util.error import LabGraphError
+from ...util.testing import local_test
+from .. import (
+    BaseEventGenerator,
+    DeferredMessage,
+    Event,
+    EventGraph,
+    EventPublishingHeap,
+    NativeEventGeneratorNode,
+)
+
+
+START_TIME = 100.0
+NUM_EVENTS = 3
+# How late an event may arrive at a subscriber in the same process
+MAX_LATENESS = 0.05
+RECEIVE_TIMEOUT = 5.0
+
+# The (arrival time, field, timestamp) of the messages received by MySink, shared with
+# the generator node so that it can wait for them before terminating the graph
+received: List[Tuple[float, str, float]] = []
+
+
+class MyMessage(Message):
+    my_field: str
+
+
+class MyTimestampedMessage(TimestampedMessage):
+    my_field: str
+
+
+class MyEventGenerator(BaseEventGenerator):
+    def __init__(self, graph: EventGraph) -> None:
+        self.graph = graph
+
+    def generate_events(self) -> EventPublishingHeap:
+        return self.graph.heap
+
+    def set_topics(self) -> None:
+        pass
+
+
+class MyNativeEventGeneratorNode(NativeEventGeneratorNode):
+    MY_TOPIC = Topic(MyMessage)
+    MY_TIMESTAMPED_TOPIC = Topic(MyTimestampedMessage)
+
+    async def publish_events(self) -> AsyncPublisher:
+        async for topic_message in super().publish_events():
+            yield topic_message
+
+
+def make_node() -> MyNativeEventGeneratorNode:
+    node = MyNativeEventGeneratorNode()
+    start = Event(
+        DeferredMessage(MyTimestampedMessage, "start"),
+        node.MY_TIMESTAMPED_TOPIC,
+        0.0,
+        1.0,
+    )
+    graph = EventGraph(start)
+    graph.add_event_at_end(
+        Event(DeferredMessage(MyMessage, "end"), node.MY_TOPIC, 0.5), start
+    )
+    graph.add_event_at_start(
+        Event(DeferredMessage(MyMessage, "middle"), node.MY_TOPIC, 0.25), start
+    )
+    node.setup_generator(MyEventGenerator(graph))
+    return node
+
+
+def test_native_event_generator_node_meta() -> None:
+    node = MyNativeEventGeneratorNode()
+    publisher_metadata = get_method_metadata(node.publish_events)
+    topic_names = {topic.name for topic in publisher_metadata.published_topics}
+    assert topic_names == {node.MY_TOPIC.name, node.MY_TIMESTAMPED_TOPIC.name}
+
+
+def test_native_event_generator_node_schedule() -> None:
+    """
+    Tests that the schedule has the events in the order of their deadlines, on the
+    streams of their topics, with their deadlines as timestamps.
+    """
+    node = make_node()
+    node._bootstrap_streams(
+        {node.MY_TOPIC.name: "stream", node.MY_TIMESTAMPED_TOPIC.name: "timestamped"}
+    )
+    schedule = node._build_schedule(START_TIME)
+    assert [(offset, stream) for offset, stream, _ in schedule] == [
+        (0.0, "timestamped"),
+        (0.25, "stream"),
+        (1.5, "stream"),
+    ]
+    first = MyTimestampedMessage(__sample__=schedule[0][2])
+    assert first.timestamp == START_TIME
+    assert first.my_field == "start"
+    assert MyMessage(__sample__=schedule[2][2]).my_field == "end"
+
+
+def test_native_event_generator_node_unpublished_topic() -> None:
+    node = make_node()
+    node._bootstrap_streams({node.MY_TIMESTAMPED_TOPIC.name: "timestamped"})
+    with pytest.raises(LabGraphError):
+        _ = node._build_schedule(START_TIME)
+
+
+def test_native_event_generator_node_not_bootstrapped() -> None:
+    node = make_node()
+    with pytest.raises(LabGraphError):
+        _ = node._build_schedule(START_TIME)
+
+
+class MyTerminatingNativeEventGeneratorNode(MyNativeEventGeneratorNode):
+    async def publish_events(self) -> AsyncPublisher:
+        async for topic_message in super().publish_events():
+            yield topic_message
+        # Every event was published, so it is only left to deliver them
+        deadline = time.time() + RECEIVE_TIMEOUT
+        while len(received) < NUM_EVENTS and time.time() < deadline:
+            await asyncio.sleep(0.01)
+        raise NormalTermination()
+
+
+class MySink(Node):
+    INPUT = Topic(MyMessage)
+    TIMESTAMPED_INPUT = Topic(MyTimestampedMessage)
+
+    @subscriber(INPUT)
+    def sink(self, message: MyMessage) -> None:
+        received.append((time.time(), message.my_field, 0.0))
+
+    @subscriber(TIMESTAMPED_INPUT)
+    def sink_timestamped(self, message: MyTimestampedMessage) -> None:
+        received.append((time.time(), message.my_field, message.timestamp))
+
+
+class MyEventGraph(Graph):
+    GENERATOR: MyTerminatingNativeEventGeneratorNode
+    SINK: MySink
+
+    def setup(self) -> None:
+        start = Event(
+            DeferredMessage(MyTimestampedMessage, "start"),
+            self.GENERATOR.MY_TIMESTAMPED_TOPIC,
+            0.0,
+            0.2,
+        )
+        graph = EventGraph(start)
+        graph.add_event_at_end(
+            Event(DeferredMessage(MyMessage, "end"), self.GENERATOR.MY_TOPIC, 0.1),
+            start,
+        )
+        graph.add_event_at_start(
+            Event(DeferredMessage(MyMessage, "middle"), self.GENERATOR.MY_TOPIC, 0.1),
+            start,
+        )
+        self.GENERATOR.setup_generator(MyEventGenerator(graph))
+
+    def connections(self) -> Connections:
+        return (
+            (self.GENERATOR.MY_TOPIC, self.SINK.INPUT),
+            (self.GENERATOR.MY_TIMESTAMPED_TOPIC, self.SINK.TIMESTAMPED_INPUT),
+        )
+
+
+@local_test
+def test_native_event_generator_node_run() -> None:
+    """
+    Tests that a native event generator node run by LocalRunner publishes its events
+    from C++ in the order of their deadlines, each on time, and records how late they
+    were.
+    """
+    received.clear()
+    # The scheduler runs on the clock authority's clock when there is one. A test that
+    # ran before in this process may have left one paused or running faster than the
+    # wall time, so run it at the wall time for the arrival times to be comparable.
+    if clockManager().clock() is not None:
+        controller = ClockController()
+        controller.set_realtime_factor(1.0)
+        controller.start(time.time())
+    graph = MyEventGraph()
+    LocalRunner(module=graph).run()
+
+    assert [field for _, field, _ in received] == ["start", "middle", "end"]
+    # The events are published at their deadlines after the first one, which is the
+    # timestamp of the timestamped message
+    (start_time, _, timestamp), (middle_time, _, _), (end_time, _, _) = received
+    assert start_time - timestamp == pytest.approx(0.0, abs=MAX_LATENESS)
+    assert middle_time - start_time == pytest.approx(0.1, abs=MAX_LATENESS)
+    assert end_time - start_time == pytest.approx(0.3, abs=MAX_LATENESS)
+
+    generator = graph.GENERATOR
+    assert generator.lateness is not None
+    assert generator.lateness.events == NUM_EVENTS
+    assert 0.0 <= generator.lateness.max_lateness < MAX_LATENESS
+    assert generator.topic_lateness[generator.MY_TOPIC.name].events == 2
+    assert generator.topic_lateness[generator.MY_TIMESTAMPED_TOPIC.name].events == 1
@@ -69,7 +69,7 @@ class Logger(Node):
             assert (
                 stream_interface is not None
             ), f"Expected stream '{stream.id}' to be created"
-            self.consumers[stream.id] = Consumer(
+            self.consumers[logging_id] = Consumer(
                 stream_interface=stream_interface,
                 sample_callback=callback,
                 mode=Mode.SYNC,
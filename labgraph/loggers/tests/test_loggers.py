@@ -144,3 +144,45 @@ async def _write_messages(
         await asyncio.sleep(1.0 / MESSAGE_RATE)
 
     logger.running = False
+
+
+@local_test
+def test_logger_shared_stream() -> None:
+    """
+    Test that every logging id of a stream receives its messages when several topics
+    logged under different ids share that stream.
+    """
+    logging_ids = (random_string(16), random_string(16))
+    stream_id = random_string(16)
+    streams_by_logging_id = {
+        logging_id: Stream(
+            id=stream_id,
+            topic_paths=("MY_NODE/A", "MY_OTHER_NODE/B"),
+            message_type=MyMessage1,
+        )
+        for logging_id in logging_ids
+    }
+    stream_interface = register_stream(name=stream_id, message_type=MyMessage1)
+    producer = Producer(stream_interface=stream_interface, mode=Mode.SYNC)
+    producers_and_messages: List[Tuple[Producer, Message]] = [
+        (producer, MyMessage1(int_field=i)) for i in range(NUM_MESSAGES_PER_STREAM)
+    ]
+
+    config = LoggerConfig(streams_by_logging_id=streams_by_logging_id)
+    logger = NaiveLogger()
+    logger.configure(config)
+    logger.setup()
+
+    loop = get_event_loop()
+    loop.run_until_complete(
+        asyncio.gather(
+            logger.run_logger(), _write_messages(logger, producers_and_messages)
+        )
+    )
+
+    logger.cleanup()
+    producer.close()
+
+    for logging_id in logging_ids:
+        actual_int_values = [message.int_field for message in logger.output[logging_id]]
+        assert sorted(actual_int_values) == list(range(NUM_MESSAGES_PER_STREAM))
@@ -7,10 +7,14 @@ import dataclasses
 import hashlib
 import logging
 import struct
+import threading
 from collections import OrderedDict
 from typing import Any, Dict, Generic, Optional, Tuple, Type, TypeVar, Union
 
+import numpy as np
+
 from .._cthulhu.bindings import (
+    anonymousStreamHandle,
     Field as CthulhuField,
     memoryPool,
     StreamSample,
@@ -18,7 +22,16 @@ from .._cthulhu.bindings import (
     typeRegistry,
 )
 from ..util.error import LabGraphError
-from .types import DEFAULT_BYTE_ORDER, FieldType, StructType, get_field_type
+from .types import (
+    BytesDynamicType,
+    DEFAULT_BYTE_ORDER,
+    FieldType,
+    get_field_type,
+    NumpyDynamicType,
+    NumpyType,
+    StrDynamicType,
+    StructType,
+)
 
 
 logger = logging.getLogger(__name__)
@@ -29,10 +42,33 @@ T = TypeVar("T")
 # serializing the message for streaming
 LOCAL_INTERNAL_FIELDS = (
     "__sample__",
+    "__field_values__",
     "__original_message__",
     "__original_message_type__",
 )
 
+# The memory pool handle of buffers that don't belong to a stream, resolved once rather
+# than for every allocation
+ANONYMOUS_STREAM_HANDLE = anonymousStreamHandle()
+
+
+# Whether messages constructed from field values keep them and only serialize them to
+# shared memory once their sample is needed. Set by `LocalRunner` while it runs with
+# `RunnerOptions.local_passthrough`, since only passed-through messages never need it.
+_defer_serialization = False
+
+# Serializes building the samples of messages constructed while deferring
+_build_sample_lock = threading.Lock()
+
+
+def set_deferred_serialization(enabled: bool) -> None:
+    """
+    Sets whether messages constructed from field values from now on defer serializing
+    them to shared memory until their sample is needed.
+    """
+    global _defer_serialization
+    _defer_serialization = enabled
+
 
 class Field(Generic[T]):
     """
@@ -267,7 +303,11 @@ class Message(metaclass=MessageMeta):
     dataclasses in the builtin `dataclasses` module.
 
     Messages' data are stored in shared memory via Cthulhu, meaning the transmission of
-    messages between nodes requires no copying of data.
+    messages between nodes requires no copying of data. While a runner passes messages
+    to subscribers in the same process as is (`RunnerOptions.local_passthrough`), a
+    message constructed from field values keeps a copy of them instead, and only
+    serializes them to shared memory once its sample is needed, e.g., when it is
+    produced to a stream.
     """
 
     # If __original_message_type__ is set, then we cache an instance of that class for
@@ -275,14 +315,20 @@ class Message(metaclass=MessageMeta):
     __original_message__: Optional[Union["Message", IsOriginalMessage]]
 
     # Cthulhu sample that backs this message - the Cthulhu sample manages this message's
-    # shared memory
+    # shared memory. None until it is first needed if the message deferred serializing
+    # its field values.
     __sample__: StreamSample
 
+    # The field values of a message that deferred serializing them, as reading them from
+    # its sample would return them
+    __field_values__: Optional[Dict[str, Any]]
+
     __original_message_type__: Optional[Type["Message"]]
 
     def __init__(self, *args: Any, **kwargs: Any) -> None:
         super().__setattr__("__original_message__", None)
         super().__setattr__("__original_message_type__", None)
+        super().__setattr__("__field_values__", None)
         if 1 <= len(kwargs) <= 2 and "__sample__" in kwargs.keys():
             # Option to create a message directly from Cthulhu sample
             # Bypasses frozen check due to `frozen=True` by calling `__setattr__` on
@@ -345,11 +391,34 @@ class Message(metaclass=MessageMeta):
                     f"{field.data_type.description})"
                 )
 
+        if _defer_serialization:
+            # Bypasses frozen check due to `frozen=True` by calling `__setattr__` on
+            # `object`
+            super().__setattr__(
+                "__field_values__",
+                {
+                    field.name: _copy_field_value(field, values[field.name])
+                    for field in cls.__message_fields__.values()
+                },
+            )
+            super().__setattr__("__sample__", None)
+        else:
+            self._build_sample(values)
+
+    def _build_sample(self, values: Dict[str, Any]) -> StreamSample:
+        """
+        Serializes field values to a Cthulhu sample in shared memory, and sets it as the
+        message's sample.
+        """
+        cls = type(self)
+
         # Allocate shared memory for a Cthulhu sample
         sample = StreamSample()
 
         if cls.__message_size__ > 0:
-            sample.parameters = memoryPool().getBufferFromPool("", cls.__message_size__)
+            sample.parameters = memoryPool().getBufferFromPool(
+                ANONYMOUS_STREAM_HANDLE, cls.__message_size__
+            )
 
             # Preprocess the fixed-length field values and put them in the correct sequence
             # for serialization
@@ -377,7 +446,7 @@ class Message(metaclass=MessageMeta):
 
             # Allocate shared memory for the dynamic-length field values
             dynamic_buffers = [
-                memoryPool().getBufferFromPool("", len(value))
+                memoryPool().getBufferFromPool(ANONYMOUS_STREAM_HANDLE, len(value))
                 for value in dynamic_values
             ]
 
@@ -392,6 +461,7 @@ class Message(metaclass=MessageMeta):
         # Bypasses frozen check due to `frozen=True` by calling `__setattr__` on
         # `object`
         super().__setattr__("__sample__", sample)
+        return sample
 
     def asdict(self) -> "OrderedDict[str, Any]":
         """
@@ -438,7 +508,21 @@ class Message(metaclass=MessageMeta):
     def __getattribute__(self, name: str) -> Any:
         all_fields = super().__getattribute__("__class__").__message_fields__
         if name not in all_fields:
-            return super().__getattribute__(name)
+            value = super().__getattribute__(name)
+            if value is None and name == "__sample__":
+                with _build_sample_lock:
+                    value = super().__getattribute__(name)
+                    if value is None:
+                        value = self._build_sample(
+                            super().__getattribute__("__field_values__")
+                        )
+            return value
+
+        # Use the field values if the message deferred serializing them
+        field_values = super().__getattribute__("__field_values__")
+        if field_values is not None:
+            return field_values[name]
+
         cls = type(self)
         field = all_fields[name]
 
@@ -491,6 +575,32 @@ class Message(metaclass=MessageMeta):
         return self.asdict() == other.asdict()
 
 
+def _copy_field_value(field: Field[T], value: T) -> T:
+    """
+    Returns a copy of a field value that reads as reading it from a message's sample
+    would, without serializing it. Arrays are copied as is, and immutable values are
+    kept; other values go through the field type's serialization.
+    """
+    if isinstance(field.data_type, (NumpyType, NumpyDynamicType)):
+        assert isinstance(value, np.ndarray)
+        return value.astype(field.data_type.dtype)  # type: ignore
+    if isinstance(field.data_type, StrDynamicType):
+        return value
+    if isinstance(field.data_type, BytesDynamicType):
+        return bytes(value)  # type: ignore
+    if field.data_type.size is None:
+        return field.data_type.postprocess(
+            bytearray(field.data_type.preprocess(value))
+        )
+    assert isinstance(field.data_type, StructType)
+    format_string = DEFAULT_BYTE_ORDER.value + field.data_type.format_string
+    return field.data_type.postprocess(
+        struct.unpack(
+            format_string, struct.pack(format_string, field.data_type.preprocess(value))
+        )[0]
+    )
+
+
 class TimestampedMessage(Message):
     """
     Represents a simple timestamped LabGraph message.  All messages which
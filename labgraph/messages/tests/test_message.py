@@ -3,17 +3,19 @@
 
 # Unit tests for the Message class.
 
+import threading
 from enum import Enum
 from typing import Any, Dict, List
 
 import numpy as np
 import pytest
 
-from ..message import Message
+from ..message import Message, set_deferred_serialization
 from ..types import NumpyDynamicType, NumpyType
 
 
 NUMPY_SHAPE = (10, 10)
+NUM_THREADS = 8
 
 
 class MyStrEnum(str, Enum):
@@ -404,6 +406,121 @@ def test_dynamic_numpy_field_with_invalid_type() -> None:
         MyDynamicNumpyIntMessage(field1="hello", field2=np.random.rand(3, 3), field3=5)
 
 
+def test_sample_built_on_construction() -> None:
+    """
+    Tests that a message constructed from field values serializes them right away by
+    default, so later changes to the values don't reach the message.
+    """
+    values = {"a": 1}
+    message = MyDynamicMessage(field1=values, field2=5, field3=[1, 2])
+    assert object.__getattribute__(message, "__sample__") is not None
+
+    values["a"] = 2
+    assert message.field1 == {"a": 1}
+    assert message.field1 is not message.field1
+
+
+def test_sample_built_on_demand() -> None:
+    """
+    Tests that a message constructed while deferring serialization only serializes its
+    field values when its sample is needed, and reads them as a message read from the
+    sample would.
+    """
+    set_deferred_serialization(True)
+    try:
+        array = np.random.rand(3, 3)
+        message = MyDynamicNumpyMessage(field1="hello", field2=array, field3=5)
+        bytes_message = MyMessage(
+            int_field=5,
+            str_field="hello",
+            float_field=5.0,
+            bool_field=True,
+            bytes_field=b"world\0",
+        )
+    finally:
+        set_deferred_serialization(False)
+    eager_bytes_message = MyMessage(
+        int_field=5,
+        str_field="hello",
+        float_field=5.0,
+        bool_field=True,
+        bytes_field=b"world\0",
+    )
+
+    assert object.__getattribute__(message, "__sample__") is None
+    assert message.field2 is not array
+    assert (message.field2 == array).all()
+    array[0, 0] = -1
+    assert message.field2[0, 0] != -1
+    assert bytes_message.bytes_field == eager_bytes_message.bytes_field
+
+    sample = message.__sample__
+    assert sample is not None
+    assert message.__sample__ is sample
+
+    received = MyDynamicNumpyMessage(__sample__=sample)
+    assert received.field1 == "hello"
+    assert (received.field2 == message.field2).all()
+    assert received.field3 == 5
+
+
+def test_deferred_values_not_serialized(monkeypatch: pytest.MonkeyPatch) -> None:
+    """
+    Tests that a message constructed while deferring serialization copies its arrays
+    without serializing them, and only serializes them once its sample is needed.
+    """
+    serialized = []
+
+    def preprocess(self: NumpyDynamicType, obj: np.ndarray) -> bytes:
+        serialized.append(obj)
+        return original_preprocess(self, obj)
+
+    original_preprocess = NumpyDynamicType.preprocess
+    monkeypatch.setattr(NumpyDynamicType, "preprocess", preprocess)
+    set_deferred_serialization(True)
+    try:
+        array = np.random.rand(*NUMPY_SHAPE)
+        message = MyDynamicNumpyMessage(field1="hello", field2=array, field3=5)
+        static_message = MyNumpyMessage(field1="hello", field2=array, field3=5)
+    finally:
+        set_deferred_serialization(False)
+
+    assert serialized == []
+    assert message.field2 is not array
+    assert (message.field2 == array).all()
+    assert static_message.field2 is not array
+    assert (static_message.field2 == array).all()
+
+    received = MyDynamicNumpyMessage(__sample__=message.__sample__)
+    assert len(serialized) == 1
+    assert (received.field2 == array).all()
+
+
+def test_sample_built_on_demand_once() -> None:
+    """
+    Tests that threads racing to read the sample of a message that deferred
+    serialization all get the same sample.
+    """
+    set_deferred_serialization(True)
+    try:
+        message = MyDynamicNumpyMessage(
+            field1="hello", field2=np.random.rand(100, 100), field3=5
+        )
+    finally:
+        set_deferred_serialization(False)
+
+    samples = []
+    threads = [
+        threading.Thread(target=lambda: samples.append(message.__sample__))
+        for _ in range(NUM_THREADS)
+    ]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert all(sample is samples[0] for sample in samples)
+
+
 def test_static_to_dynamic_conversion() -> None:
     """
     Tests that we can convert a static field to a dynamic field between equivalent
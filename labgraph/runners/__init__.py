@@ -4,8 +4,14 @@
 __all__ = [
     "Aligner",
     "BootstrapInfo",
+    "GraphBenchmarkHarness",
     "ParallelRunner",
     "LocalRunner",
+    "LoadSpec",
+    "PlacementPlan",
+    "PlacementProfile",
+    "plan_placement",
+    "ProbeSpec",
     "run",
     "RunnerOptions",
     "TimestampAligner",
@@ -13,7 +19,9 @@ __all__ = [
 ]
 
 from .aligner import Aligner, TimestampAligner
+from .benchmark_harness import GraphBenchmarkHarness, LoadSpec, ProbeSpec
 from .exceptions import NormalTermination
 from .local_runner import LocalRunner
 from .parallel_runner import ParallelRunner, run
+from .placement import PlacementPlan, PlacementProfile, plan_placement
 from .runner import BootstrapInfo, RunnerOptions
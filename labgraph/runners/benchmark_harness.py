@@ -0,0 +1,505 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import asyncio
+import json
+import math
+import tempfile
+import time
+import types
+from dataclasses import asdict, dataclass, field
+from pathlib import Path
+from typing import Any, Dict, Generic, List, Optional, Sequence, Type, TypeVar, Union
+
+from labgraph_cpp import LoadGenerator  # type: ignore
+
+from ..graphs.config import Config
+from ..graphs.cpp_node import CPPNodeConfig
+from ..graphs.graph import Graph
+from ..graphs.group import Connections
+from ..graphs.method import background, subscriber
+from ..graphs.module import Module
+from ..graphs.node import Node
+from ..graphs.topic import PATH_DELIMITER, Topic
+from ..messages.message import Message
+from ..util.error import LabGraphError
+from ..util.logger import get_logger
+from .exceptions import NormalTermination
+from .local_runner import LocalRunner
+from .parallel_runner import ParallelRunner
+from .runner import RunnerOptions
+
+
+logger = get_logger(__name__)
+
+M = TypeVar("M", bound=Module)  # Module type
+
+MODULE_NAME = "MODULE"
+LOAD_PREFIX = "LOAD"
+PROBE_PREFIX = "PROBE"
+
+DEFAULT_DURATION = 5.0
+DEFAULT_DRAIN_TIME = 1.0
+DEFAULT_DROP_TOLERANCE = 0.01
+LATENCY_PERCENTILES = (50, 90, 99)
+
+
+@dataclass
+class LoadSpec:
+    """
+    Describes synthetic load published to an input topic of the benchmarked module.
+
+    Args:
+        topic: The path of the topic in the module, e.g., "SOURCE/INPUT".
+        rate: The number of messages to publish per second.
+        dynamic_field_size:
+            The size in bytes of each dynamic-length field of the messages, if their
+            type has any. Fixed-length fields always have their type's size.
+    """
+
+    topic: str
+    rate: float
+    dynamic_field_size: int = 0
+
+
+@dataclass
+class ProbeSpec:
+    """
+    Describes a topic of the benchmarked module to record.
+
+    Args:
+        topic: The path of the topic in the module, e.g., "SINK/OUTPUT".
+        ratio:
+            The number of messages the topic is expected to receive per message
+            published to the loaded topics, e.g., 1.0 for a pipeline that passes
+            every message on. If set, messages missing from the topic count as dropped.
+    """
+
+    topic: str
+    ratio: Optional[float] = None
+
+
+class BenchmarkProbeConfig(Config):
+    output_path: str
+    # If set, the probe terminates the graph once this many seconds have passed
+    stop_after: Optional[float] = None
+
+
+class BenchmarkProbe(Node):
+    """
+    Records the arrival of the messages of a topic, and their latency since the
+    wall-clock time in their sample header. Writes what it recorded to a JSON file
+    when the graph terminates.
+    """
+
+    INPUT = Topic(Message)
+    config: BenchmarkProbeConfig
+
+    def setup(self) -> None:
+        self.num_messages = 0
+        self.latencies: List[float] = []
+
+    @subscriber(INPUT)
+    def record(self, message: Message) -> None:
+        self.num_messages += 1
+        timestamp = message.__sample__.metadata.header.timestamp
+        if timestamp > 0:
+            self.latencies.append(time.time() - timestamp)
+
+    @background
+    async def stop(self) -> None:
+        if self.config.stop_after is not None:
+            await asyncio.sleep(self.config.stop_after)
+            raise NormalTermination()
+
+    def cleanup(self) -> None:
+        with open(self.config.output_path, "w") as output_file:
+            json.dump(
+                {
+                    "num_messages": self.num_messages,
+                    "latencies": self.latencies,
+                },
+                output_file,
+            )
+
+
+@dataclass
+class EdgeResult:
+    """
+    What a probe recorded about a topic of the benchmarked module.
+
+    Args:
+        topic: The path of the topic in the module.
+        num_messages: The number of messages that arrived.
+        throughput: The number of messages per second over the load duration.
+        latency_percentiles:
+            Percentiles of the latency in seconds from publishing to arrival, by
+            percentile. Empty if the messages carried no timestamp.
+        max_latency: The largest latency in seconds, if any was measured.
+        num_expected:
+            For topics receiving synthetic load, the number of messages published. For
+            probes with a ratio, the number of messages the ratio expects.
+    """
+
+    topic: str
+    num_messages: int
+    throughput: float
+    latency_percentiles: Dict[int, float] = field(default_factory=dict)
+    max_latency: Optional[float] = None
+    num_expected: Optional[int] = None
+
+    @property
+    def num_dropped(self) -> int:
+        if self.num_expected is None:
+            return 0
+        return max(self.num_expected - self.num_messages, 0)
+
+
+@dataclass
+class BenchmarkResult:
+    """
+    The result of running the benchmarked module under one load.
+
+    Args:
+        loads: The load published to the module's input topics.
+        edges: The result for each probed topic, by topic path.
+        sustained:
+            Whether the module kept up with the load: no more than the drop tolerance
+            was lost on any topic expecting a number of messages, and the latency
+            stayed within its budget.
+    """
+
+    loads: List[LoadSpec]
+    edges: Dict[str, EdgeResult]
+    sustained: bool
+
+    @property
+    def total_rate(self) -> float:
+        return sum(load.rate for load in self.loads)
+
+
+@dataclass
+class SweepResult:
+    """
+    The results of increasing the load on a module until it stops keeping up.
+
+    Args:
+        results: The result of each run, in the order they ran.
+        max_sustained: The run with the highest load the module kept up with, if any.
+    """
+
+    results: List[BenchmarkResult]
+    max_sustained: Optional[BenchmarkResult]
+
+    @property
+    def max_sustainable_rate(self) -> float:
+        """
+        The total messages per second of the loads the module kept up with, for
+        tracking over time.
+        """
+        return 0.0 if self.max_sustained is None else self.max_sustained.total_rate
+
+    def write(self, path: str) -> None:
+        """
+        Writes the results to a JSON file.
+        """
+        with open(path, "w") as output_file:
+            json.dump(
+                {
+                    "max_sustainable_rate": self.max_sustainable_rate,
+                    "results": [asdict(result) for result in self.results],
+                },
+                output_file,
+                indent=2,
+            )
+
+
+class GraphBenchmarkHarness(Generic[M]):
+    """
+    Utility class for benchmarking a LabGraph module under controlled load, the way
+    `NodeTestHarness` tests a single node. The harness builds a graph around the
+    module, publishing synthetic messages from C++ `LoadGenerator` nodes to its input
+    topics and recording the messages of the probed topics, and runs it with
+    `LocalRunner` or `ParallelRunner`.
+
+    The synthetic messages have the size of the topic's message type, but all their
+    fields are zero, so the benchmarked module must accept such messages. Latency is
+    measured from the wall-clock time messages were first published at, so messages
+    that a node passes on unchanged keep the time of their synthetic origin.
+
+    Args:
+        module_type: The type of module to benchmark, typically a `Group`.
+        config: The configuration to set on the module, if any.
+        probes:
+            The topics to record, as `ProbeSpec`s or paths, e.g., "SINK/OUTPUT". The
+            loaded topics are always recorded. Messages the module drops are only seen
+            by probes downstream of it, so runs need either a ratio for each of these
+            probes or a latency budget to tell whether the module kept up.
+        parallel:
+            If true, runs the module, each load generator and each probe in their own
+            process with `ParallelRunner`; otherwise runs them all in this process.
+    """
+
+    def __init__(
+        self,
+        module_type: Type[M],
+        config: Optional[Config] = None,
+        probes: Sequence[Union[ProbeSpec, str]] = (),
+        parallel: bool = False,
+    ) -> None:
+        self.module_type: Type[M] = module_type
+        self.config = config
+        self.probes = tuple(
+            probe if isinstance(probe, ProbeSpec) else ProbeSpec(topic=probe)
+            for probe in probes
+        )
+        self.parallel = parallel
+
+    def run(
+        self,
+        loads: Sequence[LoadSpec],
+        duration: float = DEFAULT_DURATION,
+        drain_time: float = DEFAULT_DRAIN_TIME,
+        drop_tolerance: float = DEFAULT_DROP_TOLERANCE,
+        latency_budget: Optional[float] = None,
+    ) -> BenchmarkResult:
+        """
+        Runs the module under load, and returns what the probes recorded.
+
+        Args:
+            loads: The load to publish to the module's input topics.
+            duration: The number of seconds to publish the load for.
+            drain_time:
+                The number of seconds to wait after the load for messages in flight.
+            drop_tolerance:
+                The fraction of the messages published to a loaded topic that may be
+                lost while still keeping up.
+            latency_budget:
+                If set, the largest 99th-percentile latency in seconds on any probed
+                topic while still keeping up. Required if a probe of a topic without
+                load has no ratio.
+        """
+        loads = list(loads)
+        probed_topics = [load.topic for load in loads]
+        probes = [probe for probe in self.probes if probe.topic not in probed_topics]
+        probed_topics += [probe.topic for probe in probes]
+        unchecked = [probe.topic for probe in probes if probe.ratio is None]
+        if latency_budget is None and len(unchecked) > 0:
+            raise LabGraphError(
+                f"Cannot tell whether {self.module_type.__name__} keeps up: no ratio "
+                f"was declared for the probes of {', '.join(unchecked)}, and no "
+                "latency budget was set"
+            )
+        with tempfile.TemporaryDirectory() as output_dir:
+            output_paths = [
+                str(Path(output_dir) / f"probe_{index}.json")
+                for index in range(len(probed_topics))
+            ]
+            graph = self._create_graph(
+                loads, probed_topics, output_paths, duration, drain_time
+            )
+            options = RunnerOptions(timestamp_samples=True)
+            if self.parallel:
+                ParallelRunner(graph, options=options).run()
+            else:
+                LocalRunner(module=graph, options=options).run()
+
+            edges = {}
+            for topic, output_path in zip(probed_topics, output_paths):
+                with open(output_path) as output_file:
+                    recorded = json.load(output_file)
+                edges[topic] = self._edge_result(
+                    topic, recorded, loads, probes, duration
+                )
+
+        sustained = all(
+            edge.num_dropped <= drop_tolerance * edge.num_expected
+            for edge in edges.values()
+            if edge.num_expected is not None
+        )
+        if latency_budget is not None:
+            sustained = sustained and all(
+                edge.latency_percentiles.get(99, 0.0) <= latency_budget
+                for edge in edges.values()
+            )
+        return BenchmarkResult(loads=loads, edges=edges, sustained=sustained)
+
+    def sweep(
+        self,
+        loads: Sequence[LoadSpec],
+        growth: float = 2.0,
+        max_runs: int = 10,
+        refine_runs: int = 3,
+        **kwargs: Any,
+    ) -> SweepResult:
+        """
+        Finds the highest load the module keeps up with. Starting from the given loads,
+        multiplies every rate by `growth` until the module stops keeping up, then
+        bisects between the last load it kept up with and the first it didn't.
+
+        Args:
+            loads: The initial load to publish to the module's input topics.
+            growth: The factor to multiply the rates by between runs.
+            max_runs: The largest number of runs before bisecting.
+            refine_runs: The number of bisecting runs.
+            kwargs: Forwarded to `run()`.
+        """
+        results: List[BenchmarkResult] = []
+
+        def run_scaled(scale: float) -> BenchmarkResult:
+            result = self.run(
+                [
+                    LoadSpec(
+                        topic=load.topic,
+                        rate=load.rate * scale,
+                        dynamic_field_size=load.dynamic_field_size,
+                    )
+                    for load in loads
+                ],
+                **kwargs,
+            )
+            logger.info(
+                f"{self.module_type.__name__}: {result.total_rate:.1f} messages/s "
+                + ("sustained" if result.sustained else "not sustained")
+            )
+            results.append(result)
+            return result
+
+        low: Optional[float] = None
+        high: Optional[float] = None
+        scale = 1.0
+        for _ in range(max_runs):
+            if run_scaled(scale).sustained:
+                low = scale
+                scale *= growth
+            else:
+                high = scale
+                break
+
+        if low is not None and high is not None:
+            for _ in range(refine_runs):
+                scale = math.sqrt(low * high)
+                if run_scaled(scale).sustained:
+                    low = scale
+                else:
+                    high = scale
+
+        sustained = [result for result in results if result.sustained]
+        return SweepResult(
+            results=results,
+            max_sustained=max(sustained, key=lambda result: result.total_rate)
+            if len(sustained) > 0
+            else None,
+        )
+
+    def _create_graph(
+        self,
+        loads: Sequence[LoadSpec],
+        probed_topics: Sequence[str],
+        output_paths: Sequence[str],
+        duration: float,
+        drain_time: float,
+    ) -> Graph:
+        module_type = self.module_type
+        module_config = self.config
+        annotations: Dict[str, type] = {MODULE_NAME: module_type}
+        for index in range(len(loads)):
+            annotations[f"{LOAD_PREFIX}{index}"] = LoadGenerator
+        for index in range(len(probed_topics)):
+            annotations[f"{PROBE_PREFIX}{index}"] = BenchmarkProbe
+
+        def module_topic(graph: Graph, topic_path: str) -> Topic:
+            return graph.__topics__[PATH_DELIMITER.join((MODULE_NAME, topic_path))]
+
+        def setup(graph: Graph) -> None:
+            module = getattr(graph, MODULE_NAME)
+            if module_config is not None:
+                module.configure(module_config)
+            for index, load in enumerate(loads):
+                message_type = module_topic(graph, load.topic).message_type
+                getattr(graph, f"{LOAD_PREFIX}{index}").configure(
+                    CPPNodeConfig(
+                        args=[
+                            load.rate,
+                            round(load.rate * duration),
+                            message_type.__message_size__,
+                            [load.dynamic_field_size]
+                            * message_type.__num_dynamic_fields__,
+                        ]
+                    )
+                )
+            for index, output_path in enumerate(output_paths):
+                getattr(graph, f"{PROBE_PREFIX}{index}").configure(
+                    BenchmarkProbeConfig(
+                        output_path=output_path,
+                        # One probe is enough to terminate the graph
+                        stop_after=duration + drain_time if index == 0 else None,
+                    )
+                )
+
+        def connections(graph: Graph) -> Connections:
+            return tuple(
+                (
+                    getattr(graph, f"{LOAD_PREFIX}{index}").OUTPUT,
+                    module_topic(graph, load.topic),
+                )
+                for index, load in enumerate(loads)
+            ) + tuple(
+                (
+                    module_topic(graph, topic),
+                    getattr(graph, f"{PROBE_PREFIX}{index}").INPUT,
+                )
+                for index, topic in enumerate(probed_topics)
+            )
+
+        def process_modules(graph: Graph) -> Sequence[Module]:
+            return tuple(graph.__children__.values())
+
+        graph_type = types.new_class(
+            f"{module_type.__name__}Benchmark",
+            (Graph,),
+            exec_body=lambda namespace: namespace.update(
+                {
+                    "__annotations__": annotations,
+                    "__module__": __name__,
+                    "setup": setup,
+                    "connections": connections,
+                    "process_modules": process_modules,
+                }
+            ),
+        )
+        return graph_type()
+
+    def _edge_result(
+        self,
+        topic: str,
+        recorded: Dict[str, Any],
+        loads: Sequence[LoadSpec],
+        probes: Sequence[ProbeSpec],
+        duration: float,
+    ) -> EdgeResult:
+        latencies = sorted(recorded["latencies"])
+        percentiles = {}
+        if len(latencies) > 0:
+            for percentile in LATENCY_PERCENTILES:
+                index = min(
+                    int(math.ceil(percentile / 100 * len(latencies))) - 1,
+                    len(latencies) - 1,
+                )
+                percentiles[percentile] = latencies[max(index, 0)]
+        num_expected = None
+        for load in loads:
+            if load.topic == topic:
+                num_expected = round(load.rate * duration)
+        for probe in probes:
+            if probe.topic == topic and probe.ratio is not None:
+                num_published = sum(round(load.rate * duration) for load in loads)
+                num_expected = round(probe.ratio * num_published)
+        return EdgeResult(
+            topic=topic,
+            num_messages=recorded["num_messages"],
+            throughput=recorded["num_messages"] / duration,
+            latency_percentiles=percentiles,
+            max_latency=latencies[-1] if len(latencies) > 0 else None,
+            num_expected=num_expected,
+        )
@@ -0,0 +1,330 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import asyncio
+import contextlib
+import functools
+import statistics
+import threading
+import time
+from dataclasses import dataclass
+from typing import Any, ContextManager, List
+
+import numpy as np
+
+from .._cthulhu.bindings import StreamConsumer, StreamInterface  # type: ignore
+from .._cthulhu.cthulhu import Consumer, Mode, Producer, register_stream
+from ..graphs.config import Config
+from ..graphs.graph import Graph
+from ..graphs.group import Connections
+from ..graphs.method import AsyncPublisher, publisher, subscriber
+from ..graphs.node import Node
+from ..graphs.topic import Topic
+from ..messages.message import Message
+from ..util.error import LabGraphError
+from ..util.random import random_string
+from .exceptions import NormalTermination
+from .local_runner import LocalRunner, StreamDispatch
+from .runner import RunnerOptions
+
+
+DEFAULT_NUM_MESSAGES = 10000
+DEFAULT_NUM_ARRAY_MESSAGES = 100
+DEFAULT_ARRAY_SIZE = 1000000
+DEFAULT_PUBLISH_INTERVAL = 0.01
+RECEIVE_TIMEOUT = 10.0
+STREAM_NAME_LENGTH = 32
+
+
+class DispatchBenchmarkMessage(Message):
+    int_field: int
+
+
+@dataclass
+class DispatchBenchmarkResult:
+    """
+    The median latency in seconds from producing a message to user code receiving it
+    on each path a Python subscriber can be reached by.
+
+    Args:
+        num_messages: The number of messages measured on each path.
+        native:
+            Through a bare Cthulhu `StreamConsumer`, which calls Python with the
+            sample. This is the baseline the other paths are compared to.
+        consumer: Through a LabGraph `Consumer`, which also constructs the message.
+        runner:
+            Through a `Consumer` and a `StreamDispatch` onto an event loop thread, like
+            a subscriber run by a `LocalRunner`.
+    """
+
+    num_messages: int
+    native: float
+    consumer: float
+    runner: float
+
+    def report(self) -> str:
+        """
+        Returns a human-readable summary of the latencies and of the overhead of each
+        path over the native one.
+        """
+        lines = [f"Median latency over {self.num_messages} messages:"]
+        for name, latency in (
+            ("native", self.native),
+            ("consumer", self.consumer),
+            ("runner", self.runner),
+        ):
+            overhead = latency - self.native
+            lines.append(
+                f"  {name:<10}{latency * 1e6:10.2f} us  (+{overhead * 1e6:.2f} us)"
+            )
+        return "\n".join(lines)
+
+
+class _Receiver:
+    """
+    Stands in for user code: records when a message arrived and wakes the producing
+    thread.
+    """
+
+    def __init__(self) -> None:
+        self.event = threading.Event()
+        self.received_at = 0.0
+
+    def receive(self, message: DispatchBenchmarkMessage) -> None:
+        self.received_at = time.perf_counter()
+        self.event.set()
+
+
+class _EventLoopThread:
+    """
+    Runs an event loop on a background thread for as long as it is entered.
+    """
+
+    def __init__(self) -> None:
+        self.loop = asyncio.new_event_loop()
+        self.thread = threading.Thread(target=self.loop.run_forever, daemon=True)
+
+    def __enter__(self) -> "_EventLoopThread":
+        self.thread.start()
+        return self
+
+    def __exit__(self, *args: Any) -> None:
+        self.loop.call_soon_threadsafe(self.loop.stop)
+        self.thread.join()
+        self.loop.close()
+
+
+def _measure(
+    stream_interface: StreamInterface,
+    receiver: _Receiver,
+    consumer: ContextManager[Any],
+    num_messages: int,
+) -> float:
+    """
+    Produces messages one at a time, waiting for each to reach the receiver before
+    producing the next so that no latency is spent queueing. Returns the median
+    latency.
+    """
+    latencies: List[float] = []
+    with consumer, Producer(stream_interface=stream_interface) as producer:
+        for i in range(num_messages):
+            message = DispatchBenchmarkMessage(int_field=i)
+            receiver.event.clear()
+            sent_at = time.perf_counter()
+            producer.produce_message(message)
+            if not receiver.event.wait(RECEIVE_TIMEOUT):
+                raise LabGraphError(f"Message {i} was not received")
+            latencies.append(receiver.received_at - sent_at)
+    return statistics.median(latencies)
+
+
+def benchmark_dispatch(
+    num_messages: int = DEFAULT_NUM_MESSAGES,
+) -> DispatchBenchmarkResult:
+    """
+    Measures the per-message Python overhead between Cthulhu's consumer thread and
+    user code. Each path is measured with its own consumer on the same stream.
+
+    Args:
+        num_messages: The number of messages to measure on each path.
+    """
+    stream_interface = register_stream(
+        name=random_string(length=STREAM_NAME_LENGTH),
+        message_type=DispatchBenchmarkMessage,
+    )
+
+    receiver = _Receiver()
+    native = _measure(
+        stream_interface,
+        receiver,
+        contextlib.closing(
+            StreamConsumer(
+                **{"si": stream_interface, "sampleCb": receiver.receive, "async": True}
+            )
+        ),
+        num_messages,
+    )
+
+    receiver = _Receiver()
+    consumer = _measure(
+        stream_interface,
+        receiver,
+        Consumer(
+            stream_interface=stream_interface,
+            sample_callback=receiver.receive,
+            mode=Mode.ASYNC,
+        ),
+        num_messages,
+    )
+
+    receiver = _Receiver()
+    with _EventLoopThread() as loop_thread:
+        # The event loop of a `LocalRunner` is woken by its own work; this one is
+        # otherwise idle, so the handoff has to wake it up
+        dispatch = StreamDispatch()
+        dispatch.target = functools.partial(
+            loop_thread.loop.call_soon_threadsafe, receiver.receive
+        )
+
+        def callback(message: DispatchBenchmarkMessage) -> None:
+            dispatch.target(message)
+
+        runner = _measure(
+            stream_interface,
+            receiver,
+            Consumer(
+                stream_interface=stream_interface,
+                sample_callback=callback,
+                mode=Mode.ASYNC,
+            ),
+            num_messages,
+        )
+
+    return DispatchBenchmarkResult(
+        num_messages=num_messages, native=native, consumer=consumer, runner=runner
+    )
+
+
+class ArrayMessage(Message):
+    sent_at: float
+    data: np.ndarray
+
+
+@dataclass
+class PassthroughBenchmarkResult:
+    """
+    The median latency in seconds from publishing a message with an array field to a
+    subscriber in the same process having read the array.
+
+    Args:
+        num_messages: The number of messages measured in each mode.
+        array_size: The number of float64 elements of the array of each message.
+        serialized: With messages passed through Cthulhu's shared memory.
+        passthrough:
+            With `RunnerOptions.local_passthrough` set, so the published messages
+            are passed to the subscriber as is.
+    """
+
+    num_messages: int
+    array_size: int
+    serialized: float
+    passthrough: float
+
+    def report(self) -> str:
+        """
+        Returns a human-readable summary of the latencies in both modes.
+        """
+        return "\n".join(
+            (
+                f"Median latency over {self.num_messages} messages of "
+                f"{self.array_size * 8} array bytes:",
+                f"  {'serialized':<12}{self.serialized * 1e6:10.2f} us",
+                f"  {'passthrough':<12}{self.passthrough * 1e6:10.2f} us",
+            )
+        )
+
+
+class ArrayBenchmarkConfig(Config):
+    num_messages: int
+    array_size: int
+    publish_interval: float
+
+
+class ArraySource(Node):
+    OUTPUT = Topic(ArrayMessage)
+    config: ArrayBenchmarkConfig
+
+    @publisher(OUTPUT)
+    async def source(self) -> AsyncPublisher:
+        for _ in range(self.config.num_messages):
+            data = np.ones(self.config.array_size)
+            yield self.OUTPUT, ArrayMessage(sent_at=time.perf_counter(), data=data)
+            await asyncio.sleep(self.config.publish_interval)
+
+
+class ArraySink(Node):
+    INPUT = Topic(ArrayMessage)
+    config: ArrayBenchmarkConfig
+
+    def setup(self) -> None:
+        self.latencies: List[float] = []
+
+    @subscriber(INPUT)
+    def sink(self, message: ArrayMessage) -> None:
+        assert message.data.size == self.config.array_size
+        self.latencies.append(time.perf_counter() - message.sent_at)
+        if len(self.latencies) == self.config.num_messages:
+            raise NormalTermination()
+
+
+class ArrayBenchmarkGraph(Graph):
+    SOURCE: ArraySource
+    SINK: ArraySink
+    config: ArrayBenchmarkConfig
+
+    def setup(self) -> None:
+        self.SOURCE.configure(self.config)
+        self.SINK.configure(self.config)
+
+    def connections(self) -> Connections:
+        return ((self.SOURCE.OUTPUT, self.SINK.INPUT),)
+
+
+def _measure_graph(config: ArrayBenchmarkConfig, local_passthrough: bool) -> float:
+    graph = ArrayBenchmarkGraph()
+    graph.configure(config)
+    options = RunnerOptions(local_passthrough=local_passthrough)
+    LocalRunner(module=graph, options=options).run()
+    return statistics.median(graph.SINK.latencies)
+
+
+def benchmark_passthrough(
+    num_messages: int = DEFAULT_NUM_ARRAY_MESSAGES,
+    array_size: int = DEFAULT_ARRAY_SIZE,
+    publish_interval: float = DEFAULT_PUBLISH_INTERVAL,
+) -> PassthroughBenchmarkResult:
+    """
+    Measures the latency of messages with a large array field between a publisher and
+    a subscriber run by the same `LocalRunner`, with and without local passthrough.
+
+    Args:
+        num_messages: The number of messages to measure in each mode.
+        array_size: The number of float64 elements of the array of each message.
+        publish_interval: The time in seconds to wait between publishing messages.
+    """
+    config = ArrayBenchmarkConfig(
+        num_messages=num_messages,
+        array_size=array_size,
+        publish_interval=publish_interval,
+    )
+    return PassthroughBenchmarkResult(
+        num_messages=num_messages,
+        array_size=array_size,
+        serialized=_measure_graph(config, local_passthrough=False),
+        passthrough=_measure_graph(config, local_passthrough=True),
+    )
+
+
+if __name__ == "__main__":
+    print(benchmark_dispatch().report())
+    print(benchmark_passthrough().report())
@@ -37,14 +37,17 @@ from .._cthulhu.cthulhu import (
     format_performance_summary,
     get_stream,
 )
+from ..events.native_event_generator_node import NativeEventGeneratorNode
 from ..graphs.cpp_node import CPPNode
 from ..graphs.method import SubscriberType, Transformer
 from ..graphs.module import Module
 from ..graphs.topic import PATH_DELIMITER, Topic
-from ..messages.message import Message
+from ..messages.message import Message, set_deferred_serialization
+from ..util.error import LabGraphError
 from ..util.logger import get_logger
 from .cthulhu import create_module_streams
 from .exceptions import ExceptionMessage, NormalTermination
+from .placement import PlacementProfiler
 from .process_manager import ProcessPhase
 from .profiling import should_profile, write_profiling_results
 from .runner import Runner, RunnerOptions
@@ -60,6 +63,26 @@ DEFAULT_QUEUE_CAPACITY = 10000
 EXCEPTION_STREAM_SUFFIX = "_EXCEPTION"
 
 
+def _unregistered_callback(message: Message) -> None:
+    raise LabGraphError(
+        f"Received {message.__class__.__name__} before its callback was registered"
+    )
+
+
+class StreamDispatch:
+    """
+    Forwards the messages of a stream to the callback registered for it by a
+    `LocalRunner`'s asyncio thread. The stream's consumer holds on to its dispatch, and
+    registering a callback only assigns `target`, so neither delivering a message nor
+    (re-)registering a callback takes a lock.
+    """
+
+    __slots__ = ("target",)
+
+    def __init__(self) -> None:
+        self.target: Callable[[Message], None] = _unregistered_callback
+
+
 @dataclass
 class LocalRunnerState:
     """
@@ -71,7 +94,9 @@ class LocalRunnerState:
             `LocalRunner`'s threads.
         producers: The Cthulhu producers used by the module.
         consumers: The Cthulhu consumers used by the module.
-        callbacks: The callbacks registered by the module's asyncio thread.
+        dispatches:
+            The dispatch of each stream to the callback registered by the module's
+            asyncio thread.
         setup_barrier:
             Barrier for coordinating startup between the `LocalRunner`'s threads.
         ready_event:
@@ -79,18 +104,22 @@ class LocalRunnerState:
             has completed all its startup tasks.
         setup_complete: A flag indicating whether setup is complete for this module.
         cleanup_started: A flag indicating whether cleanup has started for this module.
+        profiler:
+            Records the module's stream traffic and load, if
+            `RunnerOptions.placement_profile_dir` is set.
     """
 
     lock: threading.Lock = field(default_factory=threading.Lock)
     producers: Dict[str, Producer] = field(default_factory=dict)
     consumers: Dict[str, Consumer] = field(default_factory=dict)
-    callbacks: Dict[str, SubscriberType] = field(default_factory=dict)
+    dispatches: Dict[str, StreamDispatch] = field(default_factory=dict)
     setup_barrier: threading.Barrier = field(
         default_factory=functools.partial(threading.Barrier, 2, timeout=BARRIER_TIMEOUT)
     )
     ready_event: threading.Event = field(default_factory=threading.Event)
     setup_complete: bool = False
     cleanup_started: bool = False
+    profiler: Optional[PlacementProfiler] = None
 
 
 class LocalRunner(Runner):
@@ -134,6 +163,11 @@ class LocalRunner(Runner):
             self._running = True
             logger.debug(f"{self._module}:started")
             self._state = LocalRunnerState()
+            if self._options.local_passthrough:
+                set_deferred_serialization(True)
+            if self._options.placement_profile_dir is not None:
+                self._state.profiler = self._create_profiler()
+                thread_mark = self._state.profiler.begin_thread()
 
             # Start the background thread (runs the event loop)
             async_thread = _AsyncThread(runner=self)
@@ -174,6 +208,9 @@ class LocalRunner(Runner):
                     self._options.bootstrap_info.process_name, ProcessPhase.RUNNING
                 )
 
+            if self._state.profiler is not None:
+                self._state.profiler.start()
+
             # Thread event: signal to background thread that Cthulhu and graph are
             # set up
             self._state.ready_event.set()
@@ -198,6 +235,8 @@ class LocalRunner(Runner):
             self._handle_exception()
         finally:
             self._running = False
+            if self._options.local_passthrough:
+                set_deferred_serialization(False)
             if self._options.bootstrap_info is not None:
                 # Signal that this process is ready
                 self._options.bootstrap_info.process_manager_state.update(
@@ -214,6 +253,13 @@ class LocalRunner(Runner):
             monitor_thread.join()
             logger.debug(f"{self._module}:monitor thread complete")
 
+            if self._state.profiler is not None:
+                self._state.profiler.end_thread(thread_mark)
+                profile_path = self._state.profiler.write(
+                    self._options.placement_profile_dir, self._module
+                )
+                logger.info(f"{self._module}:saved placement profile to {profile_path}")
+
             if should_profile():
                 yappi.stop()
                 write_profiling_results(self._module)
@@ -238,6 +284,17 @@ class LocalRunner(Runner):
                 if self._exception is not None:
                     raise self._exception
 
+    def _create_profiler(self) -> PlacementProfiler:
+        bootstrap_info = self._options.bootstrap_info
+        if bootstrap_info is None:
+            return PlacementProfiler(
+                process=self._module.__class__.__name__, module_path=""
+            )
+        return PlacementProfiler(
+            process=bootstrap_info.process_name,
+            module_path=bootstrap_info.stream_namespace or "",
+        )
+
     def _setup_cthulhu(self) -> None:
         """
         Sets up Cthulhu as the transport for the LabGraph graph. Creates streams only
@@ -249,6 +306,7 @@ class LocalRunner(Runner):
         self._create_producers()
         self._create_consumers()
         self._bootstrap_cpp_nodes()
+        self._bootstrap_event_generator_nodes()
 
     def _bootstrap_cpp_nodes(self) -> None:
         module_tuples = list(self._module.__descendants__.items())
@@ -289,14 +347,39 @@ class LocalRunner(Runner):
             )
             node._bootstrap(bootstrap_info)
 
+    def _bootstrap_event_generator_nodes(self) -> None:
+        """
+        Hands the streams of each `NativeEventGeneratorNode` in the module over to the
+        node, which publishes its events on them from C++. The Cthulhu producers
+        created for these streams are closed, as a stream can only have one producer.
+        """
+        module_tuples = list(self._module.__descendants__.items())
+        module_tuples.append(("", self._module))
+        for node_path, node in module_tuples:
+            if not isinstance(node, NativeEventGeneratorNode):
+                continue
+            stream_interfaces = {}
+            for topic_name in node.__topics__.keys():
+                if node_path == "":
+                    topic_path = topic_name
+                else:
+                    topic_path = PATH_DELIMITER.join((node_path, topic_name))
+                stream_id = self._module._stream_for_topic_path(topic_path).id
+                with self._state.lock:
+                    producer = self._state.producers.pop(stream_id, None)
+                if producer is None:
+                    continue
+                producer.close()
+                stream_interfaces[topic_name] = producer.stream_interface
+            node._bootstrap_streams(stream_interfaces)
+
     def _wait_for_ready(self) -> None:
         if self._options.bootstrap_info is None:
             return
-        while (
-            self._options.bootstrap_info.process_manager_state.get_overall().value
-            < ProcessPhase.READY.value
-        ):
-            time.sleep(0.1)
+        state = self._options.bootstrap_info.process_manager_state
+        version = state.version
+        while state.get_overall().value < ProcessPhase.READY.value:
+            version = state.wait_for_change(version, 0.1)
 
     def _run_main(self) -> None:
         """
@@ -341,12 +424,16 @@ class LocalRunner(Runner):
             producer = Producer(stream_interface=cthulhu_stream, mode=Mode.ASYNC)
             with self._state.lock:
                 self._state.producers[local_stream_id] = producer
+            if self._state.profiler is not None:
+                self._state.profiler.add_stream(
+                    local_stream_id, (root_topic_path,), produced=True
+                )
 
     def _callback_for_stream(self, stream_id: str) -> Callable[..., None]:
         """
         Returns a callback for the given stream id. The actual callbacks are registered
         in the `LocalRunner`'s state object by the asyncio thread. This returns a
-        callback that looks up the registered callback and then calls it.
+        callback that forwards to the stream's `StreamDispatch`.
         """
         # Typing `callback` with `MessageType` allows us to know how to deserialize
         # the incoming message in shared memory
@@ -357,10 +444,11 @@ class LocalRunner(Runner):
             # Type with extra information for the aligner
             MessageType = LabGraphCallbackParams[MessageType]  # type: ignore
 
+        with self._state.lock:
+            dispatch = self._state.dispatches.setdefault(stream_id, StreamDispatch())
+
         def callback(message: MessageType) -> None:  # type: ignore
-            with self._state.lock:
-                callback_fn = self._state.callbacks[stream_id]
-            callback_fn(message)
+            dispatch.target(message)
 
         return callback
 
@@ -402,6 +490,10 @@ class LocalRunner(Runner):
             consumer.queue_capacity = DEFAULT_QUEUE_CAPACITY
             with self._state.lock:
                 self._state.consumers[local_stream_id] = consumer
+            if self._state.profiler is not None:
+                self._state.profiler.add_stream(
+                    local_stream_id, (root_topic_path,), produced=False
+                )
 
     def _run_setup(self) -> None:
         """
@@ -498,32 +590,35 @@ class _AsyncThread(threading.Thread):
 
         try:
             # Create callback methods that run in the event loop
-            with self.state.lock:
-                for stream in self.module.__streams__.values():
-                    callbacks = []
-                    for subscriber_path, subscriber in self.module.subscribers.items():
-                        if subscriber.subscribed_topic_path in stream.topic_paths:
-                            if isinstance(subscriber, Transformer):
-                                callbacks.append(
-                                    self.wrap_transformer_callback(
-                                        transformer_path=subscriber_path, loop=loop
-                                    )
+            for stream in self.module.__streams__.values():
+                callbacks = []
+                for subscriber_path, subscriber in self.module.subscribers.items():
+                    if subscriber.subscribed_topic_path in stream.topic_paths:
+                        if isinstance(subscriber, Transformer):
+                            callbacks.append(
+                                self.wrap_transformer_callback(
+                                    transformer_path=subscriber_path, loop=loop
                                 )
-                            else:
-                                callbacks.append(
-                                    self.wrap_subscriber_callback(
-                                        subscriber_path=subscriber_path, loop=loop
-                                    )
+                            )
+                        else:
+                            callbacks.append(
+                                self.wrap_subscriber_callback(
+                                    subscriber_path=subscriber_path, loop=loop
                                 )
+                            )
 
-                    stream_callback = self.wrap_all_callbacks(callbacks, loop=loop)
+                stream_callback = self.wrap_all_callbacks(callbacks, loop=loop)
 
-                    if self.options.aligner is not None:
-                        # Inject aligner into callback if present
-                        self.options.aligner.register(stream.id, stream_callback)
-                        stream_callback = self.options.aligner.push
+                if self.options.aligner is not None:
+                    # Inject aligner into callback if present
+                    self.options.aligner.register(stream.id, stream_callback)
+                    stream_callback = self.options.aligner.push
 
-                    self.state.callbacks[stream.id] = stream_callback
+                with self.state.lock:
+                    dispatch = self.state.dispatches.setdefault(
+                        stream.id, StreamDispatch()
+                    )
+                dispatch.target = stream_callback
 
             # Thread barrier: wait for nodes' setup + signal to main thread that
             # callbacks are ready
@@ -531,6 +626,8 @@ class _AsyncThread(threading.Thread):
 
             # Thread event: wait for main thread to set up Cthulhu
             self.state.ready_event.wait()
+            if self.state.profiler is not None:
+                thread_mark = self.state.profiler.begin_thread()
 
             # Schedule startup coroutines in event loop
             for awaitable in self.get_startup_methods():
@@ -551,6 +648,9 @@ class _AsyncThread(threading.Thread):
                 # Run event loop
                 while self.runner._running:
                     loop.run_until_complete(asyncio.sleep(0.01))
+
+            if self.state.profiler is not None:
+                self.state.profiler.end_thread(thread_mark)
         except BaseException:
             logger.debug(f"{self.module}:handling exception in background thread")
             self.runner._handle_exception()
@@ -643,8 +743,36 @@ class _AsyncThread(threading.Thread):
         async for topic, message in publisher_method():
             topic_path = self.module._get_topic_path(topic)
             stream = self.module._stream_for_topic_path(topic_path)
-            producer = self.state.producers[stream.id]
-            producer.produce_message(message)
+            if self.options.local_passthrough and self.is_local_only(stream.id):
+                # The message never reaches shared memory, so it has no sample to
+                # timestamp, and the stream stays within the module, so it doesn't
+                # weigh on placement
+                dispatch = self.state.dispatches[stream.id]
+                if self.options.aligner is not None:
+                    dispatch.target(LabGraphCallbackParams(message, stream.id))
+                else:
+                    dispatch.target(message)
+                continue
+            if self.options.timestamp_samples:
+                metadata = message.__sample__.metadata
+                header = metadata.header
+                if header.timestamp == 0:
+                    header.timestamp = time.time()
+                    metadata.header = header
+            self.state.producers[stream.id].produce_message(message)
+            if self.state.profiler is not None:
+                self.state.profiler.count(stream.id, message)
+
+    def is_local_only(self, stream_id: str) -> bool:
+        """
+        Returns whether the only consumer of a stream is this module's own, i.e., there
+        are no consumers of it in other processes or in C++ nodes.
+
+        Args:
+            stream_id: The id of the stream.
+        """
+        stream_interface = self.state.producers[stream_id].stream_interface
+        return stream_id in self.state.consumers and stream_interface.num_consumers == 1
 
     def get_publisher_methods(
         self,
@@ -664,42 +792,44 @@ class _AsyncThread(threading.Thread):
 
     def wrap_subscriber_callback(
         self, subscriber_path: str, loop: Any
-    ) -> Callable[[Message], Awaitable[None]]:
+    ) -> Callable[[Message], None]:
         """
-        Returns a subscriber callback as an async function.
+        Returns a callback that schedules a subscriber on the event loop. The subscriber
+        method and the original type of its messages are resolved here, so the
+        callback only hands each message to the event loop.
 
         Args:
             subscriber_path: The path to the @subscriber-decorated callback.
             loop: The event loop to run the callback on.
         """
+        import asyncio
 
         subscriber_method = self.module._get_subscriber_method(subscriber_path)
+        original_type = self.original_stream_types.get(subscriber_path)
 
         if inspect.iscoroutinefunction(subscriber_method):
-            return subscriber_method
-
-        async def subscriber_callback(message: Message) -> None:
-            if subscriber_path in self.original_stream_types:
-                object.__setattr__(
-                    message,
-                    "__original_message_type__",
-                    self.original_stream_types[subscriber_path],
-                )
-            if loop.is_closed():
-                logger.warn(
-                    f"{message.__class__.__name__} dropped while graph shutting down"
-                )
-                return
-            loop.call_soon(self.module._get_subscriber_method(subscriber_path), message)
-            return
+
+            def async_subscriber_callback(message: Message) -> None:
+                if original_type is not None:
+                    object.__setattr__(
+                        message, "__original_message_type__", original_type
+                    )
+                asyncio.ensure_future(subscriber_method(message), loop=loop)
+
+            return async_subscriber_callback
+
+        def subscriber_callback(message: Message) -> None:
+            if original_type is not None:
+                object.__setattr__(message, "__original_message_type__", original_type)
+            loop.call_soon(subscriber_method, message)
 
         return subscriber_callback
 
     def wrap_transformer_callback(
         self, transformer_path: str, loop: Any
-    ) -> Callable[[Message], Awaitable[None]]:
+    ) -> Callable[[Message], None]:
         """
-        Returns a transformer callback as an async function.
+        Returns a callback that schedules a transformer on the event loop.
 
         Args:
             transformer_path:
@@ -707,34 +837,34 @@ class _AsyncThread(threading.Thread):
                 decorators.
             loop: The event loop to run the callback on.
         """
+        import asyncio
 
-        async def transformer_callback(message: Message) -> None:
-            if transformer_path in self.original_stream_types:
-                object.__setattr__(
-                    message,
-                    "__original_message_type__",
-                    self.original_stream_types[transformer_path],
-                )
-            await self.run_publisher_method(
-                functools.partial(
-                    self.module._get_transformer_method(transformer_path), message
-                )
+        transformer_method = self.module._get_transformer_method(transformer_path)
+        original_type = self.original_stream_types.get(transformer_path)
+
+        def transformer_callback(message: Message) -> None:
+            if original_type is not None:
+                object.__setattr__(message, "__original_message_type__", original_type)
+            asyncio.ensure_future(
+                self.run_publisher_method(
+                    functools.partial(transformer_method, message)
+                ),
+                loop=loop,
             )
 
         return transformer_callback
 
     def wrap_all_callbacks(
-        self, callbacks: List[Callable[[Message], Awaitable[None]]], loop: Any
+        self, callbacks: List[Callable[[Message], None]], loop: Any
     ) -> SubscriberType:
         """
         Given a list of callbacks, returns a callback that wraps all of them by
-        scheduling all of them on the event loop when a message is received.
+        passing each message received to all of them.
 
         Args:
             callbacks: The callbacks to wrap.
-            loop: The event loop to schedule the callbacks on.
+            loop: The event loop the callbacks schedule work on.
         """
-        import asyncio
 
         def callback(message: Message) -> None:
             if loop.is_closed():
@@ -743,7 +873,7 @@ class _AsyncThread(threading.Thread):
                 )
                 return
             for callback in callbacks:
-                asyncio.ensure_future(callback(message), loop=loop)
+                callback(message)
 
         return callback
 
@@ -764,25 +894,25 @@ class _MonitorThread(threading.Thread):
         self.runner = runner
 
     def run(self) -> None:
-        if self.runner._options.bootstrap_info is None:
+        bootstrap_info = self.runner._options.bootstrap_info
+        if bootstrap_info is None:
             return
 
+        state = bootstrap_info.process_manager_state
+        version = state.version
         while True:
             if not self.runner._running:
                 logger.debug(f"{self.runner._module}:monitor thread stopping")
                 return
 
-            try:
-                if (
-                    self.runner._options.bootstrap_info.process_manager_state.get_overall().value
-                    >= ProcessPhase.STOPPING.value
-                ):
-                    logger.debug(
-                        f"{self.runner._module}:stopping due to graph shutdown"
-                    )
-                    self.runner._running = False
-                    return
-            except (EOFError, ConnectionError, OSError, BrokenPipeError):
+            if not state.manager_alive:
                 logger.warning(f"{self.runner._module}:lost process manager, stopping")
                 self.runner._running = False
-            time.sleep(0.1)
+                return
+            state.heartbeat(bootstrap_info.process_name)
+            if state.get_overall().value >= ProcessPhase.STOPPING.value:
+                logger.debug(f"{self.runner._module}:stopping due to graph shutdown")
+                self.runner._running = False
+                return
+            # Woken up as soon as the graph starts stopping
+            version = state.wait_for_change(version, 0.1)
@@ -33,6 +33,8 @@ logger = get_logger(__name__)
 
 BARRIER_TIMEOUT = 60
 SHUTDOWN_PERIOD = 5
+# The monitor thread of each process sends heartbeats while it runs
+HEARTBEAT_PERIOD = 30
 EXCEPTION_POLL_TIME = 1
 
 EXCEPTION_STREAM_SUFFIX = "_EXCEPTION"
@@ -46,7 +48,13 @@ class ParallelRunner(Runner):
         self._options = options or RunnerOptions()
 
         # TODO: Validate process groups
-        self._modules = tuple(self._graph.process_modules())
+        if self._options.process_modules is not None:
+            self._modules = tuple(
+                self._graph if path == "" else self._graph.__descendants__[path]
+                for path in self._options.process_modules
+            )
+        else:
+            self._modules = tuple(self._graph.process_modules())
         self._logger: Optional[Logger] = None
         self._exception: Optional[BaseException] = None
 
@@ -138,7 +146,9 @@ class ParallelRunner(Runner):
                 )
             )
 
-        self._process_manager = ProcessManager(processes=processes)
+        self._process_manager = ProcessManager(
+            processes=processes, heartbeat_period=HEARTBEAT_PERIOD
+        )
         self._process_manager.run()
 
     def _get_class_qualname(self, cls: type) -> str:
@@ -0,0 +1,453 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import json
+import threading
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Dict, List, Optional, Sequence, Set, Tuple
+
+from ..graphs.graph import Graph
+from ..graphs.module import Module
+from ..graphs.node import Node
+from ..graphs.topic import PATH_DELIMITER
+from ..messages.message import Message
+from .parallel_runner import LOGGER_KEY
+
+
+PROFILE_SUFFIX = ".json"
+
+DEFAULT_MAX_CPU_LOAD = 1.0
+DEFAULT_MAX_GIL_LOAD = 0.8
+
+
+def _thread_cpu_time() -> float:
+    return time.clock_gettime(time.CLOCK_THREAD_CPUTIME_ID)
+
+
+class PlacementProfiler:
+    """
+    Records what a `LocalRunner` needs to know for placing its module in a process:
+    the messages and bytes it produces to each stream, the streams it consumes, the
+    CPU time of its process and the CPU time of its Python threads, which is time
+    spent holding the GIL. Counting adds a few dictionary updates per message, so it
+    is only enabled by `RunnerOptions.placement_profile_dir`.
+
+    Args:
+        process: The name of the process running the module.
+        module_path: The path of the module in the graph, empty for the graph.
+    """
+
+    def __init__(self, process: str, module_path: str) -> None:
+        self.process = process
+        self.module_path = module_path
+        self._lock = threading.Lock()
+        self._topic_paths: Dict[str, Tuple[str, ...]] = {}
+        self._produced: Dict[str, List[int]] = {}
+        self._consumed: Set[str] = set()
+        self._thread_cpu_time = 0.0
+        self._start_time: Optional[float] = None
+        self._start_process_time = 0.0
+
+    def add_stream(
+        self, stream_id: str, topic_paths: Sequence[str], produced: bool
+    ) -> None:
+        """
+        Registers a stream of the module.
+
+        Args:
+            stream_id: The id of the stream in the module.
+            topic_paths: The paths of the stream's topics, from the root of the graph.
+            produced:
+                Whether the module produces to the stream. Otherwise it consumes it.
+        """
+        with self._lock:
+            self._topic_paths[stream_id] = tuple(topic_paths)
+            if produced:
+                self._produced.setdefault(stream_id, [0, 0])
+            else:
+                self._consumed.add(stream_id)
+
+    def start(self) -> None:
+        """
+        Starts measuring time, once the graph is running.
+        """
+        self._start_time = time.perf_counter()
+        self._start_process_time = time.process_time()
+
+    def count(self, stream_id: str, message: Message) -> None:
+        """
+        Counts a message produced to a stream.
+        """
+        size = message.__message_size__
+        sample = message.__sample__
+        for index in range(message.__num_dynamic_fields__):
+            size += memoryview(sample.dynamicParameters[index]).nbytes
+        counts = self._produced[stream_id]
+        counts[0] += 1
+        counts[1] += size
+
+    def begin_thread(self) -> float:
+        """
+        Returns a mark to pass to `end_thread` when the calling Python thread is done.
+        """
+        return _thread_cpu_time()
+
+    def end_thread(self, mark: float) -> None:
+        """
+        Adds the CPU time of the calling Python thread since `begin_thread`.
+        """
+        elapsed = _thread_cpu_time() - mark
+        with self._lock:
+            self._thread_cpu_time += elapsed
+
+    def write(self, directory: str, module: Module) -> Path:
+        """
+        Writes the profile to a JSON file in a directory, and returns its path.
+        """
+        elapsed = 0.0
+        cpu_time = 0.0
+        if self._start_time is not None:
+            elapsed = time.perf_counter() - self._start_time
+            cpu_time = time.process_time() - self._start_process_time
+        with self._lock:
+            streams = [
+                {
+                    "topic_paths": list(self._topic_paths[stream_id]),
+                    "messages": counts[0],
+                    "bytes": counts[1],
+                    "produced": True,
+                }
+                for stream_id, counts in self._produced.items()
+            ] + [
+                {
+                    "topic_paths": list(self._topic_paths[stream_id]),
+                    "messages": 0,
+                    "bytes": 0,
+                    "produced": False,
+                }
+                for stream_id in self._consumed
+            ]
+            profile = {
+                "process": self.process,
+                "module_path": self.module_path,
+                "elapsed": elapsed,
+                "cpu_time": cpu_time,
+                "gil_time": self._thread_cpu_time,
+                "streams": streams,
+            }
+        path = Path(directory) / Path(
+            f"placement_{module.__class__.__name__}_{module.id}{PROFILE_SUFFIX}"
+        )
+        path.parent.mkdir(parents=True, exist_ok=True)
+        with open(path, "w") as profile_file:
+            json.dump(profile, profile_file, indent=2)
+        return path
+
+
+@dataclass
+class ProcessLoad:
+    """
+    The load of a process, in cores.
+
+    Args:
+        cpu: The CPU time of the process per second.
+        gil: The CPU time of the process's Python threads per second.
+    """
+
+    cpu: float = 0.0
+    gil: float = 0.0
+
+    def __add__(self, other: "ProcessLoad") -> "ProcessLoad":
+        return ProcessLoad(cpu=self.cpu + other.cpu, gil=self.gil + other.gil)
+
+
+@dataclass
+class PlacementProfile:
+    """
+    The profiles of a graph's processes, from a run with
+    `RunnerOptions.placement_profile_dir` set. The profiled processes are the units
+    that placement groups: a finer grouping in the profiling run, such as one process
+    per node, leaves the planner more to choose from.
+
+    Args:
+        loads: The load of each profiled module, by module path.
+        fixed_loads: The load of each process that is never regrouped, by name.
+        stream_rates: The bytes per second of each stream of the graph, by stream id.
+        stream_endpoints:
+            The profiled modules and fixed processes producing or consuming each
+            stream, by stream id.
+    """
+
+    loads: Dict[str, ProcessLoad] = field(default_factory=dict)
+    fixed_loads: Dict[str, ProcessLoad] = field(default_factory=dict)
+    stream_rates: Dict[str, float] = field(default_factory=dict)
+    stream_endpoints: Dict[str, Set[str]] = field(default_factory=dict)
+
+    @classmethod
+    def load(cls, graph: Graph, directory: str) -> "PlacementProfile":
+        """
+        Loads the profiles written to a directory by the processes of a graph.
+        """
+        stream_ids = {
+            topic_path: stream.id
+            for stream in graph.__streams__.values()
+            for topic_path in stream.topic_paths
+        }
+        result = cls()
+        paths = sorted(Path(directory).glob(f"placement_*{PROFILE_SUFFIX}"))
+        if len(paths) == 0:
+            raise ValueError(f"No placement profiles in {directory}")
+        for path in paths:
+            with open(path) as profile_file:
+                profile = json.load(profile_file)
+            elapsed = profile["elapsed"]
+            load = ProcessLoad()
+            if elapsed > 0:
+                load = ProcessLoad(
+                    cpu=profile["cpu_time"] / elapsed, gil=profile["gil_time"] / elapsed
+                )
+            if profile["process"] == LOGGER_KEY:
+                # The logger added by `ParallelRunner` is never regrouped
+                unit = LOGGER_KEY
+                result.fixed_loads[unit] = load
+            else:
+                unit = profile["module_path"]
+                result.loads[unit] = load
+            for stream in profile["streams"]:
+                stream_id = next(
+                    (
+                        stream_ids[topic_path]
+                        for topic_path in stream["topic_paths"]
+                        if topic_path in stream_ids
+                    ),
+                    None,
+                )
+                if stream_id is None:
+                    continue
+                result.stream_endpoints.setdefault(stream_id, set()).add(unit)
+                rate = stream["bytes"] / elapsed if elapsed > 0 else 0.0
+                result.stream_rates[stream_id] = (
+                    result.stream_rates.get(stream_id, 0.0) + rate
+                )
+        return result
+
+
+@dataclass
+class PlacementPlan:
+    """
+    A grouping of a graph's modules into processes, with its predicted cost.
+
+    Args:
+        process_modules:
+            The paths of the modules to run in their own process, empty for the
+            graph. Pass them as `RunnerOptions.process_modules` to apply the plan.
+        cost: The predicted bytes per second crossing process boundaries.
+        loads: The predicted load of each process, by module path.
+        current_process_modules: The paths of the graph's own process modules.
+        current_cost:
+            The predicted bytes per second crossing process boundaries with the
+            graph's own process modules, or None if the profiled modules don't fit
+            in them.
+        current_loads: The predicted load of each of the graph's own processes.
+        max_load: The load limits the plan was made under.
+    """
+
+    process_modules: Tuple[str, ...]
+    cost: float
+    loads: Dict[str, ProcessLoad]
+    current_process_modules: Tuple[str, ...]
+    current_cost: Optional[float]
+    current_loads: Dict[str, ProcessLoad]
+    max_load: ProcessLoad
+
+    def report(self) -> str:
+        """
+        Returns a description of the plan, compared with the graph's own grouping.
+        """
+        lines = [
+            f"Process placement (max CPU load {self.max_load.cpu:.2f}, max GIL load "
+            f"{self.max_load.gil:.2f})"
+        ]
+        if self.current_cost is None:
+            lines.append(
+                "Current: not comparable, the profiled modules span several of its "
+                "processes"
+            )
+        else:
+            lines.append(
+                f"Current: {len(self.current_process_modules)} processes, "
+                f"{_format_rate(self.current_cost)} across processes"
+            )
+            lines += _format_loads(self.current_loads, self.max_load)
+        lines.append(
+            f"Proposed: {len(self.process_modules)} processes, "
+            f"{_format_rate(self.cost)} across processes"
+        )
+        lines += _format_loads(self.loads, self.max_load)
+        return "\n".join(lines)
+
+
+def plan_placement(
+    graph: Graph,
+    profile: PlacementProfile,
+    max_cpu_load: float = DEFAULT_MAX_CPU_LOAD,
+    max_gil_load: float = DEFAULT_MAX_GIL_LOAD,
+) -> PlacementPlan:
+    """
+    Proposes process modules for a graph that minimize the bytes crossing process
+    boundaries, while keeping the load of each process under limits.
+
+    The candidates are the groupings that `ParallelRunner` can run: each process runs
+    a module of the graph, and the processes together run the nodes of the profiled
+    modules. A module runs in one process if it fits under the limits and it saves
+    bytes over the best split of its children, which is found recursively. Profiled
+    modules are never split, even if they are over the limits.
+
+    Args:
+        graph: The graph to place.
+        profile: The profile of a run of the graph.
+        max_cpu_load: The CPU time per second a process may use.
+        max_gil_load: The CPU time per second a process's Python threads may use.
+    """
+    max_load = ProcessLoad(cpu=max_cpu_load, gil=max_gil_load)
+    planner = _Planner(graph, profile, max_load)
+    process_modules, cost = planner.best("", graph)
+
+    current_process_modules = tuple(
+        "" if module is graph else graph._get_module_path(module)
+        for module in graph.process_modules()
+    )
+    current_groups = planner.assign(current_process_modules)
+    current_cost: Optional[float] = None
+    current_loads: Dict[str, ProcessLoad] = {}
+    if current_groups is not None:
+        current_cost = planner.cross_process_cost(current_groups)
+        current_loads = {
+            path: planner.load_of(units) for path, units in current_groups.items()
+        }
+
+    groups = {path: planner.units_under(path) for path in process_modules}
+    return PlacementPlan(
+        process_modules=tuple(process_modules),
+        cost=planner.cross_process_cost(groups),
+        loads={path: planner.load_of(units) for path, units in groups.items()},
+        current_process_modules=current_process_modules,
+        current_cost=current_cost,
+        current_loads=current_loads,
+        max_load=max_load,
+    )
+
+
+class _Planner:
+    def __init__(
+        self, graph: Graph, profile: PlacementProfile, max_load: ProcessLoad
+    ) -> None:
+        self.profile = profile
+        self.max_load = max_load
+        self.node_paths = [
+            path
+            for path, module in graph.__descendants__.items()
+            if isinstance(module, Node)
+        ]
+
+    def units_under(self, path: str) -> Set[str]:
+        return {unit for unit in self.profile.loads.keys() if _is_under(unit, path)}
+
+    def load_of(self, units: Set[str]) -> ProcessLoad:
+        load = ProcessLoad()
+        for unit in units:
+            load += self.profile.loads[unit]
+        return load
+
+    def process_cost(self, units: Set[str]) -> float:
+        # The bytes per second of the streams a process produces or consumes. Summed
+        # over processes, this counts each stream once per process it touches.
+        return sum(
+            rate
+            for stream_id, rate in self.profile.stream_rates.items()
+            if len(self.profile.stream_endpoints[stream_id] & units) > 0
+        )
+
+    def cross_process_cost(self, groups: Dict[str, Set[str]]) -> float:
+        # Each stream is delivered once to every process touching it other than the
+        # first, including the fixed ones
+        cost = 0.0
+        for stream_id, rate in self.profile.stream_rates.items():
+            endpoints = self.profile.stream_endpoints[stream_id]
+            touched = sum(1 for units in groups.values() if len(endpoints & units) > 0)
+            touched += len(endpoints & set(self.profile.fixed_loads.keys()))
+            cost += rate * max(touched - 1, 0)
+        return cost
+
+    def assign(self, process_modules: Sequence[str]) -> Optional[Dict[str, Set[str]]]:
+        # Groups the profiled modules into the given processes, or returns None if a
+        # profiled module isn't under exactly one of them
+        groups: Dict[str, Set[str]] = {path: set() for path in process_modules}
+        for unit in self.profile.loads.keys():
+            paths = [path for path in process_modules if _is_under(unit, path)]
+            if len(paths) != 1:
+                return None
+            groups[paths[0]].add(unit)
+        return groups
+
+    def best(self, path: str, module: Module) -> Tuple[List[str], float]:
+        # Returns the best process modules for the nodes of the profiled modules under
+        # this one, and the sum of their process costs
+        units = self.units_under(path)
+        if len(units) == 0:
+            return [], 0.0
+        whole_cost = self.process_cost(units)
+        if path in units:
+            return [path], whole_cost
+
+        split: List[str] = []
+        split_cost = 0.0
+        for name, child in module.__children__.items():
+            child_path = name if path == "" else PATH_DELIMITER.join((path, name))
+            child_modules, child_cost = self.best(child_path, child)
+            split += child_modules
+            split_cost += child_cost
+
+        load = self.load_of(units)
+        covered = all(
+            any(_is_under(node_path, unit) for unit in units)
+            for node_path in self.node_paths
+            if _is_under(node_path, path)
+        )
+        if (
+            covered
+            and load.cpu <= self.max_load.cpu
+            and load.gil <= self.max_load.gil
+            and whole_cost <= split_cost
+        ):
+            return [path], whole_cost
+        return split, split_cost
+
+
+def _is_under(path: str, ancestor: str) -> bool:
+    return (
+        ancestor == ""
+        or path == ancestor
+        or path.startswith(f"{ancestor}{PATH_DELIMITER}")
+    )
+
+
+def _format_rate(rate: float) -> str:
+    for unit in ("B", "KB", "MB"):
+        if rate < 1000:
+            return f"{rate:.1f} {unit}/s"
+        rate /= 1000
+    return f"{rate:.1f} GB/s"
+
+
+def _format_loads(loads: Dict[str, ProcessLoad], max_load: ProcessLoad) -> List[str]:
+    lines = []
+    for path, load in sorted(loads.items()):
+        overloaded = load.cpu > max_load.cpu or load.gil > max_load.gil
+        lines.append(
+            f"  {path or '<graph>'}: CPU {load.cpu:.2f} GIL {load.gil:.2f}"
+            + (" (over the limit)" if overloaded else "")
+        )
+    return lines
@@ -3,17 +3,17 @@
 
 import dataclasses
 import enum
-import multiprocessing as mp
+import os
 import pickle
-import socket
 import subprocess
 import tempfile
+import threading
 import time
-from multiprocessing import managers
 from typing import Callable, Dict, Optional, Sequence, Set, Tuple, Union
 
 import psutil
 
+from .._cthulhu.bindings import ProcessTable  # type: ignore
 from ..util.logger import get_logger
 from ..util.random import random_string
 from .launch import launch
@@ -24,7 +24,8 @@ logger = get_logger(__name__)
 MONITOR_SLEEP_TIME = 0.01
 DEFAULT_STARTUP_PERIOD = 60
 DEFAULT_SHUTDOWN_PERIOD = 30
-AUTH_KEY_LENGTH = 16
+TABLE_PREFIX = "LABGRAPH_PROCESSES_"
+TABLE_SUFFIX_LENGTH = 16
 
 
 class ProcessPhase(enum.Enum):
@@ -90,69 +91,59 @@ class ProcessManagerException(RuntimeError):
         }[self._failures[process_name]]
 
 
-@dataclasses.dataclass
-class ProcessManagerServerInfo:
-    port: int
-    auth_key: bytes = dataclasses.field(
-        default_factory=lambda: random_string(AUTH_KEY_LENGTH).encode("ascii")
-    )
-    host: str = "127.0.0.1"
-
-    @property
-    def address(self) -> Tuple[str, int]:
-        return (self.host, self.port)
-
-
 class ProcessManagerState:
     """
     Holds state for all the processes managed by a `ProcessManager`. Thread-safe.
 
+    The phases and exceptions are kept in a Cthulhu `ProcessTable` in shared memory,
+    which is created by the `ProcessManager` and opened by the processes it manages
+    when they load the state. Waiting processes are woken up by every change to it.
+
     Args:
         process_names: The names of all the processes being managed.
+        manager_name: The name of the `ProcessManager`.
     """
 
     # Argument passed to subprocesses so they can find the shared state
     SUBPROCESS_ARG = "process-manager-state-file"
 
-    _server_info: Optional[ProcessManagerServerInfo] = None
-    _manager: Optional[mp.managers.SyncManager] = None
-    _manager_started = False
-
     def __init__(self, process_names: Set[str], manager_name: str) -> None:
-        # Start the `mp.Manager` if it is not started
-        if not self.__class__._manager_started:
-            self.__class__._server_info = ProcessManagerServerInfo(
-                port=self.__class__._get_free_tcp_port()
-            )
-            self.__class__._manager = mp.managers.SyncManager(
-                authkey=self.__class__._server_info.auth_key,
-                address=self.__class__._server_info.address,
-            )
-            self.__class__._manager.start()
-            self.__class__._manager_started = True
-
-        assert self._manager is not None
-
         self._manager_name = manager_name
+        self._manager_pid = os.getpid()
         process_names = set(process_names).union({manager_name})
-
-        # Basic state of all managed processes
-        self._phases = self._manager.dict(
-            {process_name: ProcessPhase.STARTING for process_name in process_names}
-        )
-        self._exceptions: Dict[str, Optional[str]] = self._manager.dict(
-            {process_name: None for process_name in process_names}
+        self._table = ProcessTable.create(
+            f"{TABLE_PREFIX}{random_string(TABLE_SUFFIX_LENGTH)}",
+            sorted(process_names),
+            ProcessPhase.STARTING.value,
         )
 
-        # Synchronizes access to _phases and _exceptions
-        self.lock = self._manager.RLock()
+        # Every operation on the table is atomic. This only groups several of them
+        # together within this process.
+        self.lock = threading.RLock()
+
+    def __getstate__(self) -> Dict[str, Union[str, int]]:
+        return {
+            "table_name": self._table.name,
+            "manager_name": self._manager_name,
+            "manager_pid": self._manager_pid,
+        }
+
+    def __setstate__(self, state: Dict[str, Union[str, int]]) -> None:
+        assert isinstance(state["table_name"], str)
+        assert isinstance(state["manager_name"], str)
+        assert isinstance(state["manager_pid"], int)
+        self._manager_name = state["manager_name"]
+        self._manager_pid = state["manager_pid"]
+        self._table = ProcessTable.open(state["table_name"])
+        self.lock = threading.RLock()
 
     def get_all(self) -> Dict[str, ProcessPhase]:
         """
         Returns the current running state for all managed processes.
         """
-        with self.lock:
-            return {**self._phases}
+        return {
+            name: ProcessPhase(phase) for name, phase in self._table.phases().items()
+        }
 
     def get(self, name: str) -> ProcessPhase:
         """
@@ -161,7 +152,7 @@ class ProcessManagerState:
         Args:
             name: The name of the managed process.
         """
-        return self._phases[name]
+        return ProcessPhase(self._table.phase(name))
 
     def update(self, name: str, phase: ProcessPhase) -> None:
         """
@@ -171,11 +162,29 @@ class ProcessManagerState:
             name: The name of the managed process.
             phase: The new running state.
         """
-        with self.lock:
-            old_phase = self._phases[name]
-            logger.debug(f"{name}:updated state:{old_phase.name} -> {phase.name}")
-            assert phase.value > old_phase.value
-            self._phases[name] = phase
+        old_phase = self.get(name)
+        logger.debug(f"{name}:updated state:{old_phase.name} -> {phase.name}")
+        updated = self._table.set_phase(name, phase.value)
+        assert updated
+
+    def heartbeat(self, name: str) -> None:
+        """
+        Records that the managed process with the given name is alive.
+
+        Args:
+            name: The name of the managed process.
+        """
+        self._table.heartbeat(name)
+
+    def seconds_since_heartbeat(self, name: str) -> float:
+        """
+        Returns the time, in seconds, since the last heartbeat of the managed process
+        with the given name.
+
+        Args:
+            name: The name of the managed process.
+        """
+        return self._table.seconds_since_heartbeat(name)
 
     def get_exception(self, name: str) -> Optional[str]:
         """
@@ -185,7 +194,13 @@ class ProcessManagerState:
         Args:
             name: The name of the managed process.
         """
-        return self._exceptions[name]
+        return self._table.exception(name)
+
+    def get_all_exceptions(self) -> Dict[str, Optional[str]]:
+        """
+        Gets the descriptions of the exceptions raised by all managed processes.
+        """
+        return self._table.exceptions()
 
     def set_exception(self, name: str, exception_desc: str) -> None:
         """
@@ -197,17 +212,34 @@ class ProcessManagerState:
                 A string description of the exception that was thrown by the managed
                 process.
         """
-        with self.lock:
-            assert self.get_exception(name) is None
-            self._exceptions[name] = exception_desc
+        updated = self._table.set_exception(name, exception_desc)
+        assert updated
 
     @property
     def has_exception(self) -> bool:
         """
         Returns true if an exception was raised in any process.
         """
-        with self.lock:
-            return any(exception is not None for exception in self._exceptions.values())
+        return self._table.has_exception
+
+    @property
+    def version(self) -> int:
+        """
+        Returns a counter of the changes to the phases and exceptions, to pass to
+        `wait_for_change`.
+        """
+        return self._table.version
+
+    def wait_for_change(self, version: int, timeout: float) -> int:
+        """
+        Blocks until a phase or an exception changes after `version` was read, or the
+        timeout expires. Returns the new version.
+
+        Args:
+            version: The version the caller last saw.
+            timeout: The maximum time to wait, in seconds.
+        """
+        return self._table.wait_for_change(version, timeout)
 
     @classmethod
     def load(cls, filename: str) -> "ProcessManagerState":
@@ -217,55 +249,36 @@ class ProcessManagerState:
         Args:
             filename: The filename to read the state from.
         """
-        # See https://bugs.python.org/msg214582 for more information on why we use auth
-        # keys here.
         with open(filename, "rb") as state_file:
-            # Unpickle the outer layer
-            result = pickle.load(state_file)
-            assert isinstance(result, tuple)
-            # The outer layer should contain an auth key as well as the "real" bytes
-            server_info, state_bytes = result
-            assert isinstance(server_info, ProcessManagerServerInfo)
-            assert isinstance(state_bytes, bytes)
-            # Unpickling `mp.Manager` proxy objects (`_phases` and `_exceptions`)
-            # requires us to set the correct auth key. We do so temporarily to avoid
-            # contaminating global state.
-            old_auth_key = mp.current_process().authkey
-            mp.current_process().authkey = server_info.auth_key
-            state = pickle.loads(state_bytes)
+            state = pickle.load(state_file)
             assert isinstance(state, ProcessManagerState)
-            mp.current_process().authkey = old_auth_key
             return state
 
     def dump(self, filename: str) -> None:
         """
-        Dumps this `ProcessManagerState` to a file.
+        Dumps this `ProcessManagerState` to a file. Only the name of the shared memory
+        table is written, so the state stays shared with the loaded copies.
 
         Args:
             filename: The filename to dump to.
         """
-        # See https://bugs.python.org/msg214582 for more information on why we use auth
-        # keys here.
         with open(filename, "wb") as state_file:
-            # We pickle twice: first we pickle the state itself, and then we pickle the
-            # auth key with the pickled bytes. The reason is we will need this auth key
-            # in the child process in order to unpickle the state bytes.
-            state_bytes = pickle.dumps(self)
-            pickle.dump((self.__class__._server_info, state_bytes), state_file)
+            pickle.dump(self, state_file)
 
     def get_overall(self) -> ProcessPhase:
         """
         Returns the overall phase of all managed processes.
         """
-        return self._phases[self._manager_name]
+        return self.get(self._manager_name)
 
-    @classmethod
-    def _get_free_tcp_port(cls) -> int:
-        tcp = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-        tcp.bind(("", 0))
-        addr, port = tcp.getsockname()
-        tcp.close()
-        return int(port)
+    @property
+    def manager_alive(self) -> bool:
+        """
+        Returns true if the process that created this state is still running. The
+        shared memory stays readable after it exits, so this is how managed processes
+        notice that it is gone.
+        """
+        return psutil.pid_exists(self._manager_pid)
 
 
 @dataclasses.dataclass(frozen=True)
@@ -309,6 +322,11 @@ class ProcessManager:
             The time, in seconds, that each process has to shut down. If a process
             exceeds this time, the `ProcessManager` will consider this a hang and stop
             all the processes.
+        heartbeat_period:
+            The time, in seconds, that a running process may go without calling
+            `ProcessManagerState.heartbeat`. If a process exceeds this time, the
+            `ProcessManager` will consider this a hang and stop all the processes. If
+            None, processes aren't expected to send heartbeats.
     """
 
     def __init__(
@@ -317,10 +335,12 @@ class ProcessManager:
         name: Optional[str] = None,
         startup_period: float = DEFAULT_STARTUP_PERIOD,
         shutdown_period: float = DEFAULT_SHUTDOWN_PERIOD,
+        heartbeat_period: Optional[float] = None,
     ) -> None:
         self._name = name or self.__class__.__name__
         self._startup_period = startup_period
         self._shutdown_period = shutdown_period
+        self._heartbeat_period = heartbeat_period
 
         # Index the `ProcessInfo` objects by name, and fill in the names for any without
         # names using an integer counter
@@ -342,7 +362,7 @@ class ProcessManager:
             assert process_info.name != self._name
             self._process_info[process_info.name] = process_info
 
-        # Initiatialize state (this will be shared between processes via `mp.Manager`)
+        # Initiatialize state (this will be shared between processes via shared memory)
         self._state = ProcessManagerState(set(self._process_info.keys()), self._name)
 
         # Write the state information to disk so that other processes can access it
@@ -408,6 +428,7 @@ class ProcessManager:
         logger.debug(
             f"{self._name}:waiting for all processes to be {target_phase.name}"
         )
+        version = self._state.version
         while True:
             with self._state.lock:
                 # Check if any process has crashed
@@ -463,7 +484,9 @@ class ProcessManager:
             if should_terminate:
                 break
 
-            time.sleep(MONITOR_SLEEP_TIME)
+            # Phase changes and exceptions wake this up, crashes are checked for on
+            # timeout
+            version = self._state.wait_for_change(version, MONITOR_SLEEP_TIME)
 
         # Terminate if the termination flag was set
         if should_terminate:
@@ -480,10 +503,11 @@ class ProcessManager:
             return
         logger.debug(f"{self._name}:monitoring running processes")
         should_terminate = False
+        version = self._state.version
         while True:
             with self._state.lock:
                 # If any process is stopping, stop all managed processes
-                for process_name, phase in self._state._phases.items():
+                for process_name, phase in self._state.get_all().items():
                     if phase.value >= ProcessPhase.STOPPING.value:
                         logger.debug(f"{self._name}:{process_name} stopping")
                         should_terminate = True
@@ -493,6 +517,11 @@ class ProcessManager:
                 if len(self._crashed_processes) > 0:
                     should_terminate = True
 
+                # Check if any process has stopped sending heartbeats
+                self._check_hanged_processes()
+                if len(self._hanged_processes) > 0:
+                    should_terminate = True
+
                 # Check if any process has raised an exception
                 if self._state.has_exception:
                     should_terminate = True
@@ -501,7 +530,7 @@ class ProcessManager:
             if should_terminate:
                 break
 
-            time.sleep(MONITOR_SLEEP_TIME)
+            version = self._state.wait_for_change(version, MONITOR_SLEEP_TIME)
         logger.debug(f"{self._name}:monitoring complete")
         if should_terminate:
             self._terminate_gracefully()
@@ -514,8 +543,9 @@ class ProcessManager:
         if self._manager_exception is not None:
             raise self._manager_exception
         with self._state.lock:
+            exceptions = self._state.get_all_exceptions()
             if (
-                all(exception is None for exception in self._state._exceptions.values())
+                all(exception is None for exception in exceptions.values())
                 and len(self._hanged_processes) == 0
                 and len(self._crashed_processes) == 0
             ):
@@ -523,7 +553,7 @@ class ProcessManager:
             raise ProcessManagerException(
                 failures={
                     process_name: ProcessFailureType.EXCEPTION
-                    if self._state._exceptions[process_name] is not None
+                    if exceptions[process_name] is not None
                     else ProcessFailureType.HANG
                     if process_name in self._hanged_processes
                     else ProcessFailureType.CRASH
@@ -531,7 +561,7 @@ class ProcessManager:
                     else None
                     for process_name in self._process_info.keys()
                 },
-                exceptions={**self._state._exceptions},
+                exceptions=exceptions,
                 phases=self._state.get_all(),
             )
 
@@ -630,3 +660,27 @@ class ProcessManager:
                     self._crashed_processes.add(process_name)
                     error += f"- {process_name}\n"
                 logger.error(error)
+
+    def _check_hanged_processes(self) -> None:
+        """
+        Checks for hanged processes, if processes send heartbeats. Hanged processes are
+        running processes that haven't sent a heartbeat for the heartbeat period.
+        """
+        if self._heartbeat_period is None:
+            return
+        with self._state.lock:
+            dead_processes = self._get_dead_processes()
+            hanged_processes = {
+                name
+                for name, phase in self._state.get_all().items()
+                if name != self._name
+                and name not in dead_processes
+                and phase == ProcessPhase.RUNNING
+                and self._state.seconds_since_heartbeat(name) > self._heartbeat_period
+            }
+            if len(hanged_processes) > 0:
+                error = f"{self._name}:modules stopped sending heartbeats:\n"
+                for process_name in hanged_processes:
+                    self._hanged_processes.add(process_name)
+                    error += f"- {process_name}\n"
+                logger.error(error)
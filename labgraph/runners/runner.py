@@ -3,7 +3,7 @@
 
 from abc import ABC, abstractmethod
 from dataclasses import dataclass, field
-from typing import Dict, Optional, Type
+from typing import Dict, Optional, Sequence, Type
 
 from ..graphs.module import Module
 from ..graphs.parent_graph_info import ParentGraphInfo
@@ -38,12 +38,34 @@ class RunnerOptions:
             streams.
         logger_type: The Python class for the logger type to use.
         logger_config: Configuration to provide the logger.
+        local_passthrough:
+            If set, a message published to a stream that is only consumed by
+            subscribers in the same process is passed to them as is, without being
+            serialized to shared memory. Messages constructed while the runner runs
+            keep a copy of their field values, and only serialize them when they are
+            produced to shared memory. Subscribers then share the published message
+            and its field values, which must not be mutated.
+        placement_profile_dir:
+            If set, each process of the graph writes a placement profile to this
+            directory when it terminates, for `plan_placement` to read.
+        process_modules:
+            The paths of the modules to run in their own process, empty for the graph.
+            If set, `ParallelRunner` uses these instead of the graph's
+            `process_modules()`, e.g., to apply a `PlacementPlan`.
+        timestamp_samples:
+            If set, messages published without a timestamp in their sample header are
+            stamped with the wall-clock time they are published at, so subscribers can
+            measure their latency.
     """
 
     aligner: Optional[Aligner] = None
     bootstrap_info: Optional[BootstrapInfo] = None
     logger_type: Type[Logger] = HDF5Logger
     logger_config: LoggerConfig = field(default_factory=LoggerConfig)
+    local_passthrough: bool = False
+    placement_profile_dir: Optional[str] = None
+    process_modules: Optional[Sequence[str]] = None
+    timestamp_samples: bool = False
 
 
 class Runner(ABC):
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import pytest
+
+from ...graphs.group import Connections, Group
+from ...graphs.method import AsyncPublisher, publisher, subscriber
+from ...graphs.node import Node
+from ...graphs.topic import Topic
+from ...messages.message import Message
+from ...util.error import LabGraphError
+from ...util.testing import local_test
+from ..benchmark_harness import GraphBenchmarkHarness, LoadSpec, ProbeSpec
+
+
+RATE = 100
+DURATION = 1.0
+
+
+class MyMessage(Message):
+    int_field: int
+    str_field: str
+
+
+class MyPassthrough(Node):
+    INPUT = Topic(MyMessage)
+    OUTPUT = Topic(MyMessage)
+
+    @subscriber(INPUT)
+    @publisher(OUTPUT)
+    async def passthrough(self, message: MyMessage) -> AsyncPublisher:
+        yield self.OUTPUT, message
+
+
+class MyHalvingNode(Node):
+    INPUT = Topic(MyMessage)
+    OUTPUT = Topic(MyMessage)
+
+    def setup(self) -> None:
+        self.num_received = 0
+
+    @subscriber(INPUT)
+    @publisher(OUTPUT)
+    async def halve(self, message: MyMessage) -> AsyncPublisher:
+        self.num_received += 1
+        if self.num_received % 2 == 0:
+            yield self.OUTPUT, message
+
+
+class MyHalvingGroup(Group):
+    INPUT = Topic(MyMessage)
+    OUTPUT = Topic(MyMessage)
+
+    HALVING: MyHalvingNode
+
+    def connections(self) -> Connections:
+        return (
+            (self.INPUT, self.HALVING.INPUT),
+            (self.HALVING.OUTPUT, self.OUTPUT),
+        )
+
+
+class MyPipeline(Group):
+    INPUT = Topic(MyMessage)
+    OUTPUT = Topic(MyMessage)
+
+    FIRST: MyPassthrough
+    SECOND: MyPassthrough
+
+    def connections(self) -> Connections:
+        return (
+            (self.INPUT, self.FIRST.INPUT),
+            (self.FIRST.OUTPUT, self.SECOND.INPUT),
+            (self.SECOND.OUTPUT, self.OUTPUT),
+        )
+
+
+@local_test
+@pytest.mark.parametrize("parallel", (False, True))
+def test_benchmark_run(parallel: bool) -> None:
+    """
+    Tests that synthetic load reaches every probed topic, with its latency measured.
+    """
+    harness = GraphBenchmarkHarness(
+        MyPipeline,
+        probes=(
+            ProbeSpec(topic="FIRST/OUTPUT", ratio=1.0),
+            ProbeSpec(topic="OUTPUT", ratio=1.0),
+        ),
+        parallel=parallel,
+    )
+    result = harness.run(
+        [LoadSpec(topic="INPUT", rate=RATE, dynamic_field_size=16)], duration=DURATION
+    )
+    assert result.sustained
+    assert set(result.edges.keys()) == {"INPUT", "FIRST/OUTPUT", "OUTPUT"}
+    assert result.edges["INPUT"].num_expected == RATE * DURATION
+    assert result.edges["OUTPUT"].num_expected == RATE * DURATION
+    for edge in result.edges.values():
+        assert edge.num_messages > 0
+        assert edge.latency_percentiles[50] <= edge.latency_percentiles[99]
+
+
+@local_test
+def test_benchmark_downstream_drops() -> None:
+    """
+    Tests that messages dropped inside the module are seen by the probes downstream of
+    it, against the ratio they declare.
+    """
+    load = LoadSpec(topic="INPUT", rate=RATE, dynamic_field_size=16)
+    result = GraphBenchmarkHarness(
+        MyHalvingGroup, probes=(ProbeSpec(topic="OUTPUT", ratio=1.0),)
+    ).run([load], duration=DURATION)
+    assert not result.sustained
+    assert result.edges["INPUT"].num_dropped == 0
+    assert result.edges["OUTPUT"].num_dropped > 0
+
+    result = GraphBenchmarkHarness(
+        MyHalvingGroup, probes=(ProbeSpec(topic="OUTPUT", ratio=0.5),)
+    ).run([load], duration=DURATION)
+    assert result.sustained
+    assert result.edges["OUTPUT"].num_expected == RATE * DURATION / 2
+
+
+@local_test
+def test_benchmark_requires_ratio_or_budget() -> None:
+    """
+    Tests that a run refuses probes it couldn't tell drops on without a latency budget.
+    """
+    harness = GraphBenchmarkHarness(MyPipeline, probes=("OUTPUT",))
+    with pytest.raises(LabGraphError):
+        harness.run([LoadSpec(topic="INPUT", rate=RATE)], duration=DURATION)
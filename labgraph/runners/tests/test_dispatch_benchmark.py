@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+from ...util.testing import local_test
+from ..dispatch_benchmark import benchmark_dispatch, benchmark_passthrough
+
+
+NUM_MESSAGES = 100
+ARRAY_SIZE = 1000
+NUM_LARGE_ARRAY_MESSAGES = 20
+LARGE_ARRAY_SIZE = 1000000
+
+
+@local_test
+def test_benchmark_dispatch() -> None:
+    """
+    Tests that the dispatch benchmark delivers every message on each path.
+    """
+    result = benchmark_dispatch(num_messages=NUM_MESSAGES)
+    assert result.num_messages == NUM_MESSAGES
+    assert 0 < result.native
+    assert 0 < result.consumer
+    assert 0 < result.runner
+    assert "runner" in result.report()
+
+
+@local_test
+def test_benchmark_passthrough() -> None:
+    """
+    Tests that messages reach a subscriber in the same process both through shared
+    memory and passed through as is.
+    """
+    result = benchmark_passthrough(num_messages=NUM_MESSAGES, array_size=ARRAY_SIZE)
+    assert result.num_messages == NUM_MESSAGES
+    assert 0 < result.serialized
+    assert 0 < result.passthrough
+    assert "passthrough" in result.report()
+
+
+@local_test
+def test_benchmark_passthrough_large_array() -> None:
+    """
+    Tests that passing messages with a large array through as is is faster than
+    passing them through shared memory, as it skips serializing the array.
+    """
+    result = benchmark_passthrough(
+        num_messages=NUM_LARGE_ARRAY_MESSAGES, array_size=LARGE_ARRAY_SIZE
+    )
+    print(result.report())
+    assert result.passthrough < result.serialized
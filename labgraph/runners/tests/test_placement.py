@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+# Copyright 2004-present Facebook. All Rights Reserved.
+
+import json
+import tempfile
+from pathlib import Path
+from typing import Sequence, Tuple
+
+from ...graphs.graph import Graph
+from ...graphs.group import Connections, Group
+from ...graphs.method import AsyncPublisher, publisher, subscriber
+from ...graphs.module import Module
+from ...graphs.node import Node
+from ...graphs.topic import Topic
+from ...messages.message import Message
+from ...util.testing import local_test
+from ..placement import PlacementProfile, plan_placement
+
+
+ELAPSED = 10.0
+PIPELINE_BYTES = 1000000
+OUTPUT_BYTES = 1000
+
+
+class MyMessage(Message):
+    int_field: int
+
+
+class MySource(Node):
+    A = Topic(MyMessage)
+
+    @publisher(A)
+    async def source(self) -> AsyncPublisher:
+        yield self.A, MyMessage(int_field=0)
+
+
+class MyTransform(Node):
+    B = Topic(MyMessage)
+    C = Topic(MyMessage)
+
+    @subscriber(B)
+    @publisher(C)
+    async def transform(self, message: MyMessage) -> AsyncPublisher:
+        yield self.C, message
+
+
+class MySink(Node):
+    D = Topic(MyMessage)
+
+    @subscriber(D)
+    def sink(self, message: MyMessage) -> None:
+        pass
+
+
+class MyBusyNode(Node):
+    pass
+
+
+class MyPipeline(Group):
+    SOURCE: MySource
+    TRANSFORM: MyTransform
+
+    def connections(self) -> Connections:
+        return ((self.SOURCE.A, self.TRANSFORM.B),)
+
+
+class MyPlacementGraph(Graph):
+    PIPELINE: MyPipeline
+    SINK: MySink
+    BUSY: MyBusyNode
+
+    def connections(self) -> Connections:
+        return ((self.PIPELINE.TRANSFORM.C, self.SINK.D),)
+
+    def process_modules(self) -> Sequence[Module]:
+        return (self.PIPELINE.SOURCE, self.PIPELINE.TRANSFORM, self.SINK, self.BUSY)
+
+
+def write_profiles(directory: str, gil_loads: Tuple[float, ...]) -> None:
+    profiles = [
+        ("PIPELINE/SOURCE", [("PIPELINE/SOURCE/A", PIPELINE_BYTES, True)]),
+        (
+            "PIPELINE/TRANSFORM",
+            [
+                ("PIPELINE/TRANSFORM/B", 0, False),
+                ("PIPELINE/TRANSFORM/C", OUTPUT_BYTES, True),
+            ],
+        ),
+        ("SINK", [("SINK/D", 0, False)]),
+        ("BUSY", []),
+    ]
+    for index, ((module_path, streams), gil_load) in enumerate(
+        zip(profiles, gil_loads)
+    ):
+        profile = {
+            "process": module_path,
+            "module_path": module_path,
+            "elapsed": ELAPSED,
+            "cpu_time": gil_load * ELAPSED,
+            "gil_time": gil_load * ELAPSED,
+            "streams": [
+                {
+                    "topic_paths": [topic_path],
+                    "messages": 1,
+                    "bytes": num_bytes,
+                    "produced": produced,
+                }
+                for topic_path, num_bytes, produced in streams
+            ],
+        }
+        with open(Path(directory) / f"placement_Node_{index}.json", "w") as file:
+            json.dump(profile, file)
+
+
+@local_test
+def test_placement_single_process() -> None:
+    """
+    Tests that the whole graph runs in one process when it fits under the limits.
+    """
+    graph = MyPlacementGraph()
+    with tempfile.TemporaryDirectory() as directory:
+        write_profiles(directory, (0.1, 0.1, 0.1, 0.1))
+        profile = PlacementProfile.load(graph, directory)
+    plan = plan_placement(graph, profile)
+    assert plan.process_modules == ("",)
+    assert plan.cost == 0
+    assert plan.current_cost == (PIPELINE_BYTES + OUTPUT_BYTES) / ELAPSED
+    assert "Proposed: 1 processes" in plan.report()
+
+
+@local_test
+def test_placement_load_limit() -> None:
+    """
+    Tests that the chatty modules share a process when the limits split the graph.
+    """
+    graph = MyPlacementGraph()
+    with tempfile.TemporaryDirectory() as directory:
+        write_profiles(directory, (0.3, 0.3, 0.1, 0.6))
+        profile = PlacementProfile.load(graph, directory)
+    plan = plan_placement(graph, profile, max_gil_load=0.8)
+    assert set(plan.process_modules) == {"PIPELINE", "SINK", "BUSY"}
+    assert plan.cost == OUTPUT_BYTES / ELAPSED
+    assert plan.current_cost is not None and plan.cost < plan.current_cost
+    assert abs(plan.loads["PIPELINE"].gil - 0.6) < 1e-6
@@ -25,6 +25,10 @@ TEST_STARTUP_PERIOD = 5
 TEST_SHUTDOWN_PERIOD = 3
 PROCESS_WAIT_TIME = 0.1
 PROCESS_SLEEP_TIME = 0.01
+TEST_HEARTBEAT_PERIOD = 0.5
+# Longer than the heartbeat period, so that heartbeats are checked while running
+TEST_RUNNING_TIME = 1
+TEST_HANG_RUNNING_TIME = 30
 
 
 class DummyException(Exception):
@@ -52,6 +56,8 @@ def proc(
     manager_name: str,
     shutdown: ShutdownBehavior,
     last_phase: ProcessPhase = ProcessPhase.TERMINATED,
+    heartbeat: bool = False,
+    running_time: float = PROCESS_WAIT_TIME,
 ) -> None:
     """
     A minimal version of a process managed by a `ProcessManager`. Used for testing the
@@ -71,12 +77,17 @@ def proc(
         last_phase:
             The last phase that `proc` will enter. This must be
             `ProcessPhase.TERMINATED` if the shutdown behavior is normal.
+        heartbeat:
+            Whether the process sends heartbeats until it enters its last phase.
+        running_time: The time, in seconds, that the process stays running.
     """
     assert shutdown != ShutdownBehavior.NORMAL or last_phase == ProcessPhase.TERMINATED
     last_phase_changed_at = time.perf_counter()
 
     while True:
         time.sleep(PROCESS_SLEEP_TIME)
+        if heartbeat:
+            state.heartbeat(name)
 
         # If the manager is stopping, set this process to be stopping
         with state.lock:
@@ -93,9 +104,12 @@ def proc(
 
         # Transition to the next phase if we have slept for long enough
         current_time = time.perf_counter()
-        if current_time - last_phase_changed_at > PROCESS_WAIT_TIME:
-            current_phases = state.get_all()
-            current_phase = current_phases[name]
+        current_phases = state.get_all()
+        current_phase = current_phases[name]
+        wait_time = (
+            running_time if current_phase == ProcessPhase.RUNNING else PROCESS_WAIT_TIME
+        )
+        if current_time - last_phase_changed_at > wait_time:
             if (
                 current_phase == ProcessPhase.READY
                 and current_phases[manager_name].value < ProcessPhase.READY.value
@@ -287,18 +301,102 @@ def test_hang(hang_phase: ProcessPhase) -> None:
     assert ex.value.failures == {"proc1": ProcessFailureType.HANG, "proc2": None}
 
 
+@local_test
+def test_heartbeat() -> None:
+    """
+    Tests that processes that keep sending heartbeats run normally.
+    """
+    manager = ProcessManager(
+        processes=tuple(
+            ProcessInfo(
+                module=__name__,
+                name=name,
+                args=(
+                    "--manager-name",
+                    "test_manager",
+                    "--shutdown",
+                    "NORMAL",
+                    "--heartbeat",
+                    "--running-time",
+                    str(TEST_RUNNING_TIME),
+                ),
+            )
+            for name in ("proc1", "proc2")
+        ),
+        name="test_manager",
+        startup_period=TEST_STARTUP_PERIOD,
+        shutdown_period=TEST_SHUTDOWN_PERIOD,
+        heartbeat_period=TEST_HEARTBEAT_PERIOD,
+    )
+
+    manager.run()
+
+
+@local_test
+def test_heartbeat_hang() -> None:
+    """
+    Tests that a running process that stops sending heartbeats is detected as hanged
+    within the heartbeat period, while the other process is still running.
+    """
+    manager = ProcessManager(
+        processes=(
+            ProcessInfo(
+                module=__name__,
+                name="proc1",
+                args=(
+                    "--manager-name",
+                    "test_manager",
+                    "--shutdown",
+                    "HANG",
+                    "--last-phase",
+                    ProcessPhase.RUNNING.name,
+                    "--heartbeat",
+                ),
+            ),
+            ProcessInfo(
+                module=__name__,
+                name="proc2",
+                args=(
+                    "--manager-name",
+                    "test_manager",
+                    "--shutdown",
+                    "NORMAL",
+                    "--heartbeat",
+                    "--running-time",
+                    str(TEST_HANG_RUNNING_TIME),
+                ),
+            ),
+        ),
+        name="test_manager",
+        startup_period=TEST_STARTUP_PERIOD,
+        shutdown_period=TEST_SHUTDOWN_PERIOD,
+        heartbeat_period=TEST_HEARTBEAT_PERIOD,
+    )
+
+    start_time = time.perf_counter()
+    with pytest.raises(ProcessManagerException) as ex:
+        manager.run()
+    # The hang was detected before proc2 would have stopped by itself
+    assert time.perf_counter() - start_time < TEST_HANG_RUNNING_TIME
+    assert ex.value.failures == {"proc1": ProcessFailureType.HANG, "proc2": None}
+
+
 @click.command()
 @click.option(f"--{ProcessManagerState.SUBPROCESS_ARG}", required=True)
 @click.option("--process-name", required=True)
 @click.option("--manager-name", required=True)
 @click.option("--shutdown", required=True)
 @click.option("--last-phase")
+@click.option("--heartbeat", is_flag=True)
+@click.option("--running-time", type=float, default=PROCESS_WAIT_TIME)
 def child_main(
     process_manager_state_file: str,
     process_name: str,
     manager_name: str,
     shutdown: str,
     last_phase: Optional[str] = None,
+    heartbeat: bool = False,
+    running_time: float = PROCESS_WAIT_TIME,
 ) -> None:
     proc(
         ProcessManagerState.load(process_manager_state_file),
@@ -306,6 +404,8 @@ def child_main(
         manager_name,
         ShutdownBehavior[shutdown],
         ProcessPhase[last_phase] if last_phase is not None else ProcessPhase.TERMINATED,
+        heartbeat,
+        running_time,
     )
 
 